@@ -7,6 +7,7 @@
 
 #include "MesholaApp.h"
 #include "service/MesholaMsgService.h"
+#include "diag/Trace.h"
 
 #include <Tactility/lvgl/Toolbar.h>
 #include <Tactility/lvgl/Lvgl.h>
@@ -47,8 +48,8 @@ void MesholaApp::onShow(tt::app::AppContext& appContext, lv_obj_t* parent) {
     // Subscribe to service events
     _messageSubId = _mesholaMsgService->getMessagePubSub()->subscribe(
         [this](const service::MessageEvent& e) { onMessageEvent(e); });
-    _contactSubId = _mesholaMsgService->getContactPubSub()->subscribe(
-        [this](const service::ContactEvent& e) { onContactEvent(e); });
+    _contactBatchSubId = _mesholaMsgService->getContactBatchPubSub()->subscribe(
+        [this](const service::ContactBatchEvent& e) { onContactBatchEvent(e); });
     _ackSubId = _mesholaMsgService->getAckPubSub()->subscribe(
         [this](const service::AckEvent& e) { onAckEvent(e); });
     _statusSubId = _mesholaMsgService->getStatusPubSub()->subscribe(
@@ -78,13 +79,14 @@ void MesholaApp::onHide(tt::app::AppContext& appContext) {
     
     if (_mesholaMsgService) {
         _mesholaMsgService->getMessagePubSub()->unsubscribe(_messageSubId);
-        _mesholaMsgService->getContactPubSub()->unsubscribe(_contactSubId);
+        _mesholaMsgService->getContactBatchPubSub()->unsubscribe(_contactBatchSubId);
         _mesholaMsgService->getAckPubSub()->unsubscribe(_ackSubId);
         _mesholaMsgService->getStatusPubSub()->unsubscribe(_statusSubId);
     }
     
     _chatView.destroy();
     _contactsView.destroy();
+    _statusView.destroy();
     _mesholaMsgService = nullptr;
     _parent = nullptr;
     _contentContainer = nullptr;
@@ -96,12 +98,14 @@ void MesholaApp::onMessageEvent(const service::MessageEvent& event) {
             ? (memcmp(event.message.senderKey, _activeContact.publicKey, PUBLIC_KEY_SIZE) == 0)
             : (memcmp(event.message.recipientKey, _activeContact.publicKey, PUBLIC_KEY_SIZE) == 0);
         if (relevant) {
+            MESHOLA_TRACE_SCOPE(Ui);
             _chatView.addMessage(event.message);
         }
     }
 }
 
-void MesholaApp::onContactEvent(const service::ContactEvent& event) {
+void MesholaApp::onContactBatchEvent(const service::ContactBatchEvent& event) {
+    // One rebuild per coalescing window, however many adverts arrived
     if (_currentView == ViewType::Contacts) {
         refreshContactList();
     }
@@ -114,6 +118,9 @@ void MesholaApp::onAckEvent(const service::AckEvent& event) {
 
 void MesholaApp::onStatusEvent(const service::StatusEvent& event) {
     // Status bar updates could go here
+    if (_currentView == ViewType::Settings) {
+        _statusView.refresh();
+    }
 }
 
 void MesholaApp::createNavBar(lv_obj_t* parent) {
@@ -164,6 +171,7 @@ void MesholaApp::showView(ViewType view) {
     
     if (_currentView == ViewType::Chat) _chatView.destroy();
     else if (_currentView == ViewType::Contacts) _contactsView.destroy();
+    else if (_currentView == ViewType::Settings) _statusView.destroy();
     
     lv_obj_clean(_contentContainer);
     _currentView = view;
@@ -189,7 +197,8 @@ void MesholaApp::showView(ViewType view) {
             createChannelsViewPlaceholder();
             break;
         case ViewType::Settings:
-            createSettingsViewPlaceholder();
+            _statusView.setService(_mesholaMsgService);
+            _statusView.create(_contentContainer);
             break;
     }
 }
@@ -248,17 +257,4 @@ void MesholaApp::createChannelsViewPlaceholder() {
     lv_obj_set_style_text_color(lbl, lv_color_hex(COLOR_TEXT_DIM), LV_STATE_DEFAULT);
 }
 
-void MesholaApp::createSettingsViewPlaceholder() {
-    auto* c = lv_obj_create(_contentContainer);
-    lv_obj_set_size(c, LV_PCT(100), LV_PCT(100));
-    lv_obj_set_style_bg_color(c, lv_color_hex(COLOR_BG_DARK), LV_STATE_DEFAULT);
-    lv_obj_set_style_border_width(c, 0, LV_STATE_DEFAULT);
-    lv_obj_set_flex_flow(c, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_flex_align(c, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-    auto* lbl = lv_label_create(c);
-    lv_label_set_text(lbl, "Settings\nComing soon...");
-    lv_obj_set_style_text_align(lbl, LV_TEXT_ALIGN_CENTER, LV_STATE_DEFAULT);
-    lv_obj_set_style_text_color(lbl, lv_color_hex(COLOR_TEXT_DIM), LV_STATE_DEFAULT);
-}
-
 } // namespace meshola
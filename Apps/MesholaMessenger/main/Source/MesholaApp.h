@@ -8,6 +8,7 @@
 #include "service/MesholaMsgService.h"
 #include "views/ChatView.h"
 #include "views/ContactsView.h"
+#include "views/StatusView.h"
 
 namespace meshola {
 
@@ -64,7 +65,7 @@ private:
     
     // PubSub event handlers
     void onMessageEvent(const service::MessageEvent& event);
-    void onContactEvent(const service::ContactEvent& event);
+    void onContactBatchEvent(const service::ContactBatchEvent& event);
     void onAckEvent(const service::AckEvent& event);
     void onStatusEvent(const service::StatusEvent& event);
     
@@ -76,7 +77,6 @@ private:
     
     // Placeholder view creators (temporary until full views)
     void createChannelsViewPlaceholder();
-    void createSettingsViewPlaceholder();
     
     // Refresh views with data from service
     void refreshContactList();
@@ -98,13 +98,14 @@ private:
     // Views
     ChatView _chatView;
     ContactsView _contactsView;
+    StatusView _statusView;     // Shown on the Settings tab until settings exist
     
     // MesholaMsgService connection
     std::shared_ptr<service::MesholaMsgService> _mesholaMsgService;
     
     // PubSub subscription IDs (for unsubscribing on hide)
     tt::PubSub<service::MessageEvent>::SubscriptionHandle _messageSubId = nullptr;
-    tt::PubSub<service::ContactEvent>::SubscriptionHandle _contactSubId = nullptr;
+    tt::PubSub<service::ContactBatchEvent>::SubscriptionHandle _contactBatchSubId = nullptr;
     tt::PubSub<service::AckEvent>::SubscriptionHandle _ackSubId = nullptr;
     tt::PubSub<service::StatusEvent>::SubscriptionHandle _statusSubId = nullptr;
     
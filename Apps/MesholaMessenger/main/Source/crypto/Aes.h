@@ -0,0 +1,27 @@
+#pragma once
+
+/**
+ * AES-128 in counter mode (NIST SP 800-38A).
+ *
+ * On ESP32 the cipher runs on the AES accelerator through ESP-IDF's mbedTLS
+ * port. Elsewhere a portable byte-oriented implementation with identical
+ * output is used; it is not constant-time against cache timing, which only
+ * matters on hosts shared with an attacker.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace meshola::crypto {
+
+constexpr size_t AES128_KEY_LEN = 16;
+constexpr size_t AES_BLOCK_LEN = 16;
+
+/**
+ * XOR data in place with the AES-128-CTR keystream. iv is the first counter
+ * block, incremented as a 128-bit big-endian integer per block. Encryption
+ * and decryption are the same operation; never reuse a key/iv pair.
+ */
+void aes128Ctr(const uint8_t key[AES128_KEY_LEN], const uint8_t iv[AES_BLOCK_LEN], uint8_t* data, size_t len);
+
+} // namespace meshola::crypto
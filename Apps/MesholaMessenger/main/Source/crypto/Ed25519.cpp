@@ -0,0 +1,781 @@
+#include "Ed25519.h"
+#include "Sha2.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace meshola::crypto {
+
+namespace {
+
+// ============================================================================
+// Field arithmetic mod p = 2^255 - 19
+//
+// Ten signed limbs, alternately 26 and 25 bits wide: limb i weighs
+// 2^ceil(25.5 i), so limb products land on limb weights (times 2 when both
+// indices are odd) and 2^255 folds back as 19. Every operation carries its
+// result, which keeps limbs below ~2^26 and products well inside 64 bits.
+// ============================================================================
+
+struct Fe {
+    int32_t v[10];
+};
+
+constexpr int LIMB_BITS[10] = { 26, 25, 26, 25, 26, 25, 26, 25, 26, 25 };
+
+Fe carry(int64_t t[10]) {
+    for (int i = 0; i < 10; i++) {
+        int64_t c = t[i] >> LIMB_BITS[i];
+        t[i] -= c * ((int64_t)1 << LIMB_BITS[i]);
+        if (i < 9) {
+            t[i + 1] += c;
+        } else {
+            t[0] += 19 * c;
+        }
+    }
+    int64_t c = t[0] >> 26;
+    t[0] -= c * ((int64_t)1 << 26);
+    t[1] += c;
+    Fe out;
+    for (int i = 0; i < 10; i++) {
+        out.v[i] = (int32_t)t[i];
+    }
+    return out;
+}
+
+Fe feFromInt(int32_t value) {
+    int64_t t[10] = { value };
+    return carry(t);
+}
+
+Fe feAdd(const Fe& a, const Fe& b) {
+    int64_t t[10];
+    for (int i = 0; i < 10; i++) {
+        t[i] = (int64_t)a.v[i] + b.v[i];
+    }
+    return carry(t);
+}
+
+Fe feSub(const Fe& a, const Fe& b) {
+    int64_t t[10];
+    for (int i = 0; i < 10; i++) {
+        t[i] = (int64_t)a.v[i] - b.v[i];
+    }
+    return carry(t);
+}
+
+Fe feNeg(const Fe& a) {
+    return feSub(Fe{}, a);
+}
+
+Fe feMul(const Fe& a, const Fe& b) {
+    // b pre-scaled for the odd/odd (x2) and wrapped (x19) cases
+    int64_t b19[10];
+    int64_t b2[10];
+    int64_t b38[10];
+    for (int j = 0; j < 10; j++) {
+        b19[j] = 19 * (int64_t)b.v[j];
+        b2[j] = (j & 1) ? 2 * (int64_t)b.v[j] : b.v[j];
+        b38[j] = (j & 1) ? 2 * b19[j] : b19[j];
+    }
+    int64_t t[10] = {};
+    for (int i = 0; i < 10; i++) {
+        const int64_t ai = a.v[i];
+        const bool odd = i & 1;
+        for (int j = 0; j < 10 - i; j++) {
+            t[i + j] += ai * (odd ? b2[j] : b.v[j]);
+        }
+        for (int j = 10 - i; j < 10; j++) {
+            t[i + j - 10] += ai * (odd ? b38[j] : b19[j]);
+        }
+    }
+    return carry(t);
+}
+
+Fe feSq(const Fe& a) {
+    return feMul(a, a);
+}
+
+Fe feSqN(Fe a, int n) {
+    for (int i = 0; i < n; i++) {
+        a = feSq(a);
+    }
+    return a;
+}
+
+Fe feMulSmall(const Fe& a, int32_t k) {
+    int64_t t[10];
+    for (int i = 0; i < 10; i++) {
+        t[i] = (int64_t)a.v[i] * k;
+    }
+    return carry(t);
+}
+
+// a^(p - 2) = a^(2^255 - 21)
+Fe feInvert(const Fe& a) {
+    Fe t0 = feSq(a);                                // 2
+    Fe t1 = feMul(a, feSqN(t0, 2));                 // 9
+    t0 = feMul(t0, t1);                             // 11
+    t1 = feMul(t1, feSq(t0));                       // 2^5 - 1
+    t1 = feMul(feSqN(t1, 5), t1);                   // 2^10 - 1
+    Fe t2 = feMul(feSqN(t1, 10), t1);               // 2^20 - 1
+    t2 = feMul(feSqN(t2, 20), t2);                  // 2^40 - 1
+    t1 = feMul(feSqN(t2, 10), t1);                  // 2^50 - 1
+    t2 = feMul(feSqN(t1, 50), t1);                  // 2^100 - 1
+    t2 = feMul(feSqN(t2, 100), t2);                 // 2^200 - 1
+    t1 = feMul(feSqN(t2, 50), t1);                  // 2^250 - 1
+    return feMul(feSqN(t1, 5), t0);                 // 2^255 - 21
+}
+
+// a^((p - 5) / 8) = a^(2^252 - 3), for square roots
+Fe fePow22523(const Fe& a) {
+    Fe t0 = feSq(a);                                // 2
+    Fe t1 = feMul(a, feSqN(t0, 2));                 // 9
+    t0 = feMul(t0, t1);                             // 11
+    t0 = feMul(t1, feSq(t0));                       // 2^5 - 1
+    t1 = feMul(feSqN(t0, 5), t0);                   // 2^10 - 1
+    Fe t2 = feMul(feSqN(t1, 10), t1);               // 2^20 - 1
+    t2 = feMul(feSqN(t2, 20), t2);                  // 2^40 - 1
+    t0 = feMul(feSqN(t2, 10), t1);                  // 2^50 - 1
+    t1 = feMul(feSqN(t0, 50), t0);                  // 2^100 - 1
+    t1 = feMul(feSqN(t1, 100), t1);                 // 2^200 - 1
+    t0 = feMul(feSqN(t1, 50), t0);                  // 2^250 - 1
+    return feMul(feSqN(t0, 2), a);                  // 2^252 - 3
+}
+
+Fe feFromBytes(const uint8_t s[32]) {
+    // The top bit is not part of the value
+    Fe out;
+    int offset = 0;
+    for (int i = 0; i < 10; i++) {
+        int32_t limb = 0;
+        for (int b = 0; b < LIMB_BITS[i]; b++) {
+            int pos = offset + b;
+            limb |= (int32_t)((s[pos >> 3] >> (pos & 7)) & 1) << b;
+        }
+        out.v[i] = limb;
+        offset += LIMB_BITS[i];
+    }
+    return out;
+}
+
+void feToBytes(uint8_t s[32], const Fe& a) {
+    int64_t t[10];
+    for (int i = 0; i < 10; i++) {
+        t[i] = a.v[i];
+    }
+    // Three passes bring any carried value into [0, 2^255) with every limb
+    // in range: the first leaves at most +-8 * 2^255 to fold, the second
+    // at most one more fold, the third none
+    for (int pass = 0; pass < 3; pass++) {
+        int64_t c = 0;
+        for (int i = 0; i < 10; i++) {
+            t[i] += c;
+            c = t[i] >> LIMB_BITS[i];
+            t[i] -= c * ((int64_t)1 << LIMB_BITS[i]);
+        }
+        t[0] += 19 * c;
+    }
+    // Subtract p if the value is at least p, i.e. value + 19 reaches 2^255
+    int64_t u[10];
+    int64_t c = 19;
+    for (int i = 0; i < 10; i++) {
+        u[i] = t[i] + c;
+        c = u[i] >> LIMB_BITS[i];
+        u[i] -= c * ((int64_t)1 << LIMB_BITS[i]);
+    }
+    int64_t mask = -c;
+    for (int i = 0; i < 10; i++) {
+        t[i] = (t[i] & ~mask) | (u[i] & mask);
+    }
+    memset(s, 0, 32);
+    int offset = 0;
+    for (int i = 0; i < 10; i++) {
+        for (int b = 0; b < LIMB_BITS[i]; b++) {
+            int pos = offset + b;
+            s[pos >> 3] |= (uint8_t)(((t[i] >> b) & 1) << (pos & 7));
+        }
+        offset += LIMB_BITS[i];
+    }
+}
+
+bool feIsZero(const Fe& a) {
+    uint8_t s[32];
+    feToBytes(s, a);
+    uint8_t any = 0;
+    for (uint8_t byte : s) {
+        any |= byte;
+    }
+    return any == 0;
+}
+
+bool feIsNegative(const Fe& a) {
+    uint8_t s[32];
+    feToBytes(s, a);
+    return s[0] & 1;
+}
+
+bool feEqual(const Fe& a, const Fe& b) {
+    return feIsZero(feSub(a, b));
+}
+
+// f = g if bit, constant time
+void feCmov(Fe& f, const Fe& g, int32_t bit) {
+    int32_t mask = -bit;
+    for (int i = 0; i < 10; i++) {
+        f.v[i] ^= mask & (f.v[i] ^ g.v[i]);
+    }
+}
+
+void feCswap(Fe& f, Fe& g, int32_t bit) {
+    int32_t mask = -bit;
+    for (int i = 0; i < 10; i++) {
+        int32_t x = mask & (f.v[i] ^ g.v[i]);
+        f.v[i] ^= x;
+        g.v[i] ^= x;
+    }
+}
+
+// Variable time; constants only
+Fe fePow(const Fe& a, const uint8_t exponent[32]) {
+    Fe r = feFromInt(1);
+    for (int bit = 255; bit >= 0; bit--) {
+        r = feSq(r);
+        if ((exponent[bit >> 3] >> (bit & 7)) & 1) {
+            r = feMul(r, a);
+        }
+    }
+    return r;
+}
+
+// ============================================================================
+// Edwards points (-x^2 + y^2 = 1 + d x^2 y^2)
+//
+// Extended coordinates (X:Y:Z:T) with x = X/Z, y = Y/Z, T = XY/Z. Addends
+// are kept "cached" as (Y+X, Y-X, Z, 2dT). The a = -1 formulas of Hisil et
+// al. used here are complete, so the identity and doubling need no cases.
+// ============================================================================
+
+struct Point {
+    Fe X, Y, Z, T;
+};
+
+struct Cached {
+    Fe yPlusX, yMinusX, Z, t2d;
+};
+
+struct FieldConstants {
+    Fe d;
+    Fe d2;
+    Fe sqrtM1;
+};
+
+FieldConstants makeFieldConstants() {
+    FieldConstants k;
+    // d = -121665 / 121666
+    k.d = feMul(feNeg(feFromInt(121665)), feInvert(feFromInt(121666)));
+    k.d2 = feAdd(k.d, k.d);
+    // sqrt(-1) = 2^((p - 1) / 4), exponent 2^253 - 5
+    uint8_t exponent[32];
+    memset(exponent, 0xFF, sizeof(exponent));
+    exponent[0] = 0xFB;
+    exponent[31] = 0x1F;
+    k.sqrtM1 = fePow(feFromInt(2), exponent);
+    return k;
+}
+
+const FieldConstants& fieldConstants() {
+    static const FieldConstants k = makeFieldConstants();
+    return k;
+}
+
+Point identity() {
+    return Point{ Fe{}, feFromInt(1), feFromInt(1), Fe{} };
+}
+
+Cached cachedIdentity() {
+    return Cached{ feFromInt(1), feFromInt(1), feFromInt(1), Fe{} };
+}
+
+Cached toCached(const Point& p) {
+    return Cached{ feAdd(p.Y, p.X), feSub(p.Y, p.X), p.Z, feMul(p.T, fieldConstants().d2) };
+}
+
+Cached negate(const Cached& c) {
+    return Cached{ c.yMinusX, c.yPlusX, c.Z, feNeg(c.t2d) };
+}
+
+Point negate(const Point& p) {
+    return Point{ feNeg(p.X), p.Y, p.Z, feNeg(p.T) };
+}
+
+Point add(const Point& p, const Cached& q) {
+    Fe a = feMul(feSub(p.Y, p.X), q.yMinusX);
+    Fe b = feMul(feAdd(p.Y, p.X), q.yPlusX);
+    Fe c = feMul(p.T, q.t2d);
+    Fe zz = feMul(p.Z, q.Z);
+    Fe d = feAdd(zz, zz);
+    Fe e = feSub(b, a);
+    Fe f = feSub(d, c);
+    Fe g = feAdd(d, c);
+    Fe h = feAdd(b, a);
+    return Point{ feMul(e, f), feMul(g, h), feMul(f, g), feMul(e, h) };
+}
+
+Point dbl(const Point& p) {
+    Fe a = feSq(p.X);
+    Fe b = feSq(p.Y);
+    Fe zz = feSq(p.Z);
+    Fe c = feAdd(zz, zz);
+    Fe e = feSub(feSub(feSq(feAdd(p.X, p.Y)), a), b);
+    Fe g = feSub(b, a);
+    Fe f = feSub(g, c);
+    Fe h = feNeg(feAdd(a, b));
+    return Point{ feMul(e, f), feMul(g, h), feMul(f, g), feMul(e, h) };
+}
+
+bool isIdentity(const Point& p) {
+    return feIsZero(p.X) && feEqual(p.Y, p.Z);
+}
+
+void encodePoint(uint8_t s[32], const Point& p) {
+    Fe zInv = feInvert(p.Z);
+    Fe x = feMul(p.X, zInv);
+    Fe y = feMul(p.Y, zInv);
+    feToBytes(s, y);
+    s[31] |= (uint8_t)(feIsNegative(x) << 7);
+}
+
+// RFC 8032 5.1.3
+bool decodePoint(Point& p, const uint8_t s[32]) {
+    const FieldConstants& k = fieldConstants();
+    Fe y = feFromBytes(s);
+    uint8_t canonical[32];
+    feToBytes(canonical, y);
+    if (memcmp(canonical, s, 31) != 0 || canonical[31] != (s[31] & 0x7F)) {
+        return false;                               // y >= p
+    }
+    Fe one = feFromInt(1);
+    Fe yy = feSq(y);
+    Fe u = feSub(yy, one);
+    Fe v = feAdd(feMul(k.d, yy), one);
+    Fe v3 = feMul(feSq(v), v);
+    Fe v7 = feMul(feSq(v3), v);
+    Fe x = feMul(feMul(u, v3), fePow22523(feMul(u, v7)));
+    Fe vxx = feMul(v, feSq(x));
+    if (!feEqual(vxx, u)) {
+        if (!feEqual(vxx, feNeg(u))) {
+            return false;                           // Not on the curve
+        }
+        x = feMul(x, k.sqrtM1);
+    }
+    bool sign = s[31] >> 7;
+    if (feIsZero(x) && sign) {
+        return false;
+    }
+    if (feIsNegative(x) != sign) {
+        x = feNeg(x);
+    }
+    p = Point{ x, y, one, feMul(x, y) };
+    return true;
+}
+
+void buildTable(Cached table[8], const Point& p) {
+    table[0] = toCached(p);
+    Point multiple = dbl(p);
+    table[1] = toCached(multiple);
+    for (int i = 2; i < 8; i++) {
+        multiple = add(multiple, table[0]);
+        table[i] = toCached(multiple);
+    }
+}
+
+struct BasePoint {
+    Point point;
+    Cached table[8];        // 1B .. 8B
+};
+
+const BasePoint& basePoint() {
+    static const BasePoint b = [] {
+        // y = 4/5, x even (RFC 8032 5.1)
+        BasePoint out;
+        uint8_t s[32];
+        feToBytes(s, feMul(feFromInt(4), feInvert(feFromInt(5))));
+        decodePoint(out.point, s);
+        buildTable(out.table, out.point);
+        return out;
+    }();
+    return b;
+}
+
+// ============================================================================
+// Scalars mod L = 2^252 + 27742317777372353535851937790883648493
+// ============================================================================
+
+constexpr int64_t L[32] = {
+    0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x10
+};
+
+// Reduce 64 signed byte-sized digits mod L (after TweetNaCl)
+void modL(uint8_t r[32], int64_t x[64]) {
+    for (int i = 63; i >= 32; i--) {
+        int64_t c = 0;
+        int j;
+        for (j = i - 32; j < i - 12; j++) {
+            x[j] += c - 16 * x[i] * L[j - (i - 32)];
+            c = (x[j] + 128) >> 8;
+            x[j] -= c * 256;
+        }
+        x[j] += c;
+        x[i] = 0;
+    }
+    int64_t c = 0;
+    for (int j = 0; j < 32; j++) {
+        x[j] += c - (x[31] >> 4) * L[j];
+        c = x[j] >> 8;
+        x[j] &= 255;
+    }
+    for (int j = 0; j < 32; j++) {
+        x[j] -= c * L[j];
+    }
+    for (int i = 0; i < 32; i++) {
+        x[i + 1] += x[i] >> 8;
+        r[i] = (uint8_t)(x[i] & 255);
+    }
+}
+
+void scReduce(uint8_t out[32], const uint8_t in[64]) {
+    int64_t x[64];
+    for (int i = 0; i < 64; i++) {
+        x[i] = in[i];
+    }
+    modL(out, x);
+}
+
+// out = a * b + c mod L; out may alias c
+void scMulAdd(uint8_t out[32], const uint8_t a[32], const uint8_t b[32], const uint8_t c[32]) {
+    int64_t x[64] = {};
+    for (int i = 0; i < 32; i++) {
+        x[i] = c[i];
+    }
+    for (int i = 0; i < 32; i++) {
+        for (int j = 0; j < 32; j++) {
+            x[i + j] += (int64_t)a[i] * b[j];
+        }
+    }
+    modL(out, x);
+}
+
+bool scIsCanonical(const uint8_t s[32]) {
+    for (int i = 31; i >= 0; i--) {
+        if (s[i] != L[i]) {
+            return s[i] < L[i];
+        }
+    }
+    return false;
+}
+
+// Signed radix-16 digits in [-8, 8]; a must be below 2^255
+void recode(int8_t e[64], const uint8_t a[32]) {
+    for (int i = 0; i < 32; i++) {
+        e[2 * i] = (int8_t)(a[i] & 15);
+        e[2 * i + 1] = (int8_t)(a[i] >> 4);
+    }
+    int8_t c = 0;
+    for (int i = 0; i < 63; i++) {
+        e[i] = (int8_t)(e[i] + c);
+        c = (int8_t)((e[i] + 8) >> 4);
+        e[i] = (int8_t)(e[i] - c * 16);
+    }
+    e[63] = (int8_t)(e[63] + c);
+}
+
+// ============================================================================
+// Scalar multiplication
+// ============================================================================
+
+// sum of digits[j] * tables[j]; variable time (public inputs only)
+Point multiScalar(const int8_t* const* digits, const Cached* const* tables, size_t count) {
+    Point q = identity();
+    bool started = false;
+    for (int i = 63; i >= 0; i--) {
+        if (started) {
+            q = dbl(dbl(dbl(dbl(q))));
+        }
+        for (size_t j = 0; j < count; j++) {
+            int8_t digit = digits[j][i];
+            if (digit > 0) {
+                q = add(q, tables[j][digit - 1]);
+                started = true;
+            } else if (digit < 0) {
+                q = add(q, negate(tables[j][-digit - 1]));
+                started = true;
+            }
+        }
+    }
+    return q;
+}
+
+// a * B in constant time: every digit does the same doublings, table scan
+// and addition (of the identity for a zero digit)
+Point scalarMultBase(const uint8_t a[32]) {
+    const Cached* table = basePoint().table;
+    int8_t e[64];
+    recode(e, a);
+    Point q = identity();
+    for (int i = 63; i >= 0; i--) {
+        q = dbl(dbl(dbl(dbl(q))));
+        int32_t negative = (uint8_t)e[i] >> 7;
+        int32_t magnitude = e[i] - ((-negative) & (2 * e[i]));
+        Cached t = cachedIdentity();
+        for (int k = 1; k <= 8; k++) {
+            int32_t match = ((uint32_t)((magnitude ^ k) - 1)) >> 31;
+            feCmov(t.yPlusX, table[k - 1].yPlusX, match);
+            feCmov(t.yMinusX, table[k - 1].yMinusX, match);
+            feCmov(t.Z, table[k - 1].Z, match);
+            feCmov(t.t2d, table[k - 1].t2d, match);
+        }
+        Cached minus = negate(t);
+        feCmov(t.yPlusX, minus.yPlusX, negative);
+        feCmov(t.yMinusX, minus.yMinusX, negative);
+        feCmov(t.t2d, minus.t2d, negative);
+        q = add(q, t);
+    }
+    memset(e, 0, sizeof(e));
+    return q;
+}
+
+// ============================================================================
+// Signatures
+// ============================================================================
+
+void expandSeed(const uint8_t seed[ED25519_SEED_LEN], uint8_t h[64]) {
+    sha512(seed, ED25519_SEED_LEN, h);
+    h[0] &= 248;
+    h[31] &= 127;
+    h[31] |= 64;
+}
+
+// k = SHA-512(R || A || M) mod L
+void challenge(uint8_t k[32], const uint8_t* r, const uint8_t* publicKey, const uint8_t* message, size_t length) {
+    Sha512 hash;
+    hash.update(r, 32);
+    hash.update(publicKey, ED25519_PUBLIC_KEY_LEN);
+    hash.update(message, length);
+    uint8_t digest[64];
+    hash.finish(digest);
+    scReduce(k, digest);
+}
+
+struct Prepared {
+    Point minusA;
+    Point minusR;
+    uint8_t k[32];
+};
+
+bool prepare(Prepared& out, const Ed25519Item& item) {
+    const uint8_t* s = item.signature + 32;
+    if (!scIsCanonical(s) || !decodePoint(out.minusA, item.publicKey) || !decodePoint(out.minusR, item.signature)) {
+        return false;
+    }
+    out.minusA = negate(out.minusA);
+    out.minusR = negate(out.minusR);
+    challenge(out.k, item.signature, item.publicKey, item.message, item.length);
+    return true;
+}
+
+bool isSmallOrder(Point q) {
+    // Cofactored: [8]Q is the identity
+    return isIdentity(dbl(dbl(dbl(q))));
+}
+
+} // namespace
+
+void ed25519PublicKey(const uint8_t seed[ED25519_SEED_LEN], uint8_t publicKey[ED25519_PUBLIC_KEY_LEN]) {
+    uint8_t h[64];
+    expandSeed(seed, h);
+    encodePoint(publicKey, scalarMultBase(h));
+    memset(h, 0, sizeof(h));
+}
+
+void ed25519Sign(const uint8_t seed[ED25519_SEED_LEN],
+                 const uint8_t publicKey[ED25519_PUBLIC_KEY_LEN],
+                 const uint8_t* message,
+                 size_t length,
+                 uint8_t signature[ED25519_SIGNATURE_LEN]) {
+    uint8_t h[64];
+    expandSeed(seed, h);
+    // r = SHA-512(prefix || M) mod L, R = rB
+    uint8_t digest[64];
+    Sha512 hash;
+    hash.update(h + 32, 32);
+    hash.update(message, length);
+    hash.finish(digest);
+    uint8_t r[32];
+    scReduce(r, digest);
+    encodePoint(signature, scalarMultBase(r));
+    // S = r + k * a mod L
+    uint8_t k[32];
+    challenge(k, signature, publicKey, message, length);
+    scMulAdd(signature + 32, k, h, r);
+    memset(h, 0, sizeof(h));
+    memset(digest, 0, sizeof(digest));
+    memset(r, 0, sizeof(r));
+}
+
+bool ed25519Verify(const uint8_t publicKey[ED25519_PUBLIC_KEY_LEN],
+                   const uint8_t* message,
+                   size_t length,
+                   const uint8_t signature[ED25519_SIGNATURE_LEN]) {
+    Prepared p;
+    if (!prepare(p, Ed25519Item{ publicKey, message, length, signature })) {
+        return false;
+    }
+    // [8]([S]B - [k]A - R)
+    Cached tableA[8];
+    buildTable(tableA, p.minusA);
+    int8_t digitsS[64];
+    int8_t digitsK[64];
+    recode(digitsS, signature + 32);
+    recode(digitsK, p.k);
+    const int8_t* digits[2] = { digitsS, digitsK };
+    const Cached* tables[2] = { basePoint().table, tableA };
+    Point q = add(multiScalar(digits, tables, 2), toCached(p.minusR));
+    return isSmallOrder(q);
+}
+
+bool ed25519VerifyBatch(const Ed25519Item* items, size_t count) {
+    if (count == 0) {
+        return true;
+    }
+    if (count == 1) {
+        return ed25519Verify(items[0].publicKey, items[0].message, items[0].length, items[0].signature);
+    }
+    std::vector<Prepared> prepared(count);
+    Sha512 transcript;
+    for (size_t i = 0; i < count; i++) {
+        if (!prepare(prepared[i], items[i])) {
+            return false;
+        }
+        transcript.update(items[i].signature, ED25519_SIGNATURE_LEN);
+        transcript.update(prepared[i].k, 32);
+    }
+    uint8_t seed[64];
+    transcript.finish(seed);
+
+    // sum z_i ([S_i]B - [k_i]A_i - R_i) with 128-bit z_i from the transcript:
+    // one term of B, two per signature
+    const size_t terms = 1 + 2 * count;
+    std::vector<Cached> tables(terms * 8);
+    std::vector<int8_t> digits(terms * 64);
+    std::vector<const int8_t*> digitRows(terms);
+    std::vector<const Cached*> tableRows(terms);
+    uint8_t sumS[32] = {};
+    const uint8_t zero[32] = {};
+    for (size_t i = 0; i < count; i++) {
+        uint8_t block[64 + 4];
+        memcpy(block, seed, 64);
+        block[64] = (uint8_t)i;
+        block[65] = (uint8_t)(i >> 8);
+        block[66] = (uint8_t)(i >> 16);
+        block[67] = (uint8_t)(i >> 24);
+        uint8_t digest[64];
+        sha512(block, sizeof(block), digest);
+        uint8_t z[32] = {};
+        memcpy(z, digest, 16);
+
+        uint8_t zk[32];
+        scMulAdd(zk, z, prepared[i].k, zero);
+        scMulAdd(sumS, z, items[i].signature + 32, sumS);
+
+        size_t rTerm = 1 + 2 * i;
+        size_t aTerm = rTerm + 1;
+        buildTable(&tables[rTerm * 8], prepared[i].minusR);
+        buildTable(&tables[aTerm * 8], prepared[i].minusA);
+        recode(&digits[rTerm * 64], z);
+        recode(&digits[aTerm * 64], zk);
+    }
+    recode(&digits[0], sumS);
+    for (size_t t = 0; t < terms; t++) {
+        digitRows[t] = &digits[t * 64];
+        tableRows[t] = t == 0 ? basePoint().table : &tables[t * 8];
+    }
+    return isSmallOrder(multiScalar(digitRows.data(), tableRows.data(), terms));
+}
+
+size_t ed25519VerifyEach(const Ed25519Item* items, size_t count, bool* valid) {
+    size_t validCount = 0;
+    for (size_t start = 0; start < count; start += ED25519_MAX_BATCH) {
+        size_t n = std::min(ED25519_MAX_BATCH, count - start);
+        bool all = n > 1 && ed25519VerifyBatch(items + start, n);
+        for (size_t i = start; i < start + n; i++) {
+            valid[i] = all || ed25519Verify(items[i].publicKey, items[i].message, items[i].length, items[i].signature);
+            validCount += valid[i] ? 1 : 0;
+        }
+    }
+    return validCount;
+}
+
+void x25519(uint8_t out[X25519_LEN], const uint8_t scalar[X25519_LEN], const uint8_t u[X25519_LEN]) {
+    uint8_t e[32];
+    memcpy(e, scalar, sizeof(e));
+    e[0] &= 248;
+    e[31] &= 127;
+    e[31] |= 64;
+    // Montgomery ladder (RFC 7748 5)
+    Fe x1 = feFromBytes(u);
+    Fe x2 = feFromInt(1);
+    Fe z2 = {};
+    Fe x3 = x1;
+    Fe z3 = feFromInt(1);
+    int32_t swap = 0;
+    for (int pos = 254; pos >= 0; pos--) {
+        int32_t bit = (e[pos >> 3] >> (pos & 7)) & 1;
+        swap ^= bit;
+        feCswap(x2, x3, swap);
+        feCswap(z2, z3, swap);
+        swap = bit;
+        Fe a = feAdd(x2, z2);
+        Fe aa = feSq(a);
+        Fe b = feSub(x2, z2);
+        Fe bb = feSq(b);
+        Fe diff = feSub(aa, bb);
+        Fe c = feAdd(x3, z3);
+        Fe d = feSub(x3, z3);
+        Fe da = feMul(d, a);
+        Fe cb = feMul(c, b);
+        x3 = feSq(feAdd(da, cb));
+        z3 = feMul(x1, feSq(feSub(da, cb)));
+        x2 = feMul(aa, bb);
+        z2 = feMul(diff, feAdd(aa, feMulSmall(diff, 121665)));
+    }
+    feCswap(x2, x3, swap);
+    feCswap(z2, z3, swap);
+    feToBytes(out, feMul(x2, feInvert(z2)));
+    memset(e, 0, sizeof(e));
+}
+
+bool ed25519KeyExchange(const uint8_t seed[ED25519_SEED_LEN],
+                        const uint8_t peerPublicKey[ED25519_PUBLIC_KEY_LEN],
+                        uint8_t shared[X25519_LEN]) {
+    Point peer;
+    if (!decodePoint(peer, peerPublicKey)) {
+        return false;
+    }
+    // u = (1 + y) / (1 - y) = (Z + Y) / (Z - Y); y = 1 gives u = 0
+    uint8_t u[32];
+    feToBytes(u, feMul(feAdd(peer.Z, peer.Y), feInvert(feSub(peer.Z, peer.Y))));
+    uint8_t h[64];
+    sha512(seed, ED25519_SEED_LEN, h);
+    x25519(shared, h, u);
+    memset(h, 0, sizeof(h));
+    uint8_t any = 0;
+    for (size_t i = 0; i < X25519_LEN; i++) {
+        any |= shared[i];
+    }
+    return any != 0;
+}
+
+} // namespace meshola::crypto
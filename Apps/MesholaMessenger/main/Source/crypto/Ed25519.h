@@ -0,0 +1,93 @@
+#pragma once
+
+/**
+ * Ed25519 signatures (RFC 8032) and X25519 key agreement (RFC 7748).
+ *
+ * One Ed25519 identity serves both: ed25519KeyExchange() maps the keys onto
+ * Curve25519 (u = (1 + y) / (1 - y)), so the public key a node announces in
+ * its adverts is also its key-agreement key.
+ *
+ * Field elements are ten 25/26-bit limbs multiplied into 64-bit sums, which
+ * suits the ESP32-S3's 32-bit core (it has no ECC accelerator). Key
+ * generation, signing and key agreement run in constant time. Verification
+ * only handles public data and uses variable-time multi-scalar
+ * multiplication; the doublings are shared by every term, which is what
+ * makes a batch cheaper per signature than single checks.
+ *
+ * Verification is cofactored ([8][S]B = [8]R + [8][k]A) for single and batch
+ * checks alike, so the two never disagree about a signature.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace meshola::crypto {
+
+constexpr size_t ED25519_SEED_LEN = 32;
+constexpr size_t ED25519_PUBLIC_KEY_LEN = 32;
+constexpr size_t ED25519_SIGNATURE_LEN = 64;
+constexpr size_t X25519_LEN = 32;
+constexpr size_t ED25519_MAX_BATCH = 8;     // ~2.5 KB of tables per signature
+
+/**
+ * A signature to verify. Pointers must stay valid for the call.
+ */
+struct Ed25519Item {
+    const uint8_t* publicKey;
+    const uint8_t* message;
+    size_t length;
+    const uint8_t* signature;
+};
+
+/**
+ * Public key for a 32-byte secret seed (the RFC 8032 private key).
+ */
+void ed25519PublicKey(const uint8_t seed[ED25519_SEED_LEN], uint8_t publicKey[ED25519_PUBLIC_KEY_LEN]);
+
+/**
+ * Sign a message. publicKey must be ed25519PublicKey(seed).
+ */
+void ed25519Sign(const uint8_t seed[ED25519_SEED_LEN],
+                 const uint8_t publicKey[ED25519_PUBLIC_KEY_LEN],
+                 const uint8_t* message,
+                 size_t length,
+                 uint8_t signature[ED25519_SIGNATURE_LEN]);
+
+/**
+ * True if the signature is valid. Rejects non-canonical S and keys or R
+ * that are not points on the curve.
+ */
+bool ed25519Verify(const uint8_t publicKey[ED25519_PUBLIC_KEY_LEN],
+                   const uint8_t* message,
+                   size_t length,
+                   const uint8_t signature[ED25519_SIGNATURE_LEN]);
+
+/**
+ * True if every signature is valid. Checks one random linear combination of
+ * the verification equations, with coefficients derived from a hash of the
+ * whole batch. A false result doesn't say which signature failed.
+ */
+bool ed25519VerifyBatch(const Ed25519Item* items, size_t count);
+
+/**
+ * Verify signatures in batches of up to ED25519_MAX_BATCH, checking the
+ * signatures of a failed batch one by one. Sets valid[i] for each item and
+ * returns how many are valid.
+ */
+size_t ed25519VerifyEach(const Ed25519Item* items, size_t count, bool* valid);
+
+/**
+ * X25519 scalar multiplication: out = scalar * u (scalar clamped).
+ */
+void x25519(uint8_t out[X25519_LEN], const uint8_t scalar[X25519_LEN], const uint8_t u[X25519_LEN]);
+
+/**
+ * Shared secret between our Ed25519 identity and a peer's Ed25519 public
+ * key: X25519 of both mapped onto Curve25519. False if the peer key is not
+ * a valid point or of small order.
+ */
+bool ed25519KeyExchange(const uint8_t seed[ED25519_SEED_LEN],
+                        const uint8_t peerPublicKey[ED25519_PUBLIC_KEY_LEN],
+                        uint8_t shared[X25519_LEN]);
+
+} // namespace meshola::crypto
@@ -0,0 +1,154 @@
+#include "PeerCrypto.h"
+
+#include <cstring>
+
+namespace meshola::crypto {
+
+namespace {
+
+const char ENC_LABEL[] = "meshola-enc";
+const char MAC_LABEL[] = "meshola-mac";
+
+void deriveKeys(const uint8_t shared[X25519_LEN], PeerKeys& out) {
+    uint8_t digest[SHA256_LEN];
+    hmacSha256(shared, X25519_LEN, ENC_LABEL, sizeof(ENC_LABEL) - 1, digest);
+    memcpy(out.encKey, digest, sizeof(out.encKey));
+    hmacSha256(shared, X25519_LEN, MAC_LABEL, sizeof(MAC_LABEL) - 1, out.macKey);
+    memset(digest, 0, sizeof(digest));
+}
+
+void computeTag(const PeerKeys& keys,
+                const uint8_t nonce[PEER_NONCE_LEN],
+                const uint8_t* data,
+                size_t len,
+                uint8_t tag[PEER_TAG_LEN]) {
+    // HMAC over nonce || data without copying the payload
+    uint8_t pad[64] = {};
+    memcpy(pad, keys.macKey, sizeof(keys.macKey));
+    for (uint8_t& byte : pad) {
+        byte ^= 0x36;
+    }
+    uint8_t inner[SHA256_LEN];
+    Sha256 hash;
+    hash.update(pad, sizeof(pad));
+    hash.update(nonce, PEER_NONCE_LEN);
+    hash.update(data, len);
+    hash.finish(inner);
+    for (uint8_t& byte : pad) {
+        byte ^= 0x36 ^ 0x5C;
+    }
+    uint8_t outer[SHA256_LEN];
+    hash.update(pad, sizeof(pad));
+    hash.update(inner, sizeof(inner));
+    hash.finish(outer);
+    memcpy(tag, outer, PEER_TAG_LEN);
+    memset(pad, 0, sizeof(pad));
+}
+
+void makeIv(const uint8_t nonce[PEER_NONCE_LEN], uint8_t iv[AES_BLOCK_LEN]) {
+    memset(iv, 0, AES_BLOCK_LEN);
+    memcpy(iv, nonce, PEER_NONCE_LEN);
+}
+
+} // namespace
+
+PeerKeyCache::~PeerKeyCache() {
+    setIdentity(nullptr);
+}
+
+void PeerKeyCache::setIdentity(const uint8_t seed[ED25519_SEED_LEN]) {
+    clear();
+    if (seed) {
+        memcpy(_seed, seed, sizeof(_seed));
+        _hasIdentity = true;
+    } else {
+        memset(_seed, 0, sizeof(_seed));
+        _hasIdentity = false;
+    }
+}
+
+const PeerKeys* PeerKeyCache::lookup(const uint8_t peerPublicKey[ED25519_PUBLIC_KEY_LEN]) {
+    if (!_hasIdentity || !peerPublicKey) {
+        return nullptr;
+    }
+    Entry* victim = &_entries[0];
+    for (Entry& entry : _entries) {
+        if (entry.used && memcmp(entry.peer, peerPublicKey, sizeof(entry.peer)) == 0) {
+            entry.lastUse = ++_useClock;
+            _hits++;
+            return &entry.keys;
+        }
+        if (victim->used && (!entry.used || entry.lastUse < victim->lastUse)) {
+            victim = &entry;
+        }
+    }
+
+    _misses++;
+    uint8_t shared[X25519_LEN];
+    if (!ed25519KeyExchange(_seed, peerPublicKey, shared)) {
+        return nullptr;
+    }
+    if (victim->used) {
+        _evictions++;
+    }
+    victim->used = true;
+    victim->lastUse = ++_useClock;
+    memcpy(victim->peer, peerPublicKey, sizeof(victim->peer));
+    deriveKeys(shared, victim->keys);
+    memset(shared, 0, sizeof(shared));
+    return &victim->keys;
+}
+
+void PeerKeyCache::forget(const uint8_t peerPublicKey[ED25519_PUBLIC_KEY_LEN]) {
+    for (Entry& entry : _entries) {
+        if (entry.used && memcmp(entry.peer, peerPublicKey, sizeof(entry.peer)) == 0) {
+            memset(&entry, 0, sizeof(entry));
+        }
+    }
+}
+
+void PeerKeyCache::clear() {
+    memset(_entries.data(), 0, sizeof(Entry) * _entries.size());
+    _useClock = 0;
+}
+
+size_t PeerKeyCache::size() const {
+    size_t count = 0;
+    for (const Entry& entry : _entries) {
+        count += entry.used ? 1 : 0;
+    }
+    return count;
+}
+
+void seal(const PeerKeys& keys,
+          const uint8_t nonce[PEER_NONCE_LEN],
+          uint8_t* data,
+          size_t len,
+          uint8_t tag[PEER_TAG_LEN]) {
+    uint8_t iv[AES_BLOCK_LEN];
+    makeIv(nonce, iv);
+    aes128Ctr(keys.encKey, iv, data, len);
+    computeTag(keys, nonce, data, len, tag);
+}
+
+bool open(const PeerKeys& keys,
+          const uint8_t nonce[PEER_NONCE_LEN],
+          uint8_t* data,
+          size_t len,
+          const uint8_t tag[PEER_TAG_LEN]) {
+    uint8_t expected[PEER_TAG_LEN];
+    computeTag(keys, nonce, data, len, expected);
+    uint8_t diff = 0;
+    for (size_t i = 0; i < PEER_TAG_LEN; i++) {
+        diff |= expected[i] ^ tag[i];
+    }
+    if (diff != 0) {
+        return false;
+    }
+    uint8_t iv[AES_BLOCK_LEN];
+    makeIv(nonce, iv);
+    aes128Ctr(keys.encKey, iv, data, len);
+    return true;
+}
+
+} // namespace meshola::crypto
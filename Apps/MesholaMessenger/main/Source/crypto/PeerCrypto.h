@@ -0,0 +1,103 @@
+#pragma once
+
+/**
+ * PeerCrypto - Per-peer keys for authenticated encryption.
+ *
+ * A key exchange costs about as much as a signature, far too much to repeat
+ * for every message on the ESP32. PeerKeyCache derives the keys shared with
+ * a peer once (ed25519KeyExchange, then HMAC-SHA256 into an AES-128 key and
+ * a MAC key) and keeps the most recently used peers. seal() and open() then
+ * only cost the hardware AES and SHA passes over the payload.
+ *
+ * Frame layout and nonce bookkeeping belong to the protocol; this file only
+ * holds keys and transforms buffers. Not thread-safe.
+ */
+
+#include "Aes.h"
+#include "Ed25519.h"
+#include "Sha2.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace meshola::crypto {
+
+constexpr size_t PEER_KEY_CACHE_SIZE = 16;
+constexpr size_t PEER_NONCE_LEN = 8;        // Never reused under one peer's keys
+constexpr size_t PEER_TAG_LEN = 4;          // Truncated HMAC; LoRa frames are small
+
+struct PeerKeys {
+    uint8_t encKey[AES128_KEY_LEN];
+    uint8_t macKey[SHA256_LEN];
+};
+
+class PeerKeyCache {
+public:
+    PeerKeyCache() = default;
+    ~PeerKeyCache();
+    PeerKeyCache(const PeerKeyCache&) = delete;
+    PeerKeyCache& operator=(const PeerKeyCache&) = delete;
+
+    /**
+     * Our Ed25519 seed, or nullptr for none. Drops all cached keys.
+     */
+    void setIdentity(const uint8_t seed[ED25519_SEED_LEN]);
+    bool hasIdentity() const { return _hasIdentity; }
+
+    /**
+     * Keys shared with a peer, derived on a miss (evicting the least
+     * recently used peer when full). nullptr without an identity or if the
+     * peer key is invalid. Valid until the next call that changes the cache.
+     */
+    const PeerKeys* lookup(const uint8_t peerPublicKey[ED25519_PUBLIC_KEY_LEN]);
+
+    /**
+     * Drop one peer's keys, e.g. when the contact is removed.
+     */
+    void forget(const uint8_t peerPublicKey[ED25519_PUBLIC_KEY_LEN]);
+    void clear();
+
+    size_t size() const;
+    uint32_t hits() const { return _hits; }
+    uint32_t misses() const { return _misses; }
+    uint32_t evictions() const { return _evictions; }
+
+private:
+    struct Entry {
+        bool used;
+        uint32_t lastUse;
+        uint8_t peer[ED25519_PUBLIC_KEY_LEN];
+        PeerKeys keys;
+    };
+
+    std::array<Entry, PEER_KEY_CACHE_SIZE> _entries = {};
+    uint8_t _seed[ED25519_SEED_LEN] = {};
+    bool _hasIdentity = false;
+    uint32_t _useClock = 0;
+    uint32_t _hits = 0;
+    uint32_t _misses = 0;
+    uint32_t _evictions = 0;
+};
+
+/**
+ * Encrypt data in place with AES-128-CTR (IV = nonce, then zeros) and write
+ * the tag: HMAC-SHA256 over nonce and ciphertext, truncated.
+ */
+void seal(const PeerKeys& keys,
+          const uint8_t nonce[PEER_NONCE_LEN],
+          uint8_t* data,
+          size_t len,
+          uint8_t tag[PEER_TAG_LEN]);
+
+/**
+ * Check the tag, then decrypt in place. False (data untouched) if the tag
+ * doesn't match.
+ */
+bool open(const PeerKeys& keys,
+          const uint8_t nonce[PEER_NONCE_LEN],
+          uint8_t* data,
+          size_t len,
+          const uint8_t tag[PEER_TAG_LEN]);
+
+} // namespace meshola::crypto
@@ -0,0 +1,326 @@
+#include "Sha2.h"
+
+#include <cstring>
+
+namespace meshola::crypto {
+
+#ifdef ESP_PLATFORM
+
+// ============================================================================
+// ESP32: SHA accelerator (CONFIG_MBEDTLS_HARDWARE_SHA)
+// ============================================================================
+
+Sha256::Sha256() {
+    mbedtls_sha256_init(&_ctx);
+    mbedtls_sha256_starts(&_ctx, 0);
+}
+
+Sha256::~Sha256() {
+    mbedtls_sha256_free(&_ctx);
+}
+
+void Sha256::update(const void* data, size_t len) {
+    mbedtls_sha256_update(&_ctx, static_cast<const unsigned char*>(data), len);
+}
+
+void Sha256::finish(uint8_t out[SHA256_LEN]) {
+    mbedtls_sha256_finish(&_ctx, out);
+    mbedtls_sha256_starts(&_ctx, 0);
+}
+
+Sha512::Sha512() {
+    mbedtls_sha512_init(&_ctx);
+    mbedtls_sha512_starts(&_ctx, 0);
+}
+
+Sha512::~Sha512() {
+    mbedtls_sha512_free(&_ctx);
+}
+
+void Sha512::update(const void* data, size_t len) {
+    mbedtls_sha512_update(&_ctx, static_cast<const unsigned char*>(data), len);
+}
+
+void Sha512::finish(uint8_t out[SHA512_LEN]) {
+    mbedtls_sha512_finish(&_ctx, out);
+    mbedtls_sha512_starts(&_ctx, 0);
+}
+
+#else
+
+// ============================================================================
+// Portable (FIPS 180-4)
+// ============================================================================
+
+static constexpr uint32_t K256[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static constexpr uint64_t K512[80] = {
+    0x428a2f98d728ae22ull, 0x7137449123ef65cdull, 0xb5c0fbcfec4d3b2full, 0xe9b5dba58189dbbcull,
+    0x3956c25bf348b538ull, 0x59f111f1b605d019ull, 0x923f82a4af194f9bull, 0xab1c5ed5da6d8118ull,
+    0xd807aa98a3030242ull, 0x12835b0145706fbeull, 0x243185be4ee4b28cull, 0x550c7dc3d5ffb4e2ull,
+    0x72be5d74f27b896full, 0x80deb1fe3b1696b1ull, 0x9bdc06a725c71235ull, 0xc19bf174cf692694ull,
+    0xe49b69c19ef14ad2ull, 0xefbe4786384f25e3ull, 0x0fc19dc68b8cd5b5ull, 0x240ca1cc77ac9c65ull,
+    0x2de92c6f592b0275ull, 0x4a7484aa6ea6e483ull, 0x5cb0a9dcbd41fbd4ull, 0x76f988da831153b5ull,
+    0x983e5152ee66dfabull, 0xa831c66d2db43210ull, 0xb00327c898fb213full, 0xbf597fc7beef0ee4ull,
+    0xc6e00bf33da88fc2ull, 0xd5a79147930aa725ull, 0x06ca6351e003826full, 0x142929670a0e6e70ull,
+    0x27b70a8546d22ffcull, 0x2e1b21385c26c926ull, 0x4d2c6dfc5ac42aedull, 0x53380d139d95b3dfull,
+    0x650a73548baf63deull, 0x766a0abb3c77b2a8ull, 0x81c2c92e47edaee6ull, 0x92722c851482353bull,
+    0xa2bfe8a14cf10364ull, 0xa81a664bbc423001ull, 0xc24b8b70d0f89791ull, 0xc76c51a30654be30ull,
+    0xd192e819d6ef5218ull, 0xd69906245565a910ull, 0xf40e35855771202aull, 0x106aa07032bbd1b8ull,
+    0x19a4c116b8d2d0c8ull, 0x1e376c085141ab53ull, 0x2748774cdf8eeb99ull, 0x34b0bcb5e19b48a8ull,
+    0x391c0cb3c5c95a63ull, 0x4ed8aa4ae3418acbull, 0x5b9cca4f7763e373ull, 0x682e6ff3d6b2b8a3ull,
+    0x748f82ee5defb2fcull, 0x78a5636f43172f60ull, 0x84c87814a1f0ab72ull, 0x8cc702081a6439ecull,
+    0x90befffa23631e28ull, 0xa4506cebde82bde9ull, 0xbef9a3f7b2c67915ull, 0xc67178f2e372532bull,
+    0xca273eceea26619cull, 0xd186b8c721c0c207ull, 0xeada7dd6cde0eb1eull, 0xf57d4f7fee6ed178ull,
+    0x06f067aa72176fbaull, 0x0a637dc5a2c898a6ull, 0x113f9804bef90daeull, 0x1b710b35131c471bull,
+    0x28db77f523047d84ull, 0x32caab7b40c72493ull, 0x3c9ebe0a15c9bebcull, 0x431d67c49c100d4cull,
+    0x4cc5d4becb3e42b6ull, 0x597f299cfc657e2aull, 0x5fcb6fab3ad6faecull, 0x6c44198c4a475817ull,
+};
+
+static inline uint32_t rotr32(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+static inline uint64_t rotr64(uint64_t x, int n) {
+    return (x >> n) | (x << (64 - n));
+}
+
+static inline uint32_t load32be(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline uint64_t load64be(const uint8_t* p) {
+    return ((uint64_t)load32be(p) << 32) | load32be(p + 4);
+}
+
+static inline void store32be(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static inline void store64be(uint8_t* p, uint64_t v) {
+    store32be(p, (uint32_t)(v >> 32));
+    store32be(p + 4, (uint32_t)v);
+}
+
+Sha256::Sha256() {
+    reset();
+}
+
+Sha256::~Sha256() = default;
+
+void Sha256::reset() {
+    static constexpr uint32_t INITIAL[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(_state, INITIAL, sizeof(_state));
+    _length = 0;
+    _blockLen = 0;
+}
+
+void Sha256::compress(const uint8_t* block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = load32be(block + 4 * i);
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = _state[0], b = _state[1], c = _state[2], d = _state[3];
+    uint32_t e = _state[4], f = _state[5], g = _state[6], h = _state[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = h + (rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25)) + ((e & f) ^ (~e & g)) + K256[i] + w[i];
+        uint32_t t2 = (rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    _state[0] += a;
+    _state[1] += b;
+    _state[2] += c;
+    _state[3] += d;
+    _state[4] += e;
+    _state[5] += f;
+    _state[6] += g;
+    _state[7] += h;
+}
+
+void Sha256::update(const void* data, size_t len) {
+    const uint8_t* in = static_cast<const uint8_t*>(data);
+    _length += len;
+    while (len > 0) {
+        if (_blockLen == 0 && len >= BLOCK_LEN) {
+            compress(in);
+            in += BLOCK_LEN;
+            len -= BLOCK_LEN;
+            continue;
+        }
+        size_t take = BLOCK_LEN - _blockLen < len ? BLOCK_LEN - _blockLen : len;
+        memcpy(_block + _blockLen, in, take);
+        _blockLen += take;
+        in += take;
+        len -= take;
+        if (_blockLen == BLOCK_LEN) {
+            compress(_block);
+            _blockLen = 0;
+        }
+    }
+}
+
+void Sha256::finish(uint8_t out[SHA256_LEN]) {
+    uint64_t bits = _length * 8;
+    uint8_t pad[BLOCK_LEN + 8] = {0x80};
+    size_t padLen = (_blockLen < BLOCK_LEN - 8 ? BLOCK_LEN - 8 : 2 * BLOCK_LEN - 8) - _blockLen;
+    store64be(pad + padLen, bits);
+    update(pad, padLen + 8);
+    for (int i = 0; i < 8; i++) {
+        store32be(out + 4 * i, _state[i]);
+    }
+    reset();
+}
+
+Sha512::Sha512() {
+    reset();
+}
+
+Sha512::~Sha512() = default;
+
+void Sha512::reset() {
+    static constexpr uint64_t INITIAL[8] = {
+        0x6a09e667f3bcc908ull, 0xbb67ae8584caa73bull, 0x3c6ef372fe94f82bull, 0xa54ff53a5f1d36f1ull,
+        0x510e527fade682d1ull, 0x9b05688c2b3e6c1full, 0x1f83d9abfb41bd6bull, 0x5be0cd19137e2179ull
+    };
+    memcpy(_state, INITIAL, sizeof(_state));
+    _length = 0;
+    _blockLen = 0;
+}
+
+void Sha512::compress(const uint8_t* block) {
+    uint64_t w[80];
+    for (int i = 0; i < 16; i++) {
+        w[i] = load64be(block + 8 * i);
+    }
+    for (int i = 16; i < 80; i++) {
+        uint64_t s0 = rotr64(w[i - 15], 1) ^ rotr64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+        uint64_t s1 = rotr64(w[i - 2], 19) ^ rotr64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint64_t a = _state[0], b = _state[1], c = _state[2], d = _state[3];
+    uint64_t e = _state[4], f = _state[5], g = _state[6], h = _state[7];
+    for (int i = 0; i < 80; i++) {
+        uint64_t t1 = h + (rotr64(e, 14) ^ rotr64(e, 18) ^ rotr64(e, 41)) + ((e & f) ^ (~e & g)) + K512[i] + w[i];
+        uint64_t t2 = (rotr64(a, 28) ^ rotr64(a, 34) ^ rotr64(a, 39)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    _state[0] += a;
+    _state[1] += b;
+    _state[2] += c;
+    _state[3] += d;
+    _state[4] += e;
+    _state[5] += f;
+    _state[6] += g;
+    _state[7] += h;
+}
+
+void Sha512::update(const void* data, size_t len) {
+    const uint8_t* in = static_cast<const uint8_t*>(data);
+    _length += len;
+    while (len > 0) {
+        if (_blockLen == 0 && len >= BLOCK_LEN) {
+            compress(in);
+            in += BLOCK_LEN;
+            len -= BLOCK_LEN;
+            continue;
+        }
+        size_t take = BLOCK_LEN - _blockLen < len ? BLOCK_LEN - _blockLen : len;
+        memcpy(_block + _blockLen, in, take);
+        _blockLen += take;
+        in += take;
+        len -= take;
+        if (_blockLen == BLOCK_LEN) {
+            compress(_block);
+            _blockLen = 0;
+        }
+    }
+}
+
+void Sha512::finish(uint8_t out[SHA512_LEN]) {
+    // 128-bit length field; messages here never reach 2^61 bytes
+    uint64_t bits = _length * 8;
+    uint8_t pad[BLOCK_LEN + 16] = {0x80};
+    size_t padLen = (_blockLen < BLOCK_LEN - 16 ? BLOCK_LEN - 16 : 2 * BLOCK_LEN - 16) - _blockLen;
+    store64be(pad + padLen + 8, bits);
+    update(pad, padLen + 16);
+    for (int i = 0; i < 8; i++) {
+        store64be(out + 8 * i, _state[i]);
+    }
+    reset();
+}
+
+#endif // ESP_PLATFORM
+
+void sha256(const void* data, size_t len, uint8_t out[SHA256_LEN]) {
+    Sha256 hash;
+    hash.update(data, len);
+    hash.finish(out);
+}
+
+void sha512(const void* data, size_t len, uint8_t out[SHA512_LEN]) {
+    Sha512 hash;
+    hash.update(data, len);
+    hash.finish(out);
+}
+
+void hmacSha256(const uint8_t* key, size_t keyLen, const void* data, size_t len, uint8_t out[SHA256_LEN]) {
+    constexpr size_t BLOCK = 64;
+    uint8_t block[BLOCK] = {};
+    if (keyLen > BLOCK) {
+        sha256(key, keyLen, block);
+    } else if (keyLen > 0) {
+        memcpy(block, key, keyLen);
+    }
+    uint8_t pad[BLOCK];
+    Sha256 hash;
+    for (size_t i = 0; i < BLOCK; i++) {
+        pad[i] = block[i] ^ 0x36;
+    }
+    hash.update(pad, BLOCK);
+    hash.update(data, len);
+    uint8_t inner[SHA256_LEN];
+    hash.finish(inner);
+    for (size_t i = 0; i < BLOCK; i++) {
+        pad[i] = block[i] ^ 0x5c;
+    }
+    hash.update(pad, BLOCK);
+    hash.update(inner, SHA256_LEN);
+    hash.finish(out);
+    memset(block, 0, sizeof(block));
+    memset(pad, 0, sizeof(pad));
+}
+
+} // namespace meshola::crypto
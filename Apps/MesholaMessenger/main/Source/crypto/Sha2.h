@@ -0,0 +1,90 @@
+#pragma once
+
+/**
+ * SHA-256, HMAC-SHA256 and SHA-512.
+ *
+ * On ESP32 the hashes run on the SHA accelerator through ESP-IDF's mbedTLS
+ * port. Elsewhere (simulator, benchmarks) a portable implementation with
+ * identical output is used.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef ESP_PLATFORM
+#include <mbedtls/sha256.h>
+#include <mbedtls/sha512.h>
+#endif
+
+namespace meshola::crypto {
+
+constexpr size_t SHA256_LEN = 32;
+constexpr size_t SHA512_LEN = 64;
+
+/**
+ * Incremental SHA-256. finish() writes the digest and starts a new hash.
+ */
+class Sha256 {
+public:
+    Sha256();
+    ~Sha256();
+    Sha256(const Sha256&) = delete;
+    Sha256& operator=(const Sha256&) = delete;
+
+    void update(const void* data, size_t len);
+    void finish(uint8_t out[SHA256_LEN]);
+
+private:
+#ifdef ESP_PLATFORM
+    mbedtls_sha256_context _ctx;
+#else
+    static constexpr size_t BLOCK_LEN = 64;
+
+    uint32_t _state[8];
+    uint64_t _length;
+    uint8_t _block[BLOCK_LEN];
+    size_t _blockLen;
+
+    void reset();
+    void compress(const uint8_t* block);
+#endif
+};
+
+/**
+ * Incremental SHA-512. finish() writes the digest and starts a new hash.
+ */
+class Sha512 {
+public:
+    Sha512();
+    ~Sha512();
+    Sha512(const Sha512&) = delete;
+    Sha512& operator=(const Sha512&) = delete;
+
+    void update(const void* data, size_t len);
+    void finish(uint8_t out[SHA512_LEN]);
+
+private:
+#ifdef ESP_PLATFORM
+    mbedtls_sha512_context _ctx;
+#else
+    static constexpr size_t BLOCK_LEN = 128;
+
+    uint64_t _state[8];
+    uint64_t _length;
+    uint8_t _block[BLOCK_LEN];
+    size_t _blockLen;
+
+    void reset();
+    void compress(const uint8_t* block);
+#endif
+};
+
+void sha256(const void* data, size_t len, uint8_t out[SHA256_LEN]);
+void sha512(const void* data, size_t len, uint8_t out[SHA512_LEN]);
+
+/**
+ * HMAC-SHA256 (RFC 2104).
+ */
+void hmacSha256(const uint8_t* key, size_t keyLen, const void* data, size_t len, uint8_t out[SHA256_LEN]);
+
+} // namespace meshola::crypto
@@ -0,0 +1,153 @@
+#include "Capture.h"
+#include "../util/Clock.h"
+
+#include <cmath>
+#include <cstring>
+#include <ctime>
+
+namespace meshola::diag {
+
+// ============================================================================
+// PacketCapture
+// ============================================================================
+
+PacketCapture::~PacketCapture() {
+    close();
+}
+
+bool PacketCapture::open(const char* path, const RadioConfig& config) {
+    close();
+    if (!path) {
+        return false;
+    }
+    _file = fopen(path, "wb");
+    if (!_file) {
+        return false;
+    }
+
+    CaptureFileHeader header = {};
+    memcpy(header.magic, "MCAP", 4);
+    header.version = CAPTURE_FILE_VERSION;
+    header.recordHeaderSize = sizeof(CaptureRecordHeader);
+    header.startTime = (uint32_t)time(nullptr);
+    header.frequencyKhz = (uint32_t)lroundf(config.frequency * 1000.0f);
+    header.bandwidthHz = (uint32_t)lroundf(config.bandwidth * 1000.0f);
+    header.spreadingFactor = config.spreadingFactor;
+    header.codingRate = config.codingRate;
+    header.preambleLength = effectivePreambleLength(config);
+
+    if (fwrite(&header, sizeof(header), 1, _file) != 1) {
+        fclose(_file);
+        _file = nullptr;
+        return false;
+    }
+
+    _openedAtMs = clock::millis();
+    _records = 0;
+    _dropped = 0;
+    _used = 0;
+    return true;
+}
+
+void PacketCapture::close() {
+    if (!_file) {
+        return;
+    }
+    flush();
+    fclose(_file);
+    _file = nullptr;
+}
+
+void PacketCapture::record(const uint8_t* data, size_t len, float rssi, float snr) {
+    if (!_file || !data || len == 0 || len > 255) {
+        return;
+    }
+    size_t needed = sizeof(CaptureRecordHeader) + len;
+    if (_used + needed > sizeof(_buffer) && !flush()) {
+        _dropped++;
+        return;
+    }
+
+    CaptureRecordHeader header = {
+        .timeMs = clock::millis() - _openedAtMs,
+        .rssiX4 = (int16_t)lroundf(rssi * 4.0f),
+        .snrX4 = (int8_t)lroundf(snr * 4.0f),
+        .length = (uint8_t)len
+    };
+    memcpy(_buffer + _used, &header, sizeof(header));
+    memcpy(_buffer + _used + sizeof(header), data, len);
+    _used += needed;
+    _records++;
+}
+
+bool PacketCapture::flush() {
+    if (_used == 0) {
+        return true;
+    }
+    bool ok = fwrite(_buffer, 1, _used, _file) == _used;
+    fflush(_file);
+    _used = 0;
+    return ok;
+}
+
+// ============================================================================
+// CaptureReader
+// ============================================================================
+
+CaptureReader::~CaptureReader() {
+    close();
+}
+
+bool CaptureReader::open(const char* path) {
+    close();
+    if (!path) {
+        return false;
+    }
+    _file = fopen(path, "rb");
+    if (!_file) {
+        return false;
+    }
+    if (fread(&_header, sizeof(_header), 1, _file) != 1 ||
+        memcmp(_header.magic, "MCAP", 4) != 0 ||
+        _header.version != CAPTURE_FILE_VERSION ||
+        _header.recordHeaderSize != sizeof(CaptureRecordHeader)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void CaptureReader::close() {
+    if (_file) {
+        fclose(_file);
+        _file = nullptr;
+    }
+}
+
+RadioConfig CaptureReader::getRadioConfig() const {
+    return RadioConfig{
+        .frequency = _header.frequencyKhz / 1000.0f,
+        .bandwidth = _header.bandwidthHz / 1000.0f,
+        .spreadingFactor = _header.spreadingFactor,
+        .codingRate = _header.codingRate,
+        .txPower = 0,
+        .preambleLength = _header.preambleLength,
+        .dutyCyclePermille = 0
+    };
+}
+
+bool CaptureReader::next(CaptureRecordHeader& record, uint8_t* data) {
+    if (!_file || !data) {
+        return false;
+    }
+    if (fread(&record, sizeof(record), 1, _file) != 1) {
+        return false;
+    }
+    return record.length > 0 && fread(data, 1, record.length, _file) == record.length;
+}
+
+bool CaptureReader::rewind() {
+    return _file && fseek(_file, sizeof(CaptureFileHeader), SEEK_SET) == 0;
+}
+
+} // namespace meshola::diag
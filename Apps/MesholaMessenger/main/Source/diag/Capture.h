@@ -0,0 +1,125 @@
+#pragma once
+
+/**
+ * Raw RX frame capture.
+ *
+ * When enabled, every frame read from the radio is appended to a compact
+ * binary file together with its RSSI, SNR and arrival time, before any
+ * parsing, so field problems can be replayed on the host (sim/ meshola_replay).
+ *
+ * File layout: CaptureFileHeader, then per frame a CaptureRecordHeader
+ * followed by `length` payload bytes. Records are buffered in RAM and
+ * written in blocks to keep SD writes off the per-packet path.
+ */
+
+#include "../protocol/IProtocol.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace meshola::diag {
+
+constexpr uint16_t CAPTURE_FILE_VERSION = 1;
+constexpr size_t CAPTURE_BUFFER_SIZE = 2048;
+
+struct CaptureFileHeader {
+    char magic[4];              // "MCAP"
+    uint16_t version;           // CAPTURE_FILE_VERSION
+    uint16_t recordHeaderSize;  // sizeof(CaptureRecordHeader)
+    uint32_t startTime;         // Unix time when the capture was opened
+    uint32_t frequencyKhz;
+    uint32_t bandwidthHz;
+    uint8_t spreadingFactor;
+    uint8_t codingRate;
+    uint16_t preambleLength;
+};
+static_assert(sizeof(CaptureFileHeader) == 24, "CaptureFileHeader layout changed");
+
+struct CaptureRecordHeader {
+    uint32_t timeMs;            // Since the capture was opened
+    int16_t rssiX4;             // dBm * 4
+    int8_t snrX4;               // dB * 4
+    uint8_t length;             // Payload bytes that follow
+};
+static_assert(sizeof(CaptureRecordHeader) == 8, "CaptureRecordHeader must stay 8 bytes");
+
+/**
+ * Appends frames to a capture file. Not thread-safe: the protocol calls
+ * record() from the mesh thread and the owner opens/closes it under the
+ * service lock.
+ */
+class PacketCapture {
+public:
+    PacketCapture() = default;
+    ~PacketCapture();
+
+    PacketCapture(const PacketCapture&) = delete;
+    PacketCapture& operator=(const PacketCapture&) = delete;
+
+    bool open(const char* path, const RadioConfig& config);
+
+    /**
+     * Flush buffered records and close the file.
+     */
+    void close();
+
+    bool isOpen() const { return _file != nullptr; }
+
+    void record(const uint8_t* data, size_t len, float rssi, float snr);
+
+    uint32_t getRecordCount() const { return _records; }
+    uint32_t getDroppedCount() const { return _dropped; }
+
+private:
+    FILE* _file = nullptr;
+    uint32_t _openedAtMs = 0;
+    uint32_t _records = 0;
+    uint32_t _dropped = 0;
+    size_t _used = 0;
+    uint8_t _buffer[CAPTURE_BUFFER_SIZE];
+
+    bool flush();
+};
+
+/**
+ * Sequential reader for capture files.
+ */
+class CaptureReader {
+public:
+    CaptureReader() = default;
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    /**
+     * Open and validate the header.
+     */
+    bool open(const char* path);
+    void close();
+
+    const CaptureFileHeader& getHeader() const { return _header; }
+
+    /**
+     * Modem settings recorded in the header.
+     */
+    RadioConfig getRadioConfig() const;
+
+    /**
+     * Read the next record. data must hold 255 bytes.
+     * Returns false at end of file or on a truncated record.
+     */
+    bool next(CaptureRecordHeader& record, uint8_t* data);
+
+    /**
+     * Restart from the first record.
+     */
+    bool rewind();
+
+private:
+    FILE* _file = nullptr;
+    CaptureFileHeader _header = {};
+};
+
+} // namespace meshola::diag
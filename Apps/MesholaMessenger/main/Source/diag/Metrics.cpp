@@ -0,0 +1,30 @@
+#include "Metrics.h"
+
+namespace meshola::diag {
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot snap = {};
+    snap.count = _count.load(std::memory_order_relaxed);
+    snap.maxUs = _maxUs.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        snap.buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+    }
+    return snap;
+}
+
+uint32_t LatencyHistogram::Snapshot::percentileUs(uint32_t percentile) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t target = ((uint64_t)count * percentile + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets[i];
+        if (seen >= target) {
+            return (i < BUCKET_COUNT - 1) ? BUCKET_BOUNDS_US[i] : maxUs;
+        }
+    }
+    return maxUs;
+}
+
+} // namespace meshola::diag
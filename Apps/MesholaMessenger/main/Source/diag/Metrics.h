@@ -0,0 +1,139 @@
+#pragma once
+
+/**
+ * Lock-free metric primitives for the mesh pipeline.
+ *
+ * All updates are relaxed 32-bit atomics (native on ESP32-S3), so they are
+ * safe to call from the mesh thread, the UI thread and callbacks without
+ * taking any service lock. Readers take plain-value snapshots.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace meshola::diag {
+
+/**
+ * Monotonic event counter.
+ */
+class Counter {
+public:
+    void add(uint32_t n = 1) { _value.fetch_add(n, std::memory_order_relaxed); }
+    uint32_t get() const { return _value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> _value{0};
+};
+
+/**
+ * Current value plus high-water mark (e.g. queue depth).
+ */
+class Gauge {
+public:
+    void set(uint32_t value) {
+        _value.store(value, std::memory_order_relaxed);
+        uint32_t peak = _peak.load(std::memory_order_relaxed);
+        while (value > peak && !_peak.compare_exchange_weak(peak, value, std::memory_order_relaxed)) {}
+    }
+    uint32_t get() const { return _value.load(std::memory_order_relaxed); }
+    uint32_t peak() const { return _peak.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> _value{0};
+    std::atomic<uint32_t> _peak{0};
+};
+
+/**
+ * Fixed-bucket latency histogram in microseconds.
+ * Bucket i counts samples < BUCKET_BOUNDS_US[i]; the last bucket is overflow.
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t BUCKET_COUNT = 12;
+    static constexpr uint32_t BUCKET_BOUNDS_US[BUCKET_COUNT - 1] = {
+        100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 1000000
+    };
+
+    struct Snapshot {
+        uint32_t count;
+        uint32_t maxUs;
+        uint32_t buckets[BUCKET_COUNT];
+
+        /**
+         * Upper bound (us) of the bucket containing the given percentile (0-100).
+         * Returns maxUs for the overflow bucket.
+         */
+        uint32_t percentileUs(uint32_t percentile) const;
+    };
+
+    void record(uint32_t us) {
+        size_t i = 0;
+        while (i < BUCKET_COUNT - 1 && us >= BUCKET_BOUNDS_US[i]) {
+            i++;
+        }
+        _buckets[i].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        uint32_t max = _maxUs.load(std::memory_order_relaxed);
+        while (us > max && !_maxUs.compare_exchange_weak(max, us, std::memory_order_relaxed)) {}
+    }
+
+    Snapshot snapshot() const;
+
+private:
+    std::atomic<uint32_t> _count{0};
+    std::atomic<uint32_t> _maxUs{0};
+    std::atomic<uint32_t> _buckets[BUCKET_COUNT] = {};
+};
+
+/**
+ * Counters maintained by protocol implementations on their RX/TX paths.
+ * Owned by MesholaMsgService so they stay monotonic across profile switches.
+ */
+struct ProtocolCounters {
+    Counter rxPackets;          // Frames read from the radio
+    Counter rxCrcErrors;
+    Counter rxTimeouts;
+    Counter rxReadErrors;       // readData() failures
+    Counter rxParseFailures;    // Neither advert nor message frame
+    Counter rxAdverts;
+    Counter rxMessages;
+    Counter rxOtherRecipient;   // Compact DM frames addressed to another node
+    Counter rxUnresolvedSenders; // Compact messages held: sender prefix matched no single contact
+    Counter rxHeldDelivered;    // Held messages delivered once the sender advertised
+    Counter txPackets;
+    Counter txFailures;
+    Counter txAirtimeMs;        // Estimated time-on-air of successful TX
+    Counter txQueueDrops;       // Frames rejected: transmit queue full
+    Counter txTimeouts;         // Transmits that never reported TxDone
+    Counter txDutyCycleDrops;   // Frames dropped: over the duty cycle budget
+    Counter lbtScans;           // Channel activity detections before a transmit
+    Counter lbtDefers;          // Scans that found the channel busy and backed off
+    Counter lbtDeferMs;         // Total backoff time
+    Counter lbtForced;          // Frames sent on a busy channel at the max-defer bound
+    Counter adrSwitches;        // Rate switches sent ahead of faster DMs
+    Counter adrFastFrames;      // Frames sent faster than the profile SF
+    Counter adrWindows;         // Rate switches followed as recipient
+    Counter contactEvictions;   // Discovered contacts evicted (LRU) for a new one
+    Counter contactDrops;       // Adverts dropped: table full, nothing evictable
+    Counter txFragments;        // Fragment frames sent, retransmits included
+    Counter rxFragments;        // Fragment frames accepted into reassembly
+    Counter fragmentRetransmits; // Fragments resent in answer to a NACK
+    Counter fragmentNacks;      // NACKs sent for missing fragments
+    Counter reassemblyTimeouts; // Partial messages dropped (timeout or pool full)
+    Counter forwarded;          // Routed frames rebroadcast by this repeater
+    Counter routeDuplicates;    // Routed frames already seen (not delivered again)
+    Counter forwardsCancelled;  // Pending rebroadcasts dropped after hearing other repeaters
+    Counter forwardDrops;       // Rebroadcasts dropped: forward queue full
+    Counter txDirectRouted;     // Frames sent along a learned route instead of flooded
+    Counter advertsSigned;      // Adverts whose signature checked out
+    Counter advertSigFailures;  // Adverts dropped: bad signature, or unsigned from a signing peer
+    Counter verifyBatches;      // Batch signature checks (several adverts at once)
+    Counter txAdverts;          // Our adverts sent, scheduled or on request
+    Counter advertsSuppressed;  // Scheduled adverts skipped: our recent traffic stood in
+    Counter stateSaves;         // Contact/channel snapshots written
+    Counter stateSaveFailures;
+    Counter stateLoadFailures;  // Unreadable snapshots ignored at start
+};
+
+} // namespace meshola::diag
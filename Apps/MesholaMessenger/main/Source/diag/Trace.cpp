@@ -0,0 +1,110 @@
+#include "Trace.h"
+#include "../util/Clock.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+namespace meshola::diag {
+
+static const char* const TRACE_STAGE_NAMES[] = {
+    "mesh_loop",
+    "irq",
+    "read_data",
+    "parse_advert",
+    "parse_packet",
+    "append_message",
+    "publish",
+    "ui",
+    "transmit",
+    "verify_adverts"
+};
+static_assert(sizeof(TRACE_STAGE_NAMES) / sizeof(TRACE_STAGE_NAMES[0]) == (size_t)TraceStage::Count,
+              "TRACE_STAGE_NAMES out of sync with TraceStage");
+
+const char* Trace::stageName(TraceStage stage) {
+    if (stage >= TraceStage::Count) {
+        return "unknown";
+    }
+    return TRACE_STAGE_NAMES[(size_t)stage];
+}
+
+#if MESHOLA_TRACE
+
+static_assert((MESHOLA_TRACE_CAPACITY & (MESHOLA_TRACE_CAPACITY - 1)) == 0,
+              "MESHOLA_TRACE_CAPACITY must be a power of two");
+
+static TraceRecord sRing[MESHOLA_TRACE_CAPACITY];
+static std::atomic<uint32_t> sWriteIndex{0};
+static std::atomic<uint32_t> sFlow{0};
+static std::atomic<uint32_t> sCurrentFlow{0};
+
+void Trace::recordAt(uint64_t timestampUs, TraceStage stage, TracePhase phase, uint16_t arg) {
+    uint32_t slot = sWriteIndex.fetch_add(1, std::memory_order_relaxed) & (MESHOLA_TRACE_CAPACITY - 1);
+    TraceRecord& rec = sRing[slot];
+    rec.timestampUs = timestampUs;
+    rec.flow = sCurrentFlow.load(std::memory_order_relaxed);
+    rec.stage = (uint8_t)stage;
+    rec.phase = (uint8_t)phase;
+    rec.arg = arg;
+}
+
+void Trace::record(TraceStage stage, TracePhase phase, uint16_t arg) {
+    recordAt(clock::micros(), stage, phase, arg);
+}
+
+uint32_t Trace::beginFlow() {
+    uint32_t flow = sFlow.fetch_add(1, std::memory_order_relaxed) + 1;
+    sCurrentFlow.store(flow, std::memory_order_relaxed);
+    return flow;
+}
+
+bool Trace::dump(const char* path) {
+    if (!path) {
+        return false;
+    }
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+
+    uint32_t written = sWriteIndex.load(std::memory_order_relaxed);
+    uint32_t count = written < MESHOLA_TRACE_CAPACITY ? written : MESHOLA_TRACE_CAPACITY;
+    uint32_t first = written - count;
+
+    TraceFileHeader header = {};
+    memcpy(header.magic, "MTRC", 4);
+    header.version = TRACE_FILE_VERSION;
+    header.recordSize = sizeof(TraceRecord);
+    header.recordCount = count;
+    header.dropped = first;
+
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    // Oldest first: the ring may wrap, so write in up to two chunks
+    uint32_t start = first & (MESHOLA_TRACE_CAPACITY - 1);
+    uint32_t tail = MESHOLA_TRACE_CAPACITY - start;
+    if (tail > count) {
+        tail = count;
+    }
+    ok = ok && fwrite(&sRing[start], sizeof(TraceRecord), tail, f) == tail;
+    ok = ok && fwrite(&sRing[0], sizeof(TraceRecord), count - tail, f) == count - tail;
+
+    fclose(f);
+    return ok;
+}
+
+void Trace::clear() {
+    sWriteIndex.store(0, std::memory_order_relaxed);
+}
+
+#else
+
+void Trace::recordAt(uint64_t, TraceStage, TracePhase, uint16_t) {}
+void Trace::record(TraceStage, TracePhase, uint16_t) {}
+uint32_t Trace::beginFlow() { return 0; }
+bool Trace::dump(const char*) { return false; }
+void Trace::clear() {}
+
+#endif
+
+} // namespace meshola::diag
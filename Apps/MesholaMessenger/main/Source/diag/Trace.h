@@ -0,0 +1,146 @@
+#pragma once
+
+/**
+ * Pipeline trace ring buffer.
+ *
+ * Records enter/exit events for the stages a packet passes through between
+ * DIO1 and the UI (IRQ -> readData -> parse -> appendMessage -> publish -> UI).
+ * Records are 16 bytes, timestamps come from meshola::clock (esp_timer on
+ * target, steady_clock on host) and writers only touch one atomic index, so
+ * tracing is cheap enough to leave on while reproducing latency issues.
+ *
+ * Everything is compiled out unless MESHOLA_TRACE is defined to 1
+ * (CMake: -DMESHOLA_TRACE=1). The dump format is read by tools/trace2json.py,
+ * which converts it to Chrome trace JSON for chrome://tracing / Perfetto.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef MESHOLA_TRACE
+#define MESHOLA_TRACE 0
+#endif
+
+#ifndef MESHOLA_TRACE_CAPACITY
+#define MESHOLA_TRACE_CAPACITY 1024    // Records (16 bytes each), power of two
+#endif
+
+namespace meshola::diag {
+
+/**
+ * Pipeline stages. Keep in sync with TRACE_STAGE_NAMES and tools/trace2json.py.
+ */
+enum class TraceStage : uint8_t {
+    MeshLoop = 0,
+    Irq,
+    ReadData,
+    ParseAdvert,
+    ParsePacket,
+    AppendMessage,
+    Publish,
+    Ui,
+    Transmit,
+    VerifyAdverts,
+    Count
+};
+
+enum class TracePhase : uint8_t {
+    Begin = 0,
+    End = 1,
+    Instant = 2
+};
+
+struct TraceRecord {
+    uint64_t timestampUs;
+    uint32_t flow;          // Packet sequence number linking stages of one frame
+    uint8_t stage;          // TraceStage
+    uint8_t phase;          // TracePhase
+    uint16_t arg;           // Stage-specific (e.g. packet length)
+};
+static_assert(sizeof(TraceRecord) == 16, "TraceRecord must stay 16 bytes");
+
+/**
+ * On-disk header written before the records.
+ */
+struct TraceFileHeader {
+    char magic[4];          // "MTRC"
+    uint16_t version;       // TRACE_FILE_VERSION
+    uint16_t recordSize;    // sizeof(TraceRecord)
+    uint32_t recordCount;
+    uint32_t dropped;       // Records overwritten before the dump
+};
+
+constexpr uint16_t TRACE_FILE_VERSION = 1;
+
+class Trace {
+public:
+    /**
+     * Append a record (no-op when tracing is compiled out).
+     */
+    static void record(TraceStage stage, TracePhase phase, uint16_t arg = 0);
+
+    /**
+     * Record an event with an explicit timestamp (e.g. captured in an ISR).
+     */
+    static void recordAt(uint64_t timestampUs, TraceStage stage, TracePhase phase, uint16_t arg = 0);
+
+    /**
+     * Start a new flow (one per received/transmitted frame). Returns its id.
+     */
+    static uint32_t beginFlow();
+
+    /**
+     * Write the buffered records (oldest first) to path. Returns false if
+     * tracing is compiled out or the file cannot be written.
+     */
+    static bool dump(const char* path);
+
+    /**
+     * Discard all buffered records.
+     */
+    static void clear();
+
+    static const char* stageName(TraceStage stage);
+};
+
+/**
+ * RAII helper: Begin on construction, End on destruction.
+ */
+class TraceScope {
+public:
+    explicit TraceScope(TraceStage stage, uint16_t arg = 0) : _stage(stage) {
+        Trace::record(stage, TracePhase::Begin, arg);
+    }
+    ~TraceScope() { Trace::record(_stage, TracePhase::End); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    TraceStage _stage;
+};
+
+} // namespace meshola::diag
+
+#if MESHOLA_TRACE
+#define MESHOLA_TRACE_CONCAT_(a, b) a##b
+#define MESHOLA_TRACE_CONCAT(a, b) MESHOLA_TRACE_CONCAT_(a, b)
+#define MESHOLA_TRACE_SCOPE(stage, ...) \
+    ::meshola::diag::TraceScope MESHOLA_TRACE_CONCAT(_traceScope, __LINE__)(::meshola::diag::TraceStage::stage, ##__VA_ARGS__)
+#define MESHOLA_TRACE_BEGIN(stage, ...) \
+    ::meshola::diag::Trace::record(::meshola::diag::TraceStage::stage, ::meshola::diag::TracePhase::Begin, ##__VA_ARGS__)
+#define MESHOLA_TRACE_END(stage) \
+    ::meshola::diag::Trace::record(::meshola::diag::TraceStage::stage, ::meshola::diag::TracePhase::End)
+#define MESHOLA_TRACE_INSTANT(stage, ...) \
+    ::meshola::diag::Trace::record(::meshola::diag::TraceStage::stage, ::meshola::diag::TracePhase::Instant, ##__VA_ARGS__)
+#define MESHOLA_TRACE_INSTANT_AT(timestampUs, stage, ...) \
+    ::meshola::diag::Trace::recordAt(timestampUs, ::meshola::diag::TraceStage::stage, ::meshola::diag::TracePhase::Instant, ##__VA_ARGS__)
+#define MESHOLA_TRACE_FLOW() ::meshola::diag::Trace::beginFlow()
+#else
+#define MESHOLA_TRACE_SCOPE(stage, ...) ((void)0)
+#define MESHOLA_TRACE_BEGIN(stage, ...) ((void)0)
+#define MESHOLA_TRACE_END(stage) ((void)0)
+#define MESHOLA_TRACE_INSTANT(stage, ...) ((void)0)
+#define MESHOLA_TRACE_INSTANT_AT(timestampUs, stage, ...) ((void)0)
+#define MESHOLA_TRACE_FLOW() ((void)0)
+#endif
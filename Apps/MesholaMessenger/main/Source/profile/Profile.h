@@ -46,6 +46,11 @@ struct Profile {
     // Radio configuration
     RadioConfig radio;
     
+    // Second profile run alongside this one on the same radio ("" = none),
+    // and this profile's share of radio time when their settings differ
+    char companionProfileId[PROFILE_ID_LEN];
+    uint8_t airtimeSharePercent;
+    
     // Node identity
     char nodeName[MAX_NODE_NAME_LEN];
     uint8_t publicKey[PUBLIC_KEY_SIZE];
@@ -68,6 +73,8 @@ struct Profile {
         radio.spreadingFactor = 11;
         radio.codingRate = 5;
         radio.txPower = 22;
+        radio.preambleLength = LORA_DEFAULT_PREAMBLE_LEN;
+        airtimeSharePercent = 50;
         
         strcpy(protocolId, "meshcore");
         strcpy(nodeName, "Meshola");
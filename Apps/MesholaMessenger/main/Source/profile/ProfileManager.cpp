@@ -1,4 +1,5 @@
 #include "Profile.h"
+#include "../crypto/Ed25519.h"
 #include <cstdio>
 #include <cstdlib>
 #include <ctime>
@@ -233,22 +234,17 @@ void ProfileManager::generateNodeName(char* dest, size_t maxLen) {
 }
 
 bool ProfileManager::generateKeys(Profile& profile) {
-    // TODO: Use proper crypto library (Crypto from MeshCore dependencies)
-    // For now, generate random bytes as placeholder
-    
+    // Ed25519: the private key is a random seed, the public key derives from it
 #ifdef ESP_PLATFORM
     // Use ESP32 hardware RNG
-    for (int i = 0; i < PUBLIC_KEY_SIZE; i++) {
-        profile.privateKey[i] = esp_random() & 0xFF;
-        profile.publicKey[i] = esp_random() & 0xFF;  // Placeholder - real impl derives from private
-    }
+    esp_fill_random(profile.privateKey, PUBLIC_KEY_SIZE);
 #else
     // Fallback for testing
     for (int i = 0; i < PUBLIC_KEY_SIZE; i++) {
         profile.privateKey[i] = rand() & 0xFF;
-        profile.publicKey[i] = rand() & 0xFF;
     }
 #endif
+    crypto::ed25519PublicKey(profile.privateKey, profile.publicKey);
     
     profile.hasKeys = true;
     return true;
@@ -342,6 +338,10 @@ bool ProfileManager::saveProfile(const Profile& profile) {
     writeJsonInt(f, "spreadingFactor", profile.radio.spreadingFactor);
     writeJsonInt(f, "codingRate", profile.radio.codingRate);
     writeJsonInt(f, "txPower", profile.radio.txPower);
+    writeJsonInt(f, "preambleLength", profile.radio.preambleLength);
+    writeJsonInt(f, "dutyCyclePermille", profile.radio.dutyCyclePermille);
+    writeJsonString(f, "companionProfileId", profile.companionProfileId);
+    writeJsonInt(f, "airtimeSharePercent", profile.airtimeSharePercent);
     
     // Identity
     writeJsonString(f, "nodeName", profile.nodeName);
@@ -0,0 +1,65 @@
+#include "AdvertScheduler.h"
+
+#include <algorithm>
+
+namespace meshola {
+
+AdvertScheduler::AdvertScheduler(uint32_t seed)
+    : _rng(seed ? seed : 1)
+{
+}
+
+uint32_t AdvertScheduler::random() {
+    // xorshift32: deterministic per seed, so simulator runs repeat exactly
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return _rng;
+}
+
+uint32_t AdvertScheduler::intervalMs(size_t neighbours) {
+    uint64_t interval = (uint64_t)BASE_INTERVAL_MS * (1 + neighbours / NEIGHBOURS_PER_STEP);
+    return (uint32_t)std::min<uint64_t>(interval, MAX_INTERVAL_MS);
+}
+
+void AdvertScheduler::start(uint32_t nowMs) {
+    _dueMs = nowMs + STARTUP_MIN_MS + random() % STARTUP_SPREAD_MS;
+    _armed = true;
+    _mustSend = true;
+    _hasTraffic = false;
+    _suppressed = 0;
+}
+
+bool AdvertScheduler::fire(uint32_t nowMs, size_t neighbours) {
+    uint32_t interval = intervalMs(neighbours);
+    if (!_mustSend && _hasTraffic && (uint32_t)(nowMs - _lastTrafficMs) < interval / 2 &&
+        _suppressed < MAX_SUPPRESSED) {
+        _suppressed++;
+        schedule(nowMs, neighbours);
+        return false;
+    }
+    // Scheduled again once sent, so a failed send retries next interval too
+    schedule(nowMs, neighbours);
+    return true;
+}
+
+void AdvertScheduler::sent(uint32_t nowMs, size_t neighbours) {
+    _mustSend = false;
+    _suppressed = 0;
+    if (_armed) {
+        schedule(nowMs, neighbours);
+    }
+}
+
+void AdvertScheduler::noteTraffic(uint32_t nowMs) {
+    _lastTrafficMs = nowMs;
+    _hasTraffic = true;
+}
+
+void AdvertScheduler::schedule(uint32_t nowMs, size_t neighbours) {
+    uint32_t interval = intervalMs(neighbours);
+    uint32_t spread = interval / JITTER_DIVISOR;
+    _dueMs = nowMs + interval - spread + random() % (2 * spread);
+}
+
+} // namespace meshola
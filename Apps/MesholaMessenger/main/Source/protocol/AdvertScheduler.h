@@ -0,0 +1,93 @@
+#pragma once
+
+/**
+ * AdvertScheduler - When to send the next advert on its own.
+ *
+ * The first advert goes out a random few seconds to a minute after start,
+ * so nodes powered up together don't collide. After that the interval
+ * grows with the number of neighbours heard directly: BASE_INTERVAL_MS
+ * alone, one more base interval per NEIGHBOURS_PER_STEP neighbours, capped
+ * at MAX_INTERVAL_MS. With every node doing the same, a node hears about
+ * NEIGHBOURS_PER_STEP adverts per base interval however crowded its
+ * neighbourhood is (until the cap). Every interval is jittered by
+ * 1/JITTER_DIVISOR either way so neighbours drift apart.
+ *
+ * Frames of our own (messages) refresh our contact at every node that
+ * hears them. A due advert is skipped if we sent one within the last half
+ * interval, at most MAX_SUPPRESSED times in a row: messages don't carry
+ * our name, so nodes that have never heard of us still need an advert now
+ * and then.
+ *
+ * Frame encoding and radio access live in MeshCoreProtocol; this class only
+ * decides when. Not thread-safe; time is passed in by the caller.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace meshola {
+
+class AdvertScheduler {
+public:
+    static constexpr uint32_t STARTUP_MIN_MS = 2000;
+    static constexpr uint32_t STARTUP_SPREAD_MS = 58000;    // First advert within a minute of start
+    static constexpr uint32_t BASE_INTERVAL_MS = 15 * 60 * 1000;
+    static constexpr uint32_t MAX_INTERVAL_MS = 4 * 60 * 60 * 1000;
+    static constexpr size_t NEIGHBOURS_PER_STEP = 4;
+    static constexpr uint32_t JITTER_DIVISOR = 4;           // +-25%
+    static constexpr uint8_t MAX_SUPPRESSED = 3;
+
+    explicit AdvertScheduler(uint32_t seed = 1);
+
+    /**
+     * Restart the jitter sequence (e.g. from the node's key).
+     */
+    void reseed(uint32_t seed) { _rng = seed ? seed : 1; }
+
+    /**
+     * Arm the startup advert. It is never suppressed.
+     */
+    void start(uint32_t nowMs);
+
+    /**
+     * Stop scheduling until the next start().
+     */
+    void stop() { _armed = false; }
+
+    bool due(uint32_t nowMs) const { return _armed && (int32_t)(nowMs - _dueMs) >= 0; }
+
+    /**
+     * A due advert: true to send it (then call sent()), false if recent
+     * traffic stands in for it; the next one is scheduled either way.
+     */
+    bool fire(uint32_t nowMs, size_t neighbours);
+
+    /**
+     * An advert went out, scheduled or not: the next is an interval away.
+     */
+    void sent(uint32_t nowMs, size_t neighbours);
+
+    /**
+     * A frame identifying us went out.
+     */
+    void noteTraffic(uint32_t nowMs);
+
+    /**
+     * Interval before jitter for a neighbour count.
+     */
+    static uint32_t intervalMs(size_t neighbours);
+
+private:
+    uint32_t _rng;
+    uint32_t _dueMs = 0;
+    uint32_t _lastTrafficMs = 0;
+    bool _armed = false;
+    bool _hasTraffic = false;
+    bool _mustSend = false;
+    uint8_t _suppressed = 0;
+
+    uint32_t random();
+    void schedule(uint32_t nowMs, size_t neighbours);
+};
+
+} // namespace meshola
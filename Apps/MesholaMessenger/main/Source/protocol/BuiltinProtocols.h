@@ -0,0 +1,28 @@
+#pragma once
+
+/**
+ * Protocols built into this image.
+ *
+ * Each protocol has a MESHOLA_PROTOCOL_* flag (default on). Turning one off
+ * (CMake: -DMESHOLA_PROTOCOL_MESHCORE=0) removes it from the registry and
+ * leaves its code unreferenced, so the linker strips it from the image.
+ */
+
+#include "ProtocolTable.h"
+#include "MeshCoreProtocol.h"
+
+#ifndef MESHOLA_PROTOCOL_MESHCORE
+#define MESHOLA_PROTOCOL_MESHCORE 1
+#endif
+
+namespace meshola {
+
+using BuiltinProtocols = ProtocolTable<
+    BuiltinProtocol<MESHOLA_PROTOCOL_MESHCORE, MeshCoreProtocol>
+>;
+
+static_assert(!MESHOLA_PROTOCOL_MESHCORE ||
+              BuiltinProtocols::features(protocolIdHash("meshcore")) == MeshCoreProtocol::FEATURES,
+              "Registry lookups resolve at compile time");
+
+} // namespace meshola
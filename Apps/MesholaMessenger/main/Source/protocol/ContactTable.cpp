@@ -0,0 +1,389 @@
+#include "ContactTable.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef ESP_PLATFORM
+#include <esp_heap_caps.h>
+#endif
+
+#include <Tactility/Log.h>
+
+namespace meshola {
+
+#define TAG "ContactTable"
+
+static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+/**
+ * Contacts are large and rarely touched in bulk; prefer PSRAM.
+ */
+static Contact* allocateContacts(size_t count) {
+    size_t bytes = count * sizeof(Contact);
+#ifdef ESP_PLATFORM
+    void* memory = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!memory) {
+        memory = heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+    }
+    return static_cast<Contact*>(memory);
+#else
+    return static_cast<Contact*>(malloc(bytes));
+#endif
+}
+
+static void freeContacts(Contact* contacts) {
+#ifdef ESP_PLATFORM
+    heap_caps_free(contacts);
+#else
+    free(contacts);
+#endif
+}
+
+ContactTable::ContactTable(size_t capacity) {
+    capacity = std::min(capacity, MAX_CAPACITY);
+    _contacts = capacity > 0 ? allocateContacts(capacity) : nullptr;
+    if (!_contacts && capacity > 0) {
+        TT_LOG_E(TAG, "Failed to allocate %u contacts", (unsigned)capacity);
+        capacity = 0;
+    }
+    _capacity = capacity;
+
+    _keyHashes.resize(_capacity);
+    _lruPrev.resize(_capacity, NONE);
+    _lruNext.resize(_capacity, NONE);
+    _pinned.resize(_capacity, false);
+    _onLru.resize(_capacity, false);
+
+    // Power of two, at most half full
+    size_t indexSize = 2;
+    uint32_t bits = 1;
+    while (indexSize < _capacity * 2) {
+        indexSize <<= 1;
+        bits++;
+    }
+    _index.assign(indexSize, 0);
+    _indexMask = indexSize - 1;
+    _indexShift = 32 - bits;
+}
+
+ContactTable::~ContactTable() {
+    freeContacts(_contacts);
+}
+
+// ============================================================================
+// Index
+// ============================================================================
+
+size_t ContactTable::homeSlot(uint32_t keyHash) const {
+    // Fibonacci hashing: adverts are attacker-controlled, so spread the prefix
+    return (uint32_t)(keyHash * 2654435769u) >> _indexShift;
+}
+
+size_t ContactTable::findSlot(const uint8_t publicKey[PUBLIC_KEY_SIZE]) const {
+    uint32_t keyHash = contactKeyHash(publicKey);
+    for (size_t slot = homeSlot(keyHash); _index[slot] != 0; slot = (slot + 1) & _indexMask) {
+        size_t position = _index[slot] - 1;
+        if (_keyHashes[position] == keyHash &&
+            memcmp(_contacts[position].publicKey, publicKey, PUBLIC_KEY_SIZE) == 0) {
+            return slot;
+        }
+    }
+    return NOT_FOUND;
+}
+
+size_t ContactTable::slotOf(size_t position) const {
+    size_t slot = homeSlot(_keyHashes[position]);
+    while (_index[slot] != position + 1) {
+        slot = (slot + 1) & _indexMask;
+    }
+    return slot;
+}
+
+void ContactTable::eraseSlot(size_t slot) {
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & _indexMask; _index[next] != 0; next = (next + 1) & _indexMask) {
+        size_t home = homeSlot(_keyHashes[_index[next] - 1]);
+        if (((next - home) & _indexMask) >= ((next - hole) & _indexMask)) {
+            _index[hole] = _index[next];
+            hole = next;
+        }
+    }
+    _index[hole] = 0;
+}
+
+// ============================================================================
+// LRU
+// ============================================================================
+
+bool ContactTable::isEvictable(size_t position) const {
+    const Contact& contact = _contacts[position];
+    return contact.isDiscovered && !contact.isFavorite && !_pinned[position];
+}
+
+void ContactTable::lruLink(size_t position) {
+    _lruPrev[position] = NONE;
+    _lruNext[position] = _lruHead;
+    if (_lruHead != NONE) {
+        _lruPrev[_lruHead] = (uint16_t)position;
+    } else {
+        _lruTail = (uint16_t)position;
+    }
+    _lruHead = (uint16_t)position;
+    _onLru[position] = true;
+}
+
+void ContactTable::lruUnlink(size_t position) {
+    uint16_t prev = _lruPrev[position];
+    uint16_t next = _lruNext[position];
+    if (prev != NONE) {
+        _lruNext[prev] = next;
+    } else {
+        _lruHead = next;
+    }
+    if (next != NONE) {
+        _lruPrev[next] = prev;
+    } else {
+        _lruTail = prev;
+    }
+    _onLru[position] = false;
+}
+
+void ContactTable::refreshLru(size_t position) {
+    if (_onLru[position]) {
+        lruUnlink(position);
+    }
+    if (isEvictable(position)) {
+        lruLink(position);
+    }
+}
+
+// ============================================================================
+// Access
+// ============================================================================
+
+const Contact* ContactTable::find(const uint8_t publicKey[PUBLIC_KEY_SIZE]) const {
+    if (!publicKey) {
+        return nullptr;
+    }
+    size_t slot = findSlot(publicKey);
+    return slot != NOT_FOUND ? &_contacts[_index[slot] - 1] : nullptr;
+}
+
+const Contact* ContactTable::findByHash(uint32_t keyHash) const {
+    for (size_t slot = homeSlot(keyHash); _index[slot] != 0; slot = (slot + 1) & _indexMask) {
+        size_t position = _index[slot] - 1;
+        if (_keyHashes[position] == keyHash) {
+            return &_contacts[position];
+        }
+    }
+    return nullptr;
+}
+
+uint32_t ContactTable::prefixMask(size_t prefixLen) {
+    // contactKeyHash() holds the first key bytes little-endian
+    return prefixLen >= 4 ? 0xFFFFFFFFu : (1u << (prefixLen * 8)) - 1;
+}
+
+const Contact* ContactTable::findByPrefix(const uint8_t* prefix, size_t prefixLen) const {
+    if (!prefix || prefixLen == 0 || prefixLen > 4) {
+        return nullptr;
+    }
+    uint8_t padded[PUBLIC_KEY_SIZE] = {};
+    memcpy(padded, prefix, prefixLen);
+    uint32_t mask = prefixMask(prefixLen);
+    uint32_t wanted = contactKeyHash(padded) & mask;
+
+    const Contact* match = nullptr;
+    if (prefixLen == 4) {
+        for (size_t slot = homeSlot(wanted); _index[slot] != 0; slot = (slot + 1) & _indexMask) {
+            size_t position = _index[slot] - 1;
+            if (_keyHashes[position] == wanted) {
+                if (match) {
+                    return nullptr;
+                }
+                match = &_contacts[position];
+            }
+        }
+        return match;
+    }
+    for (size_t position = 0; position < _size; position++) {
+        if ((_keyHashes[position] & mask) == wanted) {
+            if (match) {
+                return nullptr;
+            }
+            match = &_contacts[position];
+        }
+    }
+    return match;
+}
+
+size_t ContactTable::countPrefix(const uint8_t* prefix, size_t prefixLen, size_t limit) const {
+    if (!prefix || prefixLen == 0) {
+        return 0;
+    }
+    uint8_t padded[PUBLIC_KEY_SIZE] = {};
+    memcpy(padded, prefix, std::min(prefixLen, (size_t)4));
+    uint32_t mask = prefixMask(prefixLen);
+    uint32_t wanted = contactKeyHash(padded) & mask;
+
+    size_t count = 0;
+    for (size_t position = 0; position < _size && count < limit; position++) {
+        if ((_keyHashes[position] & mask) == wanted) {
+            count++;
+        }
+    }
+    return count;
+}
+
+ContactUpsert ContactTable::upsert(const Contact& contact) {
+    size_t slot = findSlot(contact.publicKey);
+    if (slot != NOT_FOUND) {
+        size_t position = _index[slot] - 1;
+        _contacts[position] = contact;
+        refreshLru(position);
+        _revision++;
+        return ContactUpsert::Updated;
+    }
+
+    ContactUpsert result = ContactUpsert::Inserted;
+    if (_size == _capacity) {
+        if (_lruTail == NONE) {
+            return ContactUpsert::Full;
+        }
+        removeAt(_lruTail);
+        result = ContactUpsert::Evicted;
+    }
+
+    size_t position = _size++;
+    uint32_t keyHash = contactKeyHash(contact.publicKey);
+    _contacts[position] = contact;
+    _keyHashes[position] = keyHash;
+    _pinned[position] = false;
+    _onLru[position] = false;
+
+    slot = homeSlot(keyHash);
+    while (_index[slot] != 0) {
+        slot = (slot + 1) & _indexMask;
+    }
+    _index[slot] = (uint16_t)(position + 1);
+
+    refreshLru(position);
+    _revision++;
+    return result;
+}
+
+bool ContactTable::remove(const uint8_t publicKey[PUBLIC_KEY_SIZE]) {
+    if (!publicKey) {
+        return false;
+    }
+    size_t slot = findSlot(publicKey);
+    if (slot == NOT_FOUND) {
+        return false;
+    }
+    removeAt(_index[slot] - 1);
+    return true;
+}
+
+bool ContactTable::setFavorite(const uint8_t publicKey[PUBLIC_KEY_SIZE], bool favorite) {
+    if (!publicKey) {
+        return false;
+    }
+    size_t slot = findSlot(publicKey);
+    if (slot == NOT_FOUND) {
+        return false;
+    }
+    size_t position = _index[slot] - 1;
+    _contacts[position].isFavorite = favorite;
+    refreshLru(position);
+    _revision++;
+    return true;
+}
+
+bool ContactTable::promote(const uint8_t publicKey[PUBLIC_KEY_SIZE]) {
+    if (!publicKey) {
+        return false;
+    }
+    size_t slot = findSlot(publicKey);
+    if (slot == NOT_FOUND) {
+        return false;
+    }
+    size_t position = _index[slot] - 1;
+    _contacts[position].isDiscovered = false;
+    refreshLru(position);
+    _revision++;
+    return true;
+}
+
+bool ContactTable::pin(const uint8_t publicKey[PUBLIC_KEY_SIZE]) {
+    if (!publicKey) {
+        return false;
+    }
+    size_t slot = findSlot(publicKey);
+    if (slot == NOT_FOUND) {
+        return false;
+    }
+    size_t position = _index[slot] - 1;
+    _pinned[position] = true;
+    refreshLru(position);
+    return true;
+}
+
+void ContactTable::clear() {
+    _size = 0;
+    std::fill(_index.begin(), _index.end(), 0);
+    std::fill(_onLru.begin(), _onLru.end(), false);
+    _lruHead = NONE;
+    _lruTail = NONE;
+    _revision++;
+}
+
+void ContactTable::forEachOldestFirst(const std::function<void(const Contact&)>& visit) const {
+    for (size_t position = 0; position < _size; position++) {
+        if (!_onLru[position]) {
+            visit(_contacts[position]);
+        }
+    }
+    for (uint16_t position = _lruTail; position != NONE; position = _lruPrev[position]) {
+        visit(_contacts[position]);
+    }
+}
+
+void ContactTable::removeAt(size_t position) {
+    eraseSlot(slotOf(position));
+    if (_onLru[position]) {
+        lruUnlink(position);
+    }
+
+    // Keep the array dense: move the last contact into the hole
+    size_t last = _size - 1;
+    if (position != last) {
+        _index[slotOf(last)] = (uint16_t)(position + 1);
+        _contacts[position] = _contacts[last];
+        _keyHashes[position] = _keyHashes[last];
+        _pinned[position] = _pinned[last];
+        _onLru[position] = _onLru[last];
+        if (_onLru[last]) {
+            uint16_t prev = _lruPrev[last];
+            uint16_t next = _lruNext[last];
+            _lruPrev[position] = prev;
+            _lruNext[position] = next;
+            if (prev != NONE) {
+                _lruNext[prev] = (uint16_t)position;
+            } else {
+                _lruHead = (uint16_t)position;
+            }
+            if (next != NONE) {
+                _lruPrev[next] = (uint16_t)position;
+            } else {
+                _lruTail = (uint16_t)position;
+            }
+        }
+        _onLru[last] = false;
+    }
+    _size--;
+    _revision++;
+}
+
+} // namespace meshola
@@ -0,0 +1,144 @@
+#pragma once
+
+/**
+ * ContactTable - Bounded contact storage with O(1) lookup by public key.
+ *
+ * Contacts live in one dense array allocated up front (PSRAM when
+ * available), so index-based access and bulk copies stay cheap. An
+ * open-addressing index (linear probing, at most half full) maps the
+ * contactKeyHash() prefix of a key to its slot; a hit is confirmed with a
+ * full key compare. Removal swaps the last contact into the hole, so
+ * indices are not stable across remove() or an eviction.
+ *
+ * When the table is full, the least recently heard contact that is
+ * discovered-only, not a favorite and not pinned is evicted to make room.
+ * Evictable contacts sit on an intrusive LRU list that upsert() refreshes,
+ * so eviction is O(1) too. If nothing is evictable the insert fails.
+ *
+ * Not thread-safe: the owning protocol is driven under the service mutex.
+ */
+
+#include "IProtocol.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace meshola {
+
+enum class ContactUpsert : uint8_t {
+    Updated,        // Key was already present
+    Inserted,
+    Evicted,        // Inserted after evicting the LRU discovered contact
+    Full            // No room and nothing evictable
+};
+
+class ContactTable {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;   // ~100 KB of contacts
+    static constexpr size_t MAX_CAPACITY = 0xFFFE;
+
+    explicit ContactTable(size_t capacity = DEFAULT_CAPACITY);
+    ~ContactTable();
+
+    ContactTable(const ContactTable&) = delete;
+    ContactTable& operator=(const ContactTable&) = delete;
+
+    size_t size() const { return _size; }
+    size_t capacity() const { return _capacity; }
+
+    /**
+     * Contact at a dense index (0..size()-1).
+     */
+    const Contact& at(size_t index) const { return _contacts[index]; }
+    const Contact* begin() const { return _contacts; }
+    const Contact* end() const { return _contacts + _size; }
+
+    const Contact* find(const uint8_t publicKey[PUBLIC_KEY_SIZE]) const;
+
+    /**
+     * First contact whose contactKeyHash() matches.
+     */
+    const Contact* findByHash(uint32_t keyHash) const;
+
+    /**
+     * The one contact whose key starts with prefix (1-4 bytes); nullptr if
+     * none or several match. Shorter prefixes scan the key hashes (no
+     * contact data is touched).
+     */
+    const Contact* findByPrefix(const uint8_t* prefix, size_t prefixLen) const;
+
+    /**
+     * Number of contacts whose key starts with prefix, counting up to limit.
+     */
+    size_t countPrefix(const uint8_t* prefix, size_t prefixLen, size_t limit) const;
+
+    /**
+     * Insert a contact or replace the stored copy, and mark it most
+     * recently heard.
+     */
+    ContactUpsert upsert(const Contact& contact);
+
+    bool remove(const uint8_t publicKey[PUBLIC_KEY_SIZE]);
+    bool setFavorite(const uint8_t publicKey[PUBLIC_KEY_SIZE], bool favorite);
+    bool promote(const uint8_t publicKey[PUBLIC_KEY_SIZE]);
+
+    /**
+     * Exclude a contact from eviction (e.g. synthetic defaults).
+     */
+    bool pin(const uint8_t publicKey[PUBLIC_KEY_SIZE]);
+
+    void clear();
+
+    /**
+     * Visit contacts that can't be evicted, then evictable ones from least
+     * to most recently heard. Upserting them in this order into an empty
+     * table rebuilds the eviction order.
+     */
+    void forEachOldestFirst(const std::function<void(const Contact&)>& visit) const;
+
+    /**
+     * Bumped by every change to the stored contacts, so an owner can tell
+     * whether they changed since it last saved them.
+     */
+    uint32_t revision() const { return _revision; }
+
+private:
+    static constexpr uint16_t NONE = 0xFFFF;
+
+    Contact* _contacts = nullptr;           // Dense, _capacity entries
+    size_t _capacity = 0;
+    size_t _size = 0;
+    uint32_t _revision = 0;
+
+    // Per-contact metadata, parallel to _contacts (internal RAM)
+    std::vector<uint32_t> _keyHashes;
+    std::vector<uint16_t> _lruPrev;
+    std::vector<uint16_t> _lruNext;
+    std::vector<bool> _pinned;
+    std::vector<bool> _onLru;
+    uint16_t _lruHead = NONE;               // Most recently heard
+    uint16_t _lruTail = NONE;               // Next to evict
+
+    // Open-addressing index: dense position + 1, 0 = empty
+    std::vector<uint16_t> _index;
+    size_t _indexMask = 0;
+    uint32_t _indexShift = 31;
+
+    static uint32_t prefixMask(size_t prefixLen);
+
+    size_t homeSlot(uint32_t keyHash) const;
+    size_t findSlot(const uint8_t publicKey[PUBLIC_KEY_SIZE]) const;
+    size_t slotOf(size_t position) const;
+    void eraseSlot(size_t slot);
+
+    bool isEvictable(size_t position) const;
+    void lruLink(size_t position);
+    void lruUnlink(size_t position);
+    void refreshLru(size_t position);
+
+    void removeAt(size_t position);
+};
+
+} // namespace meshola
@@ -0,0 +1,58 @@
+#include "DutyCycle.h"
+
+#include <algorithm>
+
+namespace meshola {
+
+void DutyCycleBudget::setLimit(uint16_t permille) {
+    _permille = std::min(permille, DUTY_CYCLE_PERMILLE_MAX);
+}
+
+uint32_t DutyCycleBudget::budgetMs() const {
+    return DUTY_CYCLE_WINDOW_MS / 1000 * _permille;
+}
+
+uint32_t DutyCycleBudget::usedMs(uint32_t nowMs) const {
+    uint32_t used = 0;
+    for (const Bucket& bucket : _buckets) {
+        if (bucket.airtimeMs != 0 && (uint32_t)(nowMs - bucket.startMs) < DUTY_CYCLE_WINDOW_MS + DUTY_CYCLE_BUCKET_MS) {
+            used += bucket.airtimeMs;
+        }
+    }
+    return used;
+}
+
+uint32_t DutyCycleBudget::remainingMs(uint32_t nowMs) const {
+    if (_permille == 0) {
+        return UINT32_MAX;
+    }
+    uint32_t used = usedMs(nowMs);
+    uint32_t budget = budgetMs();
+    return used < budget ? budget - used : 0;
+}
+
+bool DutyCycleBudget::allows(uint32_t nowMs, uint32_t airtimeMs) const {
+    return _permille == 0 || airtimeMs <= remainingMs(nowMs);
+}
+
+void DutyCycleBudget::record(uint32_t nowMs, uint32_t airtimeMs) {
+    Bucket* bucket = &_buckets[_current];
+    if (bucket->airtimeMs == 0 || (uint32_t)(nowMs - bucket->startMs) >= DUTY_CYCLE_BUCKET_MS) {
+        // Buckets open at least a minute apart, so the one reused here
+        // started over BUCKET_COUNT minutes ago and no longer counts
+        if (bucket->airtimeMs != 0) {
+            _current = (_current + 1) % BUCKET_COUNT;
+            bucket = &_buckets[_current];
+        }
+        bucket->startMs = nowMs;
+        bucket->airtimeMs = 0;
+    }
+    bucket->airtimeMs += airtimeMs;
+}
+
+void DutyCycleBudget::clear() {
+    _buckets = {};
+    _current = 0;
+}
+
+} // namespace meshola
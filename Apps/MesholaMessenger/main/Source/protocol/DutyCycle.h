@@ -0,0 +1,86 @@
+#pragma once
+
+/**
+ * DutyCycle - Regulatory transmit-time budget.
+ *
+ * Sub-GHz bands in some regions cap each device's share of airtime, e.g.
+ * 1% or 10% per hour in the EU 868 MHz sub-bands (ETSI EN 300 220).
+ * DutyCycleBudget sums the time on air of recent frames over a sliding hour
+ * held as buckets of at least a minute, and answers whether another frame
+ * still fits. A bucket opens with the first frame after the previous one
+ * filled its minute and counts in full until its whole minute has left the
+ * window, so the budget errs on the safe side by at most one bucket. Ages
+ * are wrap-safe differences, so the books survive millis() rolling over.
+ *
+ * Frame encoding and radio access live in MeshCoreProtocol; this class only
+ * keeps the books. Airtime is recorded with no limit set too, for status.
+ * Not thread-safe; time is passed in by the caller.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace meshola {
+
+constexpr uint32_t DUTY_CYCLE_WINDOW_MS = 60 * 60 * 1000;
+constexpr uint32_t DUTY_CYCLE_BUCKET_MS = 60 * 1000;
+constexpr uint16_t DUTY_CYCLE_PERMILLE_MAX = 1000;
+
+class DutyCycleBudget {
+public:
+    /**
+     * Transmit limit in permille of the window (10 = 1%), 0 for none.
+     * Airtime already recorded stays in the window.
+     */
+    void setLimit(uint16_t permille);
+    uint16_t limit() const { return _permille; }
+
+    /**
+     * Airtime allowed per window at the current limit.
+     */
+    uint32_t budgetMs() const;
+
+    /**
+     * Airtime recorded within the window ending at nowMs.
+     */
+    uint32_t usedMs(uint32_t nowMs) const;
+
+    /**
+     * Budget left at nowMs; UINT32_MAX with no limit set.
+     */
+    uint32_t remainingMs(uint32_t nowMs) const;
+
+    /**
+     * True if a frame of airtimeMs can go on air at nowMs without exceeding
+     * the limit.
+     */
+    bool allows(uint32_t nowMs, uint32_t airtimeMs) const;
+
+    /**
+     * Account a frame that went on air at nowMs.
+     */
+    void record(uint32_t nowMs, uint32_t airtimeMs);
+
+    /**
+     * Forget all recorded airtime.
+     */
+    void clear();
+
+private:
+    // One more than the window holds: a bucket still counts for a minute
+    // after its start has left the window
+    static constexpr size_t BUCKET_COUNT = DUTY_CYCLE_WINDOW_MS / DUTY_CYCLE_BUCKET_MS + 1;
+
+    struct Bucket {
+        uint32_t startMs;       // First frame in the bucket
+        uint32_t airtimeMs;     // 0: unused
+    };
+
+    // Ring in start order; _current is the newest bucket
+    std::array<Bucket, BUCKET_COUNT> _buckets = {};
+    size_t _current = 0;
+    uint16_t _permille = 0;
+};
+
+} // namespace meshola
@@ -0,0 +1,139 @@
+#include "FloodRouter.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace meshola {
+
+uint32_t routedPacketId(uint8_t tag, const uint8_t* inner, size_t len) {
+    uint32_t hash = 2166136261u;
+    hash = (hash ^ tag) * 16777619u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ inner[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// ============================================================================
+// SeenCache
+// ============================================================================
+
+size_t SeenCache::homeSlot(uint32_t packetId) {
+    return (packetId * 2654435769u) >> 23;                  // Top 9 bits: INDEX_SIZE 512
+}
+
+static_assert(SeenCache::CAPACITY * 2 == 512, "homeSlot() takes log2(INDEX_SIZE) bits");
+
+size_t SeenCache::findSlot(uint32_t packetId) const {
+    for (size_t slot = homeSlot(packetId);; slot = (slot + 1) & (INDEX_SIZE - 1)) {
+        uint16_t entry = _index[slot];
+        if (entry == 0 || _ring[entry - 1].packetId == packetId) {
+            return slot;
+        }
+    }
+}
+
+void SeenCache::eraseSlot(size_t slot) {
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & (INDEX_SIZE - 1); _index[next] != 0; next = (next + 1) & (INDEX_SIZE - 1)) {
+        size_t home = homeSlot(_ring[_index[next] - 1].packetId);
+        if (((next - home) & (INDEX_SIZE - 1)) >= ((next - hole) & (INDEX_SIZE - 1))) {
+            _index[hole] = _index[next];
+            hole = next;
+        }
+    }
+    _index[hole] = 0;
+}
+
+bool SeenCache::insert(uint32_t packetId, uint32_t nowMs) {
+    size_t slot = findSlot(packetId);
+    if (_index[slot] != 0) {
+        Entry& entry = _ring[_index[slot] - 1];
+        bool expired = (uint32_t)(nowMs - entry.seenMs) >= TTL_MS;
+        entry.seenMs = nowMs;
+        return expired;
+    }
+
+    if (_size == CAPACITY) {
+        eraseSlot(findSlot(_ring[_next].packetId));
+        slot = findSlot(packetId);
+    } else {
+        _size++;
+    }
+    _ring[_next] = Entry{ packetId, nowMs };
+    _index[slot] = (uint16_t)(_next + 1);
+    _next = (_next + 1) % CAPACITY;
+    return true;
+}
+
+void SeenCache::clear() {
+    _index.fill(0);
+    _next = 0;
+    _size = 0;
+}
+
+// ============================================================================
+// ForwardQueue
+// ============================================================================
+
+ForwardQueue::ForwardQueue(uint32_t seed)
+    : _rng(seed ? seed : 1)
+{
+}
+
+uint32_t ForwardQueue::random() {
+    // xorshift32: deterministic per seed, so simulator runs repeat exactly
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return _rng;
+}
+
+uint32_t ForwardQueue::floodDelayMs(float snrDb, uint32_t airtimeMs) {
+    float snr = std::clamp(snrDb, SNR_FLOOR_DB, SNR_CEILING_DB);
+    float weight = (snr - SNR_FLOOR_DB) / (SNR_CEILING_DB - SNR_FLOOR_DB);
+    uint32_t slotMs = std::max<uint32_t>(airtimeMs, 1);
+    uint32_t snrMs = (uint32_t)(weight * SNR_SLOTS * slotMs);
+    return snrMs + random() % (JITTER_SLOTS * slotMs);
+}
+
+uint32_t ForwardQueue::directDelayMs(uint32_t airtimeMs) {
+    return random() % (airtimeMs / 2 + 1);
+}
+
+bool ForwardQueue::schedule(uint32_t packetId, const uint8_t* frame, size_t len, uint32_t nowMs, uint32_t delayMs) {
+    if (len > MAX_RADIO_PACKET_LEN) {
+        return false;
+    }
+    for (Pending& pending : _slots) {
+        if (!pending.used) {
+            pending.used = true;
+            pending.heard = 0;
+            pending.len = (uint8_t)len;
+            pending.packetId = packetId;
+            pending.dueMs = nowMs + delayMs;
+            memcpy(pending.frame, frame, len);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ForwardQueue::heard(uint32_t packetId) {
+    for (Pending& pending : _slots) {
+        if (pending.used && pending.packetId == packetId && ++pending.heard >= SUPPRESS_AFTER) {
+            pending.used = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ForwardQueue::clear() {
+    for (Pending& pending : _slots) {
+        pending.used = false;
+    }
+}
+
+} // namespace meshola
@@ -0,0 +1,133 @@
+#pragma once
+
+/**
+ * FloodRouter - Duplicate suppression and delayed rebroadcast for repeaters.
+ *
+ * SeenCache remembers the IDs of recently handled routed frames so each is
+ * delivered and forwarded at most once. ForwardQueue holds the frames a
+ * repeater will rebroadcast: each waits a delay weighted by the SNR it was
+ * heard at (weak links first, since they extend coverage the most) plus
+ * random jitter, and is cancelled if another repeater is heard sending
+ * the same frame in the meantime.
+ *
+ * Frame encoding lives in MeshCoreProtocol; these classes only track state.
+ * Not thread-safe; time is passed in by the caller.
+ */
+
+#include "IRadio.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace meshola {
+
+/**
+ * Packet ID: FNV-1a over the bytes that do not change hop to hop.
+ */
+uint32_t routedPacketId(uint8_t tag, const uint8_t* inner, size_t len);
+
+class SeenCache {
+public:
+    static constexpr size_t CAPACITY = 256;
+    static constexpr uint32_t TTL_MS = 10 * 60 * 1000;
+
+    /**
+     * Record an ID.
+     * @return true if it was not seen within TTL_MS
+     */
+    bool insert(uint32_t packetId, uint32_t nowMs);
+
+    void clear();
+
+private:
+    static constexpr size_t INDEX_SIZE = CAPACITY * 2;     // At most half full
+
+    struct Entry {
+        uint32_t packetId;
+        uint32_t seenMs;
+    };
+
+    std::array<Entry, CAPACITY> _ring{};
+    size_t _next = 0;                                       // Oldest entry once full
+    size_t _size = 0;
+    std::array<uint16_t, INDEX_SIZE> _index{};              // Ring position + 1, 0 = empty
+
+    static size_t homeSlot(uint32_t packetId);
+    size_t findSlot(uint32_t packetId) const;
+    void eraseSlot(size_t slot);
+};
+
+class ForwardQueue {
+public:
+    static constexpr size_t SLOTS = 8;
+    static constexpr uint8_t SUPPRESS_AFTER = 1;            // Copies heard that cancel ours
+    static constexpr float SNR_FLOOR_DB = -20.0f;
+    static constexpr float SNR_CEILING_DB = 10.0f;
+    static constexpr uint32_t SNR_SLOTS = 8;                 // Frame airtimes spanned by the SNR weight
+    static constexpr uint32_t JITTER_SLOTS = 4;
+
+    explicit ForwardQueue(uint32_t seed = 1);
+
+    /**
+     * Restart the delay jitter sequence (e.g. from the node's key).
+     */
+    void reseed(uint32_t seed) { _rng = seed ? seed : 1; }
+
+    /**
+     * Rebroadcast delay for a flooded frame heard at snrDb.
+     */
+    uint32_t floodDelayMs(float snrDb, uint32_t airtimeMs);
+
+    /**
+     * Short random delay for a source-routed frame (one forwarder per hop).
+     */
+    uint32_t directDelayMs(uint32_t airtimeMs);
+
+    /**
+     * Queue a frame to send at nowMs + delayMs.
+     * @return false if the queue is full
+     */
+    bool schedule(uint32_t packetId, const uint8_t* frame, size_t len, uint32_t nowMs, uint32_t delayMs);
+
+    /**
+     * Note another copy of packetId on air.
+     * @return true if that cancelled our pending rebroadcast
+     */
+    bool heard(uint32_t packetId);
+
+    /**
+     * Call transmit(frame, len) for every frame that is due.
+     */
+    template <typename Fn>
+    void tick(uint32_t nowMs, Fn&& transmit);
+
+    void clear();
+
+private:
+    struct Pending {
+        bool used = false;
+        uint8_t heard = 0;
+        uint8_t len = 0;
+        uint32_t packetId = 0;
+        uint32_t dueMs = 0;
+        uint8_t frame[MAX_RADIO_PACKET_LEN];
+    };
+
+    std::array<Pending, SLOTS> _slots{};
+    uint32_t _rng;
+
+    uint32_t random();
+};
+
+template <typename Fn>
+void ForwardQueue::tick(uint32_t nowMs, Fn&& transmit) {
+    for (Pending& pending : _slots) {
+        if (pending.used && (int32_t)(nowMs - pending.dueMs) >= 0) {
+            pending.used = false;
+            transmit(pending.frame, (size_t)pending.len);
+        }
+    }
+}
+
+} // namespace meshola
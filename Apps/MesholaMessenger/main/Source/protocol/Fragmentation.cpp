@@ -0,0 +1,129 @@
+#include "Fragmentation.h"
+
+#include <cstring>
+
+namespace meshola {
+
+uint32_t FragmentHeader::senderPrefix() const {
+    uint32_t prefix = 0;
+    for (size_t i = 0; i < prefixLen && i < MAX_FRAGMENT_PREFIX_LEN; i++) {
+        prefix |= (uint32_t)sender[i] << (8 * i);
+    }
+    return prefix;
+}
+
+// ============================================================================
+// ReassemblyPool
+// ============================================================================
+
+ReassemblyPool::Slot* ReassemblyPool::findSlot(uint32_t senderPrefix, uint16_t msgId) {
+    for (Slot& slot : _slots) {
+        if (slot.used && slot.message.msgId == msgId && slot.message.senderPrefix() == senderPrefix) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+ReassemblyPool::Slot* ReassemblyPool::claimSlot() {
+    Slot* oldest = &_slots[0];
+    for (Slot& slot : _slots) {
+        if (!slot.used) {
+            return &slot;
+        }
+        if ((int32_t)(slot.lastMs - oldest->lastMs) < 0) {
+            oldest = &slot;
+        }
+    }
+    _lost++;
+    return oldest;
+}
+
+ReassemblyPool::Result ReassemblyPool::add(const FragmentHeader& header, uint8_t index, uint16_t offset,
+                                           const uint8_t* data, size_t len, bool wantsNack, uint32_t nowMs) {
+    if (!data || header.count == 0 || header.count > MAX_FRAGMENTS || index >= header.count ||
+        header.prefixLen > MAX_FRAGMENT_PREFIX_LEN || (size_t)offset + len > MAX_FRAGMENTED_PAYLOAD) {
+        return Result::Rejected;
+    }
+
+    Slot* slot = findSlot(header.senderPrefix(), header.msgId);
+    if (slot) {
+        if (slot->message.count != header.count || slot->message.flags != header.flags) {
+            return Result::Rejected;
+        }
+    } else {
+        slot = claimSlot();
+        slot->used = true;
+        slot->wantsNack = wantsNack;
+        slot->nacksSent = 0;
+        slot->received = 0;
+        slot->firstMs = nowMs;
+        static_cast<FragmentHeader&>(slot->message) = header;
+        slot->message.fragmentSize = 0;
+        slot->message.length = 0;
+    }
+
+    uint32_t bit = 1u << index;
+    if (slot->received & bit) {
+        return Result::Duplicate;
+    }
+    memcpy(&slot->message.payload[offset], data, len);
+    slot->received |= bit;
+    slot->lastMs = nowMs;
+    // The last fragment fixes the total length
+    if (index == header.count - 1) {
+        slot->message.length = (uint16_t)(offset + len);
+    } else {
+        slot->message.fragmentSize = (uint16_t)len;
+    }
+
+    if (slot->received != allMask(header.count)) {
+        return Result::Pending;
+    }
+    _complete = slot->message;
+    slot->used = false;
+    return Result::Complete;
+}
+
+// ============================================================================
+// FragmentHistory
+// ============================================================================
+
+FragmentedMessage& FragmentHistory::add(uint32_t nowMs) {
+    Entry* target = &_entries[0];
+    for (Entry& entry : _entries) {
+        if (!entry.used) {
+            target = &entry;
+            break;
+        }
+        if ((int32_t)(entry.sentMs - target->sentMs) < 0) {
+            target = &entry;
+        }
+    }
+    target->used = true;
+    target->retransmits = 0;
+    target->sentMs = nowMs;
+    return target->message;
+}
+
+const FragmentedMessage* FragmentHistory::takeForRetransmit(uint16_t msgId, const uint8_t* target, size_t prefixLen,
+                                                            uint32_t nowMs) {
+    for (Entry& entry : _entries) {
+        if (!entry.used || entry.message.msgId != msgId || entry.message.prefixLen != prefixLen ||
+            memcmp(entry.message.target, target, prefixLen) != 0) {
+            continue;
+        }
+        if ((uint32_t)(nowMs - entry.sentMs) >= HOLD_MS) {
+            entry.used = false;
+            return nullptr;
+        }
+        if (entry.retransmits >= MAX_RETRANSMITS) {
+            return nullptr;
+        }
+        entry.retransmits++;
+        return &entry.message;
+    }
+    return nullptr;
+}
+
+} // namespace meshola
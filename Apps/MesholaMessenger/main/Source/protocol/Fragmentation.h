@@ -0,0 +1,165 @@
+#pragma once
+
+/**
+ * Fragmentation - Bookkeeping for payloads larger than one LoRa frame.
+ *
+ * A payload is split into up to MAX_FRAGMENTS numbered pieces that share a
+ * message ID. The receiver collects them in a ReassemblyPool slot (bounded:
+ * POOL_SLOTS partial messages of at most MAX_FRAGMENTED_PAYLOAD bytes) and,
+ * for DMs addressed to it, asks for the pieces it is still missing with a
+ * NACK bitmap when they stop arriving. The sender keeps recent fragmented
+ * DMs in a FragmentHistory so it can retransmit just those pieces.
+ *
+ * Frame encoding lives in MeshCoreProtocol; these classes only track state.
+ * Not thread-safe; time is passed in by the caller.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace meshola {
+
+constexpr size_t MAX_FRAGMENTS = 32;                // One bit each in a NACK
+constexpr size_t MAX_FRAGMENTED_PAYLOAD = 1024;
+constexpr size_t MAX_FRAGMENT_PREFIX_LEN = 4;
+
+/**
+ * Frame fields every fragment of a message repeats.
+ */
+struct FragmentHeader {
+    uint16_t msgId = 0;
+    uint8_t flags = 0;                              // Frame flags (channel, codec, prefix length)
+    uint8_t prefixLen = 0;
+    uint8_t target[MAX_FRAGMENT_PREFIX_LEN] = {};   // Channel ID or recipient key prefix
+    uint8_t sender[MAX_FRAGMENT_PREFIX_LEN] = {};
+    uint8_t count = 0;                              // Fragments in the message
+
+    uint32_t senderPrefix() const;
+};
+
+/**
+ * A whole payload: reassembled, or kept for retransmission.
+ */
+struct FragmentedMessage : FragmentHeader {
+    bool routed = false;                            // Sender side: fragments go out with a route header
+    uint16_t fragmentSize = 0;                      // Bytes per fragment except the last
+    uint16_t length = 0;
+    uint8_t payload[MAX_FRAGMENTED_PAYLOAD] = {};
+};
+
+class ReassemblyPool {
+public:
+    static constexpr size_t POOL_SLOTS = 4;
+    static constexpr uint32_t TIMEOUT_MS = 60000;       // Give up on a partial message
+    static constexpr uint32_t NACK_DELAY_MS = 5000;     // Quiet time before asking again
+    static constexpr uint8_t MAX_NACKS = 3;
+
+    enum class Result : uint8_t {
+        Pending,        // Stored, message incomplete
+        Complete,       // Last missing piece; complete() holds the message
+        Duplicate,
+        Rejected        // Inconsistent with earlier fragments or out of bounds
+    };
+
+    /**
+     * Store one fragment. The first fragment of a message takes a free
+     * slot, or the least recently active one (counted in lost()).
+     */
+    Result add(const FragmentHeader& header, uint8_t index, uint16_t offset,
+               const uint8_t* data, size_t len, bool wantsNack, uint32_t nowMs);
+
+    /**
+     * Message finished by the last add(); valid until the next add().
+     */
+    const FragmentedMessage& complete() const { return _complete; }
+
+    /**
+     * Drop expired slots and call requestNack(message, missingMask) for
+     * slots that want a NACK and have been quiet for NACK_DELAY_MS.
+     */
+    template <typename Fn>
+    void tick(uint32_t nowMs, Fn&& requestNack);
+
+    /**
+     * Partial messages given up so far: timed out or evicted.
+     */
+    uint32_t lost() const { return _lost; }
+
+private:
+    struct Slot {
+        bool used = false;
+        bool wantsNack = false;
+        uint8_t nacksSent = 0;
+        uint32_t received = 0;          // Bit per fragment
+        uint32_t firstMs = 0;
+        uint32_t lastMs = 0;
+        FragmentedMessage message;
+    };
+
+    std::array<Slot, POOL_SLOTS> _slots{};
+    FragmentedMessage _complete;
+    uint32_t _lost = 0;
+
+    static uint32_t allMask(uint8_t count) {
+        return count >= 32 ? 0xFFFFFFFFu : (1u << count) - 1;
+    }
+    Slot* findSlot(uint32_t senderPrefix, uint16_t msgId);
+    Slot* claimSlot();
+};
+
+template <typename Fn>
+void ReassemblyPool::tick(uint32_t nowMs, Fn&& requestNack) {
+    for (Slot& slot : _slots) {
+        if (!slot.used) {
+            continue;
+        }
+        if ((uint32_t)(nowMs - slot.firstMs) >= TIMEOUT_MS) {
+            slot.used = false;
+            _lost++;
+            continue;
+        }
+        if (slot.wantsNack && slot.nacksSent < MAX_NACKS &&
+            (uint32_t)(nowMs - slot.lastMs) >= NACK_DELAY_MS) {
+            slot.nacksSent++;
+            slot.lastMs = nowMs;
+            requestNack(slot.message, allMask(slot.message.count) & ~slot.received);
+        }
+    }
+}
+
+/**
+ * Recently sent fragmented messages, kept for selective retransmit.
+ */
+class FragmentHistory {
+public:
+    static constexpr size_t HISTORY_SLOTS = 2;
+    static constexpr uint32_t HOLD_MS = 60000;
+    static constexpr uint8_t MAX_RETRANSMITS = 3;       // NACKs answered per message
+
+    /**
+     * Entry for a message about to be sent, filled in place by the caller;
+     * replaces the oldest entry when full.
+     */
+    FragmentedMessage& add(uint32_t nowMs);
+
+    /**
+     * Message msgId sent to the recipient whose key starts with target, or
+     * nullptr if unknown, expired or out of retransmits. Counts one
+     * retransmit.
+     */
+    const FragmentedMessage* takeForRetransmit(uint16_t msgId, const uint8_t* target, size_t prefixLen,
+                                               uint32_t nowMs);
+
+private:
+    struct Entry {
+        bool used = false;
+        uint8_t retransmits = 0;
+        uint32_t sentMs = 0;
+        FragmentedMessage message;
+    };
+
+    std::array<Entry, HISTORY_SLOTS> _entries{};
+};
+
+} // namespace meshola
@@ -11,18 +11,25 @@
 #include <cstdint>
 #include <cstddef>
 #include <functional>
+#include <memory>
+
+#include "../diag/Metrics.h"
 
 namespace meshola {
 
+namespace diag { class PacketCapture; }
+class IRadio;
+
 // ============================================================================
 // Common Data Structures (Protocol-Agnostic)
 // ============================================================================
 
 constexpr size_t MAX_NODE_NAME_LEN = 32;
-constexpr size_t MAX_MESSAGE_LEN = 256;
+constexpr size_t MAX_MESSAGE_LEN = 512;        // Longer than one frame: sent in fragments
 constexpr size_t MAX_CHANNEL_NAME_LEN = 32;
 constexpr size_t PUBLIC_KEY_SIZE = 32;
 constexpr size_t CHANNEL_ID_SIZE = 16;
+constexpr size_t MAX_PATH_LEN = 8;             // Repeaters on a learned route
 
 /**
  * Message delivery status
@@ -53,8 +60,16 @@ enum class ProtocolFeature {
     FileTransfer,        // Binary data transfer
     Telemetry,           // Sensor data
     RemoteAdmin,         // Remote node administration
+    TextCompression,     // Chat text compressed on air when peers support it
 };
 
+/**
+ * Bit for a feature in ProtocolInfo::capabilities / ProtocolEntry::features.
+ */
+constexpr uint32_t featureBit(ProtocolFeature feature) {
+    return 1u << static_cast<uint32_t>(feature);
+}
+
 /**
  * Radio configuration
  */
@@ -64,8 +79,21 @@ struct RadioConfig {
     uint8_t spreadingFactor;  // 7-12
     uint8_t codingRate;       // 5-8 (4/5 to 4/8)
     int8_t txPower;           // dBm
+    uint16_t preambleLength;  // Symbols, 0 = LORA_DEFAULT_PREAMBLE_LEN
+    uint16_t dutyCyclePermille; // Transmit limit per hour, 10 = 1%, 0 = none
 };
 
+constexpr uint16_t LORA_DEFAULT_PREAMBLE_LEN = 12;
+
+/**
+ * Preamble length actually used on air. Receivers can only sleep between
+ * RX windows for as long as the senders' preamble lasts, so duty-cycled
+ * networks configure a longer preamble on every node.
+ */
+inline uint16_t effectivePreambleLength(const RadioConfig& config) {
+    return config.preambleLength != 0 ? config.preambleLength : LORA_DEFAULT_PREAMBLE_LEN;
+}
+
 /**
  * Protocol information
  */
@@ -95,11 +123,20 @@ struct Contact {
     int8_t lastSnr;             // dB * 4
     uint8_t pathLength;         // Hops to reach
     bool hasPath;               // Do we have a route?
+    uint8_t path[MAX_PATH_LEN]; // Repeater hashes toward the contact, nearest first (pathLength - 1 used)
     bool isOnline;              // Recently seen?
     bool isFavorite;            // User pinned
     bool isDiscovered;          // From adverts (not yet promoted)
     NodeRole role;              // Companion/Repeater/Room/Unknown
-    
+    uint8_t peerFlags;          // Protocol-specific capabilities from the peer's advert
+    int8_t peerTxPower;         // dBm, from the peer's advert if it carries it
+
+    // Link to a neighbour, from frames heard straight from it (not relayed)
+    float linkRssi;             // dBm, moving average
+    float linkSnr;              // dB, moving average
+    uint8_t linkSamples;        // Frames averaged (saturates), 0 = never heard directly
+    uint32_t linkUpdatedMs;     // Monotonic time of the last sample
+
     // Optional location (if protocol supports it)
     bool hasLocation;
     double latitude;
@@ -146,6 +183,10 @@ struct NodeStatus {
     int16_t lastRssi;
     int8_t lastSnr;
     bool radioRunning;
+    uint16_t dutyCyclePermille;     // Regulatory limit, 0 = none
+    uint32_t airtimeUsedMs;         // Time on air in the last hour
+    uint32_t airtimeRemainingMs;    // Budget left, UINT32_MAX with no limit
+    uint32_t dutyCycleRejects;      // Frames dropped over budget since start
 };
 
 // ============================================================================
@@ -156,8 +197,23 @@ using MessageCallback = std::function<void(const Message& msg)>;
 using ContactCallback = std::function<void(const Contact& contact, bool isNew)>;
 using StatusCallback = std::function<void(const NodeStatus& status)>;
 using AckCallback = std::function<void(uint32_t ackId, bool success)>;
+using TransmitCallback = std::function<void(uint32_t ackId, bool success)>;
 using ErrorCallback = std::function<void(int errorCode, const char* message)>;
 
+// Return false to stop iterating
+using ContactVisitor = std::function<bool(const Contact& contact)>;
+
+/**
+ * 32-bit lookup key for a contact. Public keys are uniformly random, so the
+ * leading bytes already make a good hash.
+ */
+inline uint32_t contactKeyHash(const uint8_t publicKey[PUBLIC_KEY_SIZE]) {
+    return (uint32_t)publicKey[0]
+         | ((uint32_t)publicKey[1] << 8)
+         | ((uint32_t)publicKey[2] << 16)
+         | ((uint32_t)publicKey[3] << 24);
+}
+
 // ============================================================================
 // Protocol Interface
 // ============================================================================
@@ -241,12 +297,25 @@ public:
      */
     virtual bool sendAdvertisement() = 0;
 
+    /**
+     * Drop per-profile state (contacts, channels, learned paths) and restore
+     * defaults, so a running instance can be re-targeted at another profile
+     * without restarting the radio.
+     */
+    virtual void resetProfileState() = 0;
+
     /**
      * Provide local identity to the protocol for packet framing.
      */
     virtual void setLocalIdentity(const uint8_t publicKey[PUBLIC_KEY_SIZE],
                                   const char* name) = 0;
 
+    /**
+     * Private key (Ed25519 seed) of the local identity, or nullptr. Adverts
+     * are signed while it matches the public key from setLocalIdentity().
+     */
+    virtual void setSigningKey(const uint8_t privateKey[PUBLIC_KEY_SIZE]) = 0;
+
     /**
      * Mark/unmark a contact as favorite.
      */
@@ -292,6 +361,22 @@ public:
      */
     virtual bool findContact(const uint8_t publicKey[PUBLIC_KEY_SIZE], Contact& out) const = 0;
     
+    /**
+     * Find contact by contactKeyHash(). Returns the first match.
+     */
+    virtual bool findContactByHash(uint32_t keyHash, Contact& out) const = 0;
+    
+    /**
+     * Copy up to maxCount contacts starting at index offset into dest.
+     * Returns the number copied.
+     */
+    virtual size_t copyContacts(Contact* dest, size_t maxCount, size_t offset) const = 0;
+    
+    /**
+     * Visit every contact in index order without copying.
+     */
+    virtual void forEachContact(const ContactVisitor& visitor) const = 0;
+    
     /**
      * Add or update a contact.
      */
@@ -321,6 +406,17 @@ public:
      */
     virtual bool getChannel(int index, Channel& out) const = 0;
     
+    /**
+     * Find channel by ID.
+     */
+    virtual bool findChannel(const uint8_t channelId[CHANNEL_ID_SIZE], Channel& out) const = 0;
+    
+    /**
+     * Copy up to maxCount channels starting at index offset into dest.
+     * Returns the number copied.
+     */
+    virtual size_t copyChannels(Channel* dest, size_t maxCount, size_t offset) const = 0;
+    
     /**
      * Add or update a channel.
      */
@@ -336,10 +432,20 @@ public:
     virtual RadioConfig getRadioConfig() const = 0;
     
     /**
-     * Update radio configuration (may require restart).
+     * Update radio configuration. While running, only the fields that
+     * changed are written to the live radio, without restarting the
+     * protocol. Returns false (and keeps the old settings) for values the
+     * transceiver does not support.
      */
     virtual bool setRadioConfig(const RadioConfig& config) = 0;
     
+    /**
+     * Receive with duty cycling between operations instead of continuous RX
+     * (see IRadio::startReceiveDutyCycle). sleepPeriodUs = 0 restores
+     * continuous receive.
+     */
+    virtual bool setRxDutyCycle(uint32_t rxPeriodUs, uint32_t sleepPeriodUs) = 0;
+    
     /**
      * Get current node status/telemetry.
      */
@@ -368,6 +474,14 @@ public:
      * Set callback for message acknowledgments.
      */
     virtual void setAckCallback(AckCallback callback) = 0;
+
+    /**
+     * Set callback for frames that finished transmitting (or failed to).
+     * Sends return once their frames are queued; this reports when each
+     * one actually left the radio. ackId is sendMessage()'s return value
+     * for frames of that DM, 0 for any other frame.
+     */
+    virtual void setTransmitCallback(TransmitCallback callback) = 0;
     
     /**
      * Set callback for errors.
@@ -378,44 +492,79 @@ public:
     // Persistence
     // ========================================================================
     
+    /**
+     * File that saveState() writes and loadState() reads, e.g. in the
+     * profile's data directory. nullptr or empty keeps state in memory only.
+     */
+    virtual void setStatePath(const char* path) = 0;
+
     /**
      * Save current state (contacts, channels, settings) to storage.
      */
     virtual bool saveState() = 0;
     
     /**
-     * Load state from storage.
+     * Load state from storage. True if there was none to load (first boot)
+     * or only an unreadable file, which the next save replaces.
      */
     virtual bool loadState() = 0;
+
+    // ========================================================================
+    // Diagnostics
+    // ========================================================================
+    
+    /**
+     * Set the counters updated on the RX/TX paths.
+     * The owner (MesholaMsgService) keeps them alive across protocol instances.
+     * Pass nullptr to fall back to protocol-internal counters.
+     */
+    virtual void setCounters(diag::ProtocolCounters* counters) = 0;
+    
+    /**
+     * Record every received frame (before parsing) into capture.
+     * nullptr disables capture.
+     */
+    virtual void setCapture(diag::PacketCapture* capture) = 0;
 };
 
 // ============================================================================
 // Protocol Factory
 // ============================================================================
 
+/**
+ * Hash of a protocol ID (32-bit FNV-1a). Usable at compile time, so
+ * lookups by a literal ID cost no string comparisons at runtime.
+ */
+constexpr uint32_t protocolIdHash(const char* id) {
+    uint32_t hash = 2166136261u;
+    for (; *id; id++) {
+        hash = (hash ^ static_cast<uint8_t>(*id)) * 16777619u;
+    }
+    return hash;
+}
+
 /**
  * Protocol registration entry
  */
 struct ProtocolEntry {
     const char* id;             // Unique identifier (e.g., "meshcore", "customfork")
+    uint32_t idHash;            // protocolIdHash(id)
     const char* name;           // Display name
-    IProtocol* (*create)();     // Factory function
+    uint32_t features;          // Bitmask of ProtocolFeature (featureBit())
+    IProtocol* (*create)();     // Factory function (platform radio)
+    IProtocol* (*createWithRadio)(std::unique_ptr<IRadio> radio);  // Optional: caller-supplied radio
 };
 
 /**
- * Protocol registry - manages available protocol implementations
+ * Protocol registry - the protocol implementations built into this image.
+ *
+ * The set is fixed at compile time (protocol/BuiltinProtocols.h); there is
+ * no runtime registration step.
  */
 class ProtocolRegistry {
 public:
-    static constexpr int MAX_PROTOCOLS = 8;
-    
     /**
-     * Register a protocol implementation.
-     */
-    static bool registerProtocol(const ProtocolEntry& entry);
-    
-    /**
-     * Get number of registered protocols.
+     * Get number of built-in protocols.
      */
     static int getProtocolCount();
     
@@ -429,14 +578,21 @@ public:
      */
     static const ProtocolEntry* findProtocol(const char* id);
     
+    /**
+     * Find protocol by protocolIdHash() of its ID.
+     */
+    static const ProtocolEntry* findProtocol(uint32_t idHash);
+    
     /**
      * Create protocol instance by ID.
      */
     static IProtocol* createProtocol(const char* id);
-
-private:
-    static ProtocolEntry protocols[MAX_PROTOCOLS];
-    static int protocolCount;
+    
+    /**
+     * Create protocol instance by ID on a given radio (e.g. a RadioArbiter
+     * client). Returns nullptr if the protocol cannot take a radio.
+     */
+    static IProtocol* createProtocol(const char* id, std::unique_ptr<IRadio> radio);
 };
 
 } // namespace meshola
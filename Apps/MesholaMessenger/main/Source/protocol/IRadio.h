@@ -0,0 +1,180 @@
+#pragma once
+
+/**
+ * Radio backend abstraction.
+ *
+ * Protocols talk to the transceiver through this interface instead of
+ * RadioLib directly, so the same protocol code runs against the SX1262 on
+ * the T-Deck (Sx1262Radio) and against the host mesh simulator (SimRadio).
+ *
+ * The model mirrors the SX126x: a single half-duplex transceiver that is
+ * either in standby, receiving, or transmitting, and reports completed
+ * operations through IRQ flags polled from the mesh thread.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "IProtocol.h"
+
+namespace meshola {
+
+// Largest LoRa payload the radio accepts (SX126x FIFO size)
+constexpr size_t MAX_RADIO_PACKET_LEN = 255;
+
+/**
+ * IRQ flags reported by pollIrq(). Backends map their native flags onto these.
+ */
+enum RadioIrq : uint32_t {
+    RadioIrqNone     = 0,
+    RadioIrqRxDone   = 1 << 0,
+    RadioIrqTxDone   = 1 << 1,
+    RadioIrqCrcError = 1 << 2,
+    RadioIrqTimeout  = 1 << 3,
+    RadioIrqCadDone  = 1 << 4,
+    RadioIrqCadDetected = 1 << 5,
+    RadioIrqAll      = 0xFFFFFFFF
+};
+
+class IRadio {
+public:
+    virtual ~IRadio() = default;
+
+    /**
+     * Bring up the transceiver with the given modem settings.
+     * Called again after end() when the protocol is re-initialised.
+     */
+    virtual bool begin(const RadioConfig& config) = 0;
+
+    /**
+     * Power down and release the transceiver.
+     */
+    virtual void end() = 0;
+
+    /**
+     * Apply modem settings to a running transceiver without tearing it down.
+     * Only fields that differ from the current settings are written. Rejects
+     * settings that fail isValidRadioConfig(). Leaves the radio in standby;
+     * call startReceive() afterwards.
+     */
+    virtual bool applyConfig(const RadioConfig& config) = 0;
+
+    /**
+     * Enter continuous receive mode.
+     */
+    virtual bool startReceive() = 0;
+
+    /**
+     * Receive with duty cycling: listen for rxPeriodUs, sleep for
+     * sleepPeriodUs, repeat. A preamble detected during a listen window
+     * keeps the receiver on until the frame completes (RxDone), after which
+     * the radio idles until the next startReceive*() call. Senders' preamble
+     * must outlast sleepPeriodUs or frames are missed.
+     */
+    virtual bool startReceiveDutyCycle(uint32_t rxPeriodUs, uint32_t sleepPeriodUs) = 0;
+
+    /**
+     * Leave RX/TX and idle in standby.
+     */
+    virtual void standby() = 0;
+
+    /**
+     * Start transmitting a frame and return at once. Completion is reported
+     * as RadioIrqTxDone; clearing it returns the radio to standby. Receive
+     * mode is left, so re-arm it afterwards.
+     */
+    virtual bool startTransmit(const uint8_t* data, size_t len) = 0;
+
+    /**
+     * Start channel activity detection and return at once. Completion is
+     * reported as RadioIrqCadDone, together with RadioIrqCadDetected if a
+     * LoRa preamble was heard. Receive mode is left, so re-arm it afterwards.
+     */
+    virtual bool startChannelScan() = 0;
+
+    /**
+     * Pending RadioIrq flags.
+     */
+    virtual uint32_t pollIrq() = 0;
+
+    /**
+     * Clear RadioIrq flags.
+     */
+    virtual void clearIrq(uint32_t flags) = 0;
+
+    /**
+     * Length of the last received frame.
+     */
+    virtual size_t getPacketLength() = 0;
+
+    /**
+     * Copy the last received frame into dest.
+     */
+    virtual bool readData(uint8_t* dest, size_t len) = 0;
+
+    /**
+     * RSSI (dBm) and SNR (dB) of the last received frame.
+     */
+    virtual float getRssi() = 0;
+    virtual float getSnr() = 0;
+
+    /**
+     * Time on air for a frame of len bytes with the current settings.
+     */
+    virtual uint32_t getTimeOnAirUs(size_t len) = 0;
+
+    /**
+     * True if this backend drives the transceiver alone. A shared radio
+     * (RadioArbiter client) may hold back applyConfig() until its time slice,
+     * so per-frame retunes can't be relied on.
+     */
+    virtual bool isExclusive() const = 0;
+};
+
+/**
+ * LoRa time on air (Semtech AN1200.13) for explicit header, CRC on,
+ * the configured preamble length and low data rate optimisation when the
+ * symbol time exceeds 16 ms. Used by backends without a native helper.
+ */
+uint32_t loraTimeOnAirUs(const RadioConfig& config, size_t len);
+
+/**
+ * The board's transceiver (Sx1262Radio on ESP32), or nullptr on hosts
+ * without one.
+ */
+std::unique_ptr<IRadio> createPlatformRadio();
+
+/**
+ * Duration of one LoRa symbol (2^SF / BW), 0 for invalid settings.
+ */
+uint32_t loraSymbolTimeUs(const RadioConfig& config);
+
+/**
+ * RadioConfig fields, as reported by radioConfigChanges().
+ */
+enum RadioConfigField : uint32_t {
+    RadioConfigNone            = 0,
+    RadioConfigFrequency       = 1 << 0,
+    RadioConfigBandwidth       = 1 << 1,
+    RadioConfigSpreadingFactor = 1 << 2,
+    RadioConfigCodingRate      = 1 << 3,
+    RadioConfigTxPower         = 1 << 4,
+    RadioConfigPreamble        = 1 << 5,    // Compared as effectivePreambleLength()
+    RadioConfigAll             = (1 << 6) - 1
+};
+
+/**
+ * Fields that differ between two configs (RadioConfigField bits).
+ * dutyCyclePermille is not a modem setting and never counts.
+ */
+uint32_t radioConfigChanges(const RadioConfig& from, const RadioConfig& to);
+
+/**
+ * True if every field is within SX126x limits: 150-960 MHz, one of the
+ * LoRa bandwidth steps (7.8-500 kHz), SF 5-12, CR 4/5-4/8, -9 to +22 dBm,
+ * and the duty cycle limit is at most 1000 permille.
+ */
+bool isValidRadioConfig(const RadioConfig& config);
+
+} // namespace meshola
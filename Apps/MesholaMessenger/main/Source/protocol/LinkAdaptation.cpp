@@ -0,0 +1,40 @@
+#include "LinkAdaptation.h"
+
+#include <algorithm>
+
+namespace meshola {
+
+float loraDemodFloorDb(uint8_t spreadingFactor) {
+    int sf = std::clamp<int>(spreadingFactor, 5, 12);
+    return -2.5f * (float)(sf - 4);
+}
+
+void updateLinkQuality(Contact& contact, float rssi, float snr, uint32_t nowMs) {
+    if (contact.linkSamples == 0) {
+        contact.linkRssi = rssi;
+        contact.linkSnr = snr;
+    } else {
+        contact.linkRssi += LINK_AVERAGE_WEIGHT * (rssi - contact.linkRssi);
+        contact.linkSnr += LINK_AVERAGE_WEIGHT * (snr - contact.linkSnr);
+    }
+    if (contact.linkSamples < UINT8_MAX) {
+        contact.linkSamples++;
+    }
+    contact.linkUpdatedMs = nowMs;
+}
+
+bool hasFreshLink(const Contact& contact, uint32_t nowMs) {
+    return contact.linkSamples >= ADR_MIN_SAMPLES &&
+           (uint32_t)(nowMs - contact.linkUpdatedMs) < ADR_MAX_SAMPLE_AGE_MS;
+}
+
+uint8_t chooseSpreadingFactor(float snrDb, uint8_t baseSf) {
+    for (uint8_t sf = ADR_MIN_SPREADING_FACTOR; sf < baseSf; sf++) {
+        if (snrDb >= loraDemodFloorDb(sf) + ADR_MARGIN_DB) {
+            return sf;
+        }
+    }
+    return baseSf;
+}
+
+} // namespace meshola
@@ -0,0 +1,54 @@
+#pragma once
+
+/**
+ * LinkAdaptation - Per-contact link quality and data rate choice.
+ *
+ * Frames heard straight from a contact (not relayed) feed a moving average
+ * of its RSSI and SNR. LoRa SNR is measured before despreading, so a value
+ * read at one spreading factor holds for any other on the same bandwidth,
+ * while each SF step down halves the time on air and raises the
+ * demodulation floor by 2.5 dB (SX126x: SF7 -7.5 dB ... SF12 -20 dB).
+ * chooseSpreadingFactor() picks the fastest SF whose floor the link clears
+ * by ADR_MARGIN_DB, which covers fading, averaging lag and the difference
+ * between the two directions of the link.
+ *
+ * Frame encoding and radio access live in MeshCoreProtocol; these helpers
+ * only keep statistics and decide rates.
+ * Not thread-safe; time is passed in by the caller.
+ */
+
+#include "IProtocol.h"
+
+#include <cstdint>
+
+namespace meshola {
+
+constexpr uint8_t ADR_MIN_SPREADING_FACTOR = 7;     // SF5/6 need implicit-header-capable peers
+constexpr float ADR_MARGIN_DB = 10.0f;
+constexpr uint8_t ADR_MIN_SAMPLES = 2;              // One frame can be a lucky fade
+constexpr uint32_t ADR_MAX_SAMPLE_AGE_MS = 15 * 60 * 1000;
+constexpr float LINK_AVERAGE_WEIGHT = 0.25f;        // Weight of a new sample
+
+/**
+ * Lowest SNR (dB) the SX126x demodulates at a spreading factor (5-12).
+ */
+float loraDemodFloorDb(uint8_t spreadingFactor);
+
+/**
+ * Fold a frame heard straight from the contact into its link average.
+ */
+void updateLinkQuality(Contact& contact, float rssi, float snr, uint32_t nowMs);
+
+/**
+ * True if the link average has ADR_MIN_SAMPLES samples, the newest from
+ * within ADR_MAX_SAMPLE_AGE_MS.
+ */
+bool hasFreshLink(const Contact& contact, uint32_t nowMs);
+
+/**
+ * Fastest spreading factor from ADR_MIN_SPREADING_FACTOR to baseSf whose
+ * demodulation floor snrDb clears by ADR_MARGIN_DB; baseSf if none does.
+ */
+uint8_t chooseSpreadingFactor(float snrDb, uint8_t baseSf);
+
+} // namespace meshola
@@ -0,0 +1,39 @@
+#include "ListenBeforeTalk.h"
+
+#include <algorithm>
+
+namespace meshola {
+
+ListenBeforeTalk::ListenBeforeTalk(uint32_t seed)
+    : _rng(seed ? seed : 1)
+{
+}
+
+uint32_t ListenBeforeTalk::random() {
+    // xorshift32: deterministic per seed, so simulator runs repeat exactly
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return _rng;
+}
+
+void ListenBeforeTalk::begin(uint32_t nowMs) {
+    _firstScanMs = nowMs;
+    _attempts = 0;
+}
+
+bool ListenBeforeTalk::defer(uint32_t nowMs, uint32_t airtimeMs, uint32_t& delayMs) {
+    if ((uint32_t)(nowMs - _firstScanMs) >= MAX_DEFER_MS) {
+        return false;
+    }
+    uint8_t exponent = (uint8_t)std::min<uint32_t>(MIN_WINDOW_EXPONENT + _attempts, MAX_WINDOW_EXPONENT);
+    if (_attempts < UINT8_MAX) {
+        _attempts++;
+    }
+    uint32_t slotMs = std::max<uint32_t>(airtimeMs / SLOT_DIVISOR, 1);
+    uint32_t slots = 1 + random() % (1u << exponent);         // At least one slot: the channel is busy now
+    delayMs = std::min(slots * slotMs, MAX_DEFER_MS - (nowMs - _firstScanMs));
+    return true;
+}
+
+} // namespace meshola
@@ -0,0 +1,62 @@
+#pragma once
+
+/**
+ * ListenBeforeTalk - Backoff policy for channel access.
+ *
+ * Before a frame goes on air the protocol runs channel activity detection
+ * (CAD). While CAD reports the channel busy, the frame waits a random
+ * number of backoff slots drawn from a window that doubles on every busy
+ * result (binary exponential backoff), with RX armed so the frame holding
+ * the channel is still received. Once MAX_DEFER_MS has passed since the
+ * frame's first scan it is sent regardless, so a jammed or permanently
+ * busy channel cannot hold the queue forever.
+ *
+ * Radio access lives in MeshCoreProtocol; this class only decides delays.
+ * Not thread-safe; time is passed in by the caller.
+ */
+
+#include <cstdint>
+
+namespace meshola {
+
+class ListenBeforeTalk {
+public:
+    static constexpr uint8_t MIN_WINDOW_EXPONENT = 1;       // First window: 2 slots
+    static constexpr uint8_t MAX_WINDOW_EXPONENT = 4;       // Window stops growing at 16 slots
+    static constexpr uint32_t MAX_DEFER_MS = 8000;          // Then transmit anyway
+    static constexpr uint32_t SLOT_DIVISOR = 8;             // Slot = frame time on air / 8
+
+    explicit ListenBeforeTalk(uint32_t seed = 1);
+
+    /**
+     * Restart the backoff sequence (e.g. from the node's key).
+     */
+    void reseed(uint32_t seed) { _rng = seed ? seed : 1; }
+
+    /**
+     * A new frame is about to be scanned for the first time.
+     */
+    void begin(uint32_t nowMs);
+
+    /**
+     * CAD found the channel busy.
+     * @param airtimeMs Time on air of the waiting frame; sets the slot length
+     * @param delayMs Set to the backoff before the next scan
+     * @return false once the max-defer bound is reached: send now
+     */
+    bool defer(uint32_t nowMs, uint32_t airtimeMs, uint32_t& delayMs);
+
+    /**
+     * Busy scans for the current frame so far.
+     */
+    uint8_t attempts() const { return _attempts; }
+
+private:
+    uint32_t _rng;
+    uint32_t _firstScanMs = 0;
+    uint8_t _attempts = 0;
+
+    uint32_t random();
+};
+
+} // namespace meshola
@@ -0,0 +1,66 @@
+#include "IRadio.h"
+
+#include <cmath>
+
+namespace meshola {
+
+uint32_t loraSymbolTimeUs(const RadioConfig& config) {
+    if (config.bandwidth <= 0.0f || config.spreadingFactor < 5 || config.spreadingFactor > 12) {
+        return 0;
+    }
+    return (uint32_t)((double)(1u << config.spreadingFactor) * 1000.0 / config.bandwidth);
+}
+
+uint32_t loraTimeOnAirUs(const RadioConfig& config, size_t len) {
+    if (config.bandwidth <= 0.0f || config.spreadingFactor < 5 || config.spreadingFactor > 12) {
+        return 0;
+    }
+    const int sf = config.spreadingFactor;
+    const int cr = (config.codingRate >= 5 && config.codingRate <= 8) ? config.codingRate : 5;
+
+    // Symbol time in microseconds: 2^SF / BW(kHz) * 1000
+    const double symbolUs = (double)(1u << sf) * 1000.0 / config.bandwidth;
+    const int lowDataRate = symbolUs > 16000.0 ? 1 : 0;
+
+    // Explicit header (H = 0), CRC on
+    int numerator = 8 * (int)len - 4 * sf + 28 + 16;
+    int denominator = 4 * (sf - 2 * lowDataRate);
+    int payloadSymbols = 8;
+    if (numerator > 0) {
+        payloadSymbols += ((numerator + denominator - 1) / denominator) * cr;
+    }
+
+    double preambleUs = ((double)effectivePreambleLength(config) + 4.25) * symbolUs;
+    return (uint32_t)(preambleUs + payloadSymbols * symbolUs);
+}
+
+uint32_t radioConfigChanges(const RadioConfig& from, const RadioConfig& to) {
+    uint32_t changes = RadioConfigNone;
+    if (from.frequency != to.frequency) changes |= RadioConfigFrequency;
+    if (from.bandwidth != to.bandwidth) changes |= RadioConfigBandwidth;
+    if (from.spreadingFactor != to.spreadingFactor) changes |= RadioConfigSpreadingFactor;
+    if (from.codingRate != to.codingRate) changes |= RadioConfigCodingRate;
+    if (from.txPower != to.txPower) changes |= RadioConfigTxPower;
+    if (effectivePreambleLength(from) != effectivePreambleLength(to)) changes |= RadioConfigPreamble;
+    return changes;
+}
+
+bool isValidRadioConfig(const RadioConfig& config) {
+    // SX126x LoRa bandwidths; RadioLib rounds to these in kHz
+    static constexpr float BANDWIDTHS_KHZ[] = { 7.8f, 10.4f, 15.6f, 20.8f, 31.25f, 41.7f, 62.5f, 125.0f, 250.0f, 500.0f };
+    bool bandwidthOk = false;
+    for (float bandwidth : BANDWIDTHS_KHZ) {
+        if (std::fabs(config.bandwidth - bandwidth) < 0.01f) {
+            bandwidthOk = true;
+            break;
+        }
+    }
+    return bandwidthOk &&
+           config.frequency >= 150.0f && config.frequency <= 960.0f &&
+           config.spreadingFactor >= 5 && config.spreadingFactor <= 12 &&
+           config.codingRate >= 5 && config.codingRate <= 8 &&
+           config.txPower >= -9 && config.txPower <= 22 &&
+           config.dutyCyclePermille <= 1000;
+}
+
+} // namespace meshola
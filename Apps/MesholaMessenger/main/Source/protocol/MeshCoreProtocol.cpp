@@ -1,8 +1,10 @@
 #include "MeshCoreProtocol.h"
+#include "TextCodec.h"
 #if defined(__GNUC__)
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdelete-non-virtual-dtor"
 #endif
+#include <algorithm>
 #include <cstring>
 #include <cstdio>
 #include <ctime>
@@ -10,10 +12,31 @@
 // ESP32 chip ID for unique node naming
 #ifdef ESP_PLATFORM
 #include <esp_mac.h>
+#include "Sx1262Radio.h"
 #endif
  
 #include <Tactility/Log.h>
 
+#include "../diag/Capture.h"
+#include "../diag/Trace.h"
+#include "../util/Clock.h"
+
+#ifndef MESHOLA_REPEATER
+#define MESHOLA_REPEATER 0
+#endif
+
+#ifndef MESHOLA_LBT
+#define MESHOLA_LBT 1
+#endif
+
+#ifndef MESHOLA_ADR
+#define MESHOLA_ADR 1
+#endif
+
+#ifndef MESHOLA_AUTO_ADVERT
+#define MESHOLA_AUTO_ADVERT 1
+#endif
+
 namespace meshola {
 
 #define TAG "MeshCoreProtocol"
@@ -34,71 +57,45 @@ static void generateUniqueNodeName(char* dest, size_t maxLen) {
 }
 
 // Protocol registration entry
-static const ProtocolEntry meshCoreEntry = {
-    .id = "meshcore",
-    .name = "MeshCore (Standard)",
-    .create = MeshCoreProtocol::create
-};
-
+std::unique_ptr<IRadio> createPlatformRadio() {
 #ifdef ESP_PLATFORM
-// T-Deck SX1262 pin map
-static constexpr int PIN_LORA_NSS   = 9;
-static constexpr int PIN_LORA_DIO1  = 45;
-static constexpr int PIN_LORA_RST   = 17;
-static constexpr int PIN_LORA_BUSY  = 13;
-static constexpr int PIN_LORA_SCLK  = 40;
-static constexpr int PIN_LORA_MISO  = 38;
-static constexpr int PIN_LORA_MOSI  = 41;
-
-static uint32_t sAckCounter = 1;
+    return std::make_unique<Sx1262Radio>();
+#else
+    return nullptr;
 #endif
+}
 
 // Default MeshCore Public channel (provided by user)
 static const char* DEFAULT_CHANNEL_NAME = "Public";
 static const char* DEFAULT_CHANNEL_HEX = "8b3387e9c5cdea6ac9e5edbaa115cd72";
 
 MeshCoreProtocol::MeshCoreProtocol()
+    : MeshCoreProtocol(createPlatformRadio())
+{
+}
+
+MeshCoreProtocol::MeshCoreProtocol(std::unique_ptr<IRadio> radio)
     : _running(false)
     , _messageCallback(nullptr)
     , _contactCallback(nullptr)
     , _statusCallback(nullptr)
     , _ackCallback(nullptr)
     , _errorCallback(nullptr)
+    , _transmitCallback(nullptr)
+    , _radio(std::move(radio))
+    , _lbtEnabled(MESHOLA_LBT != 0)
+    , _repeater(MESHOLA_REPEATER != 0)
+    , _autoAdvert(MESHOLA_AUTO_ADVERT != 0)
+    , _adrEnabled(MESHOLA_ADR != 0)
 {
     memset(&_config, 0, sizeof(_config));
     memset(_nodeName, 0, sizeof(_nodeName));
-    memset(&_defaultChannel, 0, sizeof(_defaultChannel));
     memset(_selfPublicKey, 0, sizeof(_selfPublicKey));
     memset(_selfName, 0, sizeof(_selfName));
     
     // Generate unique node name from hardware ID
     generateUniqueNodeName(_nodeName, sizeof(_nodeName));
-    strncpy(_defaultChannel.name, DEFAULT_CHANNEL_NAME, sizeof(_defaultChannel.name) - 1);
-    _defaultChannel.isPublic = true;
-    _defaultChannel.index = 0;
-    // Populate channel ID from hex string
-    auto hexToByte = [](char c) -> uint8_t {
-        if (c >= '0' && c <= '9') return c - '0';
-        if (c >= 'a' && c <= 'f') return 10 + (c - 'a');
-        if (c >= 'A' && c <= 'F') return 10 + (c - 'A');
-        return 0;
-    };
-    for (size_t i = 0; i < CHANNEL_ID_SIZE && (i * 2 + 1) < strlen(DEFAULT_CHANNEL_HEX); i++) {
-        _defaultChannel.id[i] = (hexToByte(DEFAULT_CHANNEL_HEX[i*2]) << 4) |
-                                (hexToByte(DEFAULT_CHANNEL_HEX[i*2 + 1]));
-    }
-
-    // Synthetic default contact to allow immediate DM testing
-    Contact broadcast = {};
-    strncpy(broadcast.name, "Public Broadcast", sizeof(broadcast.name) - 1);
-    broadcast.isOnline = true;
-    broadcast.isDiscovered = true;
-    broadcast.role = NodeRole::Companion;
-    broadcast.lastSeen = (uint32_t)time(nullptr);
-    broadcast.lastRssi = 0;
-    broadcast.pathLength = 1;
-    memset(broadcast.publicKey, 0, sizeof(broadcast.publicKey));
-    _contacts.push_back(broadcast);
+    resetProfileState();
     
     // Default radio config for MeshCore
     _config.frequency = 906.875f;      // US default
@@ -106,63 +103,26 @@ MeshCoreProtocol::MeshCoreProtocol()
     _config.spreadingFactor = 11;
     _config.codingRate = 5;            // 4/5
     _config.txPower = 22;              // dBm
+    _config.preambleLength = LORA_DEFAULT_PREAMBLE_LEN;
 }
 
 MeshCoreProtocol::~MeshCoreProtocol() {
     stop();
+    setSigningKey(nullptr);
 }
 
 bool MeshCoreProtocol::init(const RadioConfig& config) {
     _config = config;
-    
-#ifdef ESP_PLATFORM
-    // Clean up any previous instance
-    if (_radio) {
-        delete _radio;
-        _radio = nullptr;
-    }
-    if (_module) {
-        delete _module;
-        _module = nullptr;
-    }
-    if (_hal) {
-        _hal->term();
-        delete _hal;
-        _hal = nullptr;
-    }
-
-    // ESP-IDF HAL for RadioLib
-    _hal = new Esp32S3Hal(PIN_LORA_SCLK, PIN_LORA_MISO, PIN_LORA_MOSI);
-    _hal->init();
-
-    // Create RadioLib module for SX1262 on T-Deck
-    _module = new Module(_hal, PIN_LORA_NSS, PIN_LORA_DIO1, PIN_LORA_RST, PIN_LORA_BUSY);
-    _module->init();
-
-    _radio = new SX1262(_module);
+    _rxListening = false;
+    clearTransmitQueue();
+    _radioSf = config.spreadingFactor;
+    _radioPreamble = config.preambleLength;
+    _rateRxSf = 0;
+    _dutyCycle.setLimit(config.dutyCyclePermille);
 
-    // Bring up radio with provided config
-    int16_t state = _radio->begin(
-        _config.frequency,
-        _config.bandwidth,
-        _config.spreadingFactor,
-        _config.codingRate,
-        RADIOLIB_SX126X_SYNC_WORD_PRIVATE,
-        _config.txPower,
-        12  // default preamble
-    );
-    if (state != RADIOLIB_ERR_NONE) {
-        TT_LOG_E(TAG, "Radio begin failed: %d", state);
+    if (_radio && !_radio->begin(_config)) {
         return false;
     }
-
-    // Basic runtime tweaks
-    _radio->setDio2AsRfSwitch(true);
-    _radio->setCRC(2);
-    _radio->setOutputPower(_config.txPower);
-    // Prepare continuous RX loop
-    _rxListening = false;
-#endif
     return true;
 }
 
@@ -171,18 +131,23 @@ bool MeshCoreProtocol::start() {
         return true;
     }
 
-#ifdef ESP_PLATFORM
-    if (!_radio) {
-        return false;
-    }
-    // Kick RX into continuous mode
-    if (_radio->startReceive() != RADIOLIB_ERR_NONE) {
-        return false;
+    if (_radio) {
+        // Kick RX into continuous (or duty-cycled) mode
+        if (!startListening()) {
+            return false;
+        }
+        _rxListening = true;
     }
-    _rxListening = true;
-#endif
 
     _running = true;
+    if (_autoAdvert) {
+        uint32_t now = clock::millis();
+        _advertScheduler.start(now);
+        if (_warmStart) {
+            // Neighbours kept us in their snapshots too: no startup advert
+            _advertScheduler.sent(now, countNeighbours());
+        }
+    }
     return true;
 }
 
@@ -191,24 +156,18 @@ void MeshCoreProtocol::stop() {
         return;
     }
 
-#ifdef ESP_PLATFORM
-    if (_radio) {
-        _radio->standby();
-        delete _radio;
-        _radio = nullptr;
+    // Changes still waiting out the save debounce
+    if (stateUnsaved()) {
+        saveState();
     }
-    if (_module) {
-        delete _module;
-        _module = nullptr;
-    }
-    if (_hal) {
-        _hal->term();
-        delete _hal;
-        _hal = nullptr;
+    if (_radio) {
+        _radio->end();
     }
+    clearTransmitQueue();
+    _forwards.clear();
+    _pendingAdvertCount = 0;
+    _advertScheduler.stop();
     _rxListening = false;
-#endif
-
     _running = false;
 }
 
@@ -217,72 +176,101 @@ bool MeshCoreProtocol::isRunning() const {
 }
 
 void MeshCoreProtocol::loop() {
-    if (!_running) {
+    if (!_running || !_radio) {
         return;
     }
 
-#ifdef ESP_PLATFORM
-    if (!_radio) {
-        return;
-    }
+    // The frame on air finishing starts the next one or re-arms RX
+    uint32_t irq = _radio->pollIrq();
+    serviceTransmit(irq);
 
     // Ensure we're in RX mode
-    if (!_rxListening) {
-        _radio->startReceive();
+    if (!txHoldsRadio() && !_rxListening) {
+        startListening();
         _rxListening = true;
     }
 
-    uint32_t irq = _radio->getIrqFlags();
-    if (irq & RADIOLIB_SX126X_IRQ_CRC_ERR) {
+    // Read a received frame before anything below reuses the FIFO to transmit
+    if (irq & (RadioIrqCrcError | RadioIrqTimeout | RadioIrqRxDone)) {
+        receiveFrame(irq);
+    }
+
+    // Signed adverts held for a batch check, our own scheduled advert,
+    // reassembly timeouts and NACKs, then due rebroadcasts
+    serviceAdverts();
+    serviceAdvertSchedule();
+    serviceFragments();
+    serviceForwards();
+    serviceRateWindow();
+    serviceSnapshot();
+}
+
+void MeshCoreProtocol::receiveFrame(uint32_t irq) {
+    if (irq & RadioIrqCrcError) {
+        _counters->rxCrcErrors.add();
         TT_LOG_W(TAG, "CRC error");
-        _radio->clearIrqFlags(RADIOLIB_SX126X_IRQ_CRC_ERR);
-        _radio->startReceive();
+        _radio->clearIrq(RadioIrqCrcError);
+        startListening();
         return;
     }
-    if (irq & RADIOLIB_SX126X_IRQ_TIMEOUT) {
-        _radio->clearIrqFlags(RADIOLIB_SX126X_IRQ_TIMEOUT);
-        _radio->startReceive();
+    if (irq & RadioIrqTimeout) {
+        _counters->rxTimeouts.add();
+        _radio->clearIrq(RadioIrqTimeout);
+        startListening();
         return;
     }
 
-    if (irq & RADIOLIB_SX126X_IRQ_RX_DONE) {
-        uint8_t rxBuf[RADIOLIB_SX126X_MAX_PACKET_LENGTH + 1] = {0};
+    if (irq & RadioIrqRxDone) {
+        uint8_t rxBuf[MAX_RADIO_PACKET_LEN + 1] = {0};
         size_t packetLen = _radio->getPacketLength();
         if (packetLen >= sizeof(rxBuf)) {
             packetLen = sizeof(rxBuf) - 1;
         }
 
-        int16_t state = _radio->readData(rxBuf, packetLen);
-        _radio->clearIrqFlags(RADIOLIB_SX126X_IRQ_ALL);
-        _radio->startReceive();
-
-        if (state == RADIOLIB_ERR_NONE) {
-            // First try to parse as advert
+        bool readOk;
+        {
+            MESHOLA_TRACE_SCOPE(ReadData, (uint16_t)packetLen);
+            readOk = _radio->readData(rxBuf, packetLen);
+        }
+        _radio->clearIrq(RadioIrqAll);
+        startListening();
+
+        if (!readOk) {
+            _counters->rxReadErrors.add();
+        } else {
+            _counters->rxPackets.add();
+            if (_capture) {
+                _capture->record(rxBuf, packetLen, _radio->getRssi(), _radio->getSnr());
+            }
+            _rxRoute.valid = false;
+            _rxRoute.relayed = false;
+            _rxRoute.sourceRouted = false;
             Contact discovered{};
-            if (parseAdvert(rxBuf, packetLen, discovered)) {
-                discovered.lastRssi = (int16_t)_radio->getRSSI();
-                discovered.lastSnr = (int8_t)_radio->getSNR();
-                discovered.lastSeen = (uint32_t)time(nullptr);
-                discovered.isOnline = true;
-                discovered.isDiscovered = true;
-                // Merge into contacts list
-                bool isNew = true;
-                for (auto& c : _contacts) {
-                    if (memcmp(c.publicKey, discovered.publicKey, PUBLIC_KEY_SIZE) == 0) {
-                        c = discovered;
-                        isNew = false;
-                        break;
-                    }
-                }
-                if (isNew) {
-                    _contacts.push_back(discovered);
-                }
-                if (_contactCallback) {
-                    _contactCallback(discovered, isNew);
+            if (rxBuf[2] == PACKET_VERSION_ROUTED && !acceptRoutedFrame(rxBuf, packetLen)) {
+                // Duplicate or malformed; a fresh routed frame is unwrapped in place
+            } else if (handleRateSwitch(rxBuf, packetLen)) {
+                // Peer sends its next frames to us faster
+            } else if (parseAdvert(rxBuf, packetLen, discovered)) {
+                _counters->rxAdverts.add();
+                const Contact* known = _contacts.find(discovered.publicKey);
+                if (discovered.peerFlags & PACKET_FLAG_SIGNED) {
+                    queueSignedAdvert(discovered, rxBuf, packetLen);
+                } else if (known && (known->peerFlags & PACKET_FLAG_SIGNED)) {
+                    // A peer that signs never stops; someone else is using its key
+                    _counters->advertSigFailures.add();
+                } else {
+                    acceptAdvert(discovered, _rxRoute, _radio->getRssi(), _radio->getSnr());
                 }
+            } else if (handleFragmentFrame(rxBuf, packetLen)) {
+                // Fragment or NACK; a completed message was delivered
+            } else if (handleCompactFrame(rxBuf, packetLen)) {
+                // Delivered, or dropped and counted
             } else if (_messageCallback) {
                 Message msg = {};
-                if (!parsePacket(rxBuf, packetLen, msg)) {
+                if (parsePacket(rxBuf, packetLen, msg)) {
+                    _counters->rxMessages.add();
+                } else {
+                    _counters->rxParseFailures.add();
                     // Fallback: treat as plain text
                     msg.type = MessageType::Direct;
                     msg.isChannel = false;
@@ -290,34 +278,24 @@ void MeshCoreProtocol::loop() {
                     msg.timestamp = (uint32_t)time(nullptr);
                     strncpy(msg.text, reinterpret_cast<const char*>(rxBuf), sizeof(msg.text) - 1);
                 }
-                msg.rssi = _radio->getRSSI();
-                msg.snr = _radio->getSNR();
-                msg.status = MessageStatus::Received;
-                _messageCallback(msg);
+                deliverMessage(msg);
             }
         }
     }
-#endif
 }
 
 ProtocolInfo MeshCoreProtocol::getInfo() const {
     return ProtocolInfo{
-        .id = "meshcore",
+        .id = PROTOCOL_ID,
         .name = "MeshCore",
         .version = "1.0.0",
         .description = "Standard MeshCore protocol for off-grid mesh messaging",
-        .capabilities = (1 << static_cast<int>(ProtocolFeature::DirectMessages)) |
-                       (1 << static_cast<int>(ProtocolFeature::Channels)) |
-                       (1 << static_cast<int>(ProtocolFeature::SignedMessages)) |
-                       (1 << static_cast<int>(ProtocolFeature::LocationSharing)) |
-                       (1 << static_cast<int>(ProtocolFeature::PathRouting)) |
-                       (1 << static_cast<int>(ProtocolFeature::Encryption))
+        .capabilities = FEATURES
     };
 }
 
 bool MeshCoreProtocol::hasFeature(ProtocolFeature feature) const {
-    ProtocolInfo info = getInfo();
-    return (info.capabilities & (1 << static_cast<int>(feature))) != 0;
+    return (FEATURES & featureBit(feature)) != 0;
 }
 
 const char* MeshCoreProtocol::getNodeName() const {
@@ -346,6 +324,9 @@ void MeshCoreProtocol::setLocalIdentity(const uint8_t publicKey[PUBLIC_KEY_SIZE]
     if (publicKey) {
         memcpy(_selfPublicKey, publicKey, PUBLIC_KEY_SIZE);
         _hasSelfKey = true;
+        _forwards.reseed(contactKeyHash(publicKey));
+        _lbt.reseed(contactKeyHash(publicKey) ^ 0x9E3779B9u);
+        _advertScheduler.reseed(contactKeyHash(publicKey) ^ 0x85EBCA6Bu);
     } else {
         _hasSelfKey = false;
         memset(_selfPublicKey, 0, sizeof(_selfPublicKey));
@@ -356,40 +337,91 @@ void MeshCoreProtocol::setLocalIdentity(const uint8_t publicKey[PUBLIC_KEY_SIZE]
     }
 }
 
+void MeshCoreProtocol::setSigningKey(const uint8_t privateKey[PUBLIC_KEY_SIZE]) {
+    if (!privateKey) {
+        memset(_signingSeed, 0, sizeof(_signingSeed));
+        memset(_signingPublicKey, 0, sizeof(_signingPublicKey));
+        _hasSigningKey = false;
+        return;
+    }
+    memcpy(_signingSeed, privateKey, sizeof(_signingSeed));
+    crypto::ed25519PublicKey(_signingSeed, _signingPublicKey);
+    _hasSigningKey = true;
+    if (!canSign()) {
+        TT_LOG_W(TAG, "Private key doesn't match the public key, adverts go out unsigned");
+    }
+}
+
+bool MeshCoreProtocol::canSign() const {
+    return _hasSigningKey && _hasSelfKey && memcmp(_signingPublicKey, _selfPublicKey, PUBLIC_KEY_SIZE) == 0;
+}
+
+void MeshCoreProtocol::resetProfileState() {
+    // The outgoing profile's changes still go to its own snapshot
+    if (stateUnsaved()) {
+        saveState();
+    }
+    _pendingAdvertCount = 0;
+    for (HeldMessage& held : _heldMessages) {
+        held.prefixLen = 0;
+    }
+    memset(&_defaultChannel, 0, sizeof(_defaultChannel));
+    _channelRevision++;
+    strncpy(_defaultChannel.name, DEFAULT_CHANNEL_NAME, sizeof(_defaultChannel.name) - 1);
+    _defaultChannel.isPublic = true;
+    _defaultChannel.index = 0;
+    // Populate channel ID from hex string
+    auto hexToByte = [](char c) -> uint8_t {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return 10 + (c - 'a');
+        if (c >= 'A' && c <= 'F') return 10 + (c - 'A');
+        return 0;
+    };
+    for (size_t i = 0; i < CHANNEL_ID_SIZE && (i * 2 + 1) < strlen(DEFAULT_CHANNEL_HEX); i++) {
+        _defaultChannel.id[i] = (hexToByte(DEFAULT_CHANNEL_HEX[i*2]) << 4) |
+                                (hexToByte(DEFAULT_CHANNEL_HEX[i*2 + 1]));
+    }
+
+    // Synthetic default contact to allow immediate DM testing
+    _contacts.clear();
+    Contact broadcast = {};
+    strncpy(broadcast.name, "Public Broadcast", sizeof(broadcast.name) - 1);
+    broadcast.isOnline = true;
+    broadcast.isDiscovered = true;
+    broadcast.role = NodeRole::Companion;
+    broadcast.lastSeen = (uint32_t)time(nullptr);
+    broadcast.lastRssi = 0;
+    broadcast.pathLength = 1;
+    memset(broadcast.publicKey, 0, sizeof(broadcast.publicKey));
+    _contacts.upsert(broadcast);
+    _contacts.pin(broadcast.publicKey);
+
+    // Nothing to save until the new profile's state is loaded and changes
+    _warmStart = false;
+    _stateLoaded = false;
+    markStateSaved();
+}
+
 bool MeshCoreProtocol::sendAdvertisement() {
     if (!_running) {
         return false;
     }
-    
-#ifdef ESP_PLATFORM
     if (!_radio) {
-        return false;
+        return true;
     }
-    uint8_t payload[RADIOLIB_SX126X_MAX_PACKET_LENGTH] = {0};
-    size_t payloadLen = 0;
-    uint8_t roleByte = static_cast<uint8_t>(NodeRole::Companion);
-    if (!buildAdvert(roleByte, _selfPublicKey, _selfName[0] ? _selfName : _nodeName, payload, payloadLen)) {
+    if (!transmitAdvert()) {
         return false;
     }
-    _radio->standby();
-    int16_t state = _radio->transmit(payload, payloadLen);
-    _radio->startReceive();
-    _rxListening = true;
-    return state == RADIOLIB_ERR_NONE;
-#else
+    _advertScheduler.sent(clock::millis(), countNeighbours());
     return true;
-#endif
 }
 
 uint32_t MeshCoreProtocol::sendMessage(const Contact& to, const char* text) {
     if (!_running || !text) {
         return 0;
     }
-
-#ifdef ESP_PLATFORM
-    (void)to;
     if (!_radio) {
-        return 0;
+        return 1;
     }
 
     size_t len = strnlen(text, MAX_MESSAGE_LEN - 1);
@@ -397,170 +429,512 @@ uint32_t MeshCoreProtocol::sendMessage(const Contact& to, const char* text) {
         return 0;
     }
 
-    uint8_t payload[RADIOLIB_SX126X_MAX_PACKET_LENGTH] = {0};
-    size_t payloadLen = 0;
-    if (!buildPacket(text, nullptr, to.publicKey, false, payload, payloadLen)) {
-        TT_LOG_E(TAG, "Failed to build DM packet");
-        return 0;
-    }
-
-    // Standby for TX
-    _radio->standby();
-    int16_t state = _radio->transmit(payload, payloadLen);
-    _radio->startReceive();
-    _rxListening = true;
-    if (state != RADIOLIB_ERR_NONE) {
+    // Frames queued for this DM report completion under its ack ID, and go
+    // faster if the recipient is a close neighbour
+    _sendAckId = _nextAckId;
+    _sendSf = adrSpreadingFactor(to.publicKey);
+    memcpy(_sendRateTarget, to.publicKey, RATE_PREFIX_LEN);
+    bool ok = sendText(text, nullptr, to.publicKey, false);
+    _sendAckId = 0;
+    _sendSf = 0;
+    if (!ok) {
         return 0;
     }
-
-    uint32_t ackId = sAckCounter++;
-    return ackId;
-#else
-    (void)to;
-    return 1;
-#endif
+    _advertScheduler.noteTraffic(clock::millis());
+    return _nextAckId++;
 }
 
 bool MeshCoreProtocol::sendChannelMessage(const Channel& channel, const char* text) {
     if (!_running || !text) {
         return false;
     }
-    
-#ifdef ESP_PLATFORM
     if (!_radio) {
+        return true;
+    }
+
+    if (!sendText(text, channel.id, nullptr, true)) {
         return false;
     }
+    _advertScheduler.noteTraffic(clock::millis());
+    return true;
+}
 
-    uint8_t payload[RADIOLIB_SX126X_MAX_PACKET_LENGTH] = {0};
+bool MeshCoreProtocol::sendText(const char* text,
+                     const uint8_t channelId[CHANNEL_ID_SIZE],
+                     const uint8_t recipientKey[PUBLIC_KEY_SIZE],
+                     bool isChannel) {
+    uint8_t features = frameFeatures(isChannel ? nullptr : recipientKey);
+    uint8_t payload[MAX_RADIO_PACKET_LEN] = {0};
     size_t payloadLen = 0;
-    if (!buildPacket(text, channel.id, nullptr, true, payload, payloadLen)) {
+    if (buildPacket(text, channelId, recipientKey, isChannel, features, payload, payloadLen)) {
+        if (features & PACKET_FLAG_ROUTED) {
+            return transmitRouted(payload, payloadLen, isChannel ? nullptr : _contacts.find(recipientKey));
+        }
+        return transmitFrame(payload, payloadLen);
+    }
+    // Too long for one frame: split it if every receiver can reassemble
+    const uint8_t fragmentFeatures = PACKET_FLAG_COMPACT | PACKET_FLAG_FRAGMENT;
+    if ((features & fragmentFeatures) == fragmentFeatures) {
+        return sendFragmented(text, strnlen(text, MAX_MESSAGE_LEN - 1), channelId, recipientKey, isChannel,
+                              features);
+    }
+    if (isChannel) {
         TT_LOG_E(TAG, "Failed to build channel packet");
-        return false;
+    } else {
+        TT_LOG_E(TAG, "Failed to build DM packet");
     }
+    return false;
+}
 
-    _radio->standby();
-    int16_t state = _radio->transmit(payload, payloadLen);
-    _radio->startReceive();
-    _rxListening = true;
-    return state == RADIOLIB_ERR_NONE;
-#else
-    return true;
-#endif
+void MeshCoreProtocol::deliverMessage(Message& msg) {
+    refreshSender(msg.senderKey);
+    if (!_messageCallback) {
+        return;
+    }
+    msg.rssi = (int16_t)_radio->getRssi();
+    msg.snr = (int8_t)_radio->getSnr();
+    msg.status = MessageStatus::Received;
+    _messageCallback(msg);
 }
 
-int MeshCoreProtocol::getContactCount() const {
-    return (int)_contacts.size();
+void MeshCoreProtocol::refreshSender(const uint8_t senderKey[PUBLIC_KEY_SIZE]) {
+    learnRoute(senderKey);
+    const Contact* sender = _contacts.find(senderKey);
+    if (sender) {
+        // Any frame shows the sender is still around, not only its adverts
+        Contact updated = *sender;
+        updated.lastSeen = (uint32_t)time(nullptr);
+        updated.isOnline = true;
+        sampleLink(updated, _rxRoute, _radio->getRssi(), _radio->getSnr());
+        _contacts.upsert(updated);
+    }
 }
 
-bool MeshCoreProtocol::getContact(int index, Contact& out) const {
-    if (index < 0 || index >= (int)_contacts.size()) {
-        memset(&out, 0, sizeof(Contact));
+// ============================================================================
+// Transmit queue
+//
+// transmitFrame() only queues; the caller (often holding the service lock)
+// never waits for the frame's time on air. With listen-before-talk the queue
+// front first gets a channel scan (CAD): a clear channel sends it, a busy
+// one parks it in Backoff with RX armed for a ListenBeforeTalk delay, then
+// it is scanned again. Once on air it stays the front until loop() sees
+// RadioIrqTxDone, then the next frame starts, or RX is re-armed once the
+// queue is empty. Each finished frame is counted and reported through the
+// transmit callback. Under a regulatory duty cycle limit every frame must
+// fit the remaining hourly budget (DutyCycleBudget) to go on air; one that
+// doesn't is dropped as failed rather than held, so the queue keeps moving.
+// ============================================================================
+
+bool MeshCoreProtocol::transmitFrame(const uint8_t* payload, size_t len) {
+    MESHOLA_TRACE_FLOW();
+    if (len == 0 || len > MAX_RADIO_PACKET_LEN || _txCount == TX_QUEUE_DEPTH) {
+        _counters->txQueueDrops.add();
+        countTx(false, len);
         return false;
     }
-    out = _contacts[index];
+    QueuedTx& tx = _txQueue[(_txHead + _txCount) % TX_QUEUE_DEPTH];
+    tx.ackId = _sendAckId;
+    tx.spreadingFactor = _sendSf;
+    memcpy(tx.rateTarget, _sendRateTarget, RATE_PREFIX_LEN);
+    tx.len = (uint8_t)len;
+    memcpy(tx.data, payload, len);
+    _txCount++;
+    if (_txState == TxState::Idle) {
+        startNextTransmit();
+    }
     return true;
 }
 
-bool MeshCoreProtocol::findContact(const uint8_t publicKey[PUBLIC_KEY_SIZE], Contact& out) const {
-    if (!publicKey) return false;
-    for (const auto& c : _contacts) {
-        if (memcmp(c.publicKey, publicKey, PUBLIC_KEY_SIZE) == 0) {
-            out = c;
-            return true;
+void MeshCoreProtocol::startNextTransmit() {
+    while (_txCount > 0 && _txState == TxState::Idle) {
+        // Inside a rate window the peer is waiting on the fast SF for us
+        if (_lbtEnabled && !rateWindowOpen(_txQueue[_txHead])) {
+            _lbt.begin(clock::millis());
+            if (scanFront()) {
+                return;
+            }
+            // No CAD on this radio: send unscanned
         }
+        sendFront();
     }
-    return false;
 }
 
-bool MeshCoreProtocol::addContact(const Contact& contact) {
-    _contacts.push_back(contact);
+bool MeshCoreProtocol::scanFront() {
+    if (!tuneRadio(_config) || !_radio->startChannelScan()) {
+        return false;
+    }
+    _counters->lbtScans.add();
+    _txState = TxState::Scanning;
+    _rxListening = false;
+    _txDeadlineMs = clock::millis() + CAD_DONE_TIMEOUT_MS;
     return true;
 }
 
-bool MeshCoreProtocol::promoteContact(const uint8_t publicKey[PUBLIC_KEY_SIZE]) {
-    if (!publicKey) return false;
-    for (auto& c : _contacts) {
-        if (memcmp(c.publicKey, publicKey, PUBLIC_KEY_SIZE) == 0) {
-            c.isDiscovered = false;
-            return true;
-        }
+void MeshCoreProtocol::sendFront() {
+    const QueuedTx& tx = _txQueue[_txHead];
+    if (tx.spreadingFactor != 0 && !rateWindowOpen(tx) && startRateSwitch()) {
+        return;
     }
-    return false;
+    // startRateSwitch() falls back to the profile SF when a switch doesn't pay
+    bool fast = tx.spreadingFactor != 0;
+    RadioConfig config = fast ? fastConfig(tx.spreadingFactor, _rateTxLeadIn) : _config;
+    if (!claimAirtime(config, tx.len)) {
+        _counters->txDutyCycleDrops.add();
+        _dutyCycleRejects++;
+        finishTransmit(false);
+        return;
+    }
+    bool ok = tuneRadio(config);
+    if (ok) {
+        MESHOLA_TRACE_SCOPE(Transmit, (uint16_t)tx.len);
+        ok = _radio->startTransmit(tx.data, tx.len);
+    }
+    if (!ok) {
+        finishTransmit(false);
+        return;
+    }
+    if (fast) {
+        _counters->adrFastFrames.add();
+        _rateTxLeadIn = false;
+    }
+    _txState = TxState::OnAir;
+    _rxListening = false;
+    _txDeadlineMs = clock::millis() + _radio->getTimeOnAirUs(tx.len) / 1000 + TX_DONE_TIMEOUT_MS;
 }
 
-bool MeshCoreProtocol::setContactFavorite(const uint8_t publicKey[PUBLIC_KEY_SIZE], bool favorite) {
-    if (!publicKey) return false;
-    for (auto& c : _contacts) {
-        if (memcmp(c.publicKey, publicKey, PUBLIC_KEY_SIZE) == 0) {
-            c.isFavorite = favorite;
-            return true;
-        }
+bool MeshCoreProtocol::claimAirtime(const RadioConfig& config, size_t len) {
+    // Charged before going on air: a frame that then fails to start still
+    // counts, which only errs on the safe side
+    uint32_t nowMs = clock::millis();
+    uint32_t airtimeMs = (loraTimeOnAirUs(config, len) + 999) / 1000;
+    if (!_dutyCycle.allows(nowMs, airtimeMs)) {
+        return false;
     }
-    return false;
+    _dutyCycle.record(nowMs, airtimeMs);
+    return true;
 }
 
-bool MeshCoreProtocol::removeContact(const uint8_t publicKey[PUBLIC_KEY_SIZE]) {
-    if (!publicKey) return false;
-    for (auto it = _contacts.begin(); it != _contacts.end(); ++it) {
-        if (memcmp(it->publicKey, publicKey, PUBLIC_KEY_SIZE) == 0) {
-            _contacts.erase(it);
-            return true;
+void MeshCoreProtocol::finishTransmit(bool ok) {
+    const QueuedTx& tx = _txQueue[_txHead];
+    _txRateSwitch = false;
+    uint32_t ackId = tx.ackId;
+    countTx(ok, tx.len);
+    _txHead = (_txHead + 1) % TX_QUEUE_DEPTH;
+    _txCount--;
+    _txState = TxState::Idle;
+    if (_transmitCallback) {
+        _transmitCallback(ackId, ok);
+    }
+}
+
+void MeshCoreProtocol::serviceChannelScan(uint32_t irq) {
+    uint32_t nowMs = clock::millis();
+    if (irq & RadioIrqCadDone) {
+        _radio->clearIrq(RadioIrqCadDone | RadioIrqCadDetected);
+        uint32_t delayMs = 0;
+        if (!(irq & RadioIrqCadDetected)) {
+            sendFront();
+        } else if (_lbt.defer(nowMs, _radio->getTimeOnAirUs(_txQueue[_txHead].len) / 1000, delayMs)) {
+            // Listen while waiting: the frame holding the channel may be for us
+            _counters->lbtDefers.add();
+            _counters->lbtDeferMs.add(delayMs);
+            _txState = TxState::Backoff;
+            _txBackoffUntilMs = nowMs + delayMs;
+            _rxListening = startListening();
+        } else {
+            // Max-defer bound reached: a busy channel must not hold the queue forever
+            _counters->lbtForced.add();
+            sendFront();
         }
+    } else if ((int32_t)(nowMs - _txDeadlineMs) >= 0) {
+        TT_LOG_W(TAG, "Channel scan timed out");
+        _radio->standby();
+        sendFront();
     }
-    return false;
 }
 
-void MeshCoreProtocol::resetPath(const uint8_t publicKey[PUBLIC_KEY_SIZE]) {
-    // TODO: Reset path to contact
+void MeshCoreProtocol::serviceTransmit(uint32_t irq) {
+    switch (_txState) {
+        case TxState::Idle:
+            return;
+        case TxState::Scanning:
+            serviceChannelScan(irq);
+            break;
+        case TxState::Backoff:
+            // A frame that just arrived is read before CAD takes the radio
+            if ((int32_t)(clock::millis() - _txBackoffUntilMs) < 0 ||
+                (irq & (RadioIrqRxDone | RadioIrqCrcError))) {
+                return;
+            }
+            if (!scanFront()) {
+                sendFront();
+            }
+            break;
+        case TxState::OnAir:
+            if (irq & RadioIrqTxDone) {
+                _radio->clearIrq(RadioIrqTxDone);
+                if (_txRateSwitch) {
+                    finishRateSwitch();
+                } else {
+                    finishTransmit(true);
+                }
+            } else if ((int32_t)(clock::millis() - _txDeadlineMs) >= 0) {
+                // TX_DONE never came (lost IRQ, radio wedged): abort and move on
+                TT_LOG_W(TAG, "Transmit timed out");
+                _counters->txTimeouts.add();
+                _radio->standby();
+                finishTransmit(false);
+            }
+            break;
+    }
+    if (_txState == TxState::Idle) {
+        startNextTransmit();
+    }
+    if (_txState == TxState::Idle) {
+        _rxListening = startListening();
+    }
 }
 
-int MeshCoreProtocol::getChannelCount() const {
-    return 1;
+void MeshCoreProtocol::clearTransmitQueue() {
+    // Dropped without callbacks: the protocol is stopping or resetting
+    _txHead = 0;
+    _txCount = 0;
+    _txState = TxState::Idle;
+    _txRateSwitch = false;
+    _rateTxSf = 0;
 }
 
-bool MeshCoreProtocol::getChannel(int index, Channel& out) const {
-    if (index == 0) {
-        out = _defaultChannel;
+bool MeshCoreProtocol::tuneRadio(const RadioConfig& config) {
+    if (config.spreadingFactor == _radioSf && config.preambleLength == _radioPreamble) {
         return true;
     }
-    memset(&out, 0, sizeof(Channel));
-    return false;
+    if (!_radio->applyConfig(config)) {
+        _radioSf = 0;
+        return false;
+    }
+    _radioSf = config.spreadingFactor;
+    _radioPreamble = config.preambleLength;
+    _rxListening = false;
+    return true;
 }
 
-bool MeshCoreProtocol::setChannel(int index, const Channel& channel) {
-    if (index == 0) {
-        _defaultChannel = channel;
+bool MeshCoreProtocol::startListening() {
+    if (txHoldsRadio()) {
+        // Re-armed when the scan or frame on air completes
         return true;
     }
-    return false;
+    // Inside a rate window the peer's frames come at its faster SF, with
+    // no long preamble for duty-cycled RX to catch
+    if (!tuneRadio(_rateRxSf ? fastConfig(_rateRxSf, false) : _config)) {
+        return false;
+    }
+    if (_sleepPeriodUs != 0 && _rateRxSf == 0) {
+        return _radio->startReceiveDutyCycle(_rxPeriodUs, _sleepPeriodUs);
+    }
+    return _radio->startReceive();
 }
 
-RadioConfig MeshCoreProtocol::getRadioConfig() const {
-    return _config;
+bool MeshCoreProtocol::setRxDutyCycle(uint32_t rxPeriodUs, uint32_t sleepPeriodUs) {
+    if (rxPeriodUs == _rxPeriodUs && sleepPeriodUs == _sleepPeriodUs) {
+        return true;
+    }
+    _rxPeriodUs = rxPeriodUs;
+    _sleepPeriodUs = rxPeriodUs != 0 ? sleepPeriodUs : 0;
+    if (!_running || !_radio || txHoldsRadio()) {
+        // Used when RX is next armed, after the scan or frame on air if any
+        return true;
+    }
+    // Re-arm RX in the new mode
+    _radio->standby();
+    _rxListening = startListening();
+    return _rxListening;
 }
 
-bool MeshCoreProtocol::setRadioConfig(const RadioConfig& config) {
-    _config = config;
-    
-    if (_running) {
-        // TODO: Apply new radio settings
-        // _radio->setFrequency(config.frequency);
-        // _radio->setBandwidth(config.bandwidth);
-        // etc.
+int MeshCoreProtocol::getContactCount() const {
+    return (int)_contacts.size();
+}
+
+bool MeshCoreProtocol::getContact(int index, Contact& out) const {
+    if (index < 0 || index >= (int)_contacts.size()) {
+        memset(&out, 0, sizeof(Contact));
+        return false;
     }
-    
+    out = _contacts.at(index);
+    return true;
+}
+
+bool MeshCoreProtocol::findContact(const uint8_t publicKey[PUBLIC_KEY_SIZE], Contact& out) const {
+    const Contact* contact = _contacts.find(publicKey);
+    if (!contact) {
+        return false;
+    }
+    out = *contact;
+    return true;
+}
+
+bool MeshCoreProtocol::findContactByHash(uint32_t keyHash, Contact& out) const {
+    const Contact* contact = _contacts.findByHash(keyHash);
+    if (!contact) {
+        return false;
+    }
+    out = *contact;
+    return true;
+}
+
+size_t MeshCoreProtocol::copyContacts(Contact* dest, size_t maxCount, size_t offset) const {
+    if (!dest || offset >= _contacts.size()) {
+        return 0;
+    }
+    size_t count = std::min(maxCount, _contacts.size() - offset);
+    std::copy_n(_contacts.begin() + offset, count, dest);
+    return count;
+}
+
+void MeshCoreProtocol::forEachContact(const ContactVisitor& visitor) const {
+    for (const auto& c : _contacts) {
+        if (!visitor(c)) {
+            break;
+        }
+    }
+}
+
+bool MeshCoreProtocol::addContact(const Contact& contact) {
+    ContactUpsert result = _contacts.upsert(contact);
+    if (result == ContactUpsert::Evicted) {
+        _counters->contactEvictions.add();
+    }
+    return result != ContactUpsert::Full;
+}
+
+bool MeshCoreProtocol::promoteContact(const uint8_t publicKey[PUBLIC_KEY_SIZE]) {
+    return _contacts.promote(publicKey);
+}
+
+bool MeshCoreProtocol::setContactFavorite(const uint8_t publicKey[PUBLIC_KEY_SIZE], bool favorite) {
+    return _contacts.setFavorite(publicKey, favorite);
+}
+
+bool MeshCoreProtocol::removeContact(const uint8_t publicKey[PUBLIC_KEY_SIZE]) {
+    return _contacts.remove(publicKey);
+}
+
+void MeshCoreProtocol::resetPath(const uint8_t publicKey[PUBLIC_KEY_SIZE]) {
+    const Contact* known = _contacts.find(publicKey);
+    if (!known || !known->hasPath) {
+        return;
+    }
+    // Next DM floods again and the reply teaches us a fresh route
+    Contact updated = *known;
+    updated.hasPath = false;
+    updated.pathLength = 0;
+    memset(updated.path, 0, sizeof(updated.path));
+    _contacts.upsert(updated);
+}
+
+int MeshCoreProtocol::getChannelCount() const {
+    return 1;
+}
+
+bool MeshCoreProtocol::getChannel(int index, Channel& out) const {
+    if (index == 0) {
+        out = _defaultChannel;
+        return true;
+    }
+    memset(&out, 0, sizeof(Channel));
+    return false;
+}
+
+bool MeshCoreProtocol::findChannel(const uint8_t channelId[CHANNEL_ID_SIZE], Channel& out) const {
+    if (!channelId || memcmp(_defaultChannel.id, channelId, CHANNEL_ID_SIZE) != 0) {
+        return false;
+    }
+    out = _defaultChannel;
+    return true;
+}
+
+size_t MeshCoreProtocol::copyChannels(Channel* dest, size_t maxCount, size_t offset) const {
+    if (!dest || maxCount == 0 || offset != 0) {
+        return 0;
+    }
+    dest[0] = _defaultChannel;
+    return 1;
+}
+
+bool MeshCoreProtocol::setChannel(int index, const Channel& channel) {
+    if (index == 0) {
+        _defaultChannel = channel;
+        _channelRevision++;
+        return true;
+    }
+    return false;
+}
+
+RadioConfig MeshCoreProtocol::getRadioConfig() const {
+    return _config;
+}
+
+bool MeshCoreProtocol::setRadioConfig(const RadioConfig& config) {
+    if (!isValidRadioConfig(config)) {
+        TT_LOG_E(TAG, "Unsupported radio config (%.3f MHz, BW %.1f, SF%u, CR 4/%u, %d dBm)",
+                 config.frequency, config.bandwidth, config.spreadingFactor, config.codingRate, config.txPower);
+        return false;
+    }
+    uint32_t changes = radioConfigChanges(_config, config);
+    
+    if (changes != RadioConfigNone && _running && _radio) {
+        if (_txState == TxState::OnAir) {
+            // Re-tuning cuts off the frame on air
+            _radio->standby();
+            finishTransmit(false);
+        } else if (_txState != TxState::Idle) {
+            // The waiting frame is scanned again on the new channel
+            _radio->standby();
+            _txState = TxState::Idle;
+        }
+        // Rates chosen for the old settings no longer apply
+        for (size_t i = 0; i < _txCount; i++) {
+            _txQueue[(_txHead + i) % TX_QUEUE_DEPTH].spreadingFactor = 0;
+        }
+        _rateTxSf = 0;
+        _rateRxSf = 0;
+        // Re-tune in place: SPI bus and driver objects stay up
+        bool ok = _radio->applyConfig(config);
+        if (ok) {
+            _config = config;
+            _radioSf = config.spreadingFactor;
+            _radioPreamble = config.preambleLength;
+        } else {
+            _radioSf = 0;
+        }
+        startNextTransmit();
+        startListening();
+        _rxListening = true;
+        if (!ok) {
+            TT_LOG_E(TAG, "Failed to apply radio config");
+            return false;
+        }
+    } else if (changes != RadioConfigNone) {
+        // Written to the radio when it is next tuned
+        _radioSf = 0;
+    }
+    
+    _config = config;
+    _dutyCycle.setLimit(config.dutyCyclePermille);
     return true;
 }
 
 NodeStatus MeshCoreProtocol::getStatus() const {
     NodeStatus status = {};
     status.radioRunning = _running;
-#ifdef ESP_PLATFORM
     if (_radio) {
-        status.lastRssi = (int16_t)_radio->getRSSI(true);
-        status.lastSnr = (int8_t)_radio->getSNR();
+        status.lastRssi = (int16_t)_radio->getRssi();
+        status.lastSnr = (int8_t)_radio->getSnr();
     }
-#endif
+    uint32_t nowMs = clock::millis();
+    status.dutyCyclePermille = _dutyCycle.limit();
+    status.airtimeUsedMs = _dutyCycle.usedMs(nowMs);
+    status.airtimeRemainingMs = _dutyCycle.remainingMs(nowMs);
+    status.dutyCycleRejects = _dutyCycleRejects;
     return status;
 }
 
@@ -584,27 +958,74 @@ void MeshCoreProtocol::setErrorCallback(ErrorCallback callback) {
     _errorCallback = callback;
 }
 
-bool MeshCoreProtocol::saveState() {
-    // TODO: Save contacts and channels to flash/SD
-    return true;
+void MeshCoreProtocol::setTransmitCallback(TransmitCallback callback) {
+    _transmitCallback = callback;
 }
 
-bool MeshCoreProtocol::loadState() {
-    // TODO: Load contacts and channels from flash/SD
-    return true;
+void MeshCoreProtocol::setCounters(diag::ProtocolCounters* counters) {
+    _counters = counters ? counters : &_ownCounters;
+}
+
+void MeshCoreProtocol::setCapture(diag::PacketCapture* capture) {
+    _capture = capture;
+}
+
+void MeshCoreProtocol::setListenBeforeTalk(bool enabled) {
+    // A scan or backoff already under way finishes as started
+    _lbtEnabled = enabled;
+}
+
+void MeshCoreProtocol::setAdaptiveDataRate(bool enabled) {
+    // Frames already queued at a faster SF and open windows run their course
+    _adrEnabled = enabled;
+}
+
+void MeshCoreProtocol::setAutoAdvert(bool enabled) {
+    if (enabled == _autoAdvert) {
+        return;
+    }
+    _autoAdvert = enabled;
+    if (!enabled) {
+        _advertScheduler.stop();
+    } else if (_running) {
+        _advertScheduler.start(clock::millis());
+    }
+}
+
+void MeshCoreProtocol::setRepeater(bool enabled) {
+    _repeater = enabled;
+    if (!enabled) {
+        _forwards.clear();
+    }
+}
+
+void MeshCoreProtocol::countTx(bool ok, size_t len) {
+    if (!ok) {
+        _counters->txFailures.add();
+        return;
+    }
+    _counters->txPackets.add();
+    _counters->txAirtimeMs.add(_radio->getTimeOnAirUs(len) / 1000);
 }
 
 bool MeshCoreProtocol::buildPacket(const char* text,
                      const uint8_t channelId[CHANNEL_ID_SIZE],
                      const uint8_t recipientKey[PUBLIC_KEY_SIZE],
                      bool isChannel,
+                     uint8_t features,
                      uint8_t* outBuf,
                      size_t& outLen) const {
     if (!text || !outBuf) return false;
     size_t textLen = strnlen(text, MAX_MESSAGE_LEN - 1);
+    if (features & PACKET_FLAG_COMPACT) {
+        // Leave room for a route header and the path repeaters add
+        size_t maxLen = MAX_RADIO_PACKET_LEN - ((features & PACKET_FLAG_ROUTED) ? ROUTE_OVERHEAD : 0);
+        return buildCompactPacket(text, textLen, channelId, recipientKey, isChannel,
+                                  (features & PACKET_FLAG_TEXT_CODEC) != 0, maxLen, outBuf, outLen);
+    }
 
     const size_t headerLen = 4 + CHANNEL_ID_SIZE + PUBLIC_KEY_SIZE + PUBLIC_KEY_SIZE; // magic(2)+ver+flags + channel + sender + recipient
-    if (textLen + headerLen > RADIOLIB_SX126X_MAX_PACKET_LENGTH) {
+    if (textLen + headerLen > MAX_RADIO_PACKET_LEN) {
         return false;
     }
 
@@ -648,6 +1069,7 @@ bool MeshCoreProtocol::buildPacket(const char* text,
 bool MeshCoreProtocol::parsePacket(const uint8_t* data,
                      size_t len,
                      Message& outMsg) const {
+    MESHOLA_TRACE_SCOPE(ParsePacket, (uint16_t)len);
     const size_t headerLen = 4 + CHANNEL_ID_SIZE + PUBLIC_KEY_SIZE + PUBLIC_KEY_SIZE;
     if (!data || len < headerLen) {
         return false;
@@ -682,22 +1104,1203 @@ bool MeshCoreProtocol::parsePacket(const uint8_t* data,
     return true;
 }
 
+// ============================================================================
+// State snapshot
+//
+// Contacts (oldest first, so loading rebuilds the eviction order) and
+// channels go to one binary file (storage/StateSnapshot.h). loop() saves
+// once changes have paused for SNAPSHOT_QUIET_MS, or SNAPSHOT_MAX_DELAY_MS
+// after the first unsaved one while they keep coming, and stop() saves
+// whatever is left. Revision counters tell what changed; a steady trickle
+// of adverts costs one write per SNAPSHOT_MAX_DELAY_MS at most. Nothing is
+// written to a path before loadState() has read it, so a protocol that
+// skipped loading can't replace a good snapshot with an empty table.
+// ============================================================================
+
+void MeshCoreProtocol::setStatePath(const char* path) {
+    memset(_statePath, 0, sizeof(_statePath));
+    if (path) {
+        strncpy(_statePath, path, sizeof(_statePath) - 1);
+    }
+    // A file we haven't read is never written over
+    _stateLoaded = false;
+}
+
+bool MeshCoreProtocol::stateUnsaved() const {
+    return _stateFileStale || _contacts.revision() != _savedContactRevision ||
+           _channelRevision != _savedChannelRevision;
+}
+
+void MeshCoreProtocol::markStateSaved() {
+    _savedContactRevision = _seenContactRevision = _contacts.revision();
+    _savedChannelRevision = _seenChannelRevision = _channelRevision;
+    _stateFileStale = false;
+    _stateDirty = false;
+}
+
+bool MeshCoreProtocol::saveState() {
+    if (!_statePath[0] || !_stateLoaded) {
+        return true;
+    }
+    uint32_t now = clock::millis();
+    static const uint8_t NO_KEY[PUBLIC_KEY_SIZE] = {};
+    SnapshotWriter writer;
+    bool ok = writer.open(_statePath);
+    _contacts.forEachOldestFirst([&](const Contact& contact) {
+        // resetProfileState() recreates the broadcast contact
+        if (ok && memcmp(contact.publicKey, NO_KEY, PUBLIC_KEY_SIZE) != 0) {
+            ok = writer.addContact(contact, now);
+        }
+    });
+    for (int i = 0; ok && i < getChannelCount(); i++) {
+        Channel channel;
+        ok = getChannel(i, channel) && writer.addChannel(channel);
+    }
+    ok = ok && writer.commit();
+    if (!ok) {
+        _counters->stateSaveFailures.add();
+        TT_LOG_W(TAG, "Failed to save state to %s", _statePath);
+        // Try again once changes pause, not on every loop
+        _stateDirtySinceMs = now;
+        _stateChangedMs = now;
+        return false;
+    }
+    _counters->stateSaves.add();
+    markStateSaved();
+    return true;
+}
+
+bool MeshCoreProtocol::loadState() {
+    if (!_statePath[0]) {
+        return true;
+    }
+    SnapshotReader reader;
+    _stateLoaded = true;
+    if (!reader.open(_statePath)) {
+        markStateSaved();
+        if (reader.exists()) {
+            // Cold start; the next save replaces the file
+            TT_LOG_W(TAG, "Ignoring unreadable state snapshot %s", _statePath);
+            _counters->stateLoadFailures.add();
+            _stateFileStale = true;
+        }
+        return true;
+    }
+
+    uint32_t now = clock::millis();
+    size_t restored = 0;
+    for (size_t i = 0; i < reader.contactCount(); i++) {
+        Contact contact;
+        reader.contact(i, now, contact);
+        // Adverts heard since start() are newer
+        if (_contacts.find(contact.publicKey)) {
+            continue;
+        }
+        contact.isOnline = false;
+        // Links from before the restart still count as neighbours, but ADR
+        // waits for fresh samples
+        if (contact.linkSamples && (uint32_t)(now - contact.linkUpdatedMs) < ADR_MAX_SAMPLE_AGE_MS) {
+            contact.linkUpdatedMs = now - ADR_MAX_SAMPLE_AGE_MS;
+        }
+        if (_contacts.upsert(contact) != ContactUpsert::Full) {
+            restored++;
+        }
+    }
+    for (size_t i = 0; i < reader.channelCount(); i++) {
+        Channel channel;
+        reader.channel(i, channel);
+        setChannel(channel.index, channel);
+    }
+    markStateSaved();
+    // Loaded after start(): push back the startup advert already armed
+    _warmStart = restored > 0;
+    if (_warmStart) {
+        _advertScheduler.sent(now, countNeighbours());
+    }
+    TT_LOG_I(TAG, "Restored %u contacts from %s", (unsigned)restored, _statePath);
+    return true;
+}
+
+void MeshCoreProtocol::serviceSnapshot() {
+    if (!_statePath[0] || !_stateLoaded) {
+        return;
+    }
+    if (!stateUnsaved()) {
+        return;
+    }
+    uint32_t contacts = _contacts.revision();
+    uint32_t now = clock::millis();
+    if (!_stateDirty) {
+        _stateDirty = true;
+        _stateDirtySinceMs = now;
+        _stateChangedMs = now;
+    }
+    if (contacts != _seenContactRevision || _channelRevision != _seenChannelRevision) {
+        _seenContactRevision = contacts;
+        _seenChannelRevision = _channelRevision;
+        _stateChangedMs = now;
+    }
+    if ((uint32_t)(now - _stateChangedMs) >= SNAPSHOT_QUIET_MS ||
+        (uint32_t)(now - _stateDirtySinceMs) >= SNAPSHOT_MAX_DELAY_MS) {
+        saveState();
+    }
+}
+
+// ============================================================================
+// Compact frames (PACKET_VERSION_COMPACT)
+//
+//   magic(2) version flags | target prefix | sender prefix | varint length | text
+//
+// The target is the channel ID for channel frames and the recipient key for
+// DMs. With PACKET_FLAG_TEXT_CODEC the text is TextCodec output and the
+// length counts encoded bytes. Prefixes are 1-4 bytes (flags bits 4-5).
+// DMs always use 4. Channel frames use the shortest that leaves
+// COMPACT_PREFIXES_PER_NODE values per known contact and is unambiguous in
+// the sender's own table. Receivers resolve them against theirs; a message
+// whose sender they can't pin to a single contact waits (HELD_MESSAGE_SLOTS,
+// HELD_MESSAGE_MS) for an advert from it. Bytes after the text are ignored.
+// ============================================================================
+
+static size_t writeVarint(uint32_t value, uint8_t* out) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static bool readVarint(const uint8_t* data, size_t len, size_t& idx, uint32_t& value) {
+    value = 0;
+    for (uint32_t shift = 0; shift < 21; shift += 7) {
+        if (idx >= len) {
+            return false;
+        }
+        uint8_t byte = data[idx++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MeshCoreProtocol::noteAdvertFlags(uint8_t peerFlags) {
+    uint8_t missing = NEGOTIATED_FLAGS & ~peerFlags;
+    if (!missing) {
+        return;
+    }
+    uint32_t now = clock::millis();
+    if ((uint32_t)(now - _legacyAdvertMs) >= LEGACY_PEER_HOLD_MS) {
+        _legacyFlags = 0;
+    }
+    _legacyFlags |= missing;
+    _legacyAdvertMs = now;
+}
+
+uint8_t MeshCoreProtocol::frameFeatures(const uint8_t recipientKey[PUBLIC_KEY_SIZE]) const {
+    if (recipientKey) {
+        const Contact* known = _contacts.find(recipientKey);
+        return known ? (known->peerFlags & NEGOTIATED_FLAGS) : 0;
+    }
+    // Channel frames reach everyone in range, old nodes included
+    if ((uint32_t)(clock::millis() - _legacyAdvertMs) >= LEGACY_PEER_HOLD_MS) {
+        return NEGOTIATED_FLAGS;
+    }
+    return NEGOTIATED_FLAGS & ~_legacyFlags;
+}
+
+size_t MeshCoreProtocol::compactHashLen(const uint8_t recipientKey[PUBLIC_KEY_SIZE]) const {
+    // DMs carry whole prefixes: a receiver takes a DM whose target matches
+    // its own key, and a short target would match many nodes
+    if (recipientKey) {
+        return PACKET_MAX_HASH_LEN;
+    }
+    // Receivers resolve the sender against their own tables, not ours:
+    // leave room for COMPACT_PREFIXES_PER_NODE prefixes per node we know
+    size_t minLen = 1;
+    while (minLen < PACKET_MAX_HASH_LEN &&
+           (1ull << (8 * minLen)) < (uint64_t)_contacts.size() * COMPACT_PREFIXES_PER_NODE) {
+        minLen++;
+    }
+    // Our own advert may come back through a repeater; don't count it
+    size_t selfEntries = _contacts.find(_selfPublicKey) ? 1 : 0;
+    for (size_t hashLen = minLen; hashLen < PACKET_MAX_HASH_LEN; hashLen++) {
+        if (_contacts.countPrefix(_selfPublicKey, hashLen, selfEntries + 1) <= selfEntries) {
+            return hashLen;
+        }
+    }
+    return PACKET_MAX_HASH_LEN;
+}
+
+bool MeshCoreProtocol::buildCompactPacket(const char* text,
+                     size_t textLen,
+                     const uint8_t channelId[CHANNEL_ID_SIZE],
+                     const uint8_t recipientKey[PUBLIC_KEY_SIZE],
+                     bool isChannel,
+                     bool compress,
+                     size_t maxLen,
+                     uint8_t* outBuf,
+                     size_t& outLen) const {
+    // Only worth a flag when the codec actually shrinks the text
+    uint8_t encoded[MAX_MESSAGE_LEN];
+    size_t encodedLen = compress && textLen > 1 ? compressText(text, textLen, encoded, textLen - 1) : 0;
+    if (encodedLen > 0) {
+        text = reinterpret_cast<const char*>(encoded);
+        textLen = encodedLen;
+    }
+
+    size_t hashLen = compactHashLen(isChannel ? nullptr : recipientKey);
+    uint8_t lengthField[3];
+    size_t lengthLen = writeVarint((uint32_t)textLen, lengthField);
+    size_t headerLen = 4 + hashLen + hashLen + lengthLen;
+    if (textLen + headerLen > maxLen) {
+        return false;
+    }
+
+    size_t idx = 0;
+    outBuf[idx++] = PACKET_MAGIC_0;
+    outBuf[idx++] = PACKET_MAGIC_1;
+    outBuf[idx++] = PACKET_VERSION_COMPACT;
+    uint8_t flags = isChannel ? PACKET_FLAG_CHANNEL : 0;
+    flags |= encodedLen > 0 ? PACKET_FLAG_TEXT_CODEC : 0;
+    flags |= (uint8_t)((hashLen - 1) << PACKET_HASH_SHIFT);
+    outBuf[idx++] = flags;
+
+    const uint8_t* target = isChannel ? channelId : recipientKey;
+    if (target) {
+        memcpy(&outBuf[idx], target, hashLen);
+    } else {
+        memset(&outBuf[idx], 0, hashLen);
+    }
+    idx += hashLen;
+    memcpy(&outBuf[idx], _selfPublicKey, hashLen);  // Zeros until an identity is set
+    idx += hashLen;
+
+    memcpy(&outBuf[idx], lengthField, lengthLen);
+    idx += lengthLen;
+    memcpy(&outBuf[idx], text, textLen);
+    idx += textLen;
+
+    outLen = idx;
+    return true;
+}
+
+bool MeshCoreProtocol::handleCompactFrame(const uint8_t* data, size_t len) {
+    if (len < 4 || data[0] != PACKET_MAGIC_0 || data[1] != PACKET_MAGIC_1 ||
+        data[2] != PACKET_VERSION_COMPACT) {
+        return false;
+    }
+    size_t hashLen = ((data[3] & PACKET_HASH_MASK) >> PACKET_HASH_SHIFT) + 1;
+    if (len >= 4 + hashLen + hashLen && !acceptDirectTarget(data[3], &data[4], &data[4 + hashLen], hashLen)) {
+        return true;
+    }
+    // Never the plain-text fallback: a frame we can't place is dropped
+    Message msg = {};
+    if (parseCompactPacket(data, len, msg)) {
+        _counters->rxMessages.add();
+        deliverCompactMessage(msg, hashLen);
+    }
+    return true;
+}
+
+bool MeshCoreProtocol::acceptDirectTarget(uint8_t flags,
+                     const uint8_t* target,
+                     const uint8_t* sender,
+                     size_t hashLen) {
+    if ((flags & PACKET_FLAG_CHANNEL) ||
+        (_hasSelfKey && memcmp(_selfPublicKey, target, hashLen) == 0)) {
+        return true;
+    }
+    // Someone else's DM (relaying was decided before we got here) is neither
+    // shown nor held; it still tells us the sender's route and link
+    _counters->rxOtherRecipient.add();
+    const Contact* from = _contacts.findByPrefix(sender, hashLen);
+    if (from && _contacts.countPrefix(sender, hashLen, 2) == 1) {
+        uint8_t senderKey[PUBLIC_KEY_SIZE];
+        memcpy(senderKey, from->publicKey, PUBLIC_KEY_SIZE);
+        refreshSender(senderKey);
+    }
+    return false;
+}
+
+void MeshCoreProtocol::deliverCompactMessage(Message& msg, size_t prefixLen) {
+    const Contact* from = _contacts.findByPrefix(msg.senderKey, prefixLen);
+    if (from && _contacts.countPrefix(msg.senderKey, prefixLen, 2) == 1) {
+        memcpy(msg.senderKey, from->publicKey, PUBLIC_KEY_SIZE);
+        snprintf(msg.senderName, sizeof(msg.senderName), "%s", from->name);
+        deliverMessage(msg);
+        return;
+    }
+    // Not filed under a made-up contact: held until the sender's advert
+    // tells us who it is, replacing the oldest when full
+    _counters->rxUnresolvedSenders.add();
+    uint32_t now = clock::millis();
+    HeldMessage* slot = &_heldMessages[0];
+    for (HeldMessage& held : _heldMessages) {
+        if (held.prefixLen == 0) {
+            slot = &held;
+            break;
+        }
+        if ((int32_t)(held.heldMs - slot->heldMs) < 0) {
+            slot = &held;
+        }
+    }
+    slot->message = msg;
+    slot->message.rssi = (int16_t)_radio->getRssi();
+    slot->message.snr = (int8_t)_radio->getSnr();
+    slot->message.status = MessageStatus::Received;
+    slot->heldMs = now;
+    slot->prefixLen = (uint8_t)prefixLen;
+}
+
+void MeshCoreProtocol::releaseHeldMessages(const Contact& sender) {
+    uint32_t now = clock::millis();
+    for (HeldMessage& held : _heldMessages) {
+        if (held.prefixLen == 0) {
+            continue;
+        }
+        if ((uint32_t)(now - held.heldMs) >= HELD_MESSAGE_MS) {
+            held.prefixLen = 0;
+            continue;
+        }
+        if (memcmp(held.message.senderKey, sender.publicKey, held.prefixLen) != 0 ||
+            _contacts.countPrefix(sender.publicKey, held.prefixLen, 2) > 1) {
+            continue;
+        }
+        // Signal and route were recorded when it arrived
+        held.prefixLen = 0;
+        memcpy(held.message.senderKey, sender.publicKey, PUBLIC_KEY_SIZE);
+        snprintf(held.message.senderName, sizeof(held.message.senderName), "%s", sender.name);
+        _counters->rxHeldDelivered.add();
+        if (_messageCallback) {
+            _messageCallback(held.message);
+        }
+    }
+}
+
+bool MeshCoreProtocol::parseCompactPacket(const uint8_t* data,
+                     size_t len,
+                     Message& outMsg) const {
+    uint8_t flags = data[3];
+    size_t hashLen = ((flags & PACKET_HASH_MASK) >> PACKET_HASH_SHIFT) + 1;
+    size_t idx = 4;
+    uint32_t textLen = 0;
+    if ((flags & (PACKET_FLAG_ADVERT | PACKET_FLAG_FRAGMENT)) || len < idx + hashLen + hashLen) {
+        _counters->rxParseFailures.add();
+        return false;
+    }
+    const uint8_t* target = &data[idx];
+    idx += hashLen;
+    const uint8_t* sender = &data[idx];
+    idx += hashLen;
+    if (!readVarint(data, len, idx, textLen) || textLen > len - idx) {
+        _counters->rxParseFailures.add();
+        return false;
+    }
+    return fillCompactMessage(flags, target, sender, hashLen, &data[idx], textLen, outMsg);
+}
+
+bool MeshCoreProtocol::fillCompactMessage(uint8_t flags,
+                     const uint8_t* target,
+                     const uint8_t* sender,
+                     size_t hashLen,
+                     const uint8_t* text,
+                     size_t textLen,
+                     Message& outMsg) const {
+    bool isChannel = (flags & PACKET_FLAG_CHANNEL) != 0;
+    if (!isChannel && hashLen < PACKET_MAX_HASH_LEN) {
+        // Too short to tell whether we are the recipient
+        _counters->rxParseFailures.add();
+        return false;
+    }
+
+    memset(&outMsg, 0, sizeof(outMsg));
+    outMsg.isChannel = isChannel;
+    outMsg.isOutgoing = false;
+    outMsg.timestamp = (uint32_t)time(nullptr);
+    outMsg.type = isChannel ? MessageType::Channel : MessageType::Direct;
+    // Zero-padded prefix; deliverCompactMessage() resolves it
+    memcpy(outMsg.senderKey, sender, hashLen);
+
+    // Callers dropped DMs for other nodes; unresolved channels are passed
+    // on zero-padded
+    if (!isChannel) {
+        memcpy(outMsg.recipientKey, _selfPublicKey, PUBLIC_KEY_SIZE);
+    } else if (memcmp(_defaultChannel.id, target, hashLen) == 0) {
+        memcpy(outMsg.channelId, _defaultChannel.id, CHANNEL_ID_SIZE);
+    } else {
+        memcpy(outMsg.channelId, target, hashLen);
+    }
+
+    if (flags & PACKET_FLAG_TEXT_CODEC) {
+        if (decompressText(text, textLen, outMsg.text, sizeof(outMsg.text)) == SIZE_MAX) {
+            _counters->rxParseFailures.add();
+            return false;
+        }
+    } else {
+        size_t copyLen = std::min(textLen, sizeof(outMsg.text) - 1);
+        memcpy(outMsg.text, text, copyLen);
+        outMsg.text[copyLen] = '\0';
+    }
+    outMsg.status = MessageStatus::Received;
+    return true;
+}
+
+// ============================================================================
+// Fragments (compact frames with PACKET_FLAG_FRAGMENT)
+//
+//   fragment: magic(2) version flags | target prefix | sender prefix |
+//             msgId(2) index count offset(2) | data
+//   NACK:     magic(2) version flags | original sender prefix | requester prefix |
+//             msgId(2) missing(4)
+//
+// A message too long for one compact frame is split into fragments of equal
+// size (the last may be shorter); the rest of each frame is data at the given
+// byte offset. Channel and codec flags apply to the reassembled payload.
+// When a DM to us stalls, we NACK the missing fragment bitmap and the sender
+// retransmits just those from its FragmentHistory. Multi-byte fields are
+// little-endian.
+// ============================================================================
+
+static_assert(MAX_FRAGMENTED_PAYLOAD >= MAX_MESSAGE_LEN, "A message must fit one reassembly slot");
+
+bool MeshCoreProtocol::sendFragmented(const char* text,
+                     size_t textLen,
+                     const uint8_t channelId[CHANNEL_ID_SIZE],
+                     const uint8_t recipientKey[PUBLIC_KEY_SIZE],
+                     bool isChannel,
+                     uint8_t features) {
+    bool routed = (features & PACKET_FLAG_ROUTED) != 0;
+    bool compress = (features & PACKET_FLAG_TEXT_CODEC) != 0;
+    size_t hashLen = compactHashLen(isChannel ? nullptr : recipientKey);
+    size_t maxLen = MAX_RADIO_PACKET_LEN - (routed ? ROUTE_OVERHEAD : 0);
+    size_t fragmentSize = maxLen - (4 + hashLen + hashLen + FRAGMENT_HEADER_LEN);
+
+    // Only worth a flag when the codec actually shrinks the text
+    uint8_t encoded[MAX_MESSAGE_LEN];
+    size_t encodedLen = compress ? compressText(text, textLen, encoded, std::min(textLen - 1, sizeof(encoded)))
+                                 : 0;
+    size_t length = encodedLen > 0 ? encodedLen : textLen;
+    size_t count = (length + fragmentSize - 1) / fragmentSize;
+    // Rejected before taking a history slot, which would push out the
+    // oldest message still waiting for NACKs
+    if (count > MAX_FRAGMENTS || length > MAX_FRAGMENTED_PAYLOAD) {
+        return false;
+    }
+
+    FragmentedMessage& message = _sentFragments.add(clock::millis());
+    static_cast<FragmentHeader&>(message) = FragmentHeader{};
+    message.routed = routed;
+    memcpy(message.payload, encodedLen > 0 ? encoded : (const uint8_t*)text, length);
+    message.length = (uint16_t)length;
+    message.msgId = _nextFragmentId++;
+    message.flags = PACKET_FLAG_FRAGMENT;
+    message.flags |= isChannel ? PACKET_FLAG_CHANNEL : 0;
+    message.flags |= encodedLen > 0 ? PACKET_FLAG_TEXT_CODEC : 0;
+    message.flags |= (uint8_t)((hashLen - 1) << PACKET_HASH_SHIFT);
+    message.prefixLen = (uint8_t)hashLen;
+    const uint8_t* target = isChannel ? channelId : recipientKey;
+    if (target) {
+        memcpy(message.target, target, hashLen);
+    }
+    memcpy(message.sender, _selfPublicKey, hashLen);
+    message.fragmentSize = (uint16_t)fragmentSize;
+    message.count = (uint8_t)count;
+
+    bool ok = true;
+    for (uint8_t index = 0; index < message.count; index++) {
+        ok = transmitFragment(message, index) && ok;
+    }
+    return ok;
+}
+
+bool MeshCoreProtocol::transmitFragment(const FragmentedMessage& message, uint8_t index) {
+    size_t hashLen = message.prefixLen;
+    size_t offset = (size_t)index * message.fragmentSize;
+    size_t dataLen = std::min((size_t)message.fragmentSize, message.length - offset);
+
+    uint8_t frame[MAX_RADIO_PACKET_LEN];
+    size_t idx = 0;
+    frame[idx++] = PACKET_MAGIC_0;
+    frame[idx++] = PACKET_MAGIC_1;
+    frame[idx++] = PACKET_VERSION_COMPACT;
+    frame[idx++] = message.flags;
+    memcpy(&frame[idx], message.target, hashLen);
+    idx += hashLen;
+    memcpy(&frame[idx], message.sender, hashLen);
+    idx += hashLen;
+    frame[idx++] = (uint8_t)message.msgId;
+    frame[idx++] = (uint8_t)(message.msgId >> 8);
+    frame[idx++] = index;
+    frame[idx++] = message.count;
+    frame[idx++] = (uint8_t)offset;
+    frame[idx++] = (uint8_t)(offset >> 8);
+    memcpy(&frame[idx], &message.payload[offset], dataLen);
+    idx += dataLen;
+
+    bool ok;
+    if (message.routed) {
+        bool isChannel = (message.flags & PACKET_FLAG_CHANNEL) != 0;
+        ok = transmitRouted(frame, idx, isChannel ? nullptr : _contacts.findByPrefix(message.target, hashLen));
+    } else {
+        ok = transmitFrame(frame, idx);
+    }
+    if (ok) {
+        _counters->txFragments.add();
+    }
+    return ok;
+}
+
+bool MeshCoreProtocol::handleFragmentFrame(const uint8_t* data, size_t len) {
+    if (len < 4 || data[0] != PACKET_MAGIC_0 || data[1] != PACKET_MAGIC_1 ||
+        data[2] != PACKET_VERSION_COMPACT || !(data[3] & PACKET_FLAG_FRAGMENT)) {
+        return false;
+    }
+    uint8_t flags = data[3];
+    if (flags & PACKET_FLAG_NACK) {
+        handleFragmentNack(data, len);
+        return true;
+    }
+
+    size_t hashLen = ((flags & PACKET_HASH_MASK) >> PACKET_HASH_SHIFT) + 1;
+    size_t idx = 4;
+    if (len < idx + hashLen + hashLen + FRAGMENT_HEADER_LEN) {
+        _counters->rxParseFailures.add();
+        return true;
+    }
+    FragmentHeader header;
+    header.flags = flags;
+    header.prefixLen = (uint8_t)hashLen;
+    memcpy(header.target, &data[idx], hashLen);
+    idx += hashLen;
+    memcpy(header.sender, &data[idx], hashLen);
+    idx += hashLen;
+    header.msgId = (uint16_t)(data[idx] | (data[idx + 1] << 8));
+    idx += 2;
+    uint8_t index = data[idx++];
+    header.count = data[idx++];
+    uint16_t offset = (uint16_t)(data[idx] | (data[idx + 1] << 8));
+    idx += 2;
+
+    // Only the recipient of a DM reassembles it and asks for missing pieces
+    if (!acceptDirectTarget(flags, header.target, header.sender, hashLen)) {
+        return true;
+    }
+    bool forUs = !(flags & PACKET_FLAG_CHANNEL);
+    switch (_reassembly.add(header, index, offset, &data[idx], len - idx, forUs, clock::millis())) {
+        case ReassemblyPool::Result::Rejected:
+            _counters->rxParseFailures.add();
+            break;
+        case ReassemblyPool::Result::Duplicate:
+            break;
+        case ReassemblyPool::Result::Pending:
+            _counters->rxFragments.add();
+            break;
+        case ReassemblyPool::Result::Complete: {
+            _counters->rxFragments.add();
+            const FragmentedMessage& complete = _reassembly.complete();
+            Message msg = {};
+            if (fillCompactMessage(complete.flags, complete.target, complete.sender, complete.prefixLen,
+                                   complete.payload, complete.length, msg)) {
+                _counters->rxMessages.add();
+                deliverCompactMessage(msg, complete.prefixLen);
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+void MeshCoreProtocol::handleFragmentNack(const uint8_t* data, size_t len) {
+    size_t hashLen = ((data[3] & PACKET_HASH_MASK) >> PACKET_HASH_SHIFT) + 1;
+    size_t idx = 4;
+    if (len < idx + hashLen + hashLen + 6) {
+        _counters->rxParseFailures.add();
+        return;
+    }
+    const uint8_t* target = &data[idx];
+    idx += hashLen;
+    const uint8_t* requester = &data[idx];
+    idx += hashLen;
+    uint16_t msgId = (uint16_t)(data[idx] | (data[idx + 1] << 8));
+    idx += 2;
+    uint32_t missing = (uint32_t)data[idx] | ((uint32_t)data[idx + 1] << 8) |
+                       ((uint32_t)data[idx + 2] << 16) | ((uint32_t)data[idx + 3] << 24);
+
+    if (!_hasSelfKey || memcmp(_selfPublicKey, target, hashLen) != 0) {
+        return;
+    }
+    const FragmentedMessage* message = _sentFragments.takeForRetransmit(msgId, requester, hashLen, clock::millis());
+    if (!message || (message->flags & PACKET_FLAG_CHANNEL)) {
+        return;
+    }
+    for (uint8_t index = 0; index < message->count; index++) {
+        if ((missing & (1u << index)) && transmitFragment(*message, index)) {
+            _counters->fragmentRetransmits.add();
+        }
+    }
+}
+
+void MeshCoreProtocol::sendFragmentNack(const FragmentHeader& header, uint32_t missing) {
+    size_t hashLen = header.prefixLen;
+    uint8_t frame[4 + PACKET_MAX_HASH_LEN + PACKET_MAX_HASH_LEN + 6];
+    size_t idx = 0;
+    frame[idx++] = PACKET_MAGIC_0;
+    frame[idx++] = PACKET_MAGIC_1;
+    frame[idx++] = PACKET_VERSION_COMPACT;
+    frame[idx++] = PACKET_FLAG_FRAGMENT | PACKET_FLAG_NACK | (header.flags & PACKET_HASH_MASK);
+    memcpy(&frame[idx], header.sender, hashLen);
+    idx += hashLen;
+    memcpy(&frame[idx], _selfPublicKey, hashLen);
+    idx += hashLen;
+    frame[idx++] = (uint8_t)header.msgId;
+    frame[idx++] = (uint8_t)(header.msgId >> 8);
+    for (size_t shift = 0; shift < 32; shift += 8) {
+        frame[idx++] = (uint8_t)(missing >> shift);
+    }
+    const Contact* sender = _contacts.findByPrefix(header.sender, hashLen);
+    bool ok = sender && (sender->peerFlags & PACKET_FLAG_ROUTED) ? transmitRouted(frame, idx, sender)
+                                                                : transmitFrame(frame, idx);
+    if (ok) {
+        _counters->fragmentNacks.add();
+    }
+}
+
+void MeshCoreProtocol::serviceFragments() {
+    _reassembly.tick(clock::millis(), [this](const FragmentedMessage& message, uint32_t missing) {
+        sendFragmentNack(message, missing);
+    });
+    uint32_t lost = _reassembly.lost();
+    if (lost != _reportedReassemblyLosses) {
+        _counters->reassemblyTimeouts.add(lost - _reportedReassemblyLosses);
+        _reportedReassemblyLosses = lost;
+    }
+}
+
+// ============================================================================
+// Routed frames (PACKET_VERSION_ROUTED)
+//
+//   magic(2) version route tag pathLen | path | inner frame from its version byte
+//
+// Wraps any other frame. The originator picks the tag (a per-send counter);
+// tag and inner frame never change hop to hop and hash to the packet ID the
+// seen-cache keys on. route is either a flood with ROUTE_HOPS_MASK hops left,
+// where each repeater appends its hash (first key byte) to the path, or
+// ROUTE_DIRECT, where the path lists the repeaters still to go and each
+// forwarder removes itself from the front. A flooded frame tells the
+// receiver the route back to its originator; DMs to a contact with a learned
+// route go direct instead of flooding.
+// ============================================================================
+
+bool MeshCoreProtocol::transmitRouted(const uint8_t* frame, size_t len, const Contact* recipient) {
+    bool direct = recipient && recipient->hasPath && recipient->pathLength >= 1;
+    size_t pathLen = direct ? std::min<size_t>(recipient->pathLength - 1, MAX_PATH_LEN) : 0;
+    if (len < 4 || ROUTE_HEADER_LEN + pathLen + len - 2 > MAX_RADIO_PACKET_LEN) {
+        return false;
+    }
+
+    uint8_t routed[MAX_RADIO_PACKET_LEN];
+    size_t idx = 0;
+    routed[idx++] = PACKET_MAGIC_0;
+    routed[idx++] = PACKET_MAGIC_1;
+    routed[idx++] = PACKET_VERSION_ROUTED;
+    routed[idx++] = direct ? ROUTE_DIRECT : FLOOD_HOPS;
+    uint8_t tag = _nextRouteTag++;
+    routed[idx++] = tag;
+    routed[idx++] = (uint8_t)pathLen;
+    if (pathLen) {
+        memcpy(&routed[idx], recipient->path, pathLen);
+        idx += pathLen;
+    }
+    memcpy(&routed[idx], &frame[2], len - 2);
+    idx += len - 2;
+
+    // Ignore our own frame when repeaters send it back
+    _seen.insert(routedPacketId(tag, &frame[2], len - 2), clock::millis());
+    if (direct) {
+        _counters->txDirectRouted.add();
+    }
+    return transmitFrame(routed, idx);
+}
+
+bool MeshCoreProtocol::acceptRoutedFrame(uint8_t* frame, size_t& len) {
+    if (len < ROUTE_HEADER_LEN || frame[0] != PACKET_MAGIC_0 || frame[1] != PACKET_MAGIC_1) {
+        _counters->rxParseFailures.add();
+        return false;
+    }
+    uint8_t route = frame[3];
+    uint8_t tag = frame[4];
+    size_t pathLen = frame[5];
+    if (pathLen > MAX_PATH_LEN || len < ROUTE_HEADER_LEN + pathLen + 2) {
+        _counters->rxParseFailures.add();
+        return false;
+    }
+    const uint8_t* inner = &frame[ROUTE_HEADER_LEN + pathLen];
+    size_t innerLen = len - ROUTE_HEADER_LEN - pathLen;
+
+    uint32_t packetId = routedPacketId(tag, inner, innerLen);
+    uint32_t now = clock::millis();
+    if (!_seen.insert(packetId, now)) {
+        _counters->routeDuplicates.add();
+        if (_forwards.heard(packetId)) {
+            _counters->forwardsCancelled.add();
+        }
+        return false;
+    }
+    if (_repeater && _hasSelfKey) {
+        forwardRoutedFrame(frame, len, packetId, now);
+    }
+
+    _rxRoute.relayed = pathLen > 0;
+    _rxRoute.sourceRouted = (route & ROUTE_DIRECT) != 0;
+
+    // Remember how a flood reached us: reversed, it is the way back
+    if (!(route & ROUTE_DIRECT)) {
+        _rxRoute.valid = true;
+        _rxRoute.length = (uint8_t)pathLen;
+        memcpy(_rxRoute.path, &frame[ROUTE_HEADER_LEN], pathLen);
+    }
+
+    // Unwrap in place: magic + inner frame
+    memmove(&frame[2], inner, innerLen);
+    len = 2 + innerLen;
+    return true;
+}
+
+void MeshCoreProtocol::forwardRoutedFrame(const uint8_t* frame, size_t len, uint32_t packetId, uint32_t nowMs) {
+    uint8_t route = frame[3];
+    size_t pathLen = frame[5];
+    const uint8_t* path = &frame[ROUTE_HEADER_LEN];
+    const uint8_t* rest = &frame[ROUTE_HEADER_LEN + pathLen];
+    size_t restLen = len - ROUTE_HEADER_LEN - pathLen;
+    uint32_t airtimeMs = _radio->getTimeOnAirUs(len) / 1000;
+
+    uint8_t out[MAX_RADIO_PACKET_LEN];
+    memcpy(out, frame, ROUTE_HEADER_LEN);
+    size_t idx = ROUTE_HEADER_LEN;
+    uint32_t delayMs;
+    if (route & ROUTE_DIRECT) {
+        // Only the next hop named in the path forwards, minus itself
+        if (pathLen == 0 || path[0] != _selfPublicKey[0]) {
+            return;
+        }
+        out[5] = (uint8_t)(pathLen - 1);
+        memcpy(&out[idx], &path[1], pathLen - 1);
+        idx += pathLen - 1;
+        delayMs = _forwards.directDelayMs(airtimeMs);
+    } else {
+        uint8_t hops = route & ROUTE_HOPS_MASK;
+        if (hops == 0 || pathLen >= MAX_PATH_LEN || len >= MAX_RADIO_PACKET_LEN) {
+            return;
+        }
+        out[3] = (uint8_t)(hops - 1);
+        out[5] = (uint8_t)(pathLen + 1);
+        memcpy(&out[idx], path, pathLen);
+        idx += pathLen;
+        out[idx++] = _selfPublicKey[0];
+        delayMs = _forwards.floodDelayMs(_radio->getSnr(), airtimeMs);
+    }
+    memcpy(&out[idx], rest, restLen);
+    idx += restLen;
+
+    if (!_forwards.schedule(packetId, out, idx, nowMs, delayMs)) {
+        _counters->forwardDrops.add();
+    }
+}
+
+void MeshCoreProtocol::applyRoute(Contact& contact, const RxRoute& route) const {
+    if (!route.valid) {
+        return;
+    }
+    contact.hasPath = true;
+    contact.pathLength = (uint8_t)(route.length + 1);
+    memset(contact.path, 0, sizeof(contact.path));
+    for (size_t i = 0; i < route.length; i++) {
+        contact.path[i] = route.path[route.length - 1 - i];
+    }
+}
+
+void MeshCoreProtocol::learnRoute(const uint8_t senderKey[PUBLIC_KEY_SIZE]) {
+    if (!_rxRoute.valid) {
+        return;
+    }
+    const Contact* known = _contacts.find(senderKey);
+    if (!known) {
+        return;
+    }
+    Contact updated = *known;
+    applyRoute(updated, _rxRoute);
+    if (known->hasPath && known->pathLength == updated.pathLength &&
+        memcmp(known->path, updated.path, sizeof(updated.path)) == 0) {
+        return;
+    }
+    _contacts.upsert(updated);
+}
+
+void MeshCoreProtocol::serviceForwards() {
+    _forwards.tick(clock::millis(), [this](const uint8_t* frame, size_t len) {
+        if (transmitFrame(frame, len)) {
+            _counters->forwarded.add();
+        }
+    });
+}
+
+// ============================================================================
+// Advert signatures (PACKET_FLAG_SIGNED)
+//
+// A node with a private key matching its public key appends an Ed25519
+// signature over the whole advert (routing wrapper excluded: repeaters
+// rewrite it). Adverts arrive in bursts, when a node boots or a repeater
+// floods, and a batch check costs about half as much per signature as
+// checking them one by one. So signed adverts wait up to
+// ADVERT_BATCH_HOLD_MS (or until ADVERT_BATCH_MAX have arrived) with the
+// route and link readings of their own frame, then are checked together and
+// merged like unsigned ones. Once a contact has sent a signed advert, its
+// unsigned adverts are dropped.
+// ============================================================================
+
+void MeshCoreProtocol::acceptAdvert(Contact& discovered, const RxRoute& route, float rssi, float snr) {
+    discovered.lastRssi = (int16_t)rssi;
+    discovered.lastSnr = (int8_t)snr;
+    discovered.lastSeen = (uint32_t)time(nullptr);
+    discovered.isOnline = true;
+    discovered.isDiscovered = true;
+    noteAdvertFlags(discovered.peerFlags);
+    // Merge into contacts, keeping user flags of a known contact and its
+    // route unless this advert was flooded to us
+    const Contact* known = _contacts.find(discovered.publicKey);
+    if (known) {
+        discovered.isFavorite = known->isFavorite;
+        discovered.isDiscovered = known->isDiscovered;
+        discovered.hasPath = known->hasPath;
+        discovered.pathLength = known->pathLength;
+        memcpy(discovered.path, known->path, sizeof(discovered.path));
+        discovered.linkRssi = known->linkRssi;
+        discovered.linkSnr = known->linkSnr;
+        discovered.linkSamples = known->linkSamples;
+        discovered.linkUpdatedMs = known->linkUpdatedMs;
+    }
+    applyRoute(discovered, route);
+    sampleLink(discovered, route, rssi, snr);
+    ContactUpsert result = _contacts.upsert(discovered);
+    if (result == ContactUpsert::Evicted) {
+        _counters->contactEvictions.add();
+    }
+    if (result == ContactUpsert::Full) {
+        _counters->contactDrops.add();
+        return;
+    }
+    if (_contactCallback) {
+        _contactCallback(discovered, result != ContactUpsert::Updated);
+    }
+    releaseHeldMessages(discovered);
+}
+
+void MeshCoreProtocol::queueSignedAdvert(const Contact& contact, const uint8_t* frame, size_t len) {
+    // A repeat from the same node replaces the one waiting
+    PendingAdvert* slot = nullptr;
+    for (size_t i = 0; i < _pendingAdvertCount; i++) {
+        if (memcmp(_pendingAdverts[i].contact.publicKey, contact.publicKey, PUBLIC_KEY_SIZE) == 0) {
+            slot = &_pendingAdverts[i];
+            break;
+        }
+    }
+    if (!slot) {
+        if (_pendingAdvertCount == 0) {
+            _pendingAdvertsSinceMs = clock::millis();
+        }
+        slot = &_pendingAdverts[_pendingAdvertCount++];
+    }
+    slot->contact = contact;
+    slot->route = _rxRoute;
+    slot->rssi = _radio->getRssi();
+    slot->snr = _radio->getSnr();
+    slot->len = (uint8_t)len;
+    memcpy(slot->frame, frame, len);
+    if (_pendingAdvertCount == ADVERT_BATCH_MAX) {
+        verifyPendingAdverts();
+    }
+}
+
+void MeshCoreProtocol::verifyPendingAdverts() {
+    size_t count = _pendingAdvertCount;
+    _pendingAdvertCount = 0;
+    crypto::Ed25519Item items[ADVERT_BATCH_MAX] = {};
+    bool valid[ADVERT_BATCH_MAX] = {};
+    for (size_t i = 0; i < count; i++) {
+        const PendingAdvert& pending = _pendingAdverts[i];
+        size_t signedLen = pending.len - ADVERT_SIGNATURE_LEN;
+        items[i] = crypto::Ed25519Item{
+            .publicKey = pending.contact.publicKey,
+            .message = pending.frame,
+            .length = signedLen,
+            .signature = &pending.frame[signedLen]
+        };
+    }
+    {
+        MESHOLA_TRACE_SCOPE(VerifyAdverts, (uint16_t)count);
+        crypto::ed25519VerifyEach(items, count, valid);
+    }
+    if (count > 1) {
+        _counters->verifyBatches.add();
+    }
+    for (size_t i = 0; i < count; i++) {
+        PendingAdvert& pending = _pendingAdverts[i];
+        if (!valid[i]) {
+            _counters->advertSigFailures.add();
+            TT_LOG_W(TAG, "Dropped advert with a bad signature");
+            continue;
+        }
+        _counters->advertsSigned.add();
+        acceptAdvert(pending.contact, pending.route, pending.rssi, pending.snr);
+    }
+}
+
+void MeshCoreProtocol::serviceAdverts() {
+    if (_pendingAdvertCount != 0 &&
+        (uint32_t)(clock::millis() - _pendingAdvertsSinceMs) >= ADVERT_BATCH_HOLD_MS) {
+        verifyPendingAdverts();
+    }
+}
+
+// ============================================================================
+// Scheduled adverts (PACKET_VERSION_ADVERT)
+//
+//   magic(2) version flags role key(32) nameLen name [TX power] [signature]
+//
+// AdvertScheduler decides when; neighbours are contacts heard directly
+// (not relayed) within NEIGHBOUR_MAX_AGE_MS. The compact layout replaces
+// the full advert's zero-padded 32-byte name with a length byte and the
+// name itself: 19 bytes less for a default "Meshola-XXXX" name. It is sent only
+// while every advert heard in the last LEGACY_PEER_HOLD_MS announced
+// PACKET_FLAG_COMPACT_ADVERT; older nodes would take it for a message.
+// ============================================================================
+
+size_t MeshCoreProtocol::countNeighbours() const {
+    uint32_t now = clock::millis();
+    size_t count = 0;
+    for (const Contact& contact : _contacts) {
+        if (contact.linkSamples != 0 && (uint32_t)(now - contact.linkUpdatedMs) < NEIGHBOUR_MAX_AGE_MS &&
+            memcmp(contact.publicKey, _selfPublicKey, PUBLIC_KEY_SIZE) != 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool MeshCoreProtocol::transmitAdvert() {
+    uint8_t payload[MAX_RADIO_PACKET_LEN] = {0};
+    size_t payloadLen = 0;
+    uint8_t features = frameFeatures(nullptr);
+    uint8_t roleByte = static_cast<uint8_t>(_repeater ? NodeRole::Repeater : NodeRole::Companion);
+    if (!buildAdvert(roleByte, _selfPublicKey, _selfName[0] ? _selfName : _nodeName,
+                     (features & PACKET_FLAG_COMPACT_ADVERT) != 0, payload, payloadLen)) {
+        return false;
+    }
+    // Flooded so contacts beyond one hop learn us and a route back
+    bool ok = (features & PACKET_FLAG_ROUTED) ? transmitRouted(payload, payloadLen, nullptr)
+                                              : transmitFrame(payload, payloadLen);
+    if (ok) {
+        _counters->txAdverts.add();
+    }
+    return ok;
+}
+
+void MeshCoreProtocol::serviceAdvertSchedule() {
+    uint32_t now = clock::millis();
+    if (!_advertScheduler.due(now)) {
+        return;
+    }
+    size_t neighbours = countNeighbours();
+    if (!_advertScheduler.fire(now, neighbours)) {
+        _counters->advertsSuppressed.add();
+        return;
+    }
+    if (transmitAdvert()) {
+        _advertScheduler.sent(now, neighbours);
+    }
+}
+
+// ============================================================================
+// Adaptive data rate (PACKET_VERSION_RATE)
+//
+//   magic(2) version sf windowMs(2) target(4)
+//
+// A radio only hears the spreading factor it is tuned to, so a DM sent
+// faster than the profile SF is announced first: this rate switch goes out
+// at the profile SF and tells the recipient (key prefix) to listen at sf
+// for windowMs. The DM's frames follow without CAD, the first with
+// ADR_LEAD_IN_MS of extra preamble while the recipient retunes. Only
+// contacts that advertise PACKET_FLAG_RATE_SWITCH and were heard directly
+// and recently qualify, and only if the switch plus the fast frames take
+// less airtime than the same frames at the profile SF. Channel messages,
+// adverts and relayed traffic always use the profile SF.
+// ============================================================================
+
+bool MeshCoreProtocol::sampleLink(Contact& contact, const RxRoute& route, float rssi, float snr) const {
+    // A relayed frame measures the last repeater's link, not the sender's.
+    // A source-routed frame arrives with an empty path either way; routes
+    // are symmetric, so it came straight only if ours has no repeaters.
+    if (route.relayed || (route.sourceRouted && !(contact.hasPath && contact.pathLength == 1))) {
+        return false;
+    }
+    updateLinkQuality(contact, rssi, snr, clock::millis());
+    return true;
+}
+
+uint8_t MeshCoreProtocol::adrSpreadingFactor(const uint8_t recipientKey[PUBLIC_KEY_SIZE]) const {
+    if (!adrAvailable()) {
+        return 0;
+    }
+    const Contact* contact = _contacts.find(recipientKey);
+    if (!contact || !(contact->peerFlags & PACKET_FLAG_RATE_SWITCH) || !hasFreshLink(*contact, clock::millis()) ||
+        (contact->hasPath && contact->pathLength > 1)) {
+        return 0;
+    }
+    // The link is reciprocal apart from the two ends' TX power
+    float snrAtPeer = contact->linkSnr + (float)(_config.txPower - contact->peerTxPower);
+    uint8_t sf = chooseSpreadingFactor(snrAtPeer, _config.spreadingFactor);
+    return sf < _config.spreadingFactor ? sf : 0;
+}
+
+RadioConfig MeshCoreProtocol::fastConfig(uint8_t spreadingFactor, bool leadIn) const {
+    RadioConfig config = _config;
+    config.spreadingFactor = spreadingFactor;
+    if (leadIn) {
+        uint32_t symbolUs = loraSymbolTimeUs(config);
+        uint32_t extra = symbolUs ? (ADR_LEAD_IN_MS * 1000 + symbolUs - 1) / symbolUs : 0;
+        config.preambleLength = (uint16_t)std::min<uint32_t>(effectivePreambleLength(_config) + extra, UINT16_MAX);
+    }
+    return config;
+}
+
+bool MeshCoreProtocol::rateWindowOpen(const QueuedTx& tx) const {
+    if (tx.spreadingFactor == 0 || tx.spreadingFactor != _rateTxSf ||
+        memcmp(tx.rateTarget, _rateTxTarget, RATE_PREFIX_LEN) != 0) {
+        return false;
+    }
+    // The frame must end before the recipient returns to the profile SF
+    uint32_t endMs = clock::millis() + loraTimeOnAirUs(fastConfig(tx.spreadingFactor, _rateTxLeadIn), tx.len) / 1000;
+    return (int32_t)(_rateTxUntilMs - endMs) > 0;
+}
+
+bool MeshCoreProtocol::startRateSwitch() {
+    const QueuedTx& front = _txQueue[_txHead];
+    const uint8_t sf = front.spreadingFactor;
+
+    // The run: queued frames for the same recipient at the same rate
+    size_t run = 0;
+    uint64_t profileUs = 0;
+    uint64_t fastUs = 0;
+    for (; run < _txCount; run++) {
+        const QueuedTx& tx = _txQueue[(_txHead + run) % TX_QUEUE_DEPTH];
+        if (tx.spreadingFactor != sf || memcmp(tx.rateTarget, front.rateTarget, RATE_PREFIX_LEN) != 0) {
+            break;
+        }
+        profileUs += loraTimeOnAirUs(_config, tx.len);
+        fastUs += loraTimeOnAirUs(fastConfig(sf, run == 0), tx.len) + ADR_FRAME_GAP_MS * 1000;
+    }
+    uint32_t windowMs = (uint32_t)(fastUs / 1000) + ADR_WINDOW_GUARD_MS;
+
+    uint8_t frame[RATE_SWITCH_LEN];
+    frame[0] = PACKET_MAGIC_0;
+    frame[1] = PACKET_MAGIC_1;
+    frame[2] = PACKET_VERSION_RATE;
+    frame[3] = sf;
+    frame[4] = (uint8_t)(windowMs & 0xFF);
+    frame[5] = (uint8_t)(windowMs >> 8);
+    memcpy(&frame[6], front.rateTarget, RATE_PREFIX_LEN);
+
+    bool ok = windowMs <= ADR_MAX_WINDOW_MS && loraTimeOnAirUs(_config, RATE_SWITCH_LEN) + fastUs < profileUs &&
+              claimAirtime(_config, RATE_SWITCH_LEN) && tuneRadio(_config);
+    if (ok) {
+        MESHOLA_TRACE_SCOPE(Transmit, (uint16_t)RATE_SWITCH_LEN);
+        ok = _radio->startTransmit(frame, RATE_SWITCH_LEN);
+    }
+    if (!ok) {
+        // Not worth it (short frames) or not possible: the run goes at the profile SF
+        for (size_t i = 0; i < run; i++) {
+            _txQueue[(_txHead + i) % TX_QUEUE_DEPTH].spreadingFactor = 0;
+        }
+        return false;
+    }
+    _counters->adrSwitches.add();
+    _txRateSwitch = true;
+    _rateTxWindowMs = windowMs;
+    _rateTxSf = sf;
+    memcpy(_rateTxTarget, front.rateTarget, RATE_PREFIX_LEN);
+    _rateTxUntilMs = clock::millis();       // Opens on TxDone
+    _txState = TxState::OnAir;
+    _rxListening = false;
+    _txDeadlineMs = clock::millis() + _radio->getTimeOnAirUs(RATE_SWITCH_LEN) / 1000 + TX_DONE_TIMEOUT_MS;
+    return true;
+}
+
+void MeshCoreProtocol::finishRateSwitch() {
+    countTx(true, RATE_SWITCH_LEN);
+    _txRateSwitch = false;
+    // From our TxDone: the recipient opens its window a little later
+    _rateTxUntilMs = clock::millis() + _rateTxWindowMs;
+    _rateTxLeadIn = true;
+    _txState = TxState::Idle;
+}
+
+bool MeshCoreProtocol::handleRateSwitch(const uint8_t* data, size_t len) {
+    if (len < RATE_SWITCH_LEN || data[0] != PACKET_MAGIC_0 || data[1] != PACKET_MAGIC_1 ||
+        data[2] != PACKET_VERSION_RATE) {
+        return false;
+    }
+    uint8_t sf = data[3];
+    uint32_t windowMs = (uint32_t)data[4] | ((uint32_t)data[5] << 8);
+    if (!_hasSelfKey || memcmp(&data[6], _selfPublicKey, RATE_PREFIX_LEN) != 0) {
+        return true;                        // For another node
+    }
+    if (!adrAvailable() || sf < ADR_MIN_SPREADING_FACTOR || sf >= _config.spreadingFactor) {
+        return true;
+    }
+    _rateRxSf = sf;
+    _rateRxUntilMs = clock::millis() + std::min(windowMs, ADR_MAX_WINDOW_MS);
+    _counters->adrWindows.add();
+    _rxListening = startListening();
+    return true;
+}
+
+void MeshCoreProtocol::serviceRateWindow() {
+    if (_rateRxSf == 0 || (int32_t)(clock::millis() - _rateRxUntilMs) < 0) {
+        return;
+    }
+    _rateRxSf = 0;
+    // Back to the profile SF, unless a scan or frame on air holds the radio
+    _rxListening = startListening();
+}
+
 bool MeshCoreProtocol::buildAdvert(uint8_t role,
                      const uint8_t senderKey[PUBLIC_KEY_SIZE],
                      const char* senderName,
+                     bool compact,
                      uint8_t* outBuf,
                      size_t& outLen) const {
     if (!outBuf) return false;
-    const size_t nameLen = MAX_NODE_NAME_LEN;
-    const size_t totalLen = 4 + 1 + PUBLIC_KEY_SIZE + nameLen; // magic+ver+flags + role + key + name
-    if (totalLen > RADIOLIB_SX126X_MAX_PACKET_LENGTH) {
+    size_t nameLen = MAX_NODE_NAME_LEN;
+    if (compact) {
+        nameLen = senderName ? strnlen(senderName, MAX_NODE_NAME_LEN - 1) : 0;
+    }
+    const bool rateSwitch = adrAvailable();
+    const bool sign = canSign() && senderKey && memcmp(senderKey, _selfPublicKey, PUBLIC_KEY_SIZE) == 0;
+    // magic+ver+flags + role + key + [name length] name [+ TX power] [+ signature]
+    const size_t totalLen = 4 + 1 + PUBLIC_KEY_SIZE + (compact ? 1 : 0) + nameLen + (rateSwitch ? 1 : 0) +
+                            (sign ? ADVERT_SIGNATURE_LEN : 0);
+    if (totalLen > MAX_RADIO_PACKET_LEN) {
         return false;
     }
     size_t idx = 0;
     outBuf[idx++] = PACKET_MAGIC_0;
     outBuf[idx++] = PACKET_MAGIC_1;
-    outBuf[idx++] = PACKET_VERSION;
-    outBuf[idx++] = PACKET_FLAG_ADVERT;
+    outBuf[idx++] = compact ? PACKET_VERSION_ADVERT : PACKET_VERSION;
+    outBuf[idx++] = PACKET_FLAG_ADVERT | NEGOTIATED_FLAGS | (rateSwitch ? PACKET_FLAG_RATE_SWITCH : 0) |
+                    (sign ? PACKET_FLAG_SIGNED : 0);
     outBuf[idx++] = role;
     if (senderKey) {
         memcpy(&outBuf[idx], senderKey, PUBLIC_KEY_SIZE);
@@ -705,12 +2308,28 @@ bool MeshCoreProtocol::buildAdvert(uint8_t role,
         memset(&outBuf[idx], 0, PUBLIC_KEY_SIZE);
     }
     idx += PUBLIC_KEY_SIZE;
-    // fixed-size name field, padded with zeros
-    memset(&outBuf[idx], 0, nameLen);
-    if (senderName) {
-        strncpy(reinterpret_cast<char*>(&outBuf[idx]), senderName, nameLen - 1);
+    if (compact) {
+        outBuf[idx++] = (uint8_t)nameLen;
+        if (nameLen) {
+            memcpy(&outBuf[idx], senderName, nameLen);
+        }
+    } else {
+        // fixed-size name field, padded with zeros
+        memset(&outBuf[idx], 0, nameLen);
+        if (senderName) {
+            strncpy(reinterpret_cast<char*>(&outBuf[idx]), senderName, nameLen - 1);
+        }
     }
     idx += nameLen;
+    // Extension fields follow the name; parsers that predate them stop short
+    if (rateSwitch) {
+        outBuf[idx++] = (uint8_t)_config.txPower;
+    }
+    // The signature comes last and covers everything before it
+    if (sign) {
+        crypto::ed25519Sign(_signingSeed, _selfPublicKey, outBuf, idx, &outBuf[idx]);
+        idx += ADVERT_SIGNATURE_LEN;
+    }
     outLen = idx;
     return true;
 }
@@ -718,18 +2337,38 @@ bool MeshCoreProtocol::buildAdvert(uint8_t role,
 bool MeshCoreProtocol::parseAdvert(const uint8_t* data,
                      size_t len,
                      Contact& outContact) const {
-    const size_t nameLen = MAX_NODE_NAME_LEN;
-    const size_t minLen = 4 + 1 + PUBLIC_KEY_SIZE + nameLen;
-    if (!data || len < minLen) {
+    MESHOLA_TRACE_SCOPE(ParseAdvert, (uint16_t)len);
+    if (!data || len < 4 || data[0] != PACKET_MAGIC_0 || data[1] != PACKET_MAGIC_1) {
         return false;
     }
-    if (data[0] != PACKET_MAGIC_0 || data[1] != PACKET_MAGIC_1 || data[2] != PACKET_VERSION) {
+    const bool compact = data[2] == PACKET_VERSION_ADVERT;
+    if (!compact && data[2] != PACKET_VERSION) {
+        return false;
+    }
+    const size_t nameOffset = 5 + PUBLIC_KEY_SIZE + (compact ? 1 : 0);
+    const size_t minLen = compact ? nameOffset : nameOffset + MAX_NODE_NAME_LEN;
+    if (len < minLen) {
         return false;
     }
     uint8_t flags = data[3];
     if (!(flags & PACKET_FLAG_ADVERT)) {
         return false;
     }
+    // Extension fields end where the signature starts
+    if (flags & PACKET_FLAG_SIGNED) {
+        if (len < minLen + ADVERT_SIGNATURE_LEN) {
+            return false;
+        }
+        len -= ADVERT_SIGNATURE_LEN;
+    }
+    size_t nameLen = MAX_NODE_NAME_LEN;
+    if (compact) {
+        nameLen = data[nameOffset - 1];
+        if (nameLen >= MAX_NODE_NAME_LEN || nameOffset + nameLen > len) {
+            return false;
+        }
+    }
+    const size_t extOffset = nameOffset + nameLen;
     memset(&outContact, 0, sizeof(outContact));
     uint8_t role = data[4];
     switch (role) {
@@ -739,9 +2378,15 @@ bool MeshCoreProtocol::parseAdvert(const uint8_t* data,
         default: outContact.role = NodeRole::Unknown; break;
     }
     memcpy(outContact.publicKey, &data[5], PUBLIC_KEY_SIZE);
-    size_t nameOffset = 5 + PUBLIC_KEY_SIZE;
-    strncpy(outContact.name, reinterpret_cast<const char*>(&data[nameOffset]), sizeof(outContact.name) - 1);
+    const char* name = reinterpret_cast<const char*>(&data[nameOffset]);
+    memcpy(outContact.name, name, strnlen(name, std::min(nameLen, sizeof(outContact.name) - 1)));
     outContact.isDiscovered = true;
+    outContact.peerFlags = flags & (NEGOTIATED_FLAGS | PACKET_FLAG_RATE_SWITCH | PACKET_FLAG_SIGNED);
+    if ((flags & PACKET_FLAG_RATE_SWITCH) && len > extOffset) {
+        outContact.peerTxPower = (int8_t)data[extOffset];
+    } else {
+        outContact.peerFlags &= ~PACKET_FLAG_RATE_SWITCH;
+    }
     return true;
 }
 
@@ -749,8 +2394,8 @@ IProtocol* MeshCoreProtocol::create() {
     return new MeshCoreProtocol();
 }
 
-void MeshCoreProtocol::registerSelf() {
-    ProtocolRegistry::registerProtocol(meshCoreEntry);
+IProtocol* MeshCoreProtocol::createWithRadio(std::unique_ptr<IRadio> radio) {
+    return new MeshCoreProtocol(std::move(radio));
 }
 
 } // namespace meshola
@@ -1,14 +1,21 @@
 #pragma once
 
 #include "IProtocol.h"
+#include "IRadio.h"
+#include "AdvertScheduler.h"
+#include "ContactTable.h"
+#include "DutyCycle.h"
+#include "Fragmentation.h"
+#include "FloodRouter.h"
+#include "LinkAdaptation.h"
+#include "ListenBeforeTalk.h"
+#include "../crypto/Ed25519.h"
+#include "../storage/StateSnapshot.h"
 #include <cstring>
 #include <cstdint>
 #include <array>
+#include <memory>
 #include <vector>
-#ifdef ESP_PLATFORM
-#include <RadioLib.h>
-#include "Esp32S3Hal.h"
-#endif
 
 namespace meshola {
 
@@ -17,10 +24,27 @@ namespace meshola {
  * 
  * This wraps the actual MeshCore library (Mesh, BaseChatMesh, etc.)
  * and exposes it through the IProtocol interface.
+ *
+ * All RF access goes through an IRadio backend: the default constructor uses
+ * the T-Deck SX1262 on ESP32 and no radio on the host (sends succeed without
+ * transmitting); the host simulator injects a SimRadio instead.
  */
 class MeshCoreProtocol : public IProtocol {
 public:
+    // Registry constants (protocol/BuiltinProtocols.h)
+    static constexpr const char* PROTOCOL_ID = "meshcore";
+    static constexpr const char* PROTOCOL_NAME = "MeshCore (Standard)";
+    static constexpr uint32_t FEATURES =
+        featureBit(ProtocolFeature::DirectMessages) |
+        featureBit(ProtocolFeature::Channels) |
+        featureBit(ProtocolFeature::SignedMessages) |
+        featureBit(ProtocolFeature::LocationSharing) |
+        featureBit(ProtocolFeature::PathRouting) |
+        featureBit(ProtocolFeature::Encryption) |
+        featureBit(ProtocolFeature::TextCompression);
+
     MeshCoreProtocol();
+    explicit MeshCoreProtocol(std::unique_ptr<IRadio> radio);
     ~MeshCoreProtocol() override;
 
     // Lifecycle
@@ -41,6 +65,8 @@ public:
     bool sendAdvertisement() override;
     void setLocalIdentity(const uint8_t publicKey[PUBLIC_KEY_SIZE],
                           const char* name) override;
+    void setSigningKey(const uint8_t privateKey[PUBLIC_KEY_SIZE]) override;
+    void resetProfileState() override;
 
     // Messaging
     uint32_t sendMessage(const Contact& to, const char* text) override;
@@ -50,6 +76,9 @@ public:
     int getContactCount() const override;
     bool getContact(int index, Contact& out) const override;
     bool findContact(const uint8_t publicKey[PUBLIC_KEY_SIZE], Contact& out) const override;
+    bool findContactByHash(uint32_t keyHash, Contact& out) const override;
+    size_t copyContacts(Contact* dest, size_t maxCount, size_t offset) const override;
+    void forEachContact(const ContactVisitor& visitor) const override;
     bool addContact(const Contact& contact) override;
     bool removeContact(const uint8_t publicKey[PUBLIC_KEY_SIZE]) override;
     void resetPath(const uint8_t publicKey[PUBLIC_KEY_SIZE]) override;
@@ -59,11 +88,14 @@ public:
     // Channels
     int getChannelCount() const override;
     bool getChannel(int index, Channel& out) const override;
+    bool findChannel(const uint8_t channelId[CHANNEL_ID_SIZE], Channel& out) const override;
+    size_t copyChannels(Channel* dest, size_t maxCount, size_t offset) const override;
     bool setChannel(int index, const Channel& channel) override;
 
     // Radio Configuration
     RadioConfig getRadioConfig() const override;
     bool setRadioConfig(const RadioConfig& config) override;
+    bool setRxDutyCycle(uint32_t rxPeriodUs, uint32_t sleepPeriodUs) override;
     NodeStatus getStatus() const override;
 
     // Event Callbacks
@@ -71,17 +103,52 @@ public:
     void setContactCallback(ContactCallback callback) override;
     void setStatusCallback(StatusCallback callback) override;
     void setAckCallback(AckCallback callback) override;
+    void setTransmitCallback(TransmitCallback callback) override;
     void setErrorCallback(ErrorCallback callback) override;
 
     // Persistence
+    void setStatePath(const char* path) override;
     bool saveState() override;
     bool loadState() override;
 
-    // Factory function for registration
+    // Diagnostics
+    void setCounters(diag::ProtocolCounters* counters) override;
+    void setCapture(diag::PacketCapture* capture) override;
+
+    /**
+     * Forward routed frames heard from others (role Repeater in adverts).
+     * Defaults to MESHOLA_REPEATER.
+     */
+    void setRepeater(bool enabled);
+    bool isRepeater() const { return _repeater; }
+
+    /**
+     * Run channel activity detection before each transmit and back off while
+     * the channel is busy. Defaults to MESHOLA_LBT (on).
+     */
+    void setListenBeforeTalk(bool enabled);
+    bool isListenBeforeTalk() const { return _lbtEnabled; }
+
+    /**
+     * Send DMs to nearby contacts at a faster spreading factor when their
+     * link leaves room (see LinkAdaptation), and follow rate switches from
+     * peers. Needs a radio of its own (IRadio::isExclusive()). Defaults to
+     * MESHOLA_ADR (on).
+     */
+    void setAdaptiveDataRate(bool enabled);
+    bool isAdaptiveDataRate() const { return _adrEnabled; }
+
+    /**
+     * Send adverts on a jittered schedule that backs off as neighbours
+     * accumulate (see AdvertScheduler); sendAdvertisement() still sends one
+     * at once and restarts the interval. Defaults to MESHOLA_AUTO_ADVERT (on).
+     */
+    void setAutoAdvert(bool enabled);
+    bool isAutoAdvert() const { return _autoAdvert; }
+
+    // Factory functions for the protocol registry
     static IProtocol* create();
-    
-    // Protocol registration helper
-    static void registerSelf();
+    static IProtocol* createWithRadio(std::unique_ptr<IRadio> radio);
 
 private:
     // Internal state
@@ -95,13 +162,201 @@ private:
     StatusCallback _statusCallback;
     AckCallback _ackCallback;
     ErrorCallback _errorCallback;
+    TransmitCallback _transmitCallback;
+    
+    // RX/TX counters (service-owned, or _ownCounters when detached)
+    diag::ProtocolCounters _ownCounters;
+    diag::ProtocolCounters* _counters = &_ownCounters;
+    
+    // Optional raw RX capture (service-owned)
+    diag::PacketCapture* _capture = nullptr;
     
-#ifdef ESP_PLATFORM
-    Esp32S3Hal* _hal = nullptr;
-    Module* _module = nullptr;
-    SX1262* _radio = nullptr;
+    std::unique_ptr<IRadio> _radio;
     bool _rxListening = false;
-#endif
+    uint32_t _nextAckId = 1;
+
+    // Transmit queue: sends return at once and loop() starts the next frame
+    // when the radio reports TxDone for the one on air (the queue front)
+    enum class TxState : uint8_t {
+        Idle,                               // Queue empty
+        Scanning,                           // CAD running for the queue front
+        Backoff,                            // Channel was busy; RX armed until _txBackoffUntilMs
+        OnAir,                              // Queue front transmitting
+    };
+    static constexpr size_t RATE_PREFIX_LEN = 4;            // Recipient key bytes in a rate switch
+    struct QueuedTx {
+        uint32_t ackId;
+        uint8_t spreadingFactor;            // Faster than the profile's, 0 = profile SF
+        uint8_t rateTarget[RATE_PREFIX_LEN];    // Recipient woken by the rate switch
+        uint8_t len;
+        uint8_t data[MAX_RADIO_PACKET_LEN];
+    };
+    static constexpr size_t TX_QUEUE_DEPTH = 8;
+    static constexpr uint32_t TX_DONE_TIMEOUT_MS = 10000;   // Past the frame's time on air
+    static constexpr uint32_t CAD_DONE_TIMEOUT_MS = 500;    // CAD takes a few symbols
+
+    std::array<QueuedTx, TX_QUEUE_DEPTH> _txQueue{};
+    size_t _txHead = 0;
+    size_t _txCount = 0;
+    TxState _txState = TxState::Idle;
+    uint32_t _txDeadlineMs = 0;
+    uint32_t _txBackoffUntilMs = 0;
+    bool _lbtEnabled;
+    ListenBeforeTalk _lbt;
+    DutyCycleBudget _dutyCycle;             // Limit follows _config.dutyCyclePermille
+    uint32_t _dutyCycleRejects = 0;
+    uint32_t _sendAckId = 0;                // Stamped on frames queued by sendMessage()
+    uint8_t _sendSf = 0;                    // Likewise, with _sendRateTarget
+    uint8_t _sendRateTarget[RATE_PREFIX_LEN]{};
+    
+    // RX duty cycle (0 sleep = continuous receive)
+    uint32_t _rxPeriodUs = 0;
+    uint32_t _sleepPeriodUs = 0;
+
+    bool startListening();
+    bool transmitFrame(const uint8_t* payload, size_t len);
+    void startNextTransmit();
+    bool scanFront();
+    void sendFront();
+    void serviceChannelScan(uint32_t irq);
+    bool txHoldsRadio() const { return _txState == TxState::Scanning || _txState == TxState::OnAir; }
+    bool tuneRadio(const RadioConfig& config);
+    bool claimAirtime(const RadioConfig& config, size_t len);
+    void finishTransmit(bool ok);
+    void serviceTransmit(uint32_t irq);
+    void clearTransmitQueue();
+    void countTx(bool ok, size_t len);
+    void receiveFrame(uint32_t irq);
+    bool sendText(const char* text,
+                  const uint8_t channelId[CHANNEL_ID_SIZE],
+                  const uint8_t recipientKey[PUBLIC_KEY_SIZE],
+                  bool isChannel);
+    void deliverMessage(Message& msg);
+    void refreshSender(const uint8_t senderKey[PUBLIC_KEY_SIZE]);
+
+    // Fragmentation (compact frames with PACKET_FLAG_FRAGMENT)
+    ReassemblyPool _reassembly;
+    FragmentHistory _sentFragments;         // DMs only: channels never NACK
+    uint16_t _nextFragmentId = 1;
+    uint32_t _reportedReassemblyLosses = 0;
+
+    bool sendFragmented(const char* text,
+                        size_t textLen,
+                        const uint8_t channelId[CHANNEL_ID_SIZE],
+                        const uint8_t recipientKey[PUBLIC_KEY_SIZE],
+                        bool isChannel,
+                        uint8_t features);
+    bool transmitFragment(const FragmentedMessage& message, uint8_t index);
+    bool handleFragmentFrame(const uint8_t* data, size_t len);
+    void handleFragmentNack(const uint8_t* data, size_t len);
+    void sendFragmentNack(const FragmentHeader& header, uint32_t missing);
+    void serviceFragments();
+
+    // Flood routing (PACKET_VERSION_ROUTED)
+    struct RxRoute {
+        bool valid = false;                 // Current frame was flooded to us
+        bool relayed = false;               // Current frame came through repeaters
+        bool sourceRouted = false;          // Current frame was sent along a path (ROUTE_DIRECT)
+        uint8_t length = 0;
+        uint8_t path[MAX_PATH_LEN] = {};    // Repeaters from the originator, in order
+    };
+
+    bool _repeater;
+    SeenCache _seen;
+    ForwardQueue _forwards;
+    RxRoute _rxRoute;
+    uint8_t _nextRouteTag = 0;
+
+    bool transmitRouted(const uint8_t* frame, size_t len, const Contact* recipient);
+    bool acceptRoutedFrame(uint8_t* frame, size_t& len);
+    void forwardRoutedFrame(const uint8_t* frame, size_t len, uint32_t packetId, uint32_t nowMs);
+    void applyRoute(Contact& contact, const RxRoute& route) const;
+    void learnRoute(const uint8_t senderKey[PUBLIC_KEY_SIZE]);
+    void serviceForwards();
+
+    // Advert signatures (PACKET_FLAG_SIGNED)
+    static constexpr size_t ADVERT_BATCH_MAX = crypto::ED25519_MAX_BATCH;
+    static constexpr uint32_t ADVERT_BATCH_HOLD_MS = 3000;  // A few advert airtimes at SF11
+    struct PendingAdvert {
+        Contact contact;
+        RxRoute route;
+        float rssi;
+        float snr;
+        uint8_t len;
+        uint8_t frame[MAX_RADIO_PACKET_LEN];
+    };
+
+    uint8_t _signingSeed[crypto::ED25519_SEED_LEN]{};
+    uint8_t _signingPublicKey[PUBLIC_KEY_SIZE]{};
+    bool _hasSigningKey = false;
+    std::array<PendingAdvert, ADVERT_BATCH_MAX> _pendingAdverts{};
+    size_t _pendingAdvertCount = 0;
+    uint32_t _pendingAdvertsSinceMs = 0;
+
+    bool canSign() const;
+    void acceptAdvert(Contact& contact, const RxRoute& route, float rssi, float snr);
+    void queueSignedAdvert(const Contact& contact, const uint8_t* frame, size_t len);
+    void verifyPendingAdverts();
+    void serviceAdverts();
+
+    // Scheduled adverts (PACKET_VERSION_ADVERT when every peer parses it)
+    static constexpr uint32_t NEIGHBOUR_MAX_AGE_MS = 2 * AdvertScheduler::MAX_INTERVAL_MS;
+
+    bool _autoAdvert;
+    AdvertScheduler _advertScheduler;
+
+    size_t countNeighbours() const;
+    bool transmitAdvert();
+    void serviceAdvertSchedule();
+
+    // State snapshot (storage/StateSnapshot.h)
+    static constexpr uint32_t SNAPSHOT_QUIET_MS = 15000;                // Save once changes pause this long,
+    static constexpr uint32_t SNAPSHOT_MAX_DELAY_MS = 5 * 60 * 1000;    // or this long after the first one
+
+    char _statePath[SNAPSHOT_MAX_PATH_LEN] = {};
+    uint32_t _channelRevision = 0;          // Bumped by setChannel(); contacts keep their own
+    uint32_t _savedContactRevision = 0;     // Revisions in the file (or loaded from it)
+    uint32_t _savedChannelRevision = 0;
+    uint32_t _seenContactRevision = 0;      // Revisions when the last change was noticed
+    uint32_t _seenChannelRevision = 0;
+    bool _stateLoaded = false;              // loadState() ran for _statePath; saves allowed
+    bool _stateFileStale = false;           // File on disk unreadable: replace it
+    bool _warmStart = false;                // Contacts restored: skip the startup advert
+    bool _stateDirty = false;
+    uint32_t _stateDirtySinceMs = 0;
+    uint32_t _stateChangedMs = 0;
+
+    bool stateUnsaved() const;
+    void markStateSaved();
+    void serviceSnapshot();
+
+    // Adaptive data rate (PACKET_VERSION_RATE)
+    static constexpr uint32_t ADR_LEAD_IN_MS = 100;         // Extra preamble: peer's loop latency
+    static constexpr uint32_t ADR_FRAME_GAP_MS = 20;        // Between frames of one run
+    static constexpr uint32_t ADR_WINDOW_GUARD_MS = 50;
+    static constexpr uint32_t ADR_MAX_WINDOW_MS = 10000;
+
+    bool _adrEnabled;
+    uint8_t _radioSf = 0;                   // Settings on the radio, 0 = unknown
+    uint16_t _radioPreamble = 0;
+    bool _txRateSwitch = false;             // The frame on air is a rate switch for the front
+    uint32_t _rateTxWindowMs = 0;           // Window it announced
+    uint8_t _rateTxSf = 0;                  // Open window as sender
+    uint8_t _rateTxTarget[RATE_PREFIX_LEN]{};
+    uint32_t _rateTxUntilMs = 0;
+    bool _rateTxLeadIn = false;             // Next fast frame is the first of the window
+    uint8_t _rateRxSf = 0;                  // Open window as receiver, 0 = profile SF
+    uint32_t _rateRxUntilMs = 0;
+
+    bool adrAvailable() const { return _adrEnabled && _radio && _radio->isExclusive(); }
+    uint8_t adrSpreadingFactor(const uint8_t recipientKey[PUBLIC_KEY_SIZE]) const;
+    bool sampleLink(Contact& contact, const RxRoute& route, float rssi, float snr) const;
+    RadioConfig fastConfig(uint8_t spreadingFactor, bool leadIn) const;
+    bool rateWindowOpen(const QueuedTx& tx) const;
+    bool startRateSwitch();
+    void finishRateSwitch();
+    bool handleRateSwitch(const uint8_t* data, size_t len);
+    void serviceRateWindow();
 
     // Local identity cached for framing
     uint8_t _selfPublicKey[PUBLIC_KEY_SIZE]{};
@@ -111,19 +366,97 @@ private:
     // Packet framing helpers
     static constexpr uint8_t PACKET_MAGIC_0 = 0x4d; // 'M'
     static constexpr uint8_t PACKET_MAGIC_1 = 0x4c; // 'L'
-    static constexpr uint8_t PACKET_VERSION = 0x01;
+    static constexpr uint8_t PACKET_VERSION = 0x01;          // Full channel ID and keys
+    static constexpr uint8_t PACKET_VERSION_COMPACT = 0x02;  // ID/key prefixes + varint length
+    static constexpr uint8_t PACKET_VERSION_ROUTED = 0x03;   // Route header + any other frame
+    static constexpr uint8_t PACKET_VERSION_RATE = 0x04;     // Rate switch for the next frames
+    static constexpr uint8_t PACKET_VERSION_ADVERT = 0x05;   // Advert with a length-prefixed name
     static constexpr uint8_t PACKET_FLAG_CHANNEL = 0x01;
+    static constexpr uint8_t PACKET_FLAG_COMPACT_ADVERT = 0x01;  // Advert: parses compact adverts
     static constexpr uint8_t PACKET_FLAG_ADVERT  = 0x02;
+    static constexpr uint8_t PACKET_FLAG_COMPACT = 0x04;     // Advert: sender parses compact frames
+    static constexpr uint8_t PACKET_FLAG_TEXT_CODEC = 0x08;  // Advert: parses compressed text
+                                                             // Compact frame: text is compressed
+    static constexpr uint8_t PACKET_FLAG_RATE_SWITCH = 0x10; // Advert: follows rate switches,
+                                                             // TX power byte appended
+    static constexpr uint8_t PACKET_FLAG_SIGNED = 0x20;      // Advert: Ed25519 signature appended
+    static constexpr uint8_t PACKET_HASH_SHIFT = 4;          // Compact: prefix bytes - 1 in bits 4-5
+    static constexpr uint8_t PACKET_HASH_MASK = 0x30;
+    static constexpr uint8_t PACKET_FLAG_FRAGMENT = 0x40;    // Advert: reassembles fragments
+                                                             // Compact frame: one fragment
+    static constexpr uint8_t PACKET_FLAG_NACK = 0x80;        // With FRAGMENT: missing-fragment request
+    static constexpr uint8_t PACKET_FLAG_ROUTED = 0x80;      // Advert: parses routed frames
+    static constexpr size_t PACKET_MAX_HASH_LEN = 4;
+    static constexpr uint32_t COMPACT_PREFIXES_PER_NODE = 256;  // Channel sender prefix headroom
+    static constexpr size_t HELD_MESSAGE_SLOTS = 4;             // Compact messages from unknown senders
+    static constexpr uint32_t HELD_MESSAGE_MS = 60 * 60 * 1000;
+    static constexpr size_t FRAGMENT_HEADER_LEN = 6;         // msgId(2) index count offset(2)
+    static constexpr size_t ADVERT_SIGNATURE_LEN = crypto::ED25519_SIGNATURE_LEN;
+    static constexpr size_t RATE_SWITCH_LEN = 6 + RATE_PREFIX_LEN;  // magic(2) version sf window(2) target
+
+    // Frame features a peer must announce in its advert before we use them
+    static constexpr uint8_t NEGOTIATED_FLAGS =
+        PACKET_FLAG_COMPACT | PACKET_FLAG_TEXT_CODEC | PACKET_FLAG_FRAGMENT | PACKET_FLAG_ROUTED |
+        PACKET_FLAG_COMPACT_ADVERT;
+
+    // Route header (PACKET_VERSION_ROUTED)
+    static constexpr uint8_t ROUTE_DIRECT = 0x80;            // Source-routed along the path
+    static constexpr uint8_t ROUTE_HOPS_MASK = 0x7F;         // Flood: hops left
+    static constexpr uint8_t FLOOD_HOPS = 4;
+    static constexpr size_t ROUTE_HEADER_LEN = 6;            // magic(2) version route tag pathLen
+    static constexpr size_t ROUTE_OVERHEAD = ROUTE_HEADER_LEN - 2 + MAX_PATH_LEN;
+
+    // Channel frames avoid a feature this long after an advert from a node
+    // that lacks it
+    static constexpr uint32_t LEGACY_PEER_HOLD_MS = 30 * 60 * 1000;
+    uint8_t _legacyFlags = 0;               // NEGOTIATED_FLAGS missing from recent adverts
+    uint32_t _legacyAdvertMs = 0;
+
+    struct HeldMessage {
+        Message message;                    // senderKey: the prefix, zero-padded
+        uint32_t heldMs = 0;
+        uint8_t prefixLen = 0;              // 0: free
+    };
+    HeldMessage _heldMessages[HELD_MESSAGE_SLOTS];
+
+    void noteAdvertFlags(uint8_t peerFlags);
+    uint8_t frameFeatures(const uint8_t recipientKey[PUBLIC_KEY_SIZE]) const;
+    size_t compactHashLen(const uint8_t recipientKey[PUBLIC_KEY_SIZE]) const;
 
     bool buildPacket(const char* text,
                      const uint8_t channelId[CHANNEL_ID_SIZE],
                      const uint8_t recipientKey[PUBLIC_KEY_SIZE],
                      bool isChannel,
+                     uint8_t features,
+                     uint8_t* outBuf,
+                     size_t& outLen) const;
+    bool buildCompactPacket(const char* text,
+                     size_t textLen,
+                     const uint8_t channelId[CHANNEL_ID_SIZE],
+                     const uint8_t recipientKey[PUBLIC_KEY_SIZE],
+                     bool isChannel,
+                     bool compress,
+                     size_t maxLen,
                      uint8_t* outBuf,
                      size_t& outLen) const;
+    bool handleCompactFrame(const uint8_t* data, size_t len);
+    bool acceptDirectTarget(uint8_t flags, const uint8_t* target, const uint8_t* sender, size_t hashLen);
+    void deliverCompactMessage(Message& msg, size_t prefixLen);
+    void releaseHeldMessages(const Contact& sender);
+    bool parseCompactPacket(const uint8_t* data,
+                     size_t len,
+                     Message& outMsg) const;
+    bool fillCompactMessage(uint8_t flags,
+                     const uint8_t* target,
+                     const uint8_t* sender,
+                     size_t hashLen,
+                     const uint8_t* text,
+                     size_t textLen,
+                     Message& outMsg) const;
     bool buildAdvert(uint8_t role,
                      const uint8_t senderKey[PUBLIC_KEY_SIZE],
                      const char* senderName,
+                     bool compact,
                      uint8_t* outBuf,
                      size_t& outLen) const;
     bool parsePacket(const uint8_t* data,
@@ -135,8 +468,8 @@ private:
 
     // Default public channel (MeshCore default)
     Channel _defaultChannel{};
-    // Synthetic contacts list (e.g., defaults)
-    std::vector<Contact> _contacts;
+    // Known contacts (synthetic defaults, adverts, restored state)
+    ContactTable _contacts;
     // MeshCore integration placeholder
     // BaseChatMesh* _mesh = nullptr;
 };
@@ -1,46 +1,26 @@
 #include "IProtocol.h"
-#include <cstring>
+#include "IRadio.h"
+#include "BuiltinProtocols.h"
 
 namespace meshola {
 
-// Static storage for protocol registry
-ProtocolEntry ProtocolRegistry::protocols[MAX_PROTOCOLS] = {};
-int ProtocolRegistry::protocolCount = 0;
-
-bool ProtocolRegistry::registerProtocol(const ProtocolEntry& entry) {
-    if (protocolCount >= MAX_PROTOCOLS) {
-        return false;
-    }
-    
-    // Check for duplicate ID
-    for (int i = 0; i < protocolCount; i++) {
-        if (strcmp(protocols[i].id, entry.id) == 0) {
-            return false;  // Already registered
-        }
-    }
-    
-    protocols[protocolCount++] = entry;
-    return true;
-}
-
 int ProtocolRegistry::getProtocolCount() {
-    return protocolCount;
+    return static_cast<int>(BuiltinProtocols::COUNT);
 }
 
 const ProtocolEntry* ProtocolRegistry::getProtocol(int index) {
-    if (index < 0 || index >= protocolCount) {
+    if (index < 0 || index >= getProtocolCount()) {
         return nullptr;
     }
-    return &protocols[index];
+    return &BuiltinProtocols::entries[index];
 }
 
 const ProtocolEntry* ProtocolRegistry::findProtocol(const char* id) {
-    for (int i = 0; i < protocolCount; i++) {
-        if (strcmp(protocols[i].id, id) == 0) {
-            return &protocols[i];
-        }
-    }
-    return nullptr;
+    return BuiltinProtocols::find(id);
+}
+
+const ProtocolEntry* ProtocolRegistry::findProtocol(uint32_t idHash) {
+    return BuiltinProtocols::find(idHash);
 }
 
 IProtocol* ProtocolRegistry::createProtocol(const char* id) {
@@ -51,4 +31,12 @@ IProtocol* ProtocolRegistry::createProtocol(const char* id) {
     return nullptr;
 }
 
+IProtocol* ProtocolRegistry::createProtocol(const char* id, std::unique_ptr<IRadio> radio) {
+    const ProtocolEntry* entry = findProtocol(id);
+    if (entry && entry->createWithRadio) {
+        return entry->createWithRadio(std::move(radio));
+    }
+    return nullptr;
+}
+
 } // namespace meshola
@@ -0,0 +1,155 @@
+#pragma once
+
+/**
+ * ProtocolTable - Compile-time protocol registry.
+ *
+ * A protocol class takes part by exposing registry constants and factories:
+ *
+ *   static constexpr const char* PROTOCOL_ID;     // e.g. "meshcore"
+ *   static constexpr const char* PROTOCOL_NAME;   // Display name
+ *   static constexpr uint32_t FEATURES;           // featureBit() mask
+ *   static IProtocol* create();
+ *   static IProtocol* createWithRadio(std::unique_ptr<IRadio> radio);
+ *
+ * ProtocolTable<BuiltinProtocol<enabled, P>...> builds the entry array and
+ * an open-addressing index keyed by protocolIdHash() as constant data, so
+ * nothing runs at startup and a lookup is a hash plus one or two probes.
+ * Disabled protocols never have their factories referenced, which lets the
+ * linker drop their code (--gc-sections).
+ */
+
+#include "IProtocol.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace meshola {
+
+/**
+ * One candidate protocol; Enabled comes from a MESHOLA_PROTOCOL_* flag.
+ */
+template <bool Enabled, typename Protocol>
+struct BuiltinProtocol {
+    static constexpr bool enabled = Enabled;
+    using type = Protocol;
+};
+
+template <typename Protocol>
+constexpr ProtocolEntry makeProtocolEntry() {
+    return ProtocolEntry{
+        .id = Protocol::PROTOCOL_ID,
+        .idHash = protocolIdHash(Protocol::PROTOCOL_ID),
+        .name = Protocol::PROTOCOL_NAME,
+        .features = Protocol::FEATURES,
+        .create = &Protocol::create,
+        .createWithRadio = &Protocol::createWithRadio
+    };
+}
+
+/**
+ * Append a candidate's entry if it is enabled. A disabled candidate's
+ * factories are never named, so nothing references its code.
+ */
+template <typename Builtin, size_t N>
+constexpr void appendProtocolEntry(std::array<ProtocolEntry, N>& out, size_t& count) {
+    if constexpr (Builtin::enabled) {
+        out[count++] = makeProtocolEntry<typename Builtin::type>();
+    }
+}
+
+template <size_t N>
+constexpr bool hasUniqueHashes(const std::array<ProtocolEntry, N>& entries) {
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = i + 1; j < N; j++) {
+            if (entries[i].idHash == entries[j].idHash) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <typename... Builtins>
+class ProtocolTable {
+public:
+    static constexpr size_t COUNT = (size_t{0} + ... + (Builtins::enabled ? 1u : 0u));
+
+    // Power of two, at most half full
+    static constexpr size_t INDEX_SIZE = [] {
+        size_t size = 1;
+        while (size < COUNT * 2) {
+            size <<= 1;
+        }
+        return size;
+    }();
+
+    static constexpr std::array<ProtocolEntry, COUNT> entries = [] {
+        std::array<ProtocolEntry, COUNT> out{};
+        size_t count = 0;
+        (appendProtocolEntry<Builtins>(out, count), ...);
+        return out;
+    }();
+
+    /**
+     * Entry for an ID hash, or nullptr. Usable in constant expressions.
+     */
+    static constexpr const ProtocolEntry* find(uint32_t idHash) {
+        size_t position = positionOf(idHash);
+        return position < COUNT ? &entries[position] : nullptr;
+    }
+
+    /**
+     * Entry for an ID; the hash hit is confirmed with a string compare.
+     */
+    static const ProtocolEntry* find(const char* id) {
+        if (!id) {
+            return nullptr;
+        }
+        const ProtocolEntry* entry = find(protocolIdHash(id));
+        return entry && strcmp(entry->id, id) == 0 ? entry : nullptr;
+    }
+
+    /**
+     * Feature mask of a built-in protocol, 0 if it is not built in.
+     */
+    static constexpr uint32_t features(uint32_t idHash) {
+        size_t position = positionOf(idHash);
+        return position < COUNT ? entries[position].features : 0;
+    }
+
+private:
+    // Index-based so static_asserts stay constant when sanitizers
+    // instrument pointer checks
+    static constexpr size_t positionOf(uint32_t idHash) {
+        for (size_t probe = 0; probe < INDEX_SIZE; probe++) {
+            uint8_t slot = index[(idHash + probe) & (INDEX_SIZE - 1)];
+            if (slot == 0) {
+                return COUNT;
+            }
+            if (entries[slot - 1].idHash == idHash) {
+                return slot - 1;
+            }
+        }
+        return COUNT;
+    }
+
+    static_assert(COUNT < 255, "Index slots are uint8_t");
+    static_assert(hasUniqueHashes(entries), "Two built-in protocols share an ID hash; rename one");
+
+    // Slot holds entry index + 1, 0 = empty
+    static constexpr std::array<uint8_t, INDEX_SIZE> index = [] {
+        std::array<uint8_t, INDEX_SIZE> out{};
+        for (size_t i = 0; i < COUNT; i++) {
+            size_t slot = entries[i].idHash & (INDEX_SIZE - 1);
+            while (out[slot] != 0) {
+                slot = (slot + 1) & (INDEX_SIZE - 1);
+            }
+            out[slot] = static_cast<uint8_t>(i + 1);
+        }
+        return out;
+    }();
+};
+
+} // namespace meshola
@@ -0,0 +1,522 @@
+#include "RadioArbiter.h"
+
+#include <cstring>
+
+namespace meshola {
+
+// ============================================================================
+// Client view
+// ============================================================================
+
+class RadioArbiter::Client : public IRadio {
+public:
+    Client(RadioArbiter& arbiter, size_t index)
+        : _arbiter(arbiter)
+        , _index(index)
+    {
+    }
+
+    ~Client() override {
+        _arbiter.clientEnd(_index);
+        _arbiter._clients[_index].attached = false;
+    }
+
+    bool begin(const RadioConfig& config) override { return _arbiter.clientBegin(_index, config); }
+    void end() override { _arbiter.clientEnd(_index); }
+    bool applyConfig(const RadioConfig& config) override { return _arbiter.clientApplyConfig(_index, config); }
+    bool startReceive() override { return _arbiter.clientStartReceive(_index, 0, 0); }
+    bool startReceiveDutyCycle(uint32_t rxPeriodUs, uint32_t sleepPeriodUs) override {
+        return _arbiter.clientStartReceive(_index, rxPeriodUs, sleepPeriodUs);
+    }
+    void standby() override { _arbiter.clientStandby(_index); }
+    bool startTransmit(const uint8_t* data, size_t len) override {
+        return _arbiter.clientTransmit(_index, data, len);
+    }
+    bool startChannelScan() override { return _arbiter.clientChannelScan(_index); }
+    uint32_t pollIrq() override { return _arbiter.clientPollIrq(_index); }
+    void clearIrq(uint32_t flags) override { _arbiter._clients[_index].pendingIrq &= ~flags; }
+    size_t getPacketLength() override { return _arbiter._rxLength; }
+
+    bool readData(uint8_t* dest, size_t len) override {
+        if (!dest || _arbiter._rxLength == 0) {
+            return false;
+        }
+        memcpy(dest, _arbiter._rxFrame, len < _arbiter._rxLength ? len : _arbiter._rxLength);
+        return true;
+    }
+
+    float getRssi() override { return _arbiter._rxRssi; }
+    float getSnr() override { return _arbiter._rxSnr; }
+
+    uint32_t getTimeOnAirUs(size_t len) override {
+        // This client's settings, not whatever is on the radio right now
+        return loraTimeOnAirUs(_arbiter._clients[_index].config, len);
+    }
+
+    bool isExclusive() const override { return false; }
+
+private:
+    RadioArbiter& _arbiter;
+    size_t _index;
+};
+
+// ============================================================================
+// RadioArbiter
+// ============================================================================
+
+RadioArbiter::RadioArbiter(std::unique_ptr<IRadio> radio)
+    : _radio(std::move(radio))
+{
+}
+
+RadioArbiter::~RadioArbiter() {
+    if (_radioStarted && _radio) {
+        _radio->end();
+    }
+}
+
+std::unique_ptr<IRadio> RadioArbiter::createClient(uint8_t airtimeSharePercent) {
+    for (size_t i = 0; i < MAX_CLIENTS; i++) {
+        if (!_clients[i].attached) {
+            _clients[i] = ClientState{};
+            _clients[i].attached = true;
+            setAirtimeShare(i, airtimeSharePercent);
+            return std::make_unique<Client>(*this, i);
+        }
+    }
+    return nullptr;
+}
+
+void RadioArbiter::setAirtimeShare(size_t client, uint8_t airtimeSharePercent) {
+    if (client >= MAX_CLIENTS) {
+        return;
+    }
+    if (airtimeSharePercent == 0) {
+        airtimeSharePercent = 1;
+    } else if (airtimeSharePercent > 100) {
+        airtimeSharePercent = 100;
+    }
+    _clients[client].share = airtimeSharePercent;
+}
+
+bool RadioArbiter::sameModem(const RadioConfig& a, const RadioConfig& b) {
+    // TX power is per frame and does not split the clients
+    return (radioConfigChanges(a, b) & ~RadioConfigTxPower) == RadioConfigNone;
+}
+
+bool RadioArbiter::isOnAir(size_t client) const {
+    return _clients[client].started && (_shared || client == _active);
+}
+
+size_t RadioArbiter::startedCount() const {
+    size_t count = 0;
+    for (const auto& c : _clients) {
+        if (c.started) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool RadioArbiter::computeShared() const {
+    const RadioConfig* first = nullptr;
+    for (const auto& c : _clients) {
+        if (!c.started) {
+            continue;
+        }
+        if (!first) {
+            first = &c.config;
+        } else if (!sameModem(*first, c.config)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t RadioArbiter::slotLengthMs(size_t client) const {
+    uint32_t total = 0;
+    for (const auto& c : _clients) {
+        if (c.started) {
+            total += c.share;
+        }
+    }
+    if (total == 0) {
+        return SLOT_CYCLE_MS;
+    }
+    uint32_t slot = SLOT_CYCLE_MS * _clients[client].share / total;
+    return slot < MIN_SLOT_MS ? MIN_SLOT_MS : slot;
+}
+
+// ============================================================================
+// Physical radio
+// ============================================================================
+
+void RadioArbiter::pumpIrq() {
+    if (!_radioStarted) {
+        return;
+    }
+    uint32_t irq = _radio->pollIrq();
+    if (irq == RadioIrqNone) {
+        return;
+    }
+
+    if ((irq & RadioIrqTxDone) && _txBusy && !_scanning) {
+        _txBusy = false;
+        _clients[_txClient].pendingIrq |= RadioIrqTxDone;
+    }
+    if ((irq & RadioIrqCadDone) && _txBusy && _scanning) {
+        _txBusy = false;
+        _scanning = false;
+        _clients[_txClient].pendingIrq |= irq & (RadioIrqCadDone | RadioIrqCadDetected);
+    }
+
+    uint32_t deliver = irq & (RadioIrqCrcError | RadioIrqTimeout);
+    if (irq & RadioIrqRxDone) {
+        size_t len = _radio->getPacketLength();
+        if (len > sizeof(_rxFrame)) {
+            len = sizeof(_rxFrame);
+        }
+        if (_radio->readData(_rxFrame, len)) {
+            _rxLength = len;
+            _rxRssi = _radio->getRssi();
+            _rxSnr = _radio->getSnr();
+            deliver |= RadioIrqRxDone;
+        } else {
+            _rxLength = 0;
+        }
+    }
+    _radio->clearIrq(RadioIrqAll);
+    _rxArmed = false;
+
+    size_t listeners = 0;
+    for (size_t i = 0; i < MAX_CLIENTS; i++) {
+        if (isOnAir(i) && _clients[i].receiving) {
+            _clients[i].pendingIrq |= deliver;
+            listeners++;
+        }
+    }
+    if ((deliver & RadioIrqRxDone) && listeners > 1) {
+        _counters->sharedFrames.add();
+    }
+    if (irq & (RadioIrqTxDone | RadioIrqCadDone)) {
+        sendQueued();
+    }
+}
+
+bool RadioArbiter::ensureConfig(const RadioConfig& config) {
+    if (radioConfigChanges(_radioConfig, config) == RadioConfigNone) {
+        return true;
+    }
+    _radio->standby();
+    _rxArmed = false;
+    if (!_radio->applyConfig(config)) {
+        _counters->configFailures.add();
+        return false;
+    }
+    _radioConfig = config;
+    return true;
+}
+
+void RadioArbiter::armReceive() {
+    if (!_radioStarted || _rxArmed || _txBusy) {
+        return;
+    }
+    // Listen in the most awake mode any on-air client asked for
+    bool anyReceiving = false;
+    bool continuous = false;
+    uint32_t rxPeriodUs = 0;
+    uint32_t sleepPeriodUs = 0;
+    for (size_t i = 0; i < MAX_CLIENTS; i++) {
+        const ClientState& c = _clients[i];
+        if (!isOnAir(i) || !c.receiving) {
+            continue;
+        }
+        if (c.sleepPeriodUs == 0) {
+            continuous = true;
+        } else if (!anyReceiving || c.sleepPeriodUs < sleepPeriodUs) {
+            rxPeriodUs = c.rxPeriodUs;
+            sleepPeriodUs = c.sleepPeriodUs;
+        }
+        anyReceiving = true;
+    }
+    if (!anyReceiving) {
+        return;
+    }
+    _rxArmed = continuous
+        ? _radio->startReceive()
+        : _radio->startReceiveDutyCycle(rxPeriodUs, sleepPeriodUs);
+}
+
+bool RadioArbiter::transmitNow(size_t client, const uint8_t* data, size_t len) {
+    // Same modem in shared mode, but TX power may still differ
+    if (!ensureConfig(_clients[client].config)) {
+        return false;
+    }
+    _radio->standby();
+    _rxArmed = false;
+    _txBusy = _radio->startTransmit(data, len);
+    _scanning = false;
+    _txClient = client;
+    return _txBusy;
+}
+
+void RadioArbiter::sendQueued() {
+    // Oldest frame of an on-air client, taking turns after the last sender
+    for (size_t step = 1; step <= MAX_CLIENTS && !_txBusy; step++) {
+        size_t client = (_txClient + step) % MAX_CLIENTS;
+        ClientState& c = _clients[client];
+        while (isOnAir(client) && c.queueCount > 0 && !_txBusy) {
+            const QueuedFrame& frame = c.queue[c.queueHead];
+            bool ok = transmitNow(client, frame.data, frame.length);
+            c.queueHead = (c.queueHead + 1) % TX_QUEUE_DEPTH;
+            c.queueCount--;
+            if (!ok) {
+                // Completes as far as the client can tell; its loop re-arms RX
+                c.pendingIrq |= RadioIrqTxDone;
+            }
+        }
+    }
+    armReceive();
+}
+
+void RadioArbiter::switchTo(size_t client, uint32_t nowMs) {
+    if (client != _active) {
+        _counters->slotSwitches.add();
+    }
+    _active = client;
+    _slotStartMs = nowMs;
+    ensureConfig(_clients[client].config);
+    _rxArmed = false;
+    sendQueued();
+}
+
+void RadioArbiter::tick(uint32_t nowMs) {
+    if (!_radioStarted || startedCount() == 0) {
+        return;
+    }
+    if (!_slotClockValid) {
+        _slotStartMs = nowMs;
+        _slotClockValid = true;
+    }
+    if (_txBusy) {
+        // Switching settings now would cut the frame off
+        return;
+    }
+    if (_configPending) {
+        _configPending = false;
+        if (isOnAir(_active)) {
+            ensureConfig(_clients[_active].config);
+        }
+    }
+
+    bool shared = computeShared();
+    if (shared) {
+        if (!_shared) {
+            // Settings converged: everyone listens, queued frames go out now
+            _shared = true;
+            if (!_clients[_active].started) {
+                for (size_t i = 0; i < MAX_CLIENTS; i++) {
+                    if (_clients[i].started) {
+                        _active = i;
+                        break;
+                    }
+                }
+            }
+            ensureConfig(_clients[_active].config);
+            _rxArmed = false;
+        }
+        sendQueued();
+        return;
+    }
+
+    bool enteringSlices = _shared;
+    _shared = false;
+    bool activeGone = !_clients[_active].started;
+    if (!enteringSlices && !activeGone && nowMs - _slotStartMs < slotLengthMs(_active)) {
+        return;
+    }
+
+    // Round robin to the next started client (the current one if alone)
+    size_t next = _active;
+    for (size_t step = 1; step <= MAX_CLIENTS; step++) {
+        size_t candidate = (_active + step) % MAX_CLIENTS;
+        if (_clients[candidate].started) {
+            next = candidate;
+            break;
+        }
+    }
+    if (enteringSlices && _clients[_active].started) {
+        // Keep the current owner for a full slot on its (already applied) settings
+        next = _active;
+    }
+    switchTo(next, nowMs);
+}
+
+// ============================================================================
+// Client entry points
+// ============================================================================
+
+bool RadioArbiter::clientBegin(size_t client, const RadioConfig& config) {
+    ClientState& c = _clients[client];
+    c.config = config;
+    c.started = true;
+    c.pendingIrq = RadioIrqNone;
+    c.queueCount = 0;
+    c.queueHead = 0;
+
+    if (!_radio) {
+        return false;
+    }
+    if (!_radioStarted) {
+        if (!_radio->begin(config)) {
+            c.started = false;
+            return false;
+        }
+        _radioStarted = true;
+        _radioConfig = config;
+        _active = client;
+        _shared = true;
+        _rxArmed = false;
+        _slotClockValid = false;
+    }
+    return true;
+}
+
+void RadioArbiter::clientEnd(size_t client) {
+    ClientState& c = _clients[client];
+    if (!c.started) {
+        return;
+    }
+    c.started = false;
+    c.receiving = false;
+    c.pendingIrq = RadioIrqNone;
+    c.queueCount = 0;
+    if (_txBusy && _txClient == client) {
+        // Nobody waits for its TxDone; the next arm or transmit cuts it off
+        _txBusy = false;
+        _scanning = false;
+    }
+
+    if (startedCount() == 0 && _radioStarted) {
+        _radio->end();
+        _radioStarted = false;
+        _rxArmed = false;
+    }
+    // The remaining client (if any) takes over in the next tick()
+}
+
+bool RadioArbiter::clientApplyConfig(size_t client, const RadioConfig& config) {
+    if (!isValidRadioConfig(config)) {
+        return false;
+    }
+    _clients[client].config = config;
+    if (!_radioStarted || _clients[client].started == false) {
+        return true;
+    }
+    if (_shared && !computeShared()) {
+        // This change splits the clients; tick() starts time slicing
+        return true;
+    }
+    if (_txBusy) {
+        // Applied by tick() once the frame on air is done
+        _configPending = true;
+        return true;
+    }
+    if (isOnAir(client)) {
+        return ensureConfig(config);
+    }
+    return true;
+}
+
+bool RadioArbiter::clientStartReceive(size_t client, uint32_t rxPeriodUs, uint32_t sleepPeriodUs) {
+    ClientState& c = _clients[client];
+    bool modeChanged = !c.receiving || c.rxPeriodUs != rxPeriodUs || c.sleepPeriodUs != sleepPeriodUs;
+    c.receiving = true;
+    c.rxPeriodUs = rxPeriodUs;
+    c.sleepPeriodUs = sleepPeriodUs;
+    if (!isOnAir(client) || _txBusy) {
+        // Remembered for the client's next slot, or armed after the transmit
+        return true;
+    }
+    if (modeChanged) {
+        _rxArmed = false;
+    }
+    armReceive();
+    return _rxArmed;
+}
+
+void RadioArbiter::clientStandby(size_t client) {
+    _clients[client].receiving = false;
+    if (!isOnAir(client) || !_radioStarted) {
+        return;
+    }
+    if (_txBusy) {
+        if (_txClient != client) {
+            return;                 // Leave the other client's frame on air
+        }
+        _txBusy = false;            // The caller aborts its own frame or scan
+        _scanning = false;
+    }
+    // Another client may still be listening; it is re-armed after the
+    // caller's transmit/startReceive
+    _radio->standby();
+    _rxArmed = false;
+}
+
+bool RadioArbiter::clientTransmit(size_t client, const uint8_t* data, size_t len) {
+    if (!_radioStarted || !data || len == 0 || len > MAX_RADIO_PACKET_LEN) {
+        return false;
+    }
+    if (isOnAir(client) && !_txBusy) {
+        bool ok = transmitNow(client, data, len);
+        armReceive();
+        return ok;
+    }
+
+    // Off air, or another frame is on air: wait in the client's queue
+    ClientState& c = _clients[client];
+    if (c.queueCount >= TX_QUEUE_DEPTH) {
+        _counters->txQueueDrops.add();
+        return false;
+    }
+    QueuedFrame& frame = c.queue[(c.queueHead + c.queueCount) % TX_QUEUE_DEPTH];
+    memcpy(frame.data, data, len);
+    frame.length = (uint8_t)len;
+    c.queueCount++;
+    _counters->txQueued.add();
+    return true;
+}
+
+bool RadioArbiter::clientChannelScan(size_t client) {
+    if (!_radioStarted) {
+        return false;
+    }
+    ClientState& c = _clients[client];
+    if (!isOnAir(client)) {
+        c.pendingIrq |= RadioIrqCadDone;
+        return true;
+    }
+    if (_txBusy) {
+        c.pendingIrq |= RadioIrqCadDone | RadioIrqCadDetected;
+        return true;
+    }
+    if (!ensureConfig(c.config)) {
+        return false;
+    }
+    _radio->standby();
+    _rxArmed = false;
+    _txBusy = _radio->startChannelScan();
+    _scanning = _txBusy;
+    _txClient = client;
+    if (!_txBusy) {
+        armReceive();
+    }
+    return _txBusy;
+}
+
+uint32_t RadioArbiter::clientPollIrq(size_t client) {
+    pumpIrq();
+    return _clients[client].pendingIrq;
+}
+
+} // namespace meshola
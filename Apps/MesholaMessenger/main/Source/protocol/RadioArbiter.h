@@ -0,0 +1,170 @@
+#pragma once
+
+/**
+ * RadioArbiter - Shares one transceiver between several protocols.
+ *
+ * Each protocol gets its own IRadio (createClient()) and drives it as if it
+ * owned the SX1262. The arbiter multiplexes them onto the physical radio:
+ *
+ * - Shared: every client uses the same modem settings (frequency, bandwidth,
+ *   SF, CR, preamble). All clients listen at once; each received frame is
+ *   handed to every client, and a frame one protocol cannot parse is simply
+ *   counted as a parse failure there. Transmits start immediately unless
+ *   another frame is on air, in which case they wait in the sender's queue.
+ *
+ * - Time-sliced: settings differ (e.g. two meshes on different channels).
+ *   Clients take turns owning the radio in a SLOT_CYCLE_MS round robin,
+ *   each for its airtime share of the cycle. Frames sent by a client while
+ *   another owns the radio are queued and transmitted back to back from the
+ *   start of its next slot. Frames on the other mesh are missed while it is
+ *   off-air. A slot is not handed over while a frame is on air.
+ *
+ * Transmits are asynchronous like the radio's: RadioIrqTxDone is raised only
+ * for the client whose frame finished, and the next queued frame starts
+ * when it does. Channel scans (CAD) are routed the same way. A client that
+ * scans while another client's frame or scan occupies the radio is told the
+ * channel is busy; one scanning off-air is told it is clear, since its
+ * frame waits in the queue anyway.
+ *
+ * The mode is re-evaluated in tick(), so a settings change on either side
+ * switches between the two without restarting anything.
+ *
+ * Not thread-safe: clients and tick() must be called from one thread (the
+ * mesh thread, under MesholaMsgService::_mutex). Time is passed in by the
+ * caller so the class has no platform dependency. The arbiter must outlive
+ * every client it created.
+ */
+
+#include "IRadio.h"
+#include "../diag/Metrics.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace meshola {
+
+/**
+ * Arbiter counters, owned by ServiceMetrics.
+ */
+struct ArbiterCounters {
+    diag::Counter slotSwitches;     // Radio handed to another client (time-sliced)
+    diag::Counter sharedFrames;     // Frames delivered to more than one client
+    diag::Counter txQueued;         // Frames held until the sender's slot
+    diag::Counter txQueueDrops;     // Frames rejected because the queue was full
+    diag::Counter configFailures;   // applyConfig() failures on a slot switch
+};
+
+class RadioArbiter {
+public:
+    static constexpr size_t MAX_CLIENTS = 2;
+    static constexpr size_t TX_QUEUE_DEPTH = 4;
+    static constexpr uint32_t SLOT_CYCLE_MS = 4000;
+    static constexpr uint32_t MIN_SLOT_MS = 500;
+
+    explicit RadioArbiter(std::unique_ptr<IRadio> radio);
+    ~RadioArbiter();
+
+    RadioArbiter(const RadioArbiter&) = delete;
+    RadioArbiter& operator=(const RadioArbiter&) = delete;
+
+    /**
+     * Create a radio view for one protocol.
+     * @param airtimeSharePercent Relative share of the slot cycle (1-100)
+     * @return nullptr if MAX_CLIENTS views already exist
+     */
+    std::unique_ptr<IRadio> createClient(uint8_t airtimeSharePercent);
+
+    void setAirtimeShare(size_t client, uint8_t airtimeSharePercent);
+
+    void setCounters(ArbiterCounters* counters) { _counters = counters ? counters : &_ownCounters; }
+
+    /**
+     * Re-evaluate the sharing mode and rotate slots. Call once per mesh
+     * loop iteration, before the clients' protocol loops.
+     */
+    void tick(uint32_t nowMs);
+
+    /**
+     * True when all started clients listen at once (no time slicing).
+     */
+    bool isShared() const { return _shared; }
+
+    /**
+     * Client currently owning the radio (meaningful when time-sliced).
+     */
+    size_t getActiveClient() const { return _active; }
+
+private:
+    class Client;
+    friend class Client;
+
+    struct QueuedFrame {
+        uint8_t data[MAX_RADIO_PACKET_LEN];
+        uint8_t length;
+    };
+
+    struct ClientState {
+        bool attached = false;
+        bool started = false;           // Between begin() and end()
+        uint8_t share = 50;
+        RadioConfig config{};
+        bool receiving = false;         // Wants RX when on air
+        uint32_t rxPeriodUs = 0;        // 0 = continuous
+        uint32_t sleepPeriodUs = 0;
+        uint32_t pendingIrq = RadioIrqNone;
+        std::array<QueuedFrame, TX_QUEUE_DEPTH> queue{};
+        size_t queueHead = 0;
+        size_t queueCount = 0;
+    };
+
+    std::unique_ptr<IRadio> _radio;
+    std::array<ClientState, MAX_CLIENTS> _clients{};
+    ArbiterCounters _ownCounters;
+    ArbiterCounters* _counters = &_ownCounters;
+
+    bool _radioStarted = false;
+    RadioConfig _radioConfig{};         // Settings currently on the radio
+    bool _rxArmed = false;
+    bool _txBusy = false;               // A frame or channel scan is on air
+    bool _scanning = false;             // ...and it is a channel scan
+    size_t _txClient = 0;               // Its owner
+    bool _configPending = false;        // Settings change deferred by a transmit
+    bool _shared = true;
+    size_t _active = 0;
+    uint32_t _slotStartMs = 0;
+    bool _slotClockValid = false;
+
+    // Last frame read from the radio, handed out to every listening client
+    uint8_t _rxFrame[MAX_RADIO_PACKET_LEN];
+    size_t _rxLength = 0;
+    float _rxRssi = 0.0f;
+    float _rxSnr = 0.0f;
+
+    static bool sameModem(const RadioConfig& a, const RadioConfig& b);
+
+    bool isOnAir(size_t client) const;
+    size_t startedCount() const;
+    bool computeShared() const;
+    uint32_t slotLengthMs(size_t client) const;
+
+    void pumpIrq();
+    bool ensureConfig(const RadioConfig& config);
+    void armReceive();
+    bool transmitNow(size_t client, const uint8_t* data, size_t len);
+    void sendQueued();
+    void switchTo(size_t client, uint32_t nowMs);
+
+    // Client entry points
+    bool clientBegin(size_t client, const RadioConfig& config);
+    void clientEnd(size_t client);
+    bool clientApplyConfig(size_t client, const RadioConfig& config);
+    bool clientStartReceive(size_t client, uint32_t rxPeriodUs, uint32_t sleepPeriodUs);
+    void clientStandby(size_t client);
+    bool clientTransmit(size_t client, const uint8_t* data, size_t len);
+    bool clientChannelScan(size_t client);
+    uint32_t clientPollIrq(size_t client);
+};
+
+} // namespace meshola
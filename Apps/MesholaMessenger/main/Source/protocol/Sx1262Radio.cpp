@@ -0,0 +1,255 @@
+#include "Sx1262Radio.h"
+
+#ifdef ESP_PLATFORM
+
+#include <esp_attr.h>
+#include <esp_timer.h>
+#include <Tactility/Log.h>
+
+#include "../diag/Trace.h"
+
+namespace meshola {
+
+#define TAG "Sx1262Radio"
+
+// T-Deck SX1262 pin map
+static constexpr int PIN_LORA_NSS   = 9;
+static constexpr int PIN_LORA_DIO1  = 45;
+static constexpr int PIN_LORA_RST   = 17;
+static constexpr int PIN_LORA_BUSY  = 13;
+static constexpr int PIN_LORA_SCLK  = 40;
+static constexpr int PIN_LORA_MISO  = 38;
+static constexpr int PIN_LORA_MOSI  = 41;
+
+#if MESHOLA_TRACE
+// DIO1 edge timestamp, captured in the ISR so traces start at the real IRQ
+static volatile uint64_t sDio1Us = 0;
+
+static void IRAM_ATTR onDio1Trace() {
+    sDio1Us = (uint64_t)esp_timer_get_time();
+}
+#endif
+
+Sx1262Radio::~Sx1262Radio() {
+    end();
+}
+
+bool Sx1262Radio::begin(const RadioConfig& config) {
+    // Clean up any previous instance
+    end();
+
+    if (!isValidRadioConfig(config)) {
+        TT_LOG_E(TAG, "Unsupported radio config");
+        return false;
+    }
+
+    // ESP-IDF HAL for RadioLib
+    _hal = new Esp32S3Hal(PIN_LORA_SCLK, PIN_LORA_MISO, PIN_LORA_MOSI);
+    _hal->init();
+
+    // Create RadioLib module for SX1262 on T-Deck
+    _module = new Module(_hal, PIN_LORA_NSS, PIN_LORA_DIO1, PIN_LORA_RST, PIN_LORA_BUSY);
+    _module->init();
+
+    _radio = new SX1262(_module);
+
+    // Bring up radio with provided config
+    int16_t state = _radio->begin(
+        config.frequency,
+        config.bandwidth,
+        config.spreadingFactor,
+        config.codingRate,
+        RADIOLIB_SX126X_SYNC_WORD_PRIVATE,
+        config.txPower,
+        effectivePreambleLength(config)
+    );
+    if (state != RADIOLIB_ERR_NONE) {
+        TT_LOG_E(TAG, "Radio begin failed: %d", state);
+        return false;
+    }
+
+    // Basic runtime tweaks
+    _radio->setDio2AsRfSwitch(true);
+    _radio->setCRC(2);
+    _radio->setOutputPower(config.txPower);
+#if MESHOLA_TRACE
+    _radio->setDio1Action(onDio1Trace);
+#endif
+    _config = config;
+    _configKnown = true;
+    return true;
+}
+
+void Sx1262Radio::end() {
+    _transmitting = false;
+    _configKnown = false;
+    if (_radio) {
+        _radio->standby();
+        delete _radio;
+        _radio = nullptr;
+    }
+    if (_module) {
+        delete _module;
+        _module = nullptr;
+    }
+    if (_hal) {
+        _hal->term();
+        delete _hal;
+        _hal = nullptr;
+    }
+}
+
+bool Sx1262Radio::applyConfig(const RadioConfig& config) {
+    if (!_radio) {
+        return false;
+    }
+    if (!isValidRadioConfig(config)) {
+        TT_LOG_E(TAG, "Unsupported radio config");
+        return false;
+    }
+    uint32_t changes = _configKnown ? radioConfigChanges(_config, config) : RadioConfigAll;
+    if (changes == RadioConfigNone) {
+        return true;
+    }
+
+    // Each setter is a few SPI commands in standby, so a retune takes
+    // milliseconds (a frequency change may add an image calibration) where
+    // begin() would reset the chip. RadioLib recomputes low data rate
+    // optimisation on BW/SF changes.
+    int64_t startUs = esp_timer_get_time();
+    _radio->standby();
+    _transmitting = false;
+    int16_t state = RADIOLIB_ERR_NONE;
+    if (changes & RadioConfigFrequency) {
+        state = _radio->setFrequency(config.frequency);
+    }
+    if (state == RADIOLIB_ERR_NONE && (changes & RadioConfigBandwidth)) {
+        state = _radio->setBandwidth(config.bandwidth);
+    }
+    if (state == RADIOLIB_ERR_NONE && (changes & RadioConfigSpreadingFactor)) {
+        state = _radio->setSpreadingFactor(config.spreadingFactor);
+    }
+    if (state == RADIOLIB_ERR_NONE && (changes & RadioConfigCodingRate)) {
+        state = _radio->setCodingRate(config.codingRate);
+    }
+    if (state == RADIOLIB_ERR_NONE && (changes & RadioConfigTxPower)) {
+        state = _radio->setOutputPower(config.txPower);
+    }
+    if (state == RADIOLIB_ERR_NONE && (changes & RadioConfigPreamble)) {
+        state = _radio->setPreambleLength(effectivePreambleLength(config));
+    }
+    if (state != RADIOLIB_ERR_NONE) {
+        // Some registers may hold the new value already; the next call rewrites all
+        TT_LOG_E(TAG, "Radio reconfigure failed: %d (fields 0x%02lx)", state, (unsigned long)changes);
+        _configKnown = false;
+        return false;
+    }
+    _config = config;
+    _configKnown = true;
+    TT_LOG_I(TAG, "Retuned fields 0x%02lx in %lu us", (unsigned long)changes,
+             (unsigned long)(esp_timer_get_time() - startUs));
+    return true;
+}
+
+bool Sx1262Radio::startReceive() {
+    _transmitting = false;
+    return _radio && _radio->startReceive() == RADIOLIB_ERR_NONE;
+}
+
+bool Sx1262Radio::startReceiveDutyCycle(uint32_t rxPeriodUs, uint32_t sleepPeriodUs) {
+    // SX126x RX duty cycle: the chip alternates RX and warm-start sleep on its own
+    _transmitting = false;
+    return _radio && _radio->startReceiveDutyCycle(rxPeriodUs, sleepPeriodUs) == RADIOLIB_ERR_NONE;
+}
+
+void Sx1262Radio::standby() {
+    // Aborts a frame still on air
+    _transmitting = false;
+    if (_radio) {
+        _radio->standby();
+    }
+}
+
+bool Sx1262Radio::startTransmit(const uint8_t* data, size_t len) {
+    if (!_radio) {
+        return false;
+    }
+    // TX_DONE arrives on DIO1 and is picked up by pollIrq()
+    _transmitting = _radio->startTransmit(data, len) == RADIOLIB_ERR_NONE;
+    return _transmitting;
+}
+
+bool Sx1262Radio::startChannelScan() {
+    // CAD_DONE (+ CAD_DETECTED) arrives on DIO1; the chip returns to standby
+    _transmitting = false;
+    return _radio && _radio->startChannelScan() == RADIOLIB_ERR_NONE;
+}
+
+uint32_t Sx1262Radio::pollIrq() {
+    if (!_radio) {
+        return RadioIrqNone;
+    }
+    uint32_t native = _radio->getIrqFlags();
+    uint32_t flags = RadioIrqNone;
+    if (native & RADIOLIB_SX126X_IRQ_RX_DONE) flags |= RadioIrqRxDone;
+    if (native & RADIOLIB_SX126X_IRQ_TX_DONE) flags |= RadioIrqTxDone;
+    if (native & RADIOLIB_SX126X_IRQ_CRC_ERR) flags |= RadioIrqCrcError;
+    if (native & RADIOLIB_SX126X_IRQ_TIMEOUT) flags |= RadioIrqTimeout;
+    if (native & RADIOLIB_SX126X_IRQ_CAD_DONE) flags |= RadioIrqCadDone;
+    if (native & RADIOLIB_SX126X_IRQ_CAD_DETECTED) flags |= RadioIrqCadDetected;
+#if MESHOLA_TRACE
+    if (flags & RadioIrqRxDone) {
+        MESHOLA_TRACE_FLOW();
+        MESHOLA_TRACE_INSTANT_AT(sDio1Us, Irq);
+    }
+#endif
+    return flags;
+}
+
+void Sx1262Radio::clearIrq(uint32_t flags) {
+    if (!_radio) {
+        return;
+    }
+    if ((flags & RadioIrqTxDone) && _transmitting) {
+        // Clears the IRQ status and drops to standby
+        _radio->finishTransmit();
+        _transmitting = false;
+        return;
+    }
+    if (flags == RadioIrqAll) {
+        _radio->clearIrqFlags(RADIOLIB_SX126X_IRQ_ALL);
+        return;
+    }
+    uint32_t native = 0;
+    if (flags & RadioIrqRxDone) native |= RADIOLIB_SX126X_IRQ_RX_DONE;
+    if (flags & RadioIrqTxDone) native |= RADIOLIB_SX126X_IRQ_TX_DONE;
+    if (flags & RadioIrqCrcError) native |= RADIOLIB_SX126X_IRQ_CRC_ERR;
+    if (flags & RadioIrqTimeout) native |= RADIOLIB_SX126X_IRQ_TIMEOUT;
+    if (flags & RadioIrqCadDone) native |= RADIOLIB_SX126X_IRQ_CAD_DONE;
+    if (flags & RadioIrqCadDetected) native |= RADIOLIB_SX126X_IRQ_CAD_DETECTED;
+    _radio->clearIrqFlags(native);
+}
+
+size_t Sx1262Radio::getPacketLength() {
+    return _radio ? _radio->getPacketLength() : 0;
+}
+
+bool Sx1262Radio::readData(uint8_t* dest, size_t len) {
+    return _radio && _radio->readData(dest, len) == RADIOLIB_ERR_NONE;
+}
+
+float Sx1262Radio::getRssi() {
+    return _radio ? _radio->getRSSI() : 0.0f;
+}
+
+float Sx1262Radio::getSnr() {
+    return _radio ? _radio->getSNR() : 0.0f;
+}
+
+uint32_t Sx1262Radio::getTimeOnAirUs(size_t len) {
+    return _radio ? (uint32_t)_radio->getTimeOnAir(len) : 0;
+}
+
+} // namespace meshola
+
+#endif // ESP_PLATFORM
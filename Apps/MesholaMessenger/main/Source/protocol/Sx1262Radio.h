@@ -0,0 +1,52 @@
+#pragma once
+
+#ifdef ESP_PLATFORM
+
+#include "IRadio.h"
+#include <RadioLib.h>
+#include "Esp32S3Hal.h"
+
+namespace meshola {
+
+/**
+ * IRadio backend for the T-Deck SX1262 via RadioLib.
+ *
+ * Owns the ESP-IDF HAL, RadioLib Module and SX1262 driver. begin() creates
+ * them, end() tears them down, so a protocol can be re-initialised with new
+ * settings without leaking SPI bus handles. applyConfig() retunes the
+ * running chip, writing only the settings that changed.
+ */
+class Sx1262Radio : public IRadio {
+public:
+    Sx1262Radio() = default;
+    ~Sx1262Radio() override;
+
+    bool begin(const RadioConfig& config) override;
+    void end() override;
+    bool applyConfig(const RadioConfig& config) override;
+    bool startReceive() override;
+    bool startReceiveDutyCycle(uint32_t rxPeriodUs, uint32_t sleepPeriodUs) override;
+    void standby() override;
+    bool startTransmit(const uint8_t* data, size_t len) override;
+    bool startChannelScan() override;
+    uint32_t pollIrq() override;
+    void clearIrq(uint32_t flags) override;
+    size_t getPacketLength() override;
+    bool readData(uint8_t* dest, size_t len) override;
+    float getRssi() override;
+    float getSnr() override;
+    uint32_t getTimeOnAirUs(size_t len) override;
+    bool isExclusive() const override { return true; }
+
+private:
+    Esp32S3Hal* _hal = nullptr;
+    Module* _module = nullptr;
+    SX1262* _radio = nullptr;
+    bool _transmitting = false;     // startTransmit() not yet finished
+    RadioConfig _config{};          // Settings on the chip
+    bool _configKnown = false;      // False after a failed write: rewrite everything
+};
+
+} // namespace meshola
+
+#endif // ESP_PLATFORM
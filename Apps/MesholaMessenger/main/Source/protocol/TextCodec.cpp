@@ -0,0 +1,192 @@
+#include "TextCodec.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace meshola {
+
+// Wire format: append only (see TextCodec.h)
+static constexpr const char* DICTIONARY[] = {
+    " ", "e", "t", "a", "o", "i", "n", "s", "r", "h",
+    "l", "d", "u", "c", "m", "w", "y", "g", "p", "f",
+    "b", "k", "v", ".", ",", "?", "!", "'", "\n", "0",
+    "1", "2", "3", "4", "5", "6", "7", "8", "9", ":",
+    " the ", "the ", " to ", " and ", " you ", " is ", " in ", " of ", " it ", " for ",
+    " on ", " at ", " be ", " we ", " are ", " have ", " that ", " with ", " can ", " will ",
+    " not ", " just ", " what ", " was ", " my ", " me ", " so ", " do ", " if ", " here ",
+    " there ", " this ", " out ", " up ", " now ", " how ", " from ", " your ", " get ", " going ",
+    "I'm ", "i'm ", "I ", "i ", "ok", "OK", "Ok", "yes", "Yes", "no ",
+    "No ", "thanks", "Thanks", "hello", "Hello", "hi ", "Hi ", "hey", "Hey", "copy",
+    "Copy", "roger", "good", "Good", "morning", "night", "see ", "you", "You", "on my way",
+    "signal", "battery", "node", "mesh", "radio", "repeater", "channel", "message", "test", "Test",
+    "anyone", "location", "weather", "home", "back", "meet", "camp", "trail", "road", "water",
+    "minutes", "min", "hour", "today", "tonight", "tomorrow", "later", "soon", "where", "Where",
+    "when", "When", "what", "What", "are you", "there", "here", "come", "coming", "going",
+    "ing ", "ing", "ed ", "er ", "es ", "ly ", "nt ", "'s ", "'t ", "ll ",
+    "th", "he", "in", "er", "an", "re", "on", "at", "en", "nd",
+    "ti", "es", "or", "te", "of", "ed", "is", "it", "al", "ar",
+    "st", "to", "nt", "ng", "se", "ha", "as", "ou", "io", "le",
+    "ve", "co", "me", "de", "hi", "ri", "ro", "ic", "ne", "ea",
+    "ra", "ce", "li", "ch", "ll", "be", "ma", "si", "om", "ur",
+    ". ", ", ", "? ", "! ", "...", "  ", ":)", ":-)", "lol", "btw",
+    "pls", "thx", "all", "ght", "ion", "ent", "tion", "ter", "our", "ould",
+    "ever", "ver", "one", "ome", "ake", "ave", "ere", "ith", "ust", "ore",
+    "A", "T", "S", "W", "M", "C", "B", "N", "H", "E",
+    "x", "j", "q", "z"
+};
+
+static constexpr size_t DICTIONARY_COUNT = sizeof(DICTIONARY) / sizeof(DICTIONARY[0]);
+static_assert(DICTIONARY_COUNT <= TEXT_CODEC_DICTIONARY_SIZE, "Codes 254/255 are escapes");
+
+static constexpr size_t MAX_LITERAL_RUN = 256;
+
+namespace {
+
+/**
+ * Entries grouped by first byte, longest first, so the encoder only tries
+ * candidates that can match.
+ */
+struct DictionaryIndex {
+    std::array<uint8_t, DICTIONARY_COUNT> order{};
+    std::array<uint8_t, DICTIONARY_COUNT> length{};
+    std::array<uint16_t, 257> start{};
+
+    DictionaryIndex() {
+        for (size_t i = 0; i < DICTIONARY_COUNT; i++) {
+            order[i] = (uint8_t)i;
+            length[i] = (uint8_t)strlen(DICTIONARY[i]);
+        }
+        std::stable_sort(order.begin(), order.end(), [this](uint8_t a, uint8_t b) {
+            uint8_t firstA = (uint8_t)DICTIONARY[a][0];
+            uint8_t firstB = (uint8_t)DICTIONARY[b][0];
+            return firstA != firstB ? firstA < firstB : length[a] > length[b];
+        });
+        size_t next = 0;
+        for (size_t c = 0; c < 256; c++) {
+            start[c] = (uint16_t)next;
+            while (next < DICTIONARY_COUNT && (uint8_t)DICTIONARY[order[next]][0] == c) {
+                next++;
+            }
+        }
+        start[256] = (uint16_t)DICTIONARY_COUNT;
+    }
+};
+
+const DictionaryIndex& dictionaryIndex() {
+    static const DictionaryIndex index;
+    return index;
+}
+
+} // namespace
+
+size_t compressText(const char* text, size_t len, uint8_t* out, size_t maxOut) {
+    if (!text || !out) {
+        return 0;
+    }
+    const DictionaryIndex& index = dictionaryIndex();
+    size_t used = 0;
+    size_t literalStart = 0;
+    size_t literalCount = 0;
+
+    auto flushLiterals = [&]() -> bool {
+        while (literalCount > 0) {
+            size_t run = std::min(literalCount, MAX_LITERAL_RUN);
+            size_t needed = run == 1 ? 2 : 2 + run;
+            if (used + needed > maxOut) {
+                return false;
+            }
+            if (run == 1) {
+                out[used++] = TEXT_CODEC_LITERAL;
+            } else {
+                out[used++] = TEXT_CODEC_LITERAL_RUN;
+                out[used++] = (uint8_t)(run - 1);
+            }
+            memcpy(&out[used], &text[literalStart], run);
+            used += run;
+            literalStart += run;
+            literalCount -= run;
+        }
+        return true;
+    };
+
+    size_t pos = 0;
+    while (pos < len) {
+        uint8_t first = (uint8_t)text[pos];
+        size_t remaining = len - pos;
+        int code = -1;
+        size_t matchLen = 0;
+        for (size_t i = index.start[first]; i < index.start[first + 1]; i++) {
+            uint8_t candidate = index.order[i];
+            size_t candidateLen = index.length[candidate];
+            if (candidateLen <= remaining && memcmp(DICTIONARY[candidate], &text[pos], candidateLen) == 0) {
+                code = candidate;
+                matchLen = candidateLen;
+                break;  // Longest first
+            }
+        }
+
+        if (code < 0) {
+            if (literalCount == 0) {
+                literalStart = pos;
+            }
+            literalCount++;
+            pos++;
+            continue;
+        }
+        if (!flushLiterals() || used >= maxOut) {
+            return 0;
+        }
+        out[used++] = (uint8_t)code;
+        pos += matchLen;
+    }
+    if (!flushLiterals()) {
+        return 0;
+    }
+    return used;
+}
+
+size_t decompressText(const uint8_t* data, size_t len, char* out, size_t maxOut) {
+    if (!data || !out || maxOut == 0) {
+        return SIZE_MAX;
+    }
+    size_t used = 0;
+    size_t idx = 0;
+    auto fail = [&]() {
+        out[used] = '\0';
+        return SIZE_MAX;
+    };
+    while (idx < len) {
+        uint8_t code = data[idx++];
+        const char* piece;
+        size_t pieceLen;
+        if (code < DICTIONARY_COUNT) {
+            piece = DICTIONARY[code];
+            pieceLen = strlen(piece);
+        } else if (code == TEXT_CODEC_LITERAL || code == TEXT_CODEC_LITERAL_RUN) {
+            pieceLen = 1;
+            if (code == TEXT_CODEC_LITERAL_RUN) {
+                if (idx >= len) {
+                    return fail();
+                }
+                pieceLen = (size_t)data[idx++] + 1;
+            }
+            if (pieceLen > len - idx) {
+                return fail();
+            }
+            piece = reinterpret_cast<const char*>(&data[idx]);
+            idx += pieceLen;
+        } else {
+            return fail();  // Code from a newer dictionary
+        }
+        if (pieceLen >= maxOut - used) {
+            return fail();
+        }
+        memcpy(&out[used], piece, pieceLen);
+        used += pieceLen;
+    }
+    out[used] = '\0';
+    return used;
+}
+
+} // namespace meshola
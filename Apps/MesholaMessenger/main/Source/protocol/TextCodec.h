@@ -0,0 +1,38 @@
+#pragma once
+
+/**
+ * Short-text codec for chat payloads.
+ *
+ * A static-dictionary compressor in the style of SMAZ: each output byte is
+ * either a code for one of TEXT_CODEC_DICTIONARY_SIZE common chat fragments
+ * (words, word pieces and their surrounding spaces) or an escape followed by
+ * verbatim bytes. No state is kept between messages, so a 10-30 character
+ * line still compresses, typically to 50-70% of its length.
+ *
+ * The dictionary is part of the wire format: entries may only ever be
+ * appended (up to the escape codes), never changed or reordered.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace meshola {
+
+constexpr size_t TEXT_CODEC_DICTIONARY_SIZE = 254;     // Codes 0-253
+constexpr uint8_t TEXT_CODEC_LITERAL = 254;            // Next byte verbatim
+constexpr uint8_t TEXT_CODEC_LITERAL_RUN = 255;        // Count-1, then bytes
+
+/**
+ * Compress len bytes of text into out.
+ * @return Encoded length, or 0 if it would not fit in maxOut
+ */
+size_t compressText(const char* text, size_t len, uint8_t* out, size_t maxOut);
+
+/**
+ * Decompress into out, always NUL-terminated.
+ * @return Decoded length (excluding NUL), or SIZE_MAX if the input is
+ *         malformed or does not fit in maxOut - 1 characters
+ */
+size_t decompressText(const uint8_t* data, size_t len, char* out, size_t maxOut);
+
+} // namespace meshola
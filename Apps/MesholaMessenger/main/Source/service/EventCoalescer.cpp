@@ -0,0 +1,81 @@
+#include "EventCoalescer.h"
+#include <cstring>
+
+namespace meshola::service {
+
+EventCoalescer::EventCoalescer(uint32_t windowMs)
+    : _windowMs(windowMs)
+{
+    _contacts.reserve(MAX_PENDING_CONTACTS);
+}
+
+void EventCoalescer::addContact(const Contact& contact, bool isNew, ProtocolSlot slot) {
+    if (_fullRefresh) {
+        // Already collapsed; subscribers will re-read everything
+        return;
+    }
+
+    for (auto& pending : _contacts) {
+        if (pending.slot == slot &&
+            memcmp(pending.contact.publicKey, contact.publicKey, PUBLIC_KEY_SIZE) == 0) {
+            pending.contact = contact;
+            pending.isNew = pending.isNew || isNew;
+            return;
+        }
+    }
+
+    if (_contacts.size() >= MAX_PENDING_CONTACTS) {
+        _contacts.clear();
+        _fullRefresh = true;
+        return;
+    }
+
+    _contacts.push_back(ContactEvent{
+        .contact = contact,
+        .isNew = isNew,
+        .slot = slot
+    });
+}
+
+void EventCoalescer::refreshContact(const Contact& contact, ProtocolSlot slot) {
+    for (auto& pending : _contacts) {
+        if (pending.slot == slot &&
+            memcmp(pending.contact.publicKey, contact.publicKey, PUBLIC_KEY_SIZE) == 0) {
+            pending.contact = contact;
+            return;
+        }
+    }
+}
+
+bool EventCoalescer::isDue(uint32_t nowMs) const {
+    if (!hasPending()) {
+        return false;
+    }
+    return (uint32_t)(nowMs - _lastFlushMs) >= _windowMs;
+}
+
+bool EventCoalescer::takeContacts(ContactBatchEvent& outBatch) {
+    if (_contacts.empty() && !_fullRefresh) {
+        return false;
+    }
+    outBatch.contacts.swap(_contacts);
+    outBatch.fullRefresh = _fullRefresh;
+    _contacts.clear();
+    _contacts.reserve(MAX_PENDING_CONTACTS);
+    _fullRefresh = false;
+    return true;
+}
+
+uint32_t EventCoalescer::takeStatus() {
+    uint32_t fields = _statusFields;
+    _statusFields = 0;
+    return fields;
+}
+
+void EventCoalescer::clear() {
+    _contacts.clear();
+    _fullRefresh = false;
+    _statusFields = 0;
+}
+
+} // namespace meshola::service
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "ServiceEvents.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace meshola::service {
+
+/**
+ * EventCoalescer - Merges bursts of contact/status updates.
+ *
+ * Contact updates are merged by public key (latest state wins, isNew is
+ * sticky), status updates are merged by StatusField. The owner calls
+ * take*() at most once per window, so subscribers see a bounded event rate
+ * no matter how many adverts arrive.
+ *
+ * Not thread-safe: the owner serializes access (MesholaMsgService::_mutex).
+ * Time is passed in by the caller so the class has no platform dependency.
+ */
+class EventCoalescer {
+public:
+    static constexpr uint32_t DEFAULT_WINDOW_MS = 250;
+    // Pending contacts beyond this collapse into a single full refresh
+    static constexpr size_t MAX_PENDING_CONTACTS = 32;
+
+    explicit EventCoalescer(uint32_t windowMs = DEFAULT_WINDOW_MS);
+
+    void setWindow(uint32_t windowMs) { _windowMs = windowMs; }
+    uint32_t getWindow() const { return _windowMs; }
+
+    /**
+     * Queue a contact update, merging with any pending update for the same
+     * key and slot.
+     */
+    void addContact(const Contact& contact, bool isNew, ProtocolSlot slot = ProtocolSlot::Primary);
+
+    /**
+     * Update a pending contact's state in place without queuing a new one
+     * (the caller published it already).
+     */
+    void refreshContact(const Contact& contact, ProtocolSlot slot = ProtocolSlot::Primary);
+
+    /**
+     * Mark status fields (StatusField bitmask) as changed.
+     */
+    void markStatus(uint32_t fields) { _statusFields |= fields; }
+
+    /**
+     * Replace pending contact updates with a full refresh (e.g. profile switch).
+     */
+    void markFullRefresh() {
+        _contacts.clear();
+        _fullRefresh = true;
+    }
+
+    /**
+     * True if anything is queued.
+     */
+    bool hasPending() const { return !_contacts.empty() || _fullRefresh || _statusFields != 0; }
+
+    /**
+     * Number of distinct contacts waiting to be published.
+     */
+    size_t pendingContactCount() const { return _contacts.size(); }
+
+    /**
+     * True if pending events exist and the window since the last flush has elapsed.
+     */
+    bool isDue(uint32_t nowMs) const;
+
+    /**
+     * Move pending contacts into outBatch. Returns false if there were none.
+     */
+    bool takeContacts(ContactBatchEvent& outBatch);
+
+    /**
+     * Return and clear the pending status field mask.
+     */
+    uint32_t takeStatus();
+
+    /**
+     * Record that a flush happened at nowMs (starts the next window).
+     */
+    void markFlushed(uint32_t nowMs) { _lastFlushMs = nowMs; }
+
+    /**
+     * Drop everything pending (e.g. on profile switch).
+     */
+    void clear();
+
+private:
+    uint32_t _windowMs;
+    uint32_t _lastFlushMs = 0;
+    uint32_t _statusFields = 0;
+    bool _fullRefresh = false;
+    std::vector<ContactEvent> _contacts;
+};
+
+} // namespace meshola::service
@@ -0,0 +1,143 @@
+#include "LoopWatchdog.h"
+
+namespace meshola::service {
+
+static const char* const LOOP_STAGE_NAMES[] = {
+    "idle",
+    "lock",
+    "protocol",
+    "storage",
+    "publish",
+    "flush"
+};
+static_assert(sizeof(LOOP_STAGE_NAMES) / sizeof(LOOP_STAGE_NAMES[0]) == LOOP_STAGE_COUNT,
+              "LOOP_STAGE_NAMES out of sync with LoopStage");
+
+const char* loopStageName(LoopStage stage) {
+    if (stage >= LoopStage::Count) {
+        return "unknown";
+    }
+    return LOOP_STAGE_NAMES[static_cast<size_t>(stage)];
+}
+
+void LoopWatchdog::beginIteration(uint64_t nowUs) {
+    _iterationStartUs = nowUs;
+    _stageStartUs = nowUs;
+    for (auto& us : _stageUs) {
+        us = 0;
+    }
+    _overranThisIteration = false;
+    _stallReported.store(false, std::memory_order_relaxed);
+    _iterationStartMs.store((uint32_t)(nowUs / 1000), std::memory_order_relaxed);
+    _stage.store(static_cast<uint8_t>(LoopStage::Idle), std::memory_order_release);
+}
+
+void LoopWatchdog::enterStage(LoopStage stage, uint64_t nowUs) {
+    closeStage(nowUs);
+    _stageStartUs = nowUs;
+    _stage.store(static_cast<uint8_t>(stage), std::memory_order_release);
+}
+
+void LoopWatchdog::closeStage(uint64_t nowUs) {
+    auto stage = currentStage();
+    if (stage == LoopStage::Idle || stage >= LoopStage::Count) {
+        return;
+    }
+    uint32_t elapsed = (uint32_t)(nowUs - _stageStartUs);
+    size_t index = static_cast<size_t>(stage);
+    // A stage may be entered more than once (e.g. Storage per message)
+    _stageUs[index] += elapsed;
+
+    uint32_t budget = _budget.stageUs[index];
+    if (budget != 0 && elapsed > budget) {
+        if (_counters) {
+            _counters->stageOverruns[index].add();
+        }
+        recordOverrun(stage, elapsed);
+    }
+}
+
+void LoopWatchdog::recordOverrun(LoopStage stage, uint32_t us) {
+    _overranThisIteration = true;
+    if (_counters) {
+        _counters->lastOverrunStage.set(static_cast<uint32_t>(stage));
+        _counters->lastOverrunUs.set(us);
+    }
+}
+
+bool LoopWatchdog::endIteration(uint64_t nowUs) {
+    closeStage(nowUs);
+    _stage.store(static_cast<uint8_t>(LoopStage::Idle), std::memory_order_release);
+
+    uint32_t total = (uint32_t)(nowUs - _iterationStartUs);
+    uint32_t nowMs = (uint32_t)(nowUs / 1000);
+
+    // Blame the slowest stage of this iteration
+    size_t worst = 0;
+    for (size_t i = 1; i < LOOP_STAGE_COUNT; i++) {
+        if (_stageUs[i] > _stageUs[worst]) {
+            worst = i;
+        }
+    }
+    auto worstStage = static_cast<LoopStage>(worst);
+
+    if (_budget.iterationUs != 0 && total > _budget.iterationUs) {
+        if (_counters) {
+            _counters->iterationOverruns.add();
+        }
+        recordOverrun(worstStage, total);
+    }
+
+    if (_overranThisIteration) {
+        if (nowMs - _windowStartMs > _budget.windowMs) {
+            _windowStartMs = nowMs;
+            _windowOverruns = 0;
+        }
+        _windowOverruns++;
+        _lastOverrunMs = nowMs;
+        if (_budget.degradeOverruns != 0 && _windowOverruns >= _budget.degradeOverruns) {
+            return setDegraded(true, worstStage);
+        }
+        return false;
+    }
+
+    if (isDegraded() && nowMs - _lastOverrunMs >= _budget.windowMs) {
+        _windowOverruns = 0;
+        return setDegraded(false, LoopStage::Idle);
+    }
+    return false;
+}
+
+bool LoopWatchdog::checkStall(uint32_t nowMs) {
+    auto stage = currentStage();
+    if (stage == LoopStage::Idle || _budget.stallMs == 0) {
+        return false;
+    }
+    uint32_t started = _iterationStartMs.load(std::memory_order_relaxed);
+    if (nowMs - started < _budget.stallMs) {
+        return false;
+    }
+    if (_stallReported.exchange(true, std::memory_order_relaxed)) {
+        return false;
+    }
+    if (_counters) {
+        _counters->stalls.add();
+        _counters->lastOverrunStage.set(static_cast<uint32_t>(stage));
+        _counters->lastOverrunUs.set((nowMs - started) * 1000);
+    }
+    return setDegraded(true, stage);
+}
+
+bool LoopWatchdog::setDegraded(bool degraded, LoopStage stage) {
+    _degradedStage.store(static_cast<uint8_t>(stage), std::memory_order_relaxed);
+    bool was = _degraded.exchange(degraded, std::memory_order_acq_rel);
+    if (was == degraded) {
+        return false;
+    }
+    if (degraded && _counters) {
+        _counters->degradations.add();
+    }
+    return true;
+}
+
+} // namespace meshola::service
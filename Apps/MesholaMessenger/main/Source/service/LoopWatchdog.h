@@ -0,0 +1,125 @@
+#pragma once
+
+#include "../diag/Metrics.h"
+#include "ServiceEvents.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace meshola::service {
+
+constexpr size_t LOOP_STAGE_COUNT = static_cast<size_t>(LoopStage::Count);
+
+/**
+ * Time budgets for one mesh thread iteration.
+ *
+ * The SX1262 buffers a single received frame, so an iteration that takes
+ * longer than the shortest expected frame can drop the next one. Defaults
+ * leave headroom for SF7/BW250 traffic.
+ */
+struct LoopBudget {
+    uint32_t iterationUs = 50000;                   // Whole iteration (excluding the idle delay)
+    uint32_t stageUs[LOOP_STAGE_COUNT] = {
+        0,          // Idle (not budgeted)
+        20000,      // LockWait
+        30000,      // Protocol
+        20000,      // Storage
+        10000,      // Publish
+        10000       // Flush
+    };
+    uint32_t stallMs = 1000;            // In-progress iteration older than this = degraded
+    uint32_t degradeOverruns = 3;       // Overrunning iterations within windowMs = degraded
+    uint32_t windowMs = 10000;          // Also the clean period needed to recover
+};
+
+/**
+ * Overrun counters, owned by ServiceMetrics.
+ */
+struct WatchdogCounters {
+    diag::Counter iterationOverruns;
+    diag::Counter stageOverruns[LOOP_STAGE_COUNT];
+    diag::Counter stalls;
+    diag::Counter degradations;
+    diag::Gauge lastOverrunStage;       // LoopStage
+    diag::Gauge lastOverrunUs;
+};
+
+/**
+ * LoopWatchdog - Per-iteration stage timing for the mesh thread.
+ *
+ * The mesh thread brackets each iteration with beginIteration() and
+ * endIteration() and calls enterStage() at every stage boundary. A stage or
+ * iteration that exceeds its budget is counted and remembered; repeated
+ * overruns, or an iteration that is still running after stallMs (checked
+ * from another thread via checkStall()), mark the loop degraded until a
+ * full window passes without overruns.
+ *
+ * begin/enter/endIteration must only be called from the mesh thread.
+ * checkStall(), isDegraded() and degradedStage() are safe from any thread.
+ * Time is passed in by the caller so the class has no platform dependency.
+ */
+class LoopWatchdog {
+public:
+    void setBudget(const LoopBudget& budget) { _budget = budget; }
+    const LoopBudget& getBudget() const { return _budget; }
+
+    void setCounters(WatchdogCounters* counters) { _counters = counters; }
+
+    void beginIteration(uint64_t nowUs);
+
+    /**
+     * Close the current stage (checking its budget) and start the next.
+     */
+    void enterStage(LoopStage stage, uint64_t nowUs);
+
+    /**
+     * Close the iteration. Returns true if the degraded state changed.
+     */
+    bool endIteration(uint64_t nowUs);
+
+    /**
+     * Flag an iteration that has been running for longer than stallMs.
+     * Returns true if this call made the loop degraded.
+     */
+    bool checkStall(uint32_t nowMs);
+
+    bool isDegraded() const { return _degraded.load(std::memory_order_acquire); }
+
+    LoopStage degradedStage() const {
+        return static_cast<LoopStage>(_degradedStage.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * Stage the mesh thread is currently in (Idle between iterations).
+     */
+    LoopStage currentStage() const {
+        return static_cast<LoopStage>(_stage.load(std::memory_order_relaxed));
+    }
+
+private:
+    LoopBudget _budget;
+    WatchdogCounters* _counters = nullptr;
+
+    // Mesh thread only
+    uint64_t _iterationStartUs = 0;
+    uint64_t _stageStartUs = 0;
+    uint32_t _stageUs[LOOP_STAGE_COUNT] = {};
+    bool _overranThisIteration = false;
+    uint32_t _windowStartMs = 0;
+    uint32_t _windowOverruns = 0;
+    uint32_t _lastOverrunMs = 0;
+
+    // Shared with checkStall()
+    std::atomic<uint32_t> _iterationStartMs{0};
+    std::atomic<uint8_t> _stage{0};                 // LoopStage, Idle between iterations
+    std::atomic<bool> _stallReported{false};
+    std::atomic<bool> _degraded{false};
+    std::atomic<uint8_t> _degradedStage{0};
+
+    void closeStage(uint64_t nowUs);
+    void recordOverrun(LoopStage stage, uint32_t us);
+    bool setDegraded(bool degraded, LoopStage stage);
+};
+
+} // namespace meshola::service
@@ -1,11 +1,54 @@
 #include "MesholaMsgService.h"
-#include "../protocol/MeshCoreProtocol.h"
+#include "../protocol/IRadio.h"
+#include "../storage/StateSnapshot.h"
+#include "../diag/Trace.h"
+#include "../util/Clock.h"
 #include "Tactility/Log.h"
+#include "Tactility/hal/Device.h"
+#include "Tactility/hal/power/PowerDevice.h"
+
+#include <algorithm>
+#include <cstring>
 
 namespace meshola::service {
 
 #define TAG "MesholaMsgService"
 
+// ============================================================================
+// Battery
+// ============================================================================
+
+struct BatteryReading {
+    bool known;
+    uint8_t percent;
+    uint16_t millivolts;
+    bool charging;
+};
+
+static BatteryReading readBattery() {
+    using tt::hal::power::PowerDevice;
+    BatteryReading reading = {};
+    auto power = tt::hal::findFirstDevice<PowerDevice>(tt::hal::Device::Type::Power);
+    if (!power) {
+        return reading;
+    }
+    PowerDevice::MetricData data;
+    if (power->supportsMetric(PowerDevice::MetricType::ChargeLevel) &&
+        power->getMetric(PowerDevice::MetricType::ChargeLevel, data)) {
+        reading.known = true;
+        reading.percent = data.valueAsUint8;
+    }
+    if (power->supportsMetric(PowerDevice::MetricType::BatteryVoltage) &&
+        power->getMetric(PowerDevice::MetricType::BatteryVoltage, data)) {
+        reading.millivolts = (uint16_t)data.valueAsUint32;
+    }
+    if (power->supportsMetric(PowerDevice::MetricType::IsCharging) &&
+        power->getMetric(PowerDevice::MetricType::IsCharging, data)) {
+        reading.charging = data.valueAsBool;
+    }
+    return reading;
+}
+
 // ============================================================================
 // Service Manifest
 // ============================================================================
@@ -39,51 +82,33 @@ bool MesholaMsgService::onStart(tt::service::ServiceContext& serviceContext) {
     lock.lock();
     
     setState(ServiceState::Starting);
+    _startedAtMs = clock::millis();
     
     // Get service paths for data storage
     _paths = serviceContext.getPaths();
     
-    // Initialize PubSub channels
+    // Initialize PubSub channels (before anything can publish)
     _messagePubSub = std::make_shared<tt::PubSub<MessageEvent>>();
     _contactPubSub = std::make_shared<tt::PubSub<ContactEvent>>();
+    _contactBatchPubSub = std::make_shared<tt::PubSub<ContactBatchEvent>>();
     _channelPubSub = std::make_shared<tt::PubSub<ChannelEvent>>();
     _statusPubSub = std::make_shared<tt::PubSub<StatusEvent>>();
     _ackPubSub = std::make_shared<tt::PubSub<AckEvent>>();
+    _readyPubSub = std::make_shared<tt::PubSub<ReadyEvent>>();
     
-    // Register built-in protocols
-    MeshCoreProtocol::registerSelf();
-    
-    // Initialize profile manager
+    // Construct only; loading happens in the boot stages
     _profileManager = std::make_unique<ProfileManager>();
-    if (!_profileManager->init()) {
-        TT_LOG_E(TAG, "Failed to initialize ProfileManager");
-        setState(ServiceState::Stopped);
-        return false;
-    }
-    
-    // Initialize message store
     _messageStore = std::make_unique<MessageStore>();
+    _readyStages.store(0, std::memory_order_release);
+    _bootComplete = false;
+    _watchdog.setCounters(&_metrics.watchdog);
     
-    // Get active profile
-    const Profile* profile = _profileManager->getActiveProfile();
-    if (!profile) {
-        TT_LOG_W(TAG, "No active profile, service started but radio not initialized");
-        setState(ServiceState::Running);
-        return true;  // Service OK, just no profile yet
-    }
-    
-    // Configure message store for this profile
-    _messageStore->setActiveProfile(profile->id);
-    
-    // Initialize protocol
-    if (!initializeProtocol(*profile)) {
-        TT_LOG_W(TAG, "Failed to initialize protocol, service started but radio not ready");
-        setState(ServiceState::Running);
-        return true;  // Service OK, protocol failed
-    }
-    
+    // Running now; profiles, storage, radio and contacts come up on the mesh thread
     setState(ServiceState::Running);
-    TT_LOG_I(TAG, "MesholaMsgService started successfully");
+    startMeshThread();
+    
+    TT_LOG_I(TAG, "MesholaMsgService started in %u ms, booting in background",
+             clock::millis() - _startedAtMs);
     
     return true;
 }
@@ -95,13 +120,14 @@ void MesholaMsgService::onStop(tt::service::ServiceContext& serviceContext) {
     
     // Stop radio if running
     stopRadio();
+    stopCapture();
     
     // Clean up
     {
         auto lock = _mutex.asScopedLock();
         lock.lock();
         
-        _protocol.reset();
+        teardownProtocols();
         _messageStore.reset();
         _profileManager.reset();
     }
@@ -130,6 +156,108 @@ ServiceState MesholaMsgService::getState() const {
     return _state;
 }
 
+// ============================================================================
+// Staged Startup
+// ============================================================================
+
+template <typename Fn>
+bool MesholaMsgService::runBootStage(BootStage stage, Fn&& fn) {
+    static const char* const names[] = { "profiles", "storage", "radio", "contacts" };
+    const size_t index = static_cast<size_t>(stage);
+    
+    uint32_t startMs = clock::millis();
+    bool ok = _threadRunning && fn();
+    uint32_t durationMs = clock::millis() - startMs;
+    
+    _metrics.bootStageMs[index].set(durationMs);
+    uint32_t ready = ok
+        ? _readyStages.fetch_or(bootStageBit(stage), std::memory_order_acq_rel) | bootStageBit(stage)
+        : _readyStages.load(std::memory_order_acquire);
+    
+    if (ok) {
+        TT_LOG_I(TAG, "Boot stage %s ready in %u ms", names[index], durationMs);
+    } else {
+        TT_LOG_W(TAG, "Boot stage %s failed after %u ms", names[index], durationMs);
+    }
+    
+    ReadyEvent event = {
+        .stage = stage,
+        .success = ok,
+        .durationMs = durationMs,
+        .readyStages = ready
+    };
+    _readyPubSub->publish(event);
+    return ok;
+}
+
+void MesholaMsgService::runBootStages() {
+    const Profile* profile = nullptr;
+    
+    bool ok = runBootStage(BootStage::Profiles, [&]() {
+        auto lock = _mutex.asScopedLock();
+        lock.lock();
+        // May generate keys and write JSON on first boot
+        if (!_profileManager->init()) {
+            TT_LOG_E(TAG, "Failed to initialize ProfileManager");
+            return false;
+        }
+        profile = _profileManager->getActiveProfile();
+        if (!profile) {
+            TT_LOG_W(TAG, "No active profile, radio not initialized");
+        }
+        return profile != nullptr;
+    });
+    
+    ok = ok && runBootStage(BootStage::Storage, [&]() {
+        auto lock = _mutex.asScopedLock();
+        lock.lock();
+        _messageStore->setActiveProfile(profile->id);
+        return true;
+    });
+    
+    ok = ok && runBootStage(BootStage::Radio, [&]() {
+        auto lock = _mutex.asScopedLock();
+        lock.lock();
+        if (!initializeProtocol(*profile)) {
+            TT_LOG_W(TAG, "Failed to initialize protocol, radio not ready");
+            return false;
+        }
+        if (!_protocol->start()) {
+            TT_LOG_E(TAG, "Protocol start failed");
+            return false;
+        }
+        if (_companion && !_companion->start()) {
+            TT_LOG_W(TAG, "Companion protocol start failed");
+        }
+        return true;
+    });
+    
+    ok = ok && runBootStage(BootStage::Contacts, [&]() {
+        return publishLoadedContacts();
+    });
+    
+    _metrics.bootTotalMs.set(clock::millis() - _startedAtMs);
+    _bootComplete = true;
+    flushCoalescedEvents(true);
+    
+    if (getReadyStages() == BOOT_STAGES_ALL) {
+        TT_LOG_I(TAG, "Boot complete in %u ms", _metrics.bootTotalMs.get());
+    }
+}
+
+bool MesholaMsgService::publishLoadedContacts() {
+    auto lock = _mutex.asScopedLock();
+    lock.lock();
+    if (!_protocol) {
+        return false;
+    }
+    // initializeProtocol() loaded the saved state before start(); apps
+    // opened during boot re-read contacts and status
+    _coalescer.markFullRefresh();
+    _coalescer.markStatus(StatusFieldAll);
+    return true;
+}
+
 // ============================================================================
 // Protocol Initialization
 // ============================================================================
@@ -137,47 +265,189 @@ ServiceState MesholaMsgService::getState() const {
 bool MesholaMsgService::initializeProtocol(const Profile& profile) {
     TT_LOG_I(TAG, "Initializing protocol: %s", profile.protocolId);
     
+    teardownProtocols();
+    
+    // A companion profile shares the radio through an arbiter
+    const Profile* companion = nullptr;
+    if (profile.companionProfileId[0] != '\0' && strcmp(profile.companionProfileId, profile.id) != 0) {
+        companion = _profileManager->findProfileById(profile.companionProfileId);
+        if (!companion) {
+            TT_LOG_W(TAG, "Companion profile %s not found", profile.companionProfileId);
+        }
+    }
+    if (companion) {
+        auto radio = createPlatformRadio();
+        if (radio) {
+            _arbiter = std::make_unique<RadioArbiter>(std::move(radio));
+            _arbiter->setCounters(&_metrics.arbiter);
+        }
+    }
+    
     // Create protocol instance
-    _protocol.reset(ProtocolRegistry::createProtocol(profile.protocolId));
+    if (_arbiter) {
+        _protocol.reset(ProtocolRegistry::createProtocol(profile.protocolId,
+                                                         _arbiter->createClient(profile.airtimeSharePercent)));
+    } else {
+        _protocol.reset(ProtocolRegistry::createProtocol(profile.protocolId));
+    }
     if (!_protocol) {
         TT_LOG_E(TAG, "Failed to create protocol: %s", profile.protocolId);
+        teardownProtocols();
         return false;
     }
     
-    _currentProtocolId = profile.protocolId;
+    strncpy(_currentProtocolId, profile.protocolId, sizeof(_currentProtocolId) - 1);
+    _currentProtocolId[sizeof(_currentProtocolId) - 1] = '\0';
+    _protocol->setCounters(&_metrics.protocol);
+    _protocol->setCapture(_capture.get());
     
     // Set node name
-    _protocol->setNodeName(profile.nodeName);
-    _protocol->setLocalIdentity(profile.publicKey, profile.nodeName);
-    
-    // Wire up callbacks
-    _protocol->setMessageCallback([this](const Message& msg) {
-        onMessageReceived(msg);
-    });
-    
-    _protocol->setContactCallback([this](const Contact& contact, bool isNew) {
-        onContactDiscovered(contact, isNew);
-    });
+    applyProfileIdentity(profile);
     
-    _protocol->setStatusCallback([this](const NodeStatus& status) {
-        onStatusChanged(status);
-    });
+    wireCallbacks(*_protocol, ProtocolSlot::Primary);
     
-    _protocol->setAckCallback([this](uint32_t ackId, bool success) {
-        onAckReceived(ackId, success);
-    });
+    // Before start(): restored contacts spare the startup advert
+    _protocol->loadState();
     
     // Initialize with radio config
     if (!_protocol->init(profile.radio)) {
         TT_LOG_E(TAG, "Failed to initialize protocol with radio config");
-        _protocol.reset();
+        teardownProtocols();
         return false;
     }
     
     TT_LOG_I(TAG, "Protocol initialized: %s", profile.protocolId);
+    
+    // The active profile keeps running if its companion cannot start
+    if (companion && !initializeCompanion(*companion, profile.airtimeSharePercent)) {
+        TT_LOG_W(TAG, "Companion profile %s not started", companion->id);
+    }
+    return true;
+}
+
+bool MesholaMsgService::initializeCompanion(const Profile& companion, uint8_t primaryShare) {
+    TT_LOG_I(TAG, "Initializing companion protocol: %s (%s)", companion.protocolId, companion.id);
+    
+    if (_arbiter) {
+        _companion.reset(ProtocolRegistry::createProtocol(companion.protocolId,
+                                                          _arbiter->createClient(100 - primaryShare)));
+    } else {
+        // Host builds without a platform radio
+        _companion.reset(ProtocolRegistry::createProtocol(companion.protocolId));
+    }
+    if (!_companion) {
+        TT_LOG_E(TAG, "Failed to create companion protocol: %s", companion.protocolId);
+        return false;
+    }
+    
+    _companion->setCounters(&_metrics.protocol);
+    _companion->setNodeName(companion.nodeName);
+    _companion->setLocalIdentity(companion.publicKey, companion.nodeName);
+    _companion->setSigningKey(companion.hasKeys ? companion.privateKey : nullptr);
+    applyStatePath(*_companion, companion.id);
+    wireCallbacks(*_companion, ProtocolSlot::Companion);
+    _companion->loadState();
+    
+    if (!_companion->init(companion.radio)) {
+        TT_LOG_E(TAG, "Failed to initialize companion protocol with radio config");
+        _companion.reset();
+        return false;
+    }
+    
+    _companionStore = std::make_unique<MessageStore>();
+    _companionStore->setActiveProfile(companion.id);
     return true;
 }
 
+void MesholaMsgService::teardownProtocols() {
+    // Protocols first: their radios are arbiter clients
+    _companion.reset();
+    _companionStore.reset();
+    _protocol.reset();
+    _arbiter.reset();
+}
+
+void MesholaMsgService::wireCallbacks(IProtocol& protocol, ProtocolSlot slot) {
+    protocol.setMessageCallback([this, slot](const Message& msg) {
+        onMessageReceived(msg, slot);
+    });
+    
+    protocol.setContactCallback([this, slot](const Contact& contact, bool isNew) {
+        onContactDiscovered(contact, isNew, slot);
+    });
+    
+    protocol.setStatusCallback([this](const NodeStatus& status) {
+        onStatusChanged(status);
+    });
+    
+    protocol.setAckCallback([this, slot](uint32_t ackId, bool success) {
+        onAckReceived(ackId, success, slot);
+    });
+
+    protocol.setTransmitCallback([this, slot](uint32_t ackId, bool success) {
+        onTransmitDone(ackId, success, slot);
+    });
+}
+
+/**
+ * Call fn(protocol, slot) for the active profile's protocol, then the
+ * companion's, until fn returns false. Caller holds _mutex.
+ */
+template <typename Fn>
+void MesholaMsgService::forEachProtocol(Fn&& fn) const {
+    if (_protocol && !fn(*_protocol, ProtocolSlot::Primary)) {
+        return;
+    }
+    if (_companion) {
+        fn(*_companion, ProtocolSlot::Companion);
+    }
+}
+
+IProtocol* MesholaMsgService::findContactOwner(const uint8_t publicKey[PUBLIC_KEY_SIZE],
+                                               Contact& out, ProtocolSlot& slot) const {
+    IProtocol* owner = nullptr;
+    forEachProtocol([&](IProtocol& protocol, ProtocolSlot protocolSlot) {
+        if (protocol.findContact(publicKey, out)) {
+            owner = &protocol;
+            slot = protocolSlot;
+        }
+        return owner == nullptr;
+    });
+    return owner;
+}
+
+IProtocol* MesholaMsgService::findChannelOwner(const uint8_t channelId[CHANNEL_ID_SIZE],
+                                               Channel& out, ProtocolSlot& slot) const {
+    IProtocol* owner = nullptr;
+    forEachProtocol([&](IProtocol& protocol, ProtocolSlot protocolSlot) {
+        if (protocol.findChannel(channelId, out)) {
+            owner = &protocol;
+            slot = protocolSlot;
+        }
+        return owner == nullptr;
+    });
+    return owner;
+}
+
+MessageStore* MesholaMsgService::storeFor(ProtocolSlot slot) const {
+    return slot == ProtocolSlot::Companion ? _companionStore.get() : _messageStore.get();
+}
+
+void MesholaMsgService::applyProfileIdentity(const Profile& profile) {
+    _protocol->setNodeName(profile.nodeName);
+    _protocol->setLocalIdentity(profile.publicKey, profile.nodeName);
+    _protocol->setSigningKey(profile.hasKeys ? profile.privateKey : nullptr);
+    applyStatePath(*_protocol, profile.id);
+}
+
+void MesholaMsgService::applyStatePath(IProtocol& protocol, const char* profileId) {
+    char dataPath[128];
+    _profileManager->getProfileDataPath(profileId, dataPath, sizeof(dataPath));
+    char statePath[SNAPSHOT_MAX_PATH_LEN];
+    snprintf(statePath, sizeof(statePath), "%s/%s", dataPath, STATE_FILE_NAME);
+    protocol.setStatePath(statePath);
+}
+
 // ============================================================================
 // Radio Control
 // ============================================================================
@@ -203,23 +473,47 @@ bool MesholaMsgService::startRadio() {
         TT_LOG_E(TAG, "Protocol start failed");
         return false;
     }
+    if (_companion && !_companion->start()) {
+        TT_LOG_W(TAG, "Companion protocol start failed");
+    }
     
     // Start background thread
+    _readyStages.fetch_or(bootStageBit(BootStage::Radio), std::memory_order_acq_rel);
+    startMeshThread();
+    
+    // Boot stopped at the radio: finish the stages it skipped
+    if (!isReady(BootStage::Contacts) &&
+        runBootStage(BootStage::Contacts, [&]() { return publishLoadedContacts(); }) &&
+        getReadyStages() == BOOT_STAGES_ALL) {
+        _metrics.bootTotalMs.set(clock::millis() - _startedAtMs);
+        TT_LOG_I(TAG, "Boot complete in %u ms", _metrics.bootTotalMs.get());
+    }
+    
+    TT_LOG_I(TAG, "Radio started");
+    publishStatusEvent();
+    
+    return true;
+}
+
+void MesholaMsgService::startMeshThread() {
+    // Reap a thread that exited on its own (e.g. boot without radio)
+    if (_meshThread) {
+        _meshThread->join();
+        _meshThread.reset();
+    }
+    // Fresh protocol state: re-plan and re-apply the RX schedule
+    _power = PowerScheduler();
+    _power.setPolicy(getPowerPolicy());
     _threadRunning = true;
     _meshThread = std::make_unique<tt::Thread>(
         "MesholaMsgService",
-        8192,  // Stack size
+        10240,  // Stack size: RX frame, Message and fragment framing buffers
         [this]() -> int32_t {
             meshThreadMain();
             return 0;
         }
     );
     _meshThread->start();
-    
-    TT_LOG_I(TAG, "Radio started");
-    publishStatusEvent();
-    
-    return true;
 }
 
 void MesholaMsgService::stopRadio() {
@@ -239,6 +533,9 @@ void MesholaMsgService::stopRadio() {
         auto lock = _mutex.asScopedLock();
         lock.lock();
         
+        if (_companion) {
+            _companion->stop();
+        }
         if (_protocol) {
             _protocol->stop();
         }
@@ -249,50 +546,153 @@ void MesholaMsgService::stopRadio() {
 }
 
 bool MesholaMsgService::isRadioRunning() const {
-    return _threadRunning;
+    return _threadRunning && isReady(BootStage::Radio);
 }
 
 void MesholaMsgService::meshThreadMain() {
     TT_LOG_I(TAG, "Mesh thread started");
     
+    if (!_bootComplete) {
+        runBootStages();
+        if (!isReady(BootStage::Radio)) {
+            // Service stays up without radio; startRadio() can retry later
+            _threadRunning = false;
+            publishStatusEvent(StatusFieldRadio);
+            TT_LOG_I(TAG, "Mesh thread exiting (radio not ready)");
+            return;
+        }
+    }
+    
+    uint32_t lastMetricsLogMs = clock::millis();
+    
     while (_threadRunning) {
+        if (_loopBudgetChanged.exchange(false)) {
+            auto lock = _stateMutex.asScopedLock();
+            lock.lock();
+            _watchdog.setBudget(_pendingLoopBudget);
+        }
+        _watchdog.beginIteration(clock::micros());
+        
         {
             auto lock = _mutex.asScopedLock();
+            uint64_t waitStart = clock::micros();
+            _watchdog.enterStage(LoopStage::LockWait, waitStart);
             lock.lock();
+            uint64_t loopStart = clock::micros();
+            _metrics.mutexWaitUs.record((uint32_t)(loopStart - waitStart));
+            _watchdog.enterStage(LoopStage::Protocol, loopStart);
             
             if (_protocol) {
+                MESHOLA_TRACE_SCOPE(MeshLoop);
+                if (_arbiter) {
+                    _arbiter->tick(clock::millis());
+                }
                 _protocol->loop();
+                if (_companion) {
+                    _companion->loop();
+                }
+                _metrics.loopUs.record((uint32_t)(clock::micros() - loopStart));
+            }
+        }
+        
+        // Publish merged contact/status updates once per window
+        _watchdog.enterStage(LoopStage::Flush, clock::micros());
+        flushCoalescedEvents(false);
+        
+        if (_watchdog.endIteration(clock::micros())) {
+            publishHealthEvent();
+        }
+        
+        uint32_t nowMs = clock::millis();
+        _power.setPolicy(getPowerPolicy());
+        if (_power.isDue(nowMs)) {
+            updatePowerPlan(nowMs);
+        }
+        
+        if (_metricsLogIntervalMs != 0) {
+            uint32_t now = clock::millis();
+            if (now - lastMetricsLogMs >= _metricsLogIntervalMs) {
+                lastMetricsLogMs = now;
+                logMetrics();
             }
         }
         
-        // Small delay to prevent tight loop
-        tt::kernel::delayMillis(10);
+        // Longer when duty cycling so the CPU can idle too
+        tt::kernel::delayMillis(_power.getPlan().pollMs);
     }
     
     TT_LOG_I(TAG, "Mesh thread exiting");
 }
 
+void MesholaMsgService::updatePowerPlan(uint32_t nowMs) {
+    BatteryReading battery = readBattery();
+    PowerInputs inputs = {
+        .batteryKnown = battery.known,
+        .batteryPercent = battery.percent,
+        .charging = battery.charging,
+        .rxPackets = _metrics.protocol.rxPackets.get()
+    };
+    
+    auto lock = _mutex.asScopedLock();
+    lock.lock();
+    if (!_protocol) {
+        return;
+    }
+    
+    if (_power.evaluate(nowMs, inputs, _protocol->getRadioConfig())) {
+        const PowerPlan& plan = _power.getPlan();
+        if (!_protocol->setRxDutyCycle(plan.rxPeriodUs, plan.sleepPeriodUs)) {
+            TT_LOG_W(TAG, "Failed to apply RX duty cycle");
+        }
+        if (_companion) {
+            _companion->setRxDutyCycle(plan.rxPeriodUs, plan.sleepPeriodUs);
+        }
+        _metrics.powerPlanChanges.add();
+        if (plan.sleepPeriodUs != 0) {
+            TT_LOG_I(TAG, "RX duty cycle %lu/%lu us, est %lu uA",
+                     (unsigned long)plan.rxPeriodUs,
+                     (unsigned long)plan.sleepPeriodUs,
+                     (unsigned long)plan.radioCurrentUa);
+        } else {
+            TT_LOG_I(TAG, "Continuous RX");
+        }
+    }
+    
+    const PowerPlan& plan = _power.getPlan();
+    uint32_t cycleUs = plan.rxPeriodUs + plan.sleepPeriodUs;
+    _metrics.rxDutyPermille.set(plan.sleepPeriodUs != 0
+        ? (uint32_t)((uint64_t)plan.rxPeriodUs * 1000 / cycleUs)
+        : 1000);
+    _metrics.radioCurrentUa.set(plan.radioCurrentUa);
+    _metrics.powerSavedUa.set(PowerScheduler::RX_CURRENT_UA - plan.radioCurrentUa);
+    _metrics.rxPerMinute.set(_power.getRxPerMinute());
+}
+
 // ============================================================================
 // Protocol Callbacks
 // ============================================================================
 
-void MesholaMsgService::onMessageReceived(const Message& msg) {
+void MesholaMsgService::onMessageReceived(const Message& msg, ProtocolSlot slot) {
     TT_LOG_D(TAG, "Message received from %s", msg.senderName);
     
+    // Only called from protocol->loop() on the mesh thread
+    _watchdog.enterStage(LoopStage::Storage, clock::micros());
+    
     // Persist to storage
-    if (_messageStore) {
-        _messageStore->appendMessage(msg);
-    }
+    storeMessage(msg, slot);
     
     // Publish event to subscribers
-    publishMessageEvent(msg, true, true);
+    _watchdog.enterStage(LoopStage::Publish, clock::micros());
+    publishMessageEvent(msg, true, true, slot);
+    
+    _watchdog.enterStage(LoopStage::Protocol, clock::micros());
 }
 
-void MesholaMsgService::onContactDiscovered(const Contact& contact, bool isNew) {
+void MesholaMsgService::onContactDiscovered(const Contact& contact, bool isNew, ProtocolSlot slot) {
     TT_LOG_D(TAG, "Contact %s: %s", isNew ? "discovered" : "updated", contact.name);
     
-    // Publish event to subscribers
-    publishContactEvent(contact, isNew);
+    // Coalesced; published from the mesh thread once per window
+    queueContactEvent(contact, isNew, slot);
 }
 
 void MesholaMsgService::onStatusChanged(const NodeStatus& status) {
@@ -300,48 +700,304 @@ void MesholaMsgService::onStatusChanged(const NodeStatus& status) {
              status.radioRunning ? "on" : "off",
              status.batteryPercent,
              status.freeHeap);
-    publishStatusEvent();
+    
+    // Coalesced like contact updates; published from the mesh thread
+    auto lock = _mutex.asScopedLock();
+    lock.lock();
+    _coalescer.markStatus(StatusFieldRadio | StatusFieldNode);
 }
 
-void MesholaMsgService::onAckReceived(uint32_t ackId, bool success) {
+void MesholaMsgService::onAckReceived(uint32_t ackId, bool success, ProtocolSlot slot) {
     TT_LOG_D(TAG, "ACK %u: %s", ackId, success ? "success" : "failed");
     
     AckEvent event = {
         .ackId = ackId,
-        .success = success
+        .success = success,
+        .slot = slot
     };
     _ackPubSub->publish(event);
 }
 
+void MesholaMsgService::onTransmitDone(uint32_t ackId, bool success, ProtocolSlot slot) {
+    // sendMessage() already returned; a DM frame that never made it on air
+    // fails the message like a missing ACK would
+    if (success || ackId == 0) {
+        return;
+    }
+    TT_LOG_W(TAG, "DM %u failed to transmit", ackId);
+    onAckReceived(ackId, false, slot);
+}
+
 // ============================================================================
 // Publish Helpers
 // ============================================================================
 
-void MesholaMsgService::publishMessageEvent(const Message& msg, bool isIncoming, bool isNew) {
+void MesholaMsgService::storeMessage(const Message& msg, ProtocolSlot slot) {
+    MessageStore* store = storeFor(slot);
+    if (!store) {
+        return;
+    }
+    MESHOLA_TRACE_SCOPE(AppendMessage);
+    uint64_t start = clock::micros();
+    bool ok = store->appendMessage(msg);
+    _metrics.storageUs.record((uint32_t)(clock::micros() - start));
+    if (ok) {
+        _metrics.messagesStored.add();
+    } else {
+        _metrics.storageErrors.add();
+    }
+}
+
+void MesholaMsgService::publishMessageEvent(const Message& msg, bool isIncoming, bool isNew,
+                                            ProtocolSlot slot) {
     MessageEvent event = {
         .message = msg,
         .isIncoming = isIncoming,
-        .isNew = isNew
+        .isNew = isNew,
+        .slot = slot
     };
+    MESHOLA_TRACE_SCOPE(Publish);
     _messagePubSub->publish(event);
+    _metrics.messagesPublished.add();
 }
 
-void MesholaMsgService::publishContactEvent(const Contact& contact, bool isNew) {
+void MesholaMsgService::publishContactEvent(const Contact& contact, bool isNew, ProtocolSlot slot) {
     ContactEvent event = {
         .contact = contact,
-        .isNew = isNew
+        .isNew = isNew,
+        .slot = slot
     };
     _contactPubSub->publish(event);
 }
 
-void MesholaMsgService::publishStatusEvent() {
+void MesholaMsgService::publishStatusEvent(uint32_t changedFields) {
+    if (!_statusPubSub) {
+        return;  // Not started yet
+    }
     StatusEvent event = {
-        .radioRunning = _threadRunning,
+        .radioRunning = isRadioRunning(),
         .contactCount = getContactCount(),
         .channelCount = getChannelCount(),
-        .nodeStatus = getNodeStatus()
+        .nodeStatus = getNodeStatus(),
+        .degraded = _watchdog.isDegraded(),
+        .degradedStage = _watchdog.degradedStage(),
+        .changedFields = changedFields
     };
+    {
+        auto lock = _stateMutex.asScopedLock();
+        lock.lock();
+        _lastStatus = event;
+    }
     _statusPubSub->publish(event);
+    _metrics.statusEvents.add();
+}
+
+void MesholaMsgService::publishHealthEvent() {
+    if (!_statusPubSub) {
+        return;
+    }
+    // Reuse the last counts: the mesh thread may be stuck holding _mutex
+    StatusEvent event;
+    {
+        auto lock = _stateMutex.asScopedLock();
+        lock.lock();
+        event = _lastStatus;
+    }
+    event.degraded = _watchdog.isDegraded();
+    event.degradedStage = _watchdog.degradedStage();
+    event.changedFields = StatusFieldHealth;
+    
+    if (event.degraded) {
+        TT_LOG_W(TAG, "Mesh loop degraded (stage: %s)", loopStageName(event.degradedStage));
+    } else {
+        TT_LOG_I(TAG, "Mesh loop recovered");
+    }
+    _statusPubSub->publish(event);
+    _metrics.statusEvents.add();
+}
+
+// ============================================================================
+// Event Coalescing
+// ============================================================================
+
+void MesholaMsgService::queueContactEvent(const Contact& contact, bool isNew, ProtocolSlot slot) {
+    auto lock = _mutex.asScopedLock();
+    lock.lock();
+    
+    _coalescer.addContact(contact, isNew, slot);
+    if (isNew) {
+        _coalescer.markStatus(StatusFieldContacts);
+    }
+    _metrics.eventQueueDepth.set((uint32_t)_coalescer.pendingContactCount());
+}
+
+void MesholaMsgService::flushCoalescedEvents(bool force) {
+    ContactBatchEvent batch = {};
+    bool hasBatch = false;
+    uint32_t statusFields = 0;
+    
+    {
+        auto lock = _mutex.asScopedLock();
+        lock.lock();
+        
+        uint32_t now = clock::millis();
+        if (!_coalescer.hasPending() || (!force && !_coalescer.isDue(now))) {
+            return;
+        }
+        hasBatch = _coalescer.takeContacts(batch);
+        statusFields = _coalescer.takeStatus();
+        _coalescer.markFlushed(now);
+        _metrics.eventQueueDepth.set(0);
+    }
+    
+    // Publish outside the lock so slow subscribers don't stall the radio
+    if (hasBatch) {
+        for (const auto& event : batch.contacts) {
+            publishContactEvent(event.contact, event.isNew, event.slot);
+        }
+        _contactBatchPubSub->publish(batch);
+        _metrics.contactBatches.add();
+    }
+    if (statusFields != 0) {
+        publishStatusEvent(statusFields);
+    }
+}
+
+void MesholaMsgService::publishContactNow(const Contact& contact, ProtocolSlot slot) {
+    // Outside the lock, as in flushCoalescedEvents(); other pending
+    // updates keep waiting for their window
+    ContactBatchEvent batch = {};
+    batch.contacts.push_back(ContactEvent{
+        .contact = contact,
+        .isNew = false,
+        .slot = slot
+    });
+    publishContactEvent(contact, false, slot);
+    _contactBatchPubSub->publish(batch);
+    _metrics.contactBatches.add();
+}
+
+void MesholaMsgService::setEventCoalesceWindow(uint32_t windowMs) {
+    auto lock = _mutex.asScopedLock();
+    lock.lock();
+    _coalescer.setWindow(windowMs);
+}
+
+uint32_t MesholaMsgService::getEventCoalesceWindow() const {
+    auto lock = _mutex.asScopedLock();
+    lock.lock();
+    return _coalescer.getWindow();
+}
+
+// ============================================================================
+// Metrics
+// ============================================================================
+
+MetricsSnapshot MesholaMsgService::getMetrics() const {
+    return takeSnapshot(_metrics, clock::millis() - _startedAtMs, _watchdog.isDegraded());
+}
+
+// ============================================================================
+// Loop Watchdog
+// ============================================================================
+
+void MesholaMsgService::setLoopBudget(const LoopBudget& budget) {
+    auto lock = _stateMutex.asScopedLock();
+    lock.lock();
+    _pendingLoopBudget = budget;
+    _loopBudgetChanged = true;
+}
+
+LoopBudget MesholaMsgService::getLoopBudget() const {
+    auto lock = _stateMutex.asScopedLock();
+    lock.lock();
+    return _pendingLoopBudget;
+}
+
+void MesholaMsgService::checkWatchdog() {
+    if (_threadRunning && _watchdog.checkStall(clock::millis())) {
+        publishHealthEvent();
+    }
+}
+
+bool MesholaMsgService::dumpTrace(const char* path) const {
+    if (!path) {
+        path = TRACE_DUMP_PATH;
+    }
+    bool ok = diag::Trace::dump(path);
+    if (ok) {
+        TT_LOG_I(TAG, "Trace written to %s", path);
+    } else {
+        TT_LOG_W(TAG, "Trace dump failed (MESHOLA_TRACE=%d)", MESHOLA_TRACE);
+    }
+    return ok;
+}
+
+bool MesholaMsgService::startCapture(const char* path) {
+    if (!path) {
+        path = CAPTURE_PATH;
+    }
+    
+    auto lock = _mutex.asScopedLock();
+    lock.lock();
+    
+    if (!_protocol) {
+        TT_LOG_W(TAG, "Cannot capture: no protocol");
+        return false;
+    }
+    if (_capture) {
+        _protocol->setCapture(nullptr);
+        _capture.reset();
+    }
+    
+    auto capture = std::make_unique<diag::PacketCapture>();
+    if (!capture->open(path, _protocol->getRadioConfig())) {
+        TT_LOG_E(TAG, "Failed to open capture %s", path);
+        return false;
+    }
+    _capture = std::move(capture);
+    _protocol->setCapture(_capture.get());
+    TT_LOG_I(TAG, "Capturing RX frames to %s", path);
+    return true;
+}
+
+void MesholaMsgService::stopCapture() {
+    auto lock = _mutex.asScopedLock();
+    lock.lock();
+    
+    if (!_capture) {
+        return;
+    }
+    if (_protocol) {
+        _protocol->setCapture(nullptr);
+    }
+    _capture->close();
+    TT_LOG_I(TAG, "Capture stopped: %lu frames, %lu dropped",
+             (unsigned long)_capture->getRecordCount(),
+             (unsigned long)_capture->getDroppedCount());
+    _capture.reset();
+}
+
+bool MesholaMsgService::isCapturing() const {
+    auto lock = _mutex.asScopedLock();
+    lock.lock();
+    return _capture != nullptr;
+}
+
+void MesholaMsgService::logMetrics() const {
+    char dump[1536];
+    formatMetrics(getMetrics(), dump, sizeof(dump));
+    
+    // One log line per metrics group
+    char* line = dump;
+    while (line && *line) {
+        char* next = strchr(line, '\n');
+        if (next) {
+            *next++ = '\0';
+        }
+        TT_LOG_I(TAG, "metrics %s", line);
+        line = next;
+    }
 }
 
 // ============================================================================
@@ -365,6 +1021,13 @@ const Profile* MesholaMsgService::getActiveProfile() const {
 bool MesholaMsgService::switchProfile(const char* profileId, bool restartRadio) {
     TT_LOG_I(TAG, "Switching to profile: %s", profileId);
     
+    if (canHotSwitchProfile(profileId)) {
+        if (hotSwitchProfile(profileId)) {
+            return true;
+        }
+        TT_LOG_W(TAG, "Hot switch failed, restarting radio");
+    }
+    
     bool wasRunning = _threadRunning;
     
     // Stop radio if running
@@ -385,6 +1048,9 @@ bool MesholaMsgService::switchProfile(const char* profileId, bool restartRadio)
         // Update message store
         _messageStore->setActiveProfile(profileId);
         
+        // Pending events belong to the old profile
+        _coalescer.clear();
+        
         // Get new profile
         const Profile* profile = _profileManager->getActiveProfile();
         if (!profile) {
@@ -407,6 +1073,123 @@ bool MesholaMsgService::switchProfile(const char* profileId, bool restartRadio)
     return true;
 }
 
+bool MesholaMsgService::canHotSwitchProfile(const char* profileId) const {
+    auto lock = _mutex.asScopedLock();
+    lock.lock();
+    
+    if (!_threadRunning || !_protocol || !_profileManager || !profileId) {
+        return false;
+    }
+    const Profile* target = _profileManager->findProfileById(profileId);
+    // A companion on either side changes the radio layout: rebuild
+    return target && strcmp(target->protocolId, _currentProtocolId) == 0 &&
+           !_companion && target->companionProfileId[0] == '\0';
+}
+
+bool MesholaMsgService::hotSwitchProfile(const char* profileId) {
+    uint32_t startMs = clock::millis();
+    
+    // Prepare the new store before taking the lock (may touch the filesystem)
+    auto store = std::make_unique<MessageStore>();
+    store->setActiveProfile(profileId);
+    
+    {
+        auto lock = _mutex.asScopedLock();
+        lock.lock();
+        
+        // Check and retune first: if either fails nothing has switched yet,
+        // and the cold path in switchProfile() starts from the old profile
+        const Profile* target = _profileManager->findProfileById(profileId);
+        if (!target || !isValidRadioConfig(target->radio)) {
+            TT_LOG_E(TAG, "Profile %s has no usable radio config", profileId);
+            return false;
+        }
+        RadioConfig previous = _protocol->getRadioConfig();
+        if (!_protocol->setRadioConfig(target->radio)) {
+            return false;
+        }
+        
+        // Persist contacts/channels of the outgoing profile
+        _protocol->saveState();
+        
+        if (!_profileManager->setActiveProfile(profileId)) {
+            TT_LOG_E(TAG, "Failed to switch profile");
+            _protocol->setRadioConfig(previous);
+            return false;
+        }
+        const Profile* profile = _profileManager->getActiveProfile();
+        if (!profile) {
+            return false;
+        }
+        
+        // Mesh loop is blocked on _mutex, so RX resumes against the new
+        // profile as a whole: RF settings, identity, state and store
+        _protocol->resetProfileState();
+        applyProfileIdentity(*profile);
+        _protocol->loadState();
+        _messageStore.swap(store);
+        
+        // Pending events belong to the old profile; subscribers re-read everything
+        _coalescer.clear();
+        _coalescer.markFullRefresh();
+        _coalescer.markStatus(StatusFieldAll);
+    }
+    
+    // Old store (now in `store`) is released outside the lock
+    store.reset();
+    flushCoalescedEvents(true);
+    
+    TT_LOG_I(TAG, "Hot profile switch to %s in %u ms", profileId, clock::millis() - startMs);
+    return true;
+}
+
+// ============================================================================
+// Companion Profile
+// ============================================================================
+
+bool MesholaMsgService::setCompanionProfile(const char* profileId, uint8_t airtimeSharePercent) {
+    char activeId[PROFILE_ID_LEN];
+    {
+        auto lock = _mutex.asScopedLock();
+        lock.lock();
+        
+        Profile* profile = _profileManager ? _profileManager->getActiveProfileMutable() : nullptr;
+        if (!profile) {
+            return false;
+        }
+        bool remove = !profileId || profileId[0] == '\0';
+        if (!remove && (strcmp(profileId, profile->id) == 0 || !_profileManager->findProfileById(profileId))) {
+            TT_LOG_E(TAG, "Invalid companion profile: %s", profileId);
+            return false;
+        }
+        
+        memset(profile->companionProfileId, 0, sizeof(profile->companionProfileId));
+        if (!remove) {
+            strncpy(profile->companionProfileId, profileId, sizeof(profile->companionProfileId) - 1);
+        }
+        profile->airtimeSharePercent = std::clamp<uint8_t>(airtimeSharePercent, 10, 90);
+        _profileManager->saveActiveProfile();
+        
+        strncpy(activeId, profile->id, sizeof(activeId) - 1);
+        activeId[sizeof(activeId) - 1] = '\0';
+    }
+    
+    // Rebuild both protocols and the arbiter around the new pairing
+    return switchProfile(activeId);
+}
+
+bool MesholaMsgService::hasCompanion() const {
+    auto lock = _mutex.asScopedLock();
+    lock.lock();
+    return _companion != nullptr;
+}
+
+bool MesholaMsgService::isRadioShared() const {
+    auto lock = _mutex.asScopedLock();
+    lock.lock();
+    return !_arbiter || _arbiter->isShared();
+}
+
 // ============================================================================
 // Messaging
 // ============================================================================
@@ -422,15 +1205,17 @@ bool MesholaMsgService::sendMessage(const uint8_t recipientKey[PUBLIC_KEY_SIZE],
         return false;
     }
     
-    // Find the contact
+    // Find the contact and the protocol that knows it
     Contact recipient;
-    if (!_protocol->findContact(recipientKey, recipient)) {
+    ProtocolSlot slot = ProtocolSlot::Primary;
+    IProtocol* protocol = findContactOwner(recipientKey, recipient, slot);
+    if (!protocol) {
         TT_LOG_E(TAG, "Cannot send: recipient not found");
         return false;
     }
     
     // Send via protocol
-    outAckId = _protocol->sendMessage(recipient, text);
+    outAckId = protocol->sendMessage(recipient, text);
     if (outAckId == 0) {
         return false;
     }
@@ -438,8 +1223,8 @@ bool MesholaMsgService::sendMessage(const uint8_t recipientKey[PUBLIC_KEY_SIZE],
     // Create message record for our sent message
     Message sentMsg = {};
     sentMsg.type = MessageType::Direct;
-    memcpy(sentMsg.senderKey, _profileManager->getActiveProfile()->publicKey, PUBLIC_KEY_SIZE);
-    strncpy(sentMsg.senderName, _protocol->getNodeName(), sizeof(sentMsg.senderName) - 1);
+    protocol->getPublicKey(sentMsg.senderKey);
+    strncpy(sentMsg.senderName, protocol->getNodeName(), sizeof(sentMsg.senderName) - 1);
     memcpy(sentMsg.recipientKey, recipientKey, PUBLIC_KEY_SIZE);
     strncpy(sentMsg.text, text, sizeof(sentMsg.text) - 1);
     sentMsg.timestamp = time(nullptr);
@@ -447,12 +1232,10 @@ bool MesholaMsgService::sendMessage(const uint8_t recipientKey[PUBLIC_KEY_SIZE],
     sentMsg.ackId = outAckId;
     
     // Persist our sent message
-    if (_messageStore) {
-        _messageStore->appendMessage(sentMsg);
-    }
+    storeMessage(sentMsg, slot);
     
     // Publish event
-    publishMessageEvent(sentMsg, false, true);
+    publishMessageEvent(sentMsg, false, true, slot);
     
     return true;
 }
@@ -467,35 +1250,35 @@ bool MesholaMsgService::sendChannelMessage(const uint8_t channelId[CHANNEL_ID_SI
         return false;
     }
     
-    // Find the channel
+    // Find the channel and the protocol it belongs to
     Channel channel;
-    if (!findChannel(channelId, channel)) {
+    ProtocolSlot slot = ProtocolSlot::Primary;
+    IProtocol* protocol = findChannelOwner(channelId, channel, slot);
+    if (!protocol) {
         TT_LOG_E(TAG, "Cannot send: channel not found");
         return false;
     }
     
     // Send via protocol
-    if (!_protocol->sendChannelMessage(channel, text)) {
+    if (!protocol->sendChannelMessage(channel, text)) {
         return false;
     }
     
     // Create message record
     Message sentMsg = {};
     sentMsg.type = MessageType::Channel;
-    memcpy(sentMsg.senderKey, _profileManager->getActiveProfile()->publicKey, PUBLIC_KEY_SIZE);
-    strncpy(sentMsg.senderName, _protocol->getNodeName(), sizeof(sentMsg.senderName) - 1);
+    protocol->getPublicKey(sentMsg.senderKey);
+    strncpy(sentMsg.senderName, protocol->getNodeName(), sizeof(sentMsg.senderName) - 1);
     memcpy(sentMsg.channelId, channelId, CHANNEL_ID_SIZE);
     strncpy(sentMsg.text, text, sizeof(sentMsg.text) - 1);
     sentMsg.timestamp = time(nullptr);
     sentMsg.status = MessageStatus::Sent;
     
     // Persist
-    if (_messageStore) {
-        _messageStore->appendMessage(sentMsg);
-    }
+    storeMessage(sentMsg, slot);
     
     // Publish
-    publishMessageEvent(sentMsg, false, true);
+    publishMessageEvent(sentMsg, false, true, slot);
     
     return true;
 }
@@ -508,7 +1291,11 @@ bool MesholaMsgService::sendAdvertisement() {
         return false;
     }
     
-    return _protocol->sendAdvertisement();
+    bool ok = _protocol->sendAdvertisement();
+    if (_companion) {
+        ok = _companion->sendAdvertisement() && ok;
+    }
+    return ok;
 }
 
 // ============================================================================
@@ -519,51 +1306,90 @@ int MesholaMsgService::getContactCount() const {
     auto lock = _mutex.asScopedLock();
     lock.lock();
     
-    if (!_protocol) {
-        return 0;
-    }
-    return _protocol->getContactCount();
+    int count = 0;
+    forEachProtocol([&](IProtocol& protocol, ProtocolSlot) {
+        count += protocol.getContactCount();
+        return true;
+    });
+    return count;
 }
 
 bool MesholaMsgService::getContact(int index, Contact& out) const {
     auto lock = _mutex.asScopedLock();
     lock.lock();
     
-    if (!_protocol) {
-        return false;
-    }
-    return _protocol->getContact(index, out);
+    // Active profile's contacts first, then the companion's
+    bool found = false;
+    forEachProtocol([&](IProtocol& protocol, ProtocolSlot) {
+        int count = protocol.getContactCount();
+        if (index < count) {
+            found = protocol.getContact(index, out);
+            return false;
+        }
+        index -= count;
+        return true;
+    });
+    return found;
 }
 
 bool MesholaMsgService::findContact(const uint8_t publicKey[PUBLIC_KEY_SIZE], Contact& out) const {
     auto lock = _mutex.asScopedLock();
     lock.lock();
     
-    if (!_protocol) {
-        return false;
-    }
-    return _protocol->findContact(publicKey, out);
+    ProtocolSlot slot;
+    return findContactOwner(publicKey, out, slot) != nullptr;
 }
 
-std::vector<Contact> MesholaMsgService::getContacts() const {
+bool MesholaMsgService::findContactByHash(uint32_t keyHash, Contact& out) const {
     auto lock = _mutex.asScopedLock();
     lock.lock();
     
-    std::vector<Contact> contacts;
-    if (!_protocol) {
-        return contacts;
-    }
-    
-    int count = _protocol->getContactCount();
-    contacts.reserve(count);
+    bool found = false;
+    forEachProtocol([&](IProtocol& protocol, ProtocolSlot) {
+        found = protocol.findContactByHash(keyHash, out);
+        return !found;
+    });
+    return found;
+}
+
+size_t MesholaMsgService::copyContacts(std::span<Contact> dest, size_t offset) const {
+    auto lock = _mutex.asScopedLock();
+    lock.lock();
     
-    for (int i = 0; i < count; i++) {
-        Contact c;
-        if (_protocol->getContact(i, c)) {
-            contacts.push_back(c);
+    size_t copied = 0;
+    forEachProtocol([&](IProtocol& protocol, ProtocolSlot) {
+        size_t count = (size_t)protocol.getContactCount();
+        if (offset >= count) {
+            offset -= count;
+            return true;
         }
-    }
+        copied += protocol.copyContacts(dest.data() + copied, dest.size() - copied, offset);
+        offset = 0;
+        return copied < dest.size();
+    });
+    return copied;
+}
+
+void MesholaMsgService::forEachContact(const ContactVisitor& visitor) const {
+    auto lock = _mutex.asScopedLock();
+    lock.lock();
     
+    bool keepGoing = true;
+    forEachProtocol([&](IProtocol& protocol, ProtocolSlot) {
+        protocol.forEachContact([&](const Contact& contact) {
+            keepGoing = visitor(contact);
+            return keepGoing;
+        });
+        return keepGoing;
+    });
+}
+
+std::vector<Contact> MesholaMsgService::getContacts() const {
+    auto lock = _mutex.asScopedLock();
+    lock.lock();
+    
+    std::vector<Contact> contacts(getContactCount());
+    contacts.resize(copyContacts(contacts, 0));
     return contacts;
 }
 
@@ -575,95 +1401,104 @@ int MesholaMsgService::getChannelCount() const {
     auto lock = _mutex.asScopedLock();
     lock.lock();
     
-    if (!_protocol) {
-        return 0;
-    }
-    return _protocol->getChannelCount();
+    int count = 0;
+    forEachProtocol([&](IProtocol& protocol, ProtocolSlot) {
+        count += protocol.getChannelCount();
+        return true;
+    });
+    return count;
 }
 
 bool MesholaMsgService::getChannel(int index, Channel& out) const {
     auto lock = _mutex.asScopedLock();
     lock.lock();
     
-    if (!_protocol) {
-        return false;
-    }
-    return _protocol->getChannel(index, out);
+    bool found = false;
+    forEachProtocol([&](IProtocol& protocol, ProtocolSlot) {
+        int count = protocol.getChannelCount();
+        if (index < count) {
+            found = protocol.getChannel(index, out);
+            return false;
+        }
+        index -= count;
+        return true;
+    });
+    return found;
 }
 
 bool MesholaMsgService::findChannel(const uint8_t channelId[CHANNEL_ID_SIZE], Channel& out) const {
     auto lock = _mutex.asScopedLock();
     lock.lock();
     
-    if (!_protocol) {
-        return false;
-    }
+    ProtocolSlot slot;
+    return findChannelOwner(channelId, out, slot) != nullptr;
+}
+
+size_t MesholaMsgService::copyChannels(std::span<Channel> dest, size_t offset) const {
+    auto lock = _mutex.asScopedLock();
+    lock.lock();
     
-    int count = _protocol->getChannelCount();
-    for (int i = 0; i < count; i++) {
-        Channel ch;
-        if (_protocol->getChannel(i, ch)) {
-            if (memcmp(ch.id, channelId, CHANNEL_ID_SIZE) == 0) {
-                out = ch;
-                return true;
-            }
+    size_t copied = 0;
+    forEachProtocol([&](IProtocol& protocol, ProtocolSlot) {
+        size_t count = (size_t)protocol.getChannelCount();
+        if (offset >= count) {
+            offset -= count;
+            return true;
         }
-    }
-    return false;
+        copied += protocol.copyChannels(dest.data() + copied, dest.size() - copied, offset);
+        offset = 0;
+        return copied < dest.size();
+    });
+    return copied;
 }
 
 std::vector<Channel> MesholaMsgService::getChannels() const {
     auto lock = _mutex.asScopedLock();
     lock.lock();
     
-    std::vector<Channel> channels;
-    if (!_protocol) {
-        return channels;
-    }
-    
-    int count = _protocol->getChannelCount();
-    channels.reserve(count);
-    
-    for (int i = 0; i < count; i++) {
-        Channel ch;
-        if (_protocol->getChannel(i, ch)) {
-            channels.push_back(ch);
-        }
-    }
-    
+    std::vector<Channel> channels(getChannelCount());
+    channels.resize(copyChannels(channels, 0));
     return channels;
 }
 
 bool MesholaMsgService::setContactFavorite(const uint8_t publicKey[PUBLIC_KEY_SIZE], bool favorite) {
-    auto lock = _mutex.asScopedLock();
-    lock.lock();
-    if (!_protocol) {
-        return false;
-    }
-    bool ok = _protocol->setContactFavorite(publicKey, favorite);
-    if (ok) {
-        Contact c{};
-        if (_protocol->findContact(publicKey, c)) {
-            publishContactEvent(c, false);
+    Contact c{};
+    ProtocolSlot slot = ProtocolSlot::Primary;
+    {
+        auto lock = _mutex.asScopedLock();
+        lock.lock();
+        IProtocol* protocol = findContactOwner(publicKey, c, slot);
+        if (!protocol || !protocol->setContactFavorite(publicKey, favorite)) {
+            return false;
+        }
+        if (!protocol->findContact(publicKey, c)) {
+            return true;
         }
+        // A pending copy would undo this change when the window flushes
+        _coalescer.refreshContact(c, slot);
     }
-    return ok;
+    // User action: publish now rather than waiting for the window
+    publishContactNow(c, slot);
+    return true;
 }
 
 bool MesholaMsgService::promoteContact(const uint8_t publicKey[PUBLIC_KEY_SIZE]) {
-    auto lock = _mutex.asScopedLock();
-    lock.lock();
-    if (!_protocol) {
-        return false;
-    }
-    bool ok = _protocol->promoteContact(publicKey);
-    if (ok) {
-        Contact c{};
-        if (_protocol->findContact(publicKey, c)) {
-            publishContactEvent(c, false);
+    Contact c{};
+    ProtocolSlot slot = ProtocolSlot::Primary;
+    {
+        auto lock = _mutex.asScopedLock();
+        lock.lock();
+        IProtocol* protocol = findContactOwner(publicKey, c, slot);
+        if (!protocol || !protocol->promoteContact(publicKey)) {
+            return false;
         }
+        if (!protocol->findContact(publicKey, c)) {
+            return true;
+        }
+        _coalescer.refreshContact(c, slot);
     }
-    return ok;
+    publishContactNow(c, slot);
+    return true;
 }
 
 // ============================================================================
@@ -675,11 +1510,16 @@ std::vector<Message> MesholaMsgService::getContactMessages(const uint8_t contact
     auto lock = _mutex.asScopedLock();
     lock.lock();
     
-    if (!_messageStore) {
+    // History lives with the profile that knows the contact
+    Contact contact;
+    ProtocolSlot slot = ProtocolSlot::Primary;
+    findContactOwner(contactKey, contact, slot);
+    MessageStore* store = storeFor(slot);
+    if (!store) {
         return {};
     }
     
-    return _messageStore->getContactMessages(contactKey, maxCount);
+    return store->getContactMessages(contactKey, maxCount);
 }
 
 std::vector<Message> MesholaMsgService::getChannelMessages(const uint8_t channelId[CHANNEL_ID_SIZE], 
@@ -687,11 +1527,15 @@ std::vector<Message> MesholaMsgService::getChannelMessages(const uint8_t channel
     auto lock = _mutex.asScopedLock();
     lock.lock();
     
-    if (!_messageStore) {
+    Channel channel;
+    ProtocolSlot slot = ProtocolSlot::Primary;
+    findChannelOwner(channelId, channel, slot);
+    MessageStore* store = storeFor(slot);
+    if (!store) {
         return {};
     }
     
-    return _messageStore->getChannelMessages(channelId, maxCount);
+    return store->getChannelMessages(channelId, maxCount);
 }
 
 // ============================================================================
@@ -705,7 +1549,13 @@ NodeStatus MesholaMsgService::getNodeStatus() const {
     if (!_protocol) {
         return NodeStatus{};
     }
-    return _protocol->getStatus();
+    NodeStatus status = _protocol->getStatus();
+    BatteryReading battery = readBattery();
+    if (battery.known) {
+        status.batteryPercent = battery.percent;
+        status.batteryMillivolts = battery.millivolts;
+    }
+    return status;
 }
 
 RadioConfig MesholaMsgService::getRadioConfig() const {
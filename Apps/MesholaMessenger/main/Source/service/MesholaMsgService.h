@@ -9,6 +9,10 @@
  * - Provides radio RX/TX regardless of which app is in foreground
  * - Uses PubSub to notify apps of events
  * 
+ * Startup is staged: onStart() only creates PubSubs and returns, and the
+ * mesh thread then loads profiles, recovers storage, brings up the radio
+ * and loads contacts, publishing a ReadyEvent after each BootStage.
+ * 
  * Apps (like Meshola Messenger) subscribe to this service's PubSub
  * to receive notifications about new messages, contacts, etc.
  * 
@@ -24,62 +28,24 @@
 #include "Tactility/service/ServiceRegistration.h"
 #include "Tactility/service/ServicePaths.h"
 
+#include "../diag/Capture.h"
 #include "../protocol/IProtocol.h"
+#include "../protocol/RadioArbiter.h"
 #include "../profile/Profile.h"
 #include "../storage/MessageStore.h"
+#include "EventCoalescer.h"
+#include "LoopWatchdog.h"
+#include "PowerScheduler.h"
+#include "ServiceEvents.h"
+#include "ServiceMetrics.h"
 
+#include <atomic>
 #include <memory>
+#include <span>
 #include <vector>
 
 namespace meshola::service {
 
-// ============================================================================
-// Event Types for PubSub
-// ============================================================================
-
-/**
- * Event published when a message is received or sent.
- */
-struct MessageEvent {
-    Message message;
-    bool isIncoming;    // true = received, false = sent by us
-    bool isNew;         // true = just happened, false = loaded from storage
-};
-
-/**
- * Event published when a contact is discovered or updated.
- */
-struct ContactEvent {
-    Contact contact;
-    bool isNew;         // true = newly discovered, false = updated
-};
-
-/**
- * Event published when a channel is added or updated.
- */
-struct ChannelEvent {
-    Channel channel;
-    bool isNew;
-};
-
-/**
- * Event published when service status changes.
- */
-struct StatusEvent {
-    bool radioRunning;
-    int contactCount;
-    int channelCount;
-    NodeStatus nodeStatus;
-};
-
-/**
- * Event published when an ACK is received.
- */
-struct AckEvent {
-    uint32_t ackId;
-    bool success;
-};
-
 // ============================================================================
 // Service State
 // ============================================================================
@@ -125,6 +91,13 @@ public:
      * Get current service state.
      */
     ServiceState getState() const;
+    
+    /**
+     * Bitmask (bootStageBit) of startup stages completed successfully.
+     */
+    uint32_t getReadyStages() const { return _readyStages.load(std::memory_order_acquire); }
+    
+    bool isReady(BootStage stage) const { return (getReadyStages() & bootStageBit(stage)) != 0; }
 
     // ========================================================================
     // Profile Management
@@ -142,11 +115,38 @@ public:
     
     /**
      * Switch to a different profile.
-     * This will stop the radio, reinitialize with the new profile,
-     * and optionally restart the radio.
+     * If the radio is running and the new profile uses the same protocol,
+     * the radio stays up: identity, channels and changed RF settings are
+     * re-applied and the message store is swapped under the service lock.
+     * Otherwise the radio is stopped, the protocol rebuilt and the radio
+     * optionally restarted.
      */
     bool switchProfile(const char* profileId, bool restartRadio = true);
 
+    // ========================================================================
+    // Companion Profile
+    // ========================================================================
+    
+    /**
+     * Run a second profile's protocol alongside the active one on the same
+     * radio (see RadioArbiter), e.g. a gateway on two meshes. Events from
+     * both arrive on the same PubSubs tagged with ProtocolSlot; contact and
+     * channel queries, sends and history cover both.
+     * Stored in the active profile; the protocols are rebuilt to apply it.
+     * @param profileId Companion profile, nullptr or "" to remove
+     * @param airtimeSharePercent Active profile's share of radio time when
+     *        the two profiles' modem settings differ (clamped to 10-90)
+     */
+    bool setCompanionProfile(const char* profileId, uint8_t airtimeSharePercent = 50);
+    
+    bool hasCompanion() const;
+    
+    /**
+     * True when both profiles listen at once (same modem settings) or there
+     * is no companion; false while the radio is time-sliced between them.
+     */
+    bool isRadioShared() const;
+
     // ========================================================================
     // Messaging
     // ========================================================================
@@ -188,10 +188,28 @@ public:
     bool getContact(int index, Contact& out) const;
     
     /**
-     * Find contact by public key.
+     * Find contact by public key (active profile first, then companion).
      */
     bool findContact(const uint8_t publicKey[PUBLIC_KEY_SIZE], Contact& out) const;
     
+    /**
+     * Find contact by contactKeyHash() of its public key.
+     */
+    bool findContactByHash(uint32_t keyHash, Contact& out) const;
+    
+    /**
+     * Copy contacts starting at index offset into dest, under a single lock.
+     * @return Number of contacts copied
+     */
+    size_t copyContacts(std::span<Contact> dest, size_t offset = 0) const;
+    
+    /**
+     * Visit every contact under a single lock, without per-contact copies.
+     * The visitor runs with the service mutex held: keep it short and do
+     * not call into LVGL or block.
+     */
+    void forEachContact(const ContactVisitor& visitor) const;
+    
     /**
      * Get all contacts.
      */
@@ -216,11 +234,115 @@ public:
      */
     bool findChannel(const uint8_t channelId[CHANNEL_ID_SIZE], Channel& out) const;
     
+    /**
+     * Copy channels starting at index offset into dest, under a single lock.
+     * @return Number of channels copied
+     */
+    size_t copyChannels(std::span<Channel> dest, size_t offset = 0) const;
+    
     /**
      * Get all channels.
      */
     std::vector<Channel> getChannels() const;
 
+    // ========================================================================
+    // Event Coalescing
+    // ========================================================================
+
+    /**
+     * Set the contact/status coalescing window.
+     * At most one ContactBatchEvent (and one coalesced StatusEvent) is
+     * published per window. 0 = publish on every mesh loop iteration.
+     */
+    void setEventCoalesceWindow(uint32_t windowMs);
+    uint32_t getEventCoalesceWindow() const;
+
+    // ========================================================================
+    // Metrics
+    // ========================================================================
+    
+    /**
+     * Snapshot of monotonic counters and latency histograms.
+     * Lock-free; safe to call from any thread.
+     */
+    MetricsSnapshot getMetrics() const;
+    
+    /**
+     * Write the compact text dump of getMetrics() to the serial log.
+     */
+    void logMetrics() const;
+    
+    /**
+     * Periodically log metrics from the mesh thread (0 = disabled).
+     */
+    void setMetricsLogInterval(uint32_t intervalMs) { _metricsLogIntervalMs = intervalMs; }
+    
+    /**
+     * Write the pipeline trace ring buffer to SD (see diag/Trace.h).
+     * Only produces data when built with MESHOLA_TRACE=1.
+     * @param path Output file, nullptr = TRACE_DUMP_PATH
+     */
+    bool dumpTrace(const char* path = nullptr) const;
+    
+    static constexpr const char* TRACE_DUMP_PATH = "/sdcard/meshola_trace.bin";
+    
+    /**
+     * Start recording raw RX frames (with RSSI/SNR/time) to a capture file
+     * for offline replay (see diag/Capture.h). Replaces a running capture.
+     * Records what the active profile's protocol receives.
+     * @param path Output file, nullptr = CAPTURE_PATH
+     */
+    bool startCapture(const char* path = nullptr);
+    
+    /**
+     * Flush and close the capture file.
+     */
+    void stopCapture();
+    
+    bool isCapturing() const;
+    
+    static constexpr const char* CAPTURE_PATH = "/sdcard/meshola_rx.mcap";
+
+    // Contact/channel snapshot in each profile's data directory
+    static constexpr const char* STATE_FILE_NAME = "protocol_state.bin";
+
+    // ========================================================================
+    // Loop Watchdog
+    // ========================================================================
+    
+    /**
+     * Set the per-stage and per-iteration mesh loop budgets.
+     * Takes effect at the start of the next iteration.
+     */
+    void setLoopBudget(const LoopBudget& budget);
+    LoopBudget getLoopBudget() const;
+    
+    /**
+     * True while the mesh loop is repeatedly over budget or stalled.
+     */
+    bool isLoopDegraded() const { return _watchdog.isDegraded(); }
+    
+    /**
+     * Detect a mesh loop iteration that is still running past its stall
+     * budget (e.g. blocked on SD or a slow subscriber). Call periodically
+     * from another thread; publishes a StatusFieldHealth event on change.
+     * Never takes the service mutex.
+     */
+    void checkWatchdog();
+
+    // ========================================================================
+    // Power
+    // ========================================================================
+    
+    /**
+     * Choose how aggressively the receiver duty-cycles (default Auto).
+     * Duty cycling only engages when the profile's preambleLength leaves
+     * room to sleep; see PowerScheduler. Applied by the mesh thread within
+     * one iteration.
+     */
+    void setPowerPolicy(PowerPolicy policy) { _powerPolicy = static_cast<uint8_t>(policy); }
+    PowerPolicy getPowerPolicy() const { return static_cast<PowerPolicy>(_powerPolicy.load()); }
+
     // ========================================================================
     // Contact Management Helpers (favorites/promotion)
     // ========================================================================
@@ -278,6 +400,10 @@ public:
         return _contactPubSub; 
     }
     
+    std::shared_ptr<tt::PubSub<ContactBatchEvent>> getContactBatchPubSub() const { 
+        return _contactBatchPubSub; 
+    }
+    
     std::shared_ptr<tt::PubSub<ChannelEvent>> getChannelPubSub() const { 
         return _channelPubSub; 
     }
@@ -289,6 +415,10 @@ public:
     std::shared_ptr<tt::PubSub<AckEvent>> getAckPubSub() const { 
         return _ackPubSub; 
     }
+    
+    std::shared_ptr<tt::PubSub<ReadyEvent>> getReadyPubSub() const { 
+        return _readyPubSub; 
+    }
 
 private:
     // Thread safety
@@ -302,35 +432,95 @@ private:
     // Core components
     std::unique_ptr<ProfileManager> _profileManager;
     std::unique_ptr<MessageStore> _messageStore;
+    // Declared before the protocols: arbiter clients are their radios
+    std::unique_ptr<RadioArbiter> _arbiter;
     std::unique_ptr<IProtocol> _protocol;
-    const char* _currentProtocolId = nullptr;
+    char _currentProtocolId[32] = {};
+    
+    // Companion profile sharing the radio (ProtocolSlot::Companion)
+    std::unique_ptr<IProtocol> _companion;
+    std::unique_ptr<MessageStore> _companionStore;
     
     // Background thread for radio operations
     std::unique_ptr<tt::Thread> _meshThread;
-    bool _threadRunning = false;
+    std::atomic<bool> _threadRunning{false};  // Cleared by stopRadio() and the mesh thread
+    
+    // Staged startup progress (written by the mesh thread)
+    std::atomic<uint32_t> _readyStages{0};
+    bool _bootComplete = false;
     
     // PubSub channels for event broadcasting
     std::shared_ptr<tt::PubSub<MessageEvent>> _messagePubSub;
     std::shared_ptr<tt::PubSub<ContactEvent>> _contactPubSub;
+    std::shared_ptr<tt::PubSub<ContactBatchEvent>> _contactBatchPubSub;
     std::shared_ptr<tt::PubSub<ChannelEvent>> _channelPubSub;
     std::shared_ptr<tt::PubSub<StatusEvent>> _statusPubSub;
     std::shared_ptr<tt::PubSub<AckEvent>> _ackPubSub;
+    std::shared_ptr<tt::PubSub<ReadyEvent>> _readyPubSub;
+    
+    // Merges contact/status bursts (guarded by _mutex)
+    EventCoalescer _coalescer;
+    
+    // Diagnostics (lock-free)
+    ServiceMetrics _metrics;
+    uint32_t _startedAtMs = 0;
+    uint32_t _metricsLogIntervalMs = 0;
+    
+    // Mesh loop budgets; _pendingLoopBudget is guarded by _stateMutex
+    LoopWatchdog _watchdog;
+    LoopBudget _pendingLoopBudget;
+    std::atomic<bool> _loopBudgetChanged{false};
+    
+    // Receiver duty cycling (scheduler owned by the mesh thread)
+    PowerScheduler _power;
+    std::atomic<uint8_t> _powerPolicy{static_cast<uint8_t>(PowerPolicy::Auto)};
+    
+    // Last published status, reused for health-only events (guarded by _stateMutex)
+    StatusEvent _lastStatus = {};
+    
+    // Raw RX capture (guarded by _mutex)
+    std::unique_ptr<diag::PacketCapture> _capture;
     
     // Internal methods
     void setState(ServiceState newState);
+    void startMeshThread();
+    void runBootStages();
+    template <typename Fn>
+    bool runBootStage(BootStage stage, Fn&& fn);
+    bool publishLoadedContacts();
     bool initializeProtocol(const Profile& profile);
+    bool initializeCompanion(const Profile& companion, uint8_t primaryShare);
+    void teardownProtocols();
+    void wireCallbacks(IProtocol& protocol, ProtocolSlot slot);
+    template <typename Fn>
+    void forEachProtocol(Fn&& fn) const;
+    IProtocol* findContactOwner(const uint8_t publicKey[PUBLIC_KEY_SIZE], Contact& out, ProtocolSlot& slot) const;
+    IProtocol* findChannelOwner(const uint8_t channelId[CHANNEL_ID_SIZE], Channel& out, ProtocolSlot& slot) const;
+    MessageStore* storeFor(ProtocolSlot slot) const;
+    void applyProfileIdentity(const Profile& profile);
+    void applyStatePath(IProtocol& protocol, const char* profileId);
+    bool canHotSwitchProfile(const char* profileId) const;
+    bool hotSwitchProfile(const char* profileId);
     void meshThreadMain();
+    void updatePowerPlan(uint32_t nowMs);
     
     // Protocol callbacks
-    void onMessageReceived(const Message& msg);
-    void onContactDiscovered(const Contact& contact, bool isNew);
+    void onMessageReceived(const Message& msg, ProtocolSlot slot);
+    void onContactDiscovered(const Contact& contact, bool isNew, ProtocolSlot slot);
     void onStatusChanged(const NodeStatus& status);
-    void onAckReceived(uint32_t ackId, bool success);
+    void onAckReceived(uint32_t ackId, bool success, ProtocolSlot slot);
+    void onTransmitDone(uint32_t ackId, bool success, ProtocolSlot slot);
     
     // Publish helpers
-    void publishMessageEvent(const Message& msg, bool isIncoming, bool isNew);
-    void publishContactEvent(const Contact& contact, bool isNew);
-    void publishStatusEvent();
+    void storeMessage(const Message& msg, ProtocolSlot slot = ProtocolSlot::Primary);
+    void publishMessageEvent(const Message& msg, bool isIncoming, bool isNew,
+                             ProtocolSlot slot = ProtocolSlot::Primary);
+    void publishContactEvent(const Contact& contact, bool isNew, ProtocolSlot slot = ProtocolSlot::Primary);
+    void publishStatusEvent(uint32_t changedFields = StatusFieldAll);
+    void publishHealthEvent();
+    void queueContactEvent(const Contact& contact, bool isNew, ProtocolSlot slot = ProtocolSlot::Primary);
+    void publishContactNow(const Contact& contact, ProtocolSlot slot);
+    void flushCoalescedEvents(bool force);
 };
 
 // ============================================================================
@@ -0,0 +1,98 @@
+#include "PowerScheduler.h"
+#include "../protocol/IRadio.h"
+
+#include <algorithm>
+
+namespace meshola::service {
+
+PowerScheduler::PowerScheduler()
+    : _plan(continuousPlan())
+{
+}
+
+void PowerScheduler::setPolicy(PowerPolicy policy) {
+    if (policy != _policy) {
+        _policy = policy;
+        _forceEvaluate = true;
+    }
+}
+
+bool PowerScheduler::isDue(uint32_t nowMs) const {
+    return _forceEvaluate || nowMs - _lastEvaluateMs >= EVALUATE_INTERVAL_MS;
+}
+
+bool PowerScheduler::maxDutyCycle(const RadioConfig& config, uint32_t& rxPeriodUs, uint32_t& sleepPeriodUs) {
+    uint32_t symbolUs = loraSymbolTimeUs(config);
+    uint32_t preamble = effectivePreambleLength(config);
+    if (symbolUs == 0 || preamble <= 2u * MIN_RX_SYMBOLS) {
+        return false;
+    }
+    // A window that opens just after the preamble started must still see
+    // MIN_RX_SYMBOLS of it, hence the two-sided margin
+    sleepPeriodUs = (preamble - 2u * MIN_RX_SYMBOLS) * symbolUs;
+    int64_t centred = ((int64_t)symbolUs * (preamble + 1) - ((int64_t)sleepPeriodUs - 1000)) / 2;
+    rxPeriodUs = (uint32_t)std::max<int64_t>(centred, (int64_t)symbolUs * (MIN_RX_SYMBOLS + 1));
+    return true;
+}
+
+PowerPlan PowerScheduler::continuousPlan() {
+    return PowerPlan{
+        .rxPeriodUs = 0,
+        .sleepPeriodUs = 0,
+        .pollMs = CONTINUOUS_POLL_MS,
+        .radioCurrentUa = RX_CURRENT_UA
+    };
+}
+
+PowerPlan PowerScheduler::dutyCyclePlan(uint32_t rxPeriodUs, uint32_t sleepPeriodUs, uint32_t pollMs) {
+    uint64_t cycle = (uint64_t)rxPeriodUs + sleepPeriodUs;
+    uint64_t charge = (uint64_t)rxPeriodUs * RX_CURRENT_UA + (uint64_t)sleepPeriodUs * SLEEP_CURRENT_UA;
+    return PowerPlan{
+        .rxPeriodUs = rxPeriodUs,
+        .sleepPeriodUs = sleepPeriodUs,
+        .pollMs = pollMs,
+        .radioCurrentUa = (uint32_t)(charge / cycle)
+    };
+}
+
+bool PowerScheduler::evaluate(uint32_t nowMs, const PowerInputs& inputs, const RadioConfig& config) {
+    // Traffic rate since the last evaluation, smoothed over ~2 intervals
+    uint32_t elapsedMs = nowMs - _lastEvaluateMs;
+    if (!_forceEvaluate || elapsedMs >= EVALUATE_INTERVAL_MS) {
+        uint32_t delta = inputs.rxPackets - _lastRxPackets;
+        uint32_t rate = elapsedMs > 0 ? (uint32_t)((uint64_t)delta * 60000 / elapsedMs) : 0;
+        _rxPerMinute = (_rxPerMinute + rate) / 2;
+    }
+    _lastRxPackets = inputs.rxPackets;
+    _lastEvaluateMs = nowMs;
+    _forceEvaluate = false;
+
+    PowerPlan next = continuousPlan();
+    uint32_t rxUs = 0;
+    uint32_t sleepUs = 0;
+    bool canSleep = maxDutyCycle(config, rxUs, sleepUs);
+
+    if (_policy == PowerPolicy::MaxSaving && canSleep) {
+        next = dutyCyclePlan(rxUs, sleepUs, LOW_BATTERY_POLL_MS);
+    } else if (_policy == PowerPolicy::Auto && canSleep) {
+        bool plentyOfPower = inputs.charging ||
+                             (inputs.batteryKnown && inputs.batteryPercent >= HIGH_BATTERY_PERCENT);
+        bool busy = _rxPerMinute >= BUSY_RX_PER_MINUTE;
+        if (!plentyOfPower && !busy) {
+            if (inputs.batteryKnown && inputs.batteryPercent < LOW_BATTERY_PERCENT) {
+                next = dutyCyclePlan(rxUs, sleepUs, LOW_BATTERY_POLL_MS);
+            } else {
+                // Half the sleep: more listening, lower wake-up latency
+                next = dutyCyclePlan(rxUs, sleepUs / 2, DUTY_CYCLE_POLL_MS);
+            }
+        }
+    }
+
+    bool changed = next.rxPeriodUs != _plan.rxPeriodUs ||
+                   next.sleepPeriodUs != _plan.sleepPeriodUs ||
+                   next.pollMs != _plan.pollMs;
+    _plan = next;
+    return changed;
+}
+
+} // namespace meshola::service
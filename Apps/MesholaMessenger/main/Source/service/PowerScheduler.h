@@ -0,0 +1,113 @@
+#pragma once
+
+#include "../protocol/IProtocol.h"
+
+#include <cstdint>
+
+namespace meshola::service {
+
+/**
+ * How aggressively the receiver may sleep.
+ */
+enum class PowerPolicy : uint8_t {
+    AlwaysOn = 0,   // Continuous RX, 10 ms polling
+    Auto,           // Duty cycle picked from battery level and traffic rate
+    MaxSaving       // Longest sleep the preamble allows, whatever the battery
+};
+
+/**
+ * Inputs sampled by the service on each evaluation.
+ */
+struct PowerInputs {
+    bool batteryKnown;
+    uint8_t batteryPercent;
+    bool charging;
+    uint32_t rxPackets;         // Cumulative received frames; the rate is derived
+};
+
+/**
+ * Receiver schedule applied through IProtocol::setRxDutyCycle().
+ */
+struct PowerPlan {
+    uint32_t rxPeriodUs;        // 0 = continuous receive
+    uint32_t sleepPeriodUs;
+    uint32_t pollMs;            // Mesh thread delay between iterations
+    uint32_t radioCurrentUa;    // Estimated average receiver current
+};
+
+/**
+ * PowerScheduler - Picks the SX1262 listen/sleep ratio.
+ *
+ * A duty-cycled receiver only catches a frame if it wakes while the
+ * sender's preamble is still on air, so the sleep period is bounded by the
+ * configured preamble length (same rule as RadioLib's
+ * startReceiveDutyCycleAuto). Within that bound, low battery and quiet
+ * channels sleep longest; charging, a full battery or a busy channel keep
+ * continuous RX. With the default 12-symbol preamble there is no room to
+ * sleep and the plan stays continuous.
+ *
+ * Not thread-safe: owned by the mesh thread.
+ * Time is passed in by the caller so the class has no platform dependency.
+ */
+class PowerScheduler {
+public:
+    static constexpr uint32_t EVALUATE_INTERVAL_MS = 5000;
+
+    // SX1262 datasheet: RX with DC-DC 4.6 mA, sleep with warm start ~1.2 uA
+    static constexpr uint32_t RX_CURRENT_UA = 4600;
+    static constexpr uint32_t SLEEP_CURRENT_UA = 2;
+
+    // Preamble symbols the receiver needs to lock on
+    static constexpr uint16_t MIN_RX_SYMBOLS = 8;
+
+    // Received frames per minute above which duty cycling costs more than it saves
+    static constexpr uint32_t BUSY_RX_PER_MINUTE = 12;
+
+    static constexpr uint8_t HIGH_BATTERY_PERCENT = 80;
+    static constexpr uint8_t LOW_BATTERY_PERCENT = 30;
+
+    static constexpr uint32_t CONTINUOUS_POLL_MS = 10;
+    static constexpr uint32_t DUTY_CYCLE_POLL_MS = 50;
+    static constexpr uint32_t LOW_BATTERY_POLL_MS = 100;
+
+    PowerScheduler();
+
+    void setPolicy(PowerPolicy policy);
+    PowerPolicy getPolicy() const { return _policy; }
+
+    /**
+     * True when evaluate() should run (interval elapsed or policy changed).
+     */
+    bool isDue(uint32_t nowMs) const;
+
+    /**
+     * Re-plan from fresh inputs. Returns true if the plan changed.
+     */
+    bool evaluate(uint32_t nowMs, const PowerInputs& inputs, const RadioConfig& config);
+
+    const PowerPlan& getPlan() const { return _plan; }
+
+    /**
+     * Smoothed received frames per minute.
+     */
+    uint32_t getRxPerMinute() const { return _rxPerMinute; }
+
+    /**
+     * Longest sleep period (and matching listen window) that still catches
+     * every preamble. Returns false if the preamble is too short to sleep.
+     */
+    static bool maxDutyCycle(const RadioConfig& config, uint32_t& rxPeriodUs, uint32_t& sleepPeriodUs);
+
+private:
+    PowerPolicy _policy = PowerPolicy::Auto;
+    PowerPlan _plan;
+    bool _forceEvaluate = true;
+    uint32_t _lastEvaluateMs = 0;
+    uint32_t _lastRxPackets = 0;
+    uint32_t _rxPerMinute = 0;
+
+    static PowerPlan continuousPlan();
+    static PowerPlan dutyCyclePlan(uint32_t rxPeriodUs, uint32_t sleepPeriodUs, uint32_t pollMs);
+};
+
+} // namespace meshola::service
@@ -0,0 +1,142 @@
+#pragma once
+
+/**
+ * PubSub event types published by MesholaMsgService.
+ *
+ * Kept separate from the service header so helpers (e.g. EventCoalescer)
+ * can use them without pulling in the Tactility service headers.
+ */
+
+#include "../protocol/IProtocol.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace meshola::service {
+
+// ============================================================================
+// Event Types for PubSub
+// ============================================================================
+
+/**
+ * Which of the service's protocols an event belongs to.
+ */
+enum class ProtocolSlot : uint8_t {
+    Primary = 0,        // Active profile
+    Companion,          // Profile sharing the radio (see setCompanionProfile)
+    Count
+};
+
+/**
+ * Event published when a message is received or sent.
+ */
+struct MessageEvent {
+    Message message;
+    bool isIncoming;    // true = received, false = sent by us
+    bool isNew;         // true = just happened, false = loaded from storage
+    ProtocolSlot slot;
+};
+
+/**
+ * Event published when a contact is discovered or updated.
+ */
+struct ContactEvent {
+    Contact contact;
+    bool isNew;         // true = newly discovered, false = updated
+    ProtocolSlot slot;
+};
+
+/**
+ * Batched contact updates, published at most once per coalescing window.
+ * Each contact appears at most once (latest state wins).
+ */
+struct ContactBatchEvent {
+    std::vector<ContactEvent> contacts;
+    bool fullRefresh;   // true = too many updates to track, re-read everything
+};
+
+/**
+ * Event published when a channel is added or updated.
+ */
+struct ChannelEvent {
+    Channel channel;
+    bool isNew;
+};
+
+/**
+ * Bitmask of StatusEvent fields that changed since the last status event.
+ */
+enum StatusField : uint32_t {
+    StatusFieldRadio    = 1 << 0,
+    StatusFieldContacts = 1 << 1,
+    StatusFieldChannels = 1 << 2,
+    StatusFieldNode     = 1 << 3,
+    StatusFieldHealth   = 1 << 4,
+    StatusFieldAll      = 0xFFFFFFFF
+};
+
+/**
+ * Stages of one mesh thread iteration, timed by LoopWatchdog.
+ */
+enum class LoopStage : uint8_t {
+    Idle = 0,       // Between iterations (delay), never budgeted
+    LockWait,       // Waiting for the service mutex
+    Protocol,       // protocol->loop(): IRQ handling, readData, parsing
+    Storage,        // MessageStore append for a received message
+    Publish,        // MessageEvent subscribers
+    Flush,          // Coalesced contact/status events
+    Count
+};
+
+const char* loopStageName(LoopStage stage);
+
+/**
+ * Event published when service status changes.
+ */
+struct StatusEvent {
+    bool radioRunning;
+    int contactCount;
+    int channelCount;
+    NodeStatus nodeStatus;
+    bool degraded;              // Mesh loop repeatedly over budget or stalled
+    LoopStage degradedStage;    // Stage blamed for the degradation
+    uint32_t changedFields;     // Bitmask of StatusField
+};
+
+/**
+ * Startup stages run on the mesh thread after the service reports Running.
+ */
+enum class BootStage : uint8_t {
+    Profiles = 0,   // ProfileManager loaded (keys generated on first boot)
+    Storage,        // Message store directories recovered for the active profile
+    Radio,          // Protocol initialised, radio up and receiving
+    Contacts,       // Persisted contacts/channels loaded
+    Count
+};
+
+constexpr uint32_t bootStageBit(BootStage stage) {
+    return 1u << static_cast<uint8_t>(stage);
+}
+
+constexpr uint32_t BOOT_STAGES_ALL = (1u << static_cast<uint8_t>(BootStage::Count)) - 1;
+
+/**
+ * Event published when a startup stage completes (or fails).
+ */
+struct ReadyEvent {
+    BootStage stage;
+    bool success;
+    uint32_t durationMs;        // Time spent in this stage
+    uint32_t readyStages;       // Bitmask (bootStageBit) of stages ready so far
+};
+
+/**
+ * Event published when an ACK is received.
+ */
+struct AckEvent {
+    uint32_t ackId;
+    bool success;
+    ProtocolSlot slot;  // Ack IDs are only unique per slot
+};
+
+} // namespace meshola::service
@@ -0,0 +1,219 @@
+#include "ServiceMetrics.h"
+#include <cstdio>
+
+namespace meshola::service {
+
+MetricsSnapshot takeSnapshot(const ServiceMetrics& metrics, uint32_t uptimeMs, bool loopDegraded) {
+    const auto& p = metrics.protocol;
+    MetricsSnapshot snap = {};
+    snap.uptimeMs = uptimeMs;
+
+    snap.rxPackets = p.rxPackets.get();
+    snap.rxCrcErrors = p.rxCrcErrors.get();
+    snap.rxTimeouts = p.rxTimeouts.get();
+    snap.rxReadErrors = p.rxReadErrors.get();
+    snap.rxParseFailures = p.rxParseFailures.get();
+    snap.rxAdverts = p.rxAdverts.get();
+    snap.rxMessages = p.rxMessages.get();
+    snap.contactEvictions = p.contactEvictions.get();
+    snap.contactDrops = p.contactDrops.get();
+    snap.rxOtherRecipient = p.rxOtherRecipient.get();
+    snap.rxUnresolvedSenders = p.rxUnresolvedSenders.get();
+    snap.rxHeldDelivered = p.rxHeldDelivered.get();
+    snap.txFragments = p.txFragments.get();
+    snap.rxFragments = p.rxFragments.get();
+    snap.fragmentRetransmits = p.fragmentRetransmits.get();
+    snap.fragmentNacks = p.fragmentNacks.get();
+    snap.reassemblyTimeouts = p.reassemblyTimeouts.get();
+    snap.forwarded = p.forwarded.get();
+    snap.routeDuplicates = p.routeDuplicates.get();
+    snap.forwardsCancelled = p.forwardsCancelled.get();
+    snap.forwardDrops = p.forwardDrops.get();
+    snap.txDirectRouted = p.txDirectRouted.get();
+    snap.advertsSigned = p.advertsSigned.get();
+    snap.advertSigFailures = p.advertSigFailures.get();
+    snap.verifyBatches = p.verifyBatches.get();
+    snap.txAdverts = p.txAdverts.get();
+    snap.advertsSuppressed = p.advertsSuppressed.get();
+    snap.stateSaves = p.stateSaves.get();
+    snap.stateSaveFailures = p.stateSaveFailures.get();
+    snap.stateLoadFailures = p.stateLoadFailures.get();
+    snap.txPackets = p.txPackets.get();
+    snap.txFailures = p.txFailures.get();
+    snap.txAirtimeMs = p.txAirtimeMs.get();
+    snap.txQueueDrops = p.txQueueDrops.get();
+    snap.txTimeouts = p.txTimeouts.get();
+    snap.txDutyCycleDrops = p.txDutyCycleDrops.get();
+    snap.lbtScans = p.lbtScans.get();
+    snap.lbtDefers = p.lbtDefers.get();
+    snap.lbtDeferMs = p.lbtDeferMs.get();
+    snap.lbtForced = p.lbtForced.get();
+    snap.adrSwitches = p.adrSwitches.get();
+    snap.adrFastFrames = p.adrFastFrames.get();
+    snap.adrWindows = p.adrWindows.get();
+
+    snap.messagesStored = metrics.messagesStored.get();
+    snap.storageErrors = metrics.storageErrors.get();
+    snap.messagesPublished = metrics.messagesPublished.get();
+    snap.contactBatches = metrics.contactBatches.get();
+    snap.statusEvents = metrics.statusEvents.get();
+    snap.eventQueueDepth = metrics.eventQueueDepth.get();
+    snap.eventQueuePeak = metrics.eventQueueDepth.peak();
+    for (size_t i = 0; i < BOOT_STAGE_COUNT; i++) {
+        snap.bootStageMs[i] = metrics.bootStageMs[i].get();
+    }
+    snap.bootTotalMs = metrics.bootTotalMs.get();
+
+    const auto& w = metrics.watchdog;
+    snap.loopOverruns = w.iterationOverruns.get();
+    for (size_t i = 0; i < LOOP_STAGE_COUNT; i++) {
+        snap.stageOverruns[i] = w.stageOverruns[i].get();
+    }
+    snap.loopStalls = w.stalls.get();
+    snap.loopDegradations = w.degradations.get();
+    snap.lastOverrunStage = w.lastOverrunStage.get();
+    snap.lastOverrunUs = w.lastOverrunUs.get();
+    snap.loopDegraded = loopDegraded;
+
+    snap.rxDutyPermille = metrics.rxDutyPermille.get();
+    snap.radioCurrentUa = metrics.radioCurrentUa.get();
+    snap.powerSavedUa = metrics.powerSavedUa.get();
+    snap.rxPerMinute = metrics.rxPerMinute.get();
+    snap.powerPlanChanges = metrics.powerPlanChanges.get();
+
+    snap.arbiterSlotSwitches = metrics.arbiter.slotSwitches.get();
+    snap.arbiterSharedFrames = metrics.arbiter.sharedFrames.get();
+    snap.arbiterTxQueued = metrics.arbiter.txQueued.get();
+    snap.arbiterTxQueueDrops = metrics.arbiter.txQueueDrops.get();
+    snap.arbiterConfigFailures = metrics.arbiter.configFailures.get();
+
+    snap.loop = metrics.loopUs.snapshot();
+    snap.mutexWait = metrics.mutexWaitUs.snapshot();
+    snap.storage = metrics.storageUs.snapshot();
+    return snap;
+}
+
+size_t formatMetrics(const MetricsSnapshot& s, char* dest, size_t maxLen) {
+    if (!dest || maxLen == 0) {
+        return 0;
+    }
+
+    size_t used = 0;
+    auto append = [&](const char* fmt, auto... args) {
+        if (used >= maxLen) return;
+        int written = snprintf(dest + used, maxLen - used, fmt, args...);
+        if (written > 0) {
+            used += (size_t)written;
+            if (used >= maxLen) used = maxLen - 1;
+        }
+    };
+    auto appendHistogram = [&](const char* name, const diag::LatencyHistogram::Snapshot& h) {
+        append("%s n=%lu p50<%lu p99<%lu max=%lu us\n",
+               name,
+               (unsigned long)h.count,
+               (unsigned long)h.percentileUs(50),
+               (unsigned long)h.percentileUs(99),
+               (unsigned long)h.maxUs);
+    };
+
+    append("up=%lus\n", (unsigned long)(s.uptimeMs / 1000));
+    append("boot=%lums prof=%lu store=%lu radio=%lu contacts=%lu\n",
+           (unsigned long)s.bootTotalMs,
+           (unsigned long)s.bootStageMs[static_cast<size_t>(BootStage::Profiles)],
+           (unsigned long)s.bootStageMs[static_cast<size_t>(BootStage::Storage)],
+           (unsigned long)s.bootStageMs[static_cast<size_t>(BootStage::Radio)],
+           (unsigned long)s.bootStageMs[static_cast<size_t>(BootStage::Contacts)]);
+    append("rx=%lu crc=%lu tmo=%lu rderr=%lu bad=%lu adv=%lu msg=%lu other=%lu\n",
+           (unsigned long)s.rxPackets,
+           (unsigned long)s.rxCrcErrors,
+           (unsigned long)s.rxTimeouts,
+           (unsigned long)s.rxReadErrors,
+           (unsigned long)s.rxParseFailures,
+           (unsigned long)s.rxAdverts,
+           (unsigned long)s.rxMessages,
+           (unsigned long)s.rxOtherRecipient);
+    append("contacts evict=%lu drop=%lu unresolved=%lu late=%lu\n",
+           (unsigned long)s.contactEvictions,
+           (unsigned long)s.contactDrops,
+           (unsigned long)s.rxUnresolvedSenders,
+           (unsigned long)s.rxHeldDelivered);
+    append("frag tx=%lu rx=%lu rexmit=%lu nack=%lu lost=%lu\n",
+           (unsigned long)s.txFragments,
+           (unsigned long)s.rxFragments,
+           (unsigned long)s.fragmentRetransmits,
+           (unsigned long)s.fragmentNacks,
+           (unsigned long)s.reassemblyTimeouts);
+    append("route fwd=%lu dup=%lu cancel=%lu qdrop=%lu direct=%lu\n",
+           (unsigned long)s.forwarded,
+           (unsigned long)s.routeDuplicates,
+           (unsigned long)s.forwardsCancelled,
+           (unsigned long)s.forwardDrops,
+           (unsigned long)s.txDirectRouted);
+    append("sig ok=%lu bad=%lu batches=%lu\n",
+           (unsigned long)s.advertsSigned,
+           (unsigned long)s.advertSigFailures,
+           (unsigned long)s.verifyBatches);
+    append("advert sent=%lu suppressed=%lu\n",
+           (unsigned long)s.txAdverts,
+           (unsigned long)s.advertsSuppressed);
+    append("state save=%lu fail=%lu badload=%lu\n",
+           (unsigned long)s.stateSaves,
+           (unsigned long)s.stateSaveFailures,
+           (unsigned long)s.stateLoadFailures);
+    append("tx=%lu txfail=%lu air=%lums qdrop=%lu tmo=%lu dcdrop=%lu\n",
+           (unsigned long)s.txPackets,
+           (unsigned long)s.txFailures,
+           (unsigned long)s.txAirtimeMs,
+           (unsigned long)s.txQueueDrops,
+           (unsigned long)s.txTimeouts,
+           (unsigned long)s.txDutyCycleDrops);
+    append("lbt scan=%lu defer=%lu wait=%lums forced=%lu\n",
+           (unsigned long)s.lbtScans,
+           (unsigned long)s.lbtDefers,
+           (unsigned long)s.lbtDeferMs,
+           (unsigned long)s.lbtForced);
+    append("adr switch=%lu fast=%lu follow=%lu\n",
+           (unsigned long)s.adrSwitches,
+           (unsigned long)s.adrFastFrames,
+           (unsigned long)s.adrWindows);
+    append("stored=%lu sterr=%lu pub=%lu batches=%lu status=%lu q=%lu/%lu\n",
+           (unsigned long)s.messagesStored,
+           (unsigned long)s.storageErrors,
+           (unsigned long)s.messagesPublished,
+           (unsigned long)s.contactBatches,
+           (unsigned long)s.statusEvents,
+           (unsigned long)s.eventQueueDepth,
+           (unsigned long)s.eventQueuePeak);
+    append("wd over=%lu lock=%lu proto=%lu store=%lu pub=%lu flush=%lu stall=%lu degr=%lu%s last=%s/%luus\n",
+           (unsigned long)s.loopOverruns,
+           (unsigned long)s.stageOverruns[static_cast<size_t>(LoopStage::LockWait)],
+           (unsigned long)s.stageOverruns[static_cast<size_t>(LoopStage::Protocol)],
+           (unsigned long)s.stageOverruns[static_cast<size_t>(LoopStage::Storage)],
+           (unsigned long)s.stageOverruns[static_cast<size_t>(LoopStage::Publish)],
+           (unsigned long)s.stageOverruns[static_cast<size_t>(LoopStage::Flush)],
+           (unsigned long)s.loopStalls,
+           (unsigned long)s.loopDegradations,
+           s.loopDegraded ? "!" : "",
+           loopStageName(static_cast<LoopStage>(s.lastOverrunStage)),
+           (unsigned long)s.lastOverrunUs);
+    append("pwr rx=%lu.%lu%% est=%luuA saved=%luuA rx/min=%lu plans=%lu\n",
+           (unsigned long)(s.rxDutyPermille / 10),
+           (unsigned long)(s.rxDutyPermille % 10),
+           (unsigned long)s.radioCurrentUa,
+           (unsigned long)s.powerSavedUa,
+           (unsigned long)s.rxPerMinute,
+           (unsigned long)s.powerPlanChanges);
+    append("arb sw=%lu shared=%lu txq=%lu drop=%lu cfgfail=%lu\n",
+           (unsigned long)s.arbiterSlotSwitches,
+           (unsigned long)s.arbiterSharedFrames,
+           (unsigned long)s.arbiterTxQueued,
+           (unsigned long)s.arbiterTxQueueDrops,
+           (unsigned long)s.arbiterConfigFailures);
+    appendHistogram("loop", s.loop);
+    appendHistogram("lock", s.mutexWait);
+    appendHistogram("store", s.storage);
+
+    return used;
+}
+
+} // namespace meshola::service
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "../diag/Metrics.h"
+#include "../protocol/RadioArbiter.h"
+#include "LoopWatchdog.h"
+#include "ServiceEvents.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace meshola::service {
+
+constexpr size_t BOOT_STAGE_COUNT = static_cast<size_t>(BootStage::Count);
+
+/**
+ * Live metrics owned by MesholaMsgService.
+ * Updated lock-free from the mesh thread, protocol callbacks and API calls.
+ */
+struct ServiceMetrics {
+    diag::ProtocolCounters protocol;
+
+    diag::Counter messagesStored;
+    diag::Counter storageErrors;
+    diag::Counter messagesPublished;
+    diag::Counter contactBatches;
+    diag::Counter statusEvents;
+
+    diag::Gauge eventQueueDepth;        // Pending coalesced contacts
+
+    // Startup timing (set once by the mesh thread)
+    diag::Gauge bootStageMs[BOOT_STAGE_COUNT];
+    diag::Gauge bootTotalMs;            // Service start until the last stage finished
+
+    // Mesh loop budget enforcement (updated by LoopWatchdog)
+    WatchdogCounters watchdog;
+
+    // Receiver power schedule (updated by the mesh thread)
+    diag::Gauge rxDutyPermille;         // Share of time the receiver listens
+    diag::Gauge radioCurrentUa;         // Estimated average receiver current
+    diag::Gauge powerSavedUa;           // Versus continuous RX
+    diag::Gauge rxPerMinute;
+    diag::Counter powerPlanChanges;
+
+    // Radio sharing with a companion profile (updated by RadioArbiter)
+    ArbiterCounters arbiter;
+
+    diag::LatencyHistogram loopUs;      // protocol->loop() duration
+    diag::LatencyHistogram mutexWaitUs; // Mesh thread wait for _mutex
+    diag::LatencyHistogram storageUs;   // MessageStore::appendMessage()
+};
+
+/**
+ * Plain-value copy of ServiceMetrics returned by getMetrics().
+ */
+struct MetricsSnapshot {
+    uint32_t uptimeMs;
+
+    // Radio / protocol
+    uint32_t rxPackets;
+    uint32_t rxCrcErrors;
+    uint32_t rxTimeouts;
+    uint32_t rxReadErrors;
+    uint32_t rxParseFailures;
+    uint32_t rxAdverts;
+    uint32_t rxMessages;
+    uint32_t contactEvictions;
+    uint32_t contactDrops;
+    uint32_t rxOtherRecipient;
+    uint32_t rxUnresolvedSenders;
+    uint32_t rxHeldDelivered;
+    uint32_t txFragments;
+    uint32_t rxFragments;
+    uint32_t fragmentRetransmits;
+    uint32_t fragmentNacks;
+    uint32_t reassemblyTimeouts;
+    uint32_t forwarded;
+    uint32_t routeDuplicates;
+    uint32_t forwardsCancelled;
+    uint32_t forwardDrops;
+    uint32_t txDirectRouted;
+    uint32_t advertsSigned;
+    uint32_t advertSigFailures;
+    uint32_t verifyBatches;
+    uint32_t txAdverts;
+    uint32_t advertsSuppressed;
+    uint32_t stateSaves;
+    uint32_t stateSaveFailures;
+    uint32_t stateLoadFailures;
+    uint32_t txPackets;
+    uint32_t txFailures;
+    uint32_t txAirtimeMs;
+    uint32_t txQueueDrops;
+    uint32_t txTimeouts;
+    uint32_t txDutyCycleDrops;
+    uint32_t lbtScans;
+    uint32_t lbtDefers;
+    uint32_t lbtDeferMs;
+    uint32_t lbtForced;
+    uint32_t adrSwitches;
+    uint32_t adrFastFrames;
+    uint32_t adrWindows;
+
+    // Service
+    uint32_t messagesStored;
+    uint32_t storageErrors;
+    uint32_t messagesPublished;
+    uint32_t contactBatches;
+    uint32_t statusEvents;
+    uint32_t eventQueueDepth;
+    uint32_t eventQueuePeak;
+    uint32_t bootStageMs[BOOT_STAGE_COUNT];
+    uint32_t bootTotalMs;
+
+    // Mesh loop watchdog
+    uint32_t loopOverruns;
+    uint32_t stageOverruns[LOOP_STAGE_COUNT];
+    uint32_t loopStalls;
+    uint32_t loopDegradations;
+    uint32_t lastOverrunStage;          // LoopStage
+    uint32_t lastOverrunUs;
+    bool loopDegraded;
+
+    // Power
+    uint32_t rxDutyPermille;
+    uint32_t radioCurrentUa;
+    uint32_t powerSavedUa;
+    uint32_t rxPerMinute;
+    uint32_t powerPlanChanges;
+
+    // Radio arbiter
+    uint32_t arbiterSlotSwitches;
+    uint32_t arbiterSharedFrames;
+    uint32_t arbiterTxQueued;
+    uint32_t arbiterTxQueueDrops;
+    uint32_t arbiterConfigFailures;
+
+    diag::LatencyHistogram::Snapshot loop;
+    diag::LatencyHistogram::Snapshot mutexWait;
+    diag::LatencyHistogram::Snapshot storage;
+};
+
+/**
+ * Copy live metrics into a snapshot.
+ */
+MetricsSnapshot takeSnapshot(const ServiceMetrics& metrics, uint32_t uptimeMs, bool loopDegraded = false);
+
+/**
+ * Compact multi-line text dump ("key=value" pairs, one group per line).
+ * Returns the number of characters written (excluding terminator).
+ */
+size_t formatMetrics(const MetricsSnapshot& snapshot, char* dest, size_t maxLen);
+
+} // namespace meshola::service
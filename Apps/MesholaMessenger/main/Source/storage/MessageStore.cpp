@@ -3,22 +3,23 @@
 #include <cstring>
 #include <cstdlib>
 
-// For directory creation
-#ifdef ESP_PLATFORM
+// For directory creation (POSIX on device and on Linux/macOS hosts)
 #include <sys/stat.h>
 #include <dirent.h>
 #include <errno.h>
-#endif
 
 namespace meshola {
 
-static const char* STORAGE_BASE = "/data/meshola/messenger";
+// One JSON line: text escaped to at most twice its length, plus keys and fields
+static constexpr size_t MAX_JSON_LINE = MAX_MESSAGE_LEN * 2 + 256;
 
-MessageStore::MessageStore()
+MessageStore::MessageStore(const char* storageRoot)
     : _hasProfile(false)
 {
     memset(_profileId, 0, sizeof(_profileId));
     memset(_basePath, 0, sizeof(_basePath));
+    strncpy(_storageRoot, storageRoot ? storageRoot : DEFAULT_STORAGE_ROOT, sizeof(_storageRoot) - 1);
+    _storageRoot[sizeof(_storageRoot) - 1] = '\0';
 }
 
 MessageStore::~MessageStore() {
@@ -32,7 +33,7 @@ void MessageStore::setActiveProfile(const char* profileId) {
     
     strncpy(_profileId, profileId, sizeof(_profileId) - 1);
     snprintf(_basePath, sizeof(_basePath), "%s/profiles/%s/messages", 
-             STORAGE_BASE, profileId);
+             _storageRoot, profileId);
     _hasProfile = true;
     
     // Ensure messages directory exists
@@ -55,7 +56,7 @@ bool MessageStore::appendMessage(const Message& msg) {
     }
     
     // Serialize message to JSON
-    char jsonLine[512];
+    char jsonLine[MAX_JSON_LINE];
     if (!serializeMessage(msg, jsonLine, sizeof(jsonLine))) {
         return false;
     }
@@ -93,7 +94,7 @@ bool MessageStore::loadContactMessages(const uint8_t publicKey[PUBLIC_KEY_SIZE],
         return true;
     }
     
-    char line[512];
+    char line[MAX_JSON_LINE];
     std::vector<Message> allMessages;
     
     while (fgets(line, sizeof(line), f)) {
@@ -136,7 +137,7 @@ bool MessageStore::loadChannelMessages(const uint8_t channelId[CHANNEL_ID_SIZE],
         return true;  // No messages yet
     }
     
-    char line[512];
+    char line[MAX_JSON_LINE];
     std::vector<Message> allMessages;
     
     while (fgets(line, sizeof(line), f)) {
@@ -330,7 +331,7 @@ bool MessageStore::deserializeMessage(const char* json, Message& msg) {
         }
     };
     
-    char buf[256];
+    char buf[MAX_MESSAGE_LEN];
     
     // Parse timestamp
     if (findValue("ts", buf, sizeof(buf))) {
@@ -391,7 +392,6 @@ bool MessageStore::deserializeMessage(const char* json, Message& msg) {
 }
 
 bool MessageStore::ensureDirectory(const char* path) {
-#ifdef ESP_PLATFORM
     struct stat st;
     if (stat(path, &st) == 0) {
         return true;  // Already exists
@@ -410,10 +410,6 @@ bool MessageStore::ensureDirectory(const char* path) {
     }
     
     return mkdir(path, 0755) == 0 || errno == EEXIST;
-#else
-    // Stub for non-ESP builds
-    return true;
-#endif
 }
 
 // ============================================================================
@@ -21,7 +21,12 @@ namespace meshola {
  */
 class MessageStore {
 public:
-    MessageStore();
+    static constexpr const char* DEFAULT_STORAGE_ROOT = "/data/meshola/messenger";
+    
+    /**
+     * @param storageRoot Directory holding profiles/ (host tools point this elsewhere)
+     */
+    explicit MessageStore(const char* storageRoot = DEFAULT_STORAGE_ROOT);
     ~MessageStore();
     
     /**
@@ -134,7 +139,8 @@ private:
     char _profileId[32];
     bool _hasProfile;
     
-    // Base path for current profile's messages
+    // Root for all profiles, and base path for current profile's messages
+    char _storageRoot[96];
     char _basePath[128];
 };
 
@@ -0,0 +1,245 @@
+#include "StateSnapshot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+
+namespace meshola {
+
+static const char SNAPSHOT_MAGIC[4] = { 'M', 'S', 'N', 'P' };
+
+static uint32_t crc32Update(uint32_t crc, const void* data, size_t len) {
+    // Reflected CRC-32 (zlib), a nibble at a time: 64 bytes of table
+    static const uint32_t TABLE[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= bytes[i];
+        crc = (crc >> 4) ^ TABLE[crc & 0x0F];
+        crc = (crc >> 4) ^ TABLE[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+// ============================================================================
+// SnapshotWriter
+// ============================================================================
+
+SnapshotWriter::~SnapshotWriter() {
+    discard();
+}
+
+bool SnapshotWriter::open(const char* path) {
+    discard();
+    if (!path || strlen(path) >= sizeof(_path)) {
+        return false;
+    }
+    strncpy(_path, path, sizeof(_path) - 1);
+    snprintf(_tempPath, sizeof(_tempPath), "%s.tmp", path);
+    _file = fopen(_tempPath, "wb");
+    if (!_file) {
+        return false;
+    }
+    memset(&_header, 0, sizeof(_header));
+    memcpy(_header.magic, SNAPSHOT_MAGIC, sizeof(_header.magic));
+    _header.version = SNAPSHOT_FILE_VERSION;
+    _header.contactRecordSize = sizeof(SnapshotContactRecord);
+    _header.channelRecordSize = sizeof(SnapshotChannelRecord);
+    _crc = 0;
+    // Placeholder; commit() rewrites it with the counts and CRC
+    _ok = fwrite(&_header, sizeof(_header), 1, _file) == 1;
+    return _ok;
+}
+
+bool SnapshotWriter::append(const void* data, size_t len) {
+    if (!_file || !_ok) {
+        return false;
+    }
+    _crc = crc32Update(_crc, data, len);
+    _ok = fwrite(data, len, 1, _file) == 1;
+    return _ok;
+}
+
+bool SnapshotWriter::addContact(const Contact& contact, uint32_t nowMs) {
+    SnapshotContactRecord record = {};
+    memcpy(record.publicKey, contact.publicKey, sizeof(record.publicKey));
+    memcpy(record.name, contact.name, sizeof(record.name));
+    record.name[sizeof(record.name) - 1] = '\0';
+    record.lastSeen = contact.lastSeen;
+    record.linkAgeMs = contact.linkSamples ? nowMs - contact.linkUpdatedMs : 0;
+    record.linkRssi = contact.linkRssi;
+    record.linkSnr = contact.linkSnr;
+    record.latitude = contact.latitude;
+    record.longitude = contact.longitude;
+    record.lastRssi = contact.lastRssi;
+    record.lastSnr = contact.lastSnr;
+    record.role = static_cast<uint8_t>(contact.role);
+    record.flags = (contact.isFavorite ? SNAPSHOT_CONTACT_FAVORITE : 0) |
+                   (contact.isDiscovered ? SNAPSHOT_CONTACT_DISCOVERED : 0) |
+                   (contact.hasPath ? SNAPSHOT_CONTACT_HAS_PATH : 0) |
+                   (contact.hasLocation ? SNAPSHOT_CONTACT_HAS_LOCATION : 0);
+    record.peerFlags = contact.peerFlags;
+    record.peerTxPower = contact.peerTxPower;
+    record.linkSamples = contact.linkSamples;
+    record.pathLength = contact.pathLength;
+    memcpy(record.path, contact.path, sizeof(record.path));
+    if (!append(&record, sizeof(record))) {
+        return false;
+    }
+    _header.contactCount++;
+    return true;
+}
+
+bool SnapshotWriter::addChannel(const Channel& channel) {
+    SnapshotChannelRecord record = {};
+    memcpy(record.id, channel.id, sizeof(record.id));
+    memcpy(record.name, channel.name, sizeof(record.name));
+    record.name[sizeof(record.name) - 1] = '\0';
+    record.isPublic = channel.isPublic ? 1 : 0;
+    record.index = channel.index;
+    if (!append(&record, sizeof(record))) {
+        return false;
+    }
+    _header.channelCount++;
+    return true;
+}
+
+bool SnapshotWriter::commit() {
+    if (!_file) {
+        return false;
+    }
+    _header.crc = _crc;
+    bool ok = _ok && fseek(_file, 0, SEEK_SET) == 0 &&
+              fwrite(&_header, sizeof(_header), 1, _file) == 1 &&
+              fflush(_file) == 0 && fsync(fileno(_file)) == 0;
+    ok = fclose(_file) == 0 && ok;
+    _file = nullptr;
+    if (!ok) {
+        remove(_tempPath);
+        return false;
+    }
+    if (rename(_tempPath, _path) != 0) {
+        // FAT won't rename over an existing file; the reader falls back to
+        // the temporary file if we stop between these two calls
+        remove(_path);
+        if (rename(_tempPath, _path) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SnapshotWriter::discard() {
+    if (_file) {
+        fclose(_file);
+        _file = nullptr;
+        remove(_tempPath);
+    }
+    _ok = false;
+}
+
+// ============================================================================
+// SnapshotReader
+// ============================================================================
+
+bool SnapshotReader::open(const char* path) {
+    _exists = false;
+    if (!path) {
+        return false;
+    }
+    if (load(path)) {
+        return true;
+    }
+    if (_exists) {
+        return false;
+    }
+    char tempPath[SNAPSHOT_MAX_PATH_LEN + 4];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+    return load(tempPath);
+}
+
+bool SnapshotReader::load(const char* path) {
+    _data.clear();
+    memset(&_header, 0, sizeof(_header));
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    _exists = true;
+    long size = -1;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        size = ftell(f);
+    }
+    bool ok = size >= (long)sizeof(SnapshotFileHeader) && fseek(f, 0, SEEK_SET) == 0;
+    if (ok) {
+        _data.resize((size_t)size);
+        ok = fread(_data.data(), _data.size(), 1, f) == 1;
+    }
+    fclose(f);
+    if (!ok) {
+        _data.clear();
+        return false;
+    }
+
+    SnapshotFileHeader header;
+    memcpy(&header, _data.data(), sizeof(header));
+    uint64_t recordsLen = (uint64_t)header.contactCount * header.contactRecordSize +
+                          (uint64_t)header.channelCount * header.channelRecordSize;
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != SNAPSHOT_FILE_VERSION ||
+        header.contactRecordSize < sizeof(SnapshotContactRecord) ||
+        header.channelRecordSize < sizeof(SnapshotChannelRecord) ||
+        recordsLen > _data.size() - sizeof(header) ||
+        crc32Update(0, &_data[sizeof(header)], (size_t)recordsLen) != header.crc) {
+        _data.clear();
+        return false;
+    }
+    _header = header;
+    return true;
+}
+
+void SnapshotReader::contact(size_t index, uint32_t nowMs, Contact& out) const {
+    SnapshotContactRecord record;
+    memcpy(&record, &_data[sizeof(_header) + index * _header.contactRecordSize], sizeof(record));
+    memset(&out, 0, sizeof(out));
+    memcpy(out.publicKey, record.publicKey, sizeof(out.publicKey));
+    memcpy(out.name, record.name, sizeof(out.name));
+    out.name[sizeof(out.name) - 1] = '\0';
+    out.lastSeen = record.lastSeen;
+    out.lastRssi = record.lastRssi;
+    out.lastSnr = record.lastSnr;
+    out.role = record.role <= static_cast<uint8_t>(NodeRole::Room) ? static_cast<NodeRole>(record.role)
+                                                                   : NodeRole::Unknown;
+    out.isFavorite = (record.flags & SNAPSHOT_CONTACT_FAVORITE) != 0;
+    out.isDiscovered = (record.flags & SNAPSHOT_CONTACT_DISCOVERED) != 0;
+    out.hasPath = (record.flags & SNAPSHOT_CONTACT_HAS_PATH) != 0;
+    out.hasLocation = (record.flags & SNAPSHOT_CONTACT_HAS_LOCATION) != 0;
+    out.pathLength = std::min<uint8_t>(record.pathLength, MAX_PATH_LEN + 1);
+    memcpy(out.path, record.path, sizeof(out.path));
+    out.peerFlags = record.peerFlags;
+    out.peerTxPower = record.peerTxPower;
+    out.linkRssi = record.linkRssi;
+    out.linkSnr = record.linkSnr;
+    out.linkSamples = record.linkSamples;
+    out.linkUpdatedMs = nowMs - record.linkAgeMs;
+    out.latitude = record.latitude;
+    out.longitude = record.longitude;
+}
+
+void SnapshotReader::channel(size_t index, Channel& out) const {
+    SnapshotChannelRecord record;
+    size_t offset = sizeof(_header) + _header.contactCount * _header.contactRecordSize +
+                    index * _header.channelRecordSize;
+    memcpy(&record, &_data[offset], sizeof(record));
+    memset(&out, 0, sizeof(out));
+    memcpy(out.id, record.id, sizeof(out.id));
+    memcpy(out.name, record.name, sizeof(out.name));
+    out.name[sizeof(out.name) - 1] = '\0';
+    out.isPublic = record.isPublic != 0;
+    out.index = record.index;
+}
+
+} // namespace meshola
@@ -0,0 +1,150 @@
+#pragma once
+
+/**
+ * StateSnapshot - Binary snapshot of a protocol's contacts and channels.
+ *
+ * Restoring the contact table at boot spares the mesh the adverts a node
+ * would otherwise need to relearn it: names, keys, learned paths,
+ * favorites, link averages and the channel settings all come back.
+ *
+ * File layout: SnapshotFileHeader, then contactCount SnapshotContactRecords
+ * and channelCount SnapshotChannelRecords. The header's CRC-32 covers
+ * everything after it. A later layout may append fields to a record and
+ * raise its size; readers use the fields they know and skip the rest.
+ *
+ * SnapshotWriter streams records into "<path>.tmp" and renames it over the
+ * snapshot once complete, so a crash or power cut mid-write leaves the
+ * previous snapshot in place. SnapshotReader loads the whole file with one
+ * read and checks it before any record is used. Not thread-safe.
+ */
+
+#include "../protocol/IProtocol.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace meshola {
+
+constexpr uint16_t SNAPSHOT_FILE_VERSION = 1;
+constexpr size_t SNAPSHOT_MAX_PATH_LEN = 160;
+
+// SnapshotContactRecord::flags
+constexpr uint8_t SNAPSHOT_CONTACT_FAVORITE = 0x01;
+constexpr uint8_t SNAPSHOT_CONTACT_DISCOVERED = 0x02;
+constexpr uint8_t SNAPSHOT_CONTACT_HAS_PATH = 0x04;
+constexpr uint8_t SNAPSHOT_CONTACT_HAS_LOCATION = 0x08;
+
+struct SnapshotFileHeader {
+    char magic[4];              // "MSNP"
+    uint16_t version;           // SNAPSHOT_FILE_VERSION
+    uint16_t contactRecordSize; // sizeof(SnapshotContactRecord) when written
+    uint16_t channelRecordSize;
+    uint16_t reserved;
+    uint32_t contactCount;
+    uint32_t channelCount;
+    uint32_t crc;               // CRC-32 of the records
+};
+static_assert(sizeof(SnapshotFileHeader) == 24, "SnapshotFileHeader layout changed");
+
+struct SnapshotContactRecord {
+    uint8_t publicKey[PUBLIC_KEY_SIZE];
+    char name[MAX_NODE_NAME_LEN];
+    uint32_t lastSeen;          // Unix time
+    uint32_t linkAgeMs;         // Since the last link sample, when saved
+    float linkRssi;
+    float linkSnr;
+    double latitude;
+    double longitude;
+    int16_t lastRssi;
+    int8_t lastSnr;
+    uint8_t role;               // NodeRole
+    uint8_t flags;              // SNAPSHOT_CONTACT_*
+    uint8_t peerFlags;
+    int8_t peerTxPower;
+    uint8_t linkSamples;
+    uint8_t pathLength;
+    uint8_t path[MAX_PATH_LEN];
+    uint8_t reserved[7];
+};
+static_assert(sizeof(SnapshotContactRecord) == 120, "SnapshotContactRecord layout changed");
+
+struct SnapshotChannelRecord {
+    uint8_t id[CHANNEL_ID_SIZE];
+    char name[MAX_CHANNEL_NAME_LEN];
+    uint8_t isPublic;
+    uint8_t index;
+    uint8_t reserved[2];
+};
+static_assert(sizeof(SnapshotChannelRecord) == 52, "SnapshotChannelRecord layout changed");
+
+/**
+ * Writes one snapshot: open(), every contact, then every channel, commit().
+ * Destroying it before commit() discards the temporary file.
+ */
+class SnapshotWriter {
+public:
+    SnapshotWriter() = default;
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    bool open(const char* path);
+
+    /**
+     * @param nowMs Monotonic time, to store link sample ages
+     */
+    bool addContact(const Contact& contact, uint32_t nowMs);
+    bool addChannel(const Channel& channel);
+
+    /**
+     * Write the header, flush to storage and replace the snapshot.
+     */
+    bool commit();
+
+private:
+    FILE* _file = nullptr;
+    char _path[SNAPSHOT_MAX_PATH_LEN] = {};
+    char _tempPath[SNAPSHOT_MAX_PATH_LEN + 4] = {};
+    SnapshotFileHeader _header = {};
+    uint32_t _crc = 0;
+    bool _ok = false;
+
+    bool append(const void* data, size_t len);
+    void discard();
+};
+
+/**
+ * Reads a snapshot written by SnapshotWriter. Falls back to "<path>.tmp" if
+ * the snapshot is missing, which only happens when a rename that can't
+ * replace files (FAT) was interrupted.
+ */
+class SnapshotReader {
+public:
+    /**
+     * Read and check the file. False if it is missing, truncated, of an
+     * unknown version or fails its CRC; exists() tells the first apart.
+     */
+    bool open(const char* path);
+    bool exists() const { return _exists; }
+
+    size_t contactCount() const { return _header.contactCount; }
+    size_t channelCount() const { return _header.channelCount; }
+
+    /**
+     * @param nowMs Monotonic time; linkUpdatedMs is set from the saved age
+     */
+    void contact(size_t index, uint32_t nowMs, Contact& out) const;
+    void channel(size_t index, Channel& out) const;
+
+private:
+    std::vector<uint8_t> _data;
+    SnapshotFileHeader _header = {};
+    bool _exists = false;
+
+    bool load(const char* path);
+};
+
+} // namespace meshola
@@ -0,0 +1,31 @@
+#include "Clock.h"
+
+#ifdef ESP_PLATFORM
+#include <esp_timer.h>
+#else
+#include <chrono>
+#endif
+
+namespace meshola::clock {
+
+static MicrosSource sSource = nullptr;
+
+static uint64_t platformMicros() {
+#ifdef ESP_PLATFORM
+    return (uint64_t)esp_timer_get_time();
+#else
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+uint64_t micros() {
+    MicrosSource source = sSource;
+    return source ? source() : platformMicros();
+}
+
+void setSource(MicrosSource source) {
+    sSource = source;
+}
+
+} // namespace meshola::clock
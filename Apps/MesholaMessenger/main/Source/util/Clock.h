@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+namespace meshola::clock {
+
+/**
+ * Monotonic time source shared by the protocol, service and diagnostics.
+ *
+ * ESP32: esp_timer_get_time() (microseconds since boot).
+ * Host:  std::chrono::steady_clock.
+ *
+ * The source can be replaced (e.g. by a simulator's virtual clock) so all
+ * timing decisions stay deterministic off-target.
+ */
+using MicrosSource = uint64_t (*)();
+
+/**
+ * Microseconds since an arbitrary fixed point.
+ */
+uint64_t micros();
+
+/**
+ * Milliseconds since an arbitrary fixed point (wraps after ~49 days).
+ */
+inline uint32_t millis() {
+    return (uint32_t)(micros() / 1000);
+}
+
+/**
+ * Replace the time source. Pass nullptr to restore the platform clock.
+ */
+void setSource(MicrosSource source);
+
+} // namespace meshola::clock
@@ -139,16 +139,12 @@ void ContactsView::createEmptyState() {
 void ContactsView::refresh() {
     if (!_contactList || !_service) return;
     
-    // Get contacts from MesholaMsgService via service pointer
-    int count = _service->getContactCount();
-    
+    // One service lock for the whole list; _contacts keeps its capacity
     _contacts.clear();
-    for (int i = 0; i < count; i++) {
-        Contact contact;
-        if (_service->getContact(i, contact)) {
-            _contacts.push_back(contact);
-        }
-    }
+    _service->forEachContact([this](const Contact& contact) {
+        _contacts.push_back(contact);
+        return true;
+    });
     
     updateListDisplay();
 }
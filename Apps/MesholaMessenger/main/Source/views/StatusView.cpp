@@ -0,0 +1,169 @@
+#include "StatusView.h"
+#include "service/MesholaMsgService.h"
+#include "diag/Trace.h"
+
+namespace meshola {
+
+// Colors (match MesholaApp)
+static constexpr uint32_t COLOR_BG_DARK = 0x1a1a1a;
+static constexpr uint32_t COLOR_BG_CARD = 0x2d2d2d;
+static constexpr uint32_t COLOR_ACCENT = 0x0066cc;
+static constexpr uint32_t COLOR_TEXT = 0xffffff;
+
+StatusView::StatusView()
+    : _container(nullptr)
+    , _metricsLabel(nullptr)
+    , _captureLabel(nullptr)
+    , _service(nullptr)
+{
+}
+
+StatusView::~StatusView() {
+    destroy();
+}
+
+void StatusView::setService(std::shared_ptr<service::MesholaMsgService> service) {
+    _service = service;
+}
+
+void StatusView::create(lv_obj_t* parent) {
+    _container = lv_obj_create(parent);
+    lv_obj_set_size(_container, LV_PCT(100), LV_PCT(100));
+    lv_obj_set_flex_flow(_container, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_style_pad_all(_container, 0, LV_STATE_DEFAULT);
+    lv_obj_set_style_pad_row(_container, 0, LV_STATE_DEFAULT);
+    lv_obj_set_style_border_width(_container, 0, LV_STATE_DEFAULT);
+    lv_obj_set_style_bg_color(_container, lv_color_hex(COLOR_BG_DARK), LV_STATE_DEFAULT);
+
+    createHeader();
+
+    auto* body = lv_obj_create(_container);
+    lv_obj_set_width(body, LV_PCT(100));
+    lv_obj_set_flex_grow(body, 1);
+    lv_obj_set_style_pad_all(body, 8, LV_STATE_DEFAULT);
+    lv_obj_set_style_bg_color(body, lv_color_hex(COLOR_BG_DARK), LV_STATE_DEFAULT);
+    lv_obj_set_style_border_width(body, 0, LV_STATE_DEFAULT);
+    lv_obj_set_scrollbar_mode(body, LV_SCROLLBAR_MODE_AUTO);
+
+    _metricsLabel = lv_label_create(body);
+    lv_obj_set_width(_metricsLabel, LV_PCT(100));
+    lv_label_set_long_mode(_metricsLabel, LV_LABEL_LONG_WRAP);
+    lv_obj_set_style_text_color(_metricsLabel, lv_color_hex(COLOR_TEXT), LV_STATE_DEFAULT);
+
+    refresh();
+}
+
+void StatusView::destroy() {
+    _container = nullptr;
+    _metricsLabel = nullptr;
+    _captureLabel = nullptr;
+}
+
+void StatusView::createHeader() {
+    auto* header = lv_obj_create(_container);
+    lv_obj_set_width(header, LV_PCT(100));
+    lv_obj_set_height(header, 44);
+    lv_obj_set_flex_flow(header, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(header, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_all(header, 8, LV_STATE_DEFAULT);
+    lv_obj_set_style_pad_column(header, 8, LV_STATE_DEFAULT);
+    lv_obj_set_style_bg_color(header, lv_color_hex(COLOR_BG_CARD), LV_STATE_DEFAULT);
+    lv_obj_set_style_border_width(header, 0, LV_STATE_DEFAULT);
+    lv_obj_set_style_radius(header, 0, LV_STATE_DEFAULT);
+
+    auto* title = lv_label_create(header);
+    lv_label_set_text(title, "Diagnostics");
+    lv_obj_set_style_text_font(title, &lv_font_montserrat_14, LV_STATE_DEFAULT);
+    lv_obj_set_flex_grow(title, 1);
+
+    auto* logBtn = lv_btn_create(header);
+    lv_obj_set_size(logBtn, LV_SIZE_CONTENT, 28);
+    lv_obj_set_style_bg_color(logBtn, lv_color_hex(COLOR_ACCENT), LV_STATE_DEFAULT);
+    lv_obj_set_style_pad_all(logBtn, 6, LV_STATE_DEFAULT);
+    lv_obj_add_event_cb(logBtn, onLogPressed, LV_EVENT_CLICKED, this);
+    auto* logLabel = lv_label_create(logBtn);
+    lv_label_set_text(logLabel, LV_SYMBOL_SAVE " Log");
+
+    auto* captureBtn = lv_btn_create(header);
+    lv_obj_set_size(captureBtn, LV_SIZE_CONTENT, 28);
+    lv_obj_set_style_bg_color(captureBtn, lv_color_hex(COLOR_ACCENT), LV_STATE_DEFAULT);
+    lv_obj_set_style_pad_all(captureBtn, 6, LV_STATE_DEFAULT);
+    lv_obj_add_event_cb(captureBtn, onCapturePressed, LV_EVENT_CLICKED, this);
+    _captureLabel = lv_label_create(captureBtn);
+    updateCaptureLabel();
+
+#if MESHOLA_TRACE
+    auto* traceBtn = lv_btn_create(header);
+    lv_obj_set_size(traceBtn, LV_SIZE_CONTENT, 28);
+    lv_obj_set_style_bg_color(traceBtn, lv_color_hex(COLOR_ACCENT), LV_STATE_DEFAULT);
+    lv_obj_set_style_pad_all(traceBtn, 6, LV_STATE_DEFAULT);
+    lv_obj_add_event_cb(traceBtn, onTracePressed, LV_EVENT_CLICKED, this);
+    auto* traceLabel = lv_label_create(traceBtn);
+    lv_label_set_text(traceLabel, LV_SYMBOL_SD_CARD " Trace");
+#endif
+
+    auto* refreshBtn = lv_btn_create(header);
+    lv_obj_set_size(refreshBtn, 28, 28);
+    lv_obj_set_style_bg_color(refreshBtn, lv_color_hex(COLOR_BG_DARK), LV_STATE_DEFAULT);
+    lv_obj_set_style_pad_all(refreshBtn, 4, LV_STATE_DEFAULT);
+    lv_obj_add_event_cb(refreshBtn, onRefreshPressed, LV_EVENT_CLICKED, this);
+    auto* refreshLabel = lv_label_create(refreshBtn);
+    lv_label_set_text(refreshLabel, LV_SYMBOL_REFRESH);
+    lv_obj_center(refreshLabel);
+}
+
+void StatusView::refresh() {
+    if (!_metricsLabel) return;
+
+    if (!_service) {
+        lv_label_set_text(_metricsLabel, "Service not running");
+        return;
+    }
+
+    // Also catches a mesh loop that is stuck right now
+    _service->checkWatchdog();
+
+    char dump[1536];
+    service::formatMetrics(_service->getMetrics(), dump, sizeof(dump));
+    lv_label_set_text(_metricsLabel, dump);
+}
+
+void StatusView::onRefreshPressed(lv_event_t* event) {
+    auto* view = static_cast<StatusView*>(lv_event_get_user_data(event));
+    if (view) {
+        view->refresh();
+    }
+}
+
+void StatusView::onLogPressed(lv_event_t* event) {
+    auto* view = static_cast<StatusView*>(lv_event_get_user_data(event));
+    if (view && view->_service) {
+        view->_service->logMetrics();
+    }
+}
+
+void StatusView::updateCaptureLabel() {
+    if (!_captureLabel) return;
+    bool capturing = _service && _service->isCapturing();
+    lv_label_set_text(_captureLabel, capturing ? LV_SYMBOL_STOP " Capture" : LV_SYMBOL_SD_CARD " Capture");
+}
+
+void StatusView::onCapturePressed(lv_event_t* event) {
+    auto* view = static_cast<StatusView*>(lv_event_get_user_data(event));
+    if (!view || !view->_service) return;
+    if (view->_service->isCapturing()) {
+        view->_service->stopCapture();
+    } else {
+        view->_service->startCapture();
+    }
+    view->updateCaptureLabel();
+}
+
+void StatusView::onTracePressed(lv_event_t* event) {
+    auto* view = static_cast<StatusView*>(lv_event_get_user_data(event));
+    if (view && view->_service) {
+        view->_service->dumpTrace();
+    }
+}
+
+} // namespace meshola
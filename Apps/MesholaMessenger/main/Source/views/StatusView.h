@@ -0,0 +1,67 @@
+#pragma once
+
+#include "protocol/IProtocol.h"
+#include <lvgl.h>
+#include <memory>
+
+// Forward declaration to avoid circular include
+namespace meshola::service {
+    class MesholaMsgService;
+}
+
+namespace meshola {
+
+/**
+ * StatusView - Service diagnostics screen.
+ *
+ * Shows the MesholaMsgService metrics dump (RX/TX counters, storage and
+ * lock latency) with buttons to refresh, to copy the dump to the serial log
+ * and to start/stop raw RX capture to SD.
+ *
+ * NOTE: This view receives its service pointer from MesholaApp.
+ */
+class StatusView {
+public:
+    StatusView();
+    ~StatusView();
+
+    /**
+     * Set the service pointer. Must be called before create().
+     */
+    void setService(std::shared_ptr<service::MesholaMsgService> service);
+
+    /**
+     * Create the view UI.
+     */
+    void create(lv_obj_t* parent);
+
+    /**
+     * Destroy the view UI.
+     */
+    void destroy();
+
+    /**
+     * Re-read metrics from MesholaMsgService.
+     */
+    void refresh();
+
+private:
+    // UI elements
+    lv_obj_t* _container;
+    lv_obj_t* _metricsLabel;
+    lv_obj_t* _captureLabel;
+
+    void createHeader();
+    void updateCaptureLabel();
+
+    // Event handlers
+    static void onRefreshPressed(lv_event_t* event);
+    static void onLogPressed(lv_event_t* event);
+    static void onTracePressed(lv_event_t* event);
+    static void onCapturePressed(lv_event_t* event);
+
+    // Service pointer (owned by MesholaApp, not us)
+    std::shared_ptr<service::MesholaMsgService> _service;
+};
+
+} // namespace meshola
@@ -0,0 +1,283 @@
+#include "MeshSimulator.h"
+#include "VirtualClock.h"
+
+#include "crypto/Ed25519.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace meshola::sim {
+
+// Channel messages carry their id so receptions can be matched to sends
+static const char* MESSAGE_FORMAT = "sim %u";
+
+MeshSimulator::MeshSimulator(const SimConfig& config)
+    : _config(config)
+    , _rng(config.seed)
+    , _directRng(config.seed ^ 0x9E3779B97F4A7C15ull)
+    , _channel(config.channel, config.seed ^ 0xC3A5C85C97CB3127ull)
+{
+    VirtualClock::install();
+    VirtualClock::setUs(0);
+
+    _nodes.resize(_config.nodeCount);
+    for (int i = 0; i < _config.nodeCount; i++) {
+        Node& node = _nodes[i];
+        auto radio = std::make_unique<SimRadio>(_channel);
+        node.radio = radio.get();
+        node.protocol = std::make_unique<MeshCoreProtocol>(std::move(radio));
+
+        char name[MAX_NODE_NAME_LEN];
+        snprintf(name, sizeof(name), "sim-%04d", i);
+        uint8_t publicKey[PUBLIC_KEY_SIZE];
+        for (size_t b = 0; b < PUBLIC_KEY_SIZE; b += 8) {
+            uint64_t word = _rng.next();
+            memcpy(&publicKey[b], &word, std::min<size_t>(8, PUBLIC_KEY_SIZE - b));
+        }
+        // With signed adverts the random bytes are the private key instead
+        uint8_t privateKey[PUBLIC_KEY_SIZE];
+        if (_config.signedAdverts) {
+            memcpy(privateKey, publicKey, sizeof(privateKey));
+            crypto::ed25519PublicKey(privateKey, publicKey);
+        }
+        node.protocol->setNodeName(name);
+        node.protocol->setLocalIdentity(publicKey, name);
+        if (_config.signedAdverts) {
+            node.protocol->setSigningKey(privateKey);
+        }
+        node.protocol->setCounters(&_counters);
+        _nodeByKeyHash[contactKeyHash(publicKey)] = i;
+        // Evenly spread: node i repeats when i * share crosses an integer
+        bool repeater = std::floor((i + 1) * _config.repeaterShare) > std::floor(i * _config.repeaterShare);
+        node.protocol->setRepeater(repeater);
+        node.protocol->setListenBeforeTalk(_config.listenBeforeTalk);
+        node.protocol->setAdaptiveDataRate(_config.adaptiveDataRate);
+        node.protocol->setAutoAdvert(_config.sendAdverts);
+        _report.repeaters += repeater ? 1 : 0;
+        node.protocol->setMessageCallback([this, i](const Message& msg) { onMessage(i, msg); });
+        node.protocol->setContactCallback([this](const Contact&, bool isNew) {
+            if (isNew) {
+                _report.contactsLearned++;
+            }
+        });
+    }
+
+    placeNodes();
+
+    for (auto& node : _nodes) {
+        node.protocol->init(_config.channel.radio);
+        node.protocol->start();
+    }
+
+    generateWorkload();
+}
+
+MeshSimulator::~MeshSimulator() {
+    _nodes.clear();
+    VirtualClock::uninstall();
+}
+
+void MeshSimulator::placeNodes() {
+    const int count = _config.nodeCount;
+    const double spacing = _config.spacingM;
+    const int columns = std::max(1, (int)std::ceil(std::sqrt((double)count)));
+    const double side = spacing * std::sqrt((double)count);
+
+    for (int i = 0; i < count; i++) {
+        double x = 0.0;
+        double y = 0.0;
+        switch (_config.topology) {
+            case Topology::Grid:
+                x = (i % columns) * spacing;
+                y = (i / columns) * spacing;
+                break;
+            case Topology::Line:
+                x = i * spacing;
+                break;
+            case Topology::Random:
+                x = _rng.uniform() * side;
+                y = _rng.uniform() * side;
+                break;
+        }
+        int id = _channel.addNode(_nodes[i].radio, x, y);
+        _nodes[i].radio->attach(id);
+    }
+}
+
+void MeshSimulator::generateWorkload() {
+    const uint64_t endUs = (uint64_t)_config.durationS * 1000000ull;
+    for (int i = 0; i < _config.nodeCount; i++) {
+        if (_config.messageIntervalS <= 0.0) {
+            continue;
+        }
+        double t = _rng.exponential(_config.messageIntervalS);
+        while (t * 1e6 < endUs) {
+            ActionType type = _directRng.chance(_config.directShare) ? ActionType::DirectMessage
+                                                                      : ActionType::ChannelMessage;
+            _actions.emplace(std::make_pair((uint64_t)(t * 1e6), _actionSeq++), Action{ type, i });
+            t += _rng.exponential(_config.messageIntervalS);
+        }
+    }
+}
+
+void MeshSimulator::scheduleChannelMessage(uint64_t atUs, int nodeId) {
+    _actions.emplace(std::make_pair(atUs, _actionSeq++), Action{ ActionType::ChannelMessage, nodeId });
+}
+
+void MeshSimulator::scheduleAdvert(uint64_t atUs, int nodeId) {
+    _actions.emplace(std::make_pair(atUs, _actionSeq++), Action{ ActionType::Advert, nodeId });
+}
+
+void MeshSimulator::runAction(const Action& action) {
+    MeshCoreProtocol& protocol = *_nodes[action.nodeId].protocol;
+    if (action.type == ActionType::Advert) {
+        protocol.sendAdvertisement();
+        return;
+    }
+    if (action.type == ActionType::DirectMessage) {
+        sendDirectMessage(action.nodeId);
+        return;
+    }
+
+    Channel channel{};
+    protocol.getChannel(0, channel);
+    uint32_t messageId = (uint32_t)_sent.size();
+    char text[32];
+    snprintf(text, sizeof(text), MESSAGE_FORMAT, messageId);
+    if (!protocol.sendChannelMessage(channel, text)) {
+        _report.sendFailures++;
+        return;
+    }
+    _sent.push_back(SentMessage{ .sender = action.nodeId, .recipient = -1, .sentAtUs = VirtualClock::nowUs() });
+    _report.neighbourExpected += _channel.neighbourCount(action.nodeId);
+}
+
+void MeshSimulator::sendDirectMessage(int nodeId) {
+    MeshCoreProtocol& protocol = *_nodes[nodeId].protocol;
+    // A random contact that is another simulated node (not the broadcast entry)
+    Contact to{};
+    int recipient = -1;
+    int count = protocol.getContactCount();
+    for (int attempt = 0; attempt < count && recipient < 0; attempt++) {
+        protocol.getContact((int)_directRng.below((uint32_t)count), to);
+        auto it = _nodeByKeyHash.find(contactKeyHash(to.publicKey));
+        if (it != _nodeByKeyHash.end() && it->second != nodeId) {
+            recipient = it->second;
+        }
+    }
+    if (recipient < 0) {
+        _report.sendFailures++;
+        return;
+    }
+
+    uint32_t messageId = (uint32_t)_sent.size();
+    char text[MAX_MESSAGE_LEN];
+    int idLen = snprintf(text, sizeof(text), MESSAGE_FORMAT, messageId);
+    size_t length = std::min(_config.directLength, sizeof(text) - 1);
+    for (size_t i = (size_t)idLen; i < length; i++) {
+        text[i] = (i == (size_t)idLen) ? ' ' : (char)('a' + i % 26);
+    }
+    text[std::max(length, (size_t)idLen)] = '\0';
+    bool routed = to.hasPath;
+    if (protocol.sendMessage(to, text) == 0) {
+        _report.sendFailures++;
+        return;
+    }
+    _sent.push_back(SentMessage{ .sender = nodeId, .recipient = recipient, .sentAtUs = VirtualClock::nowUs() });
+    _report.directSent++;
+    _report.directRouted += routed ? 1 : 0;
+}
+
+void MeshSimulator::onMessage(int receiver, const Message& msg) {
+    unsigned messageId = 0;
+    if (sscanf(msg.text, MESSAGE_FORMAT, &messageId) != 1 || messageId >= _sent.size()) {
+        return;
+    }
+    const SentMessage& sent = _sent[messageId];
+    if (sent.sender == receiver) {
+        return;
+    }
+    if (sent.recipient >= 0 && sent.recipient != receiver) {
+        return;                                 // DM overheard by a bystander
+    }
+    uint64_t key = ((uint64_t)messageId << 32) | (uint32_t)receiver;
+    if (!_receptions.insert(key).second) {
+        return;
+    }
+    if (sent.recipient >= 0) {
+        _report.directDelivered++;
+        _latenciesUs.push_back((uint32_t)(VirtualClock::nowUs() - sent.sentAtUs));
+        return;
+    }
+    _report.networkReceptions++;
+    if (_channel.inRange(sent.sender, receiver)) {
+        _report.neighbourReceptions++;
+    }
+    _latenciesUs.push_back((uint32_t)(VirtualClock::nowUs() - sent.sentAtUs));
+}
+
+SimReport MeshSimulator::run() {
+    auto wallStart = std::chrono::steady_clock::now();
+    const uint64_t endUs = (uint64_t)_config.durationS * 1000000ull;
+
+    for (uint64_t now = 0; now <= endUs; now += _config.tickUs) {
+        VirtualClock::setUs(now);
+        _channel.advanceTo(now);
+        while (!_actions.empty() && _actions.begin()->first.first <= now) {
+            Action action = _actions.begin()->second;
+            _actions.erase(_actions.begin());
+            runAction(action);
+        }
+        for (auto& node : _nodes) {
+            node.protocol->loop();
+        }
+    }
+
+    _report.nodes = _config.nodeCount;
+    _report.durationS = _config.durationS;
+    _report.messagesSent = _sent.size() - _report.directSent;
+    _report.channel = _channel.getStats();
+    _report.channelUtilisation = endUs ? (double)_report.channel.airtimeUs / endUs : 0.0;
+    _report.forwarded = _counters.forwarded.get();
+    _report.routeDuplicates = _counters.routeDuplicates.get();
+    _report.forwardsCancelled = _counters.forwardsCancelled.get();
+    _report.forwardDrops = _counters.forwardDrops.get();
+    _report.lbtScans = _counters.lbtScans.get();
+    _report.lbtDefers = _counters.lbtDefers.get();
+    _report.lbtDeferMs = _counters.lbtDeferMs.get();
+    _report.lbtForced = _counters.lbtForced.get();
+    _report.adrSwitches = _counters.adrSwitches.get();
+    _report.adrFastFrames = _counters.adrFastFrames.get();
+    _report.adrWindows = _counters.adrWindows.get();
+    _report.dutyCycleDrops = _counters.txDutyCycleDrops.get();
+    _report.advertsSigned = _counters.advertsSigned.get();
+    _report.advertSigFailures = _counters.advertSigFailures.get();
+    _report.verifyBatches = _counters.verifyBatches.get();
+    _report.advertsSent = _counters.txAdverts.get();
+    _report.advertsSuppressed = _counters.advertsSuppressed.get();
+
+    uint64_t neighbours = 0;
+    for (int i = 0; i < _config.nodeCount; i++) {
+        neighbours += _channel.neighbourCount(i);
+    }
+    _report.avgNeighbours = _config.nodeCount ? (double)neighbours / _config.nodeCount : 0.0;
+
+    if (!_latenciesUs.empty()) {
+        std::sort(_latenciesUs.begin(), _latenciesUs.end());
+        auto percentile = [&](double p) {
+            size_t index = (size_t)(p * (_latenciesUs.size() - 1));
+            return _latenciesUs[index] / 1000;
+        };
+        _report.latencyP50Ms = percentile(0.50);
+        _report.latencyP99Ms = percentile(0.99);
+        _report.latencyMaxMs = _latenciesUs.back() / 1000;
+    }
+
+    _report.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+    return _report;
+}
+
+} // namespace meshola::sim
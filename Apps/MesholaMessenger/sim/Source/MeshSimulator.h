@@ -0,0 +1,159 @@
+#pragma once
+
+#include "Rng.h"
+#include "SimChannel.h"
+#include "SimRadio.h"
+#include "diag/Metrics.h"
+#include "protocol/MeshCoreProtocol.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace meshola::sim {
+
+enum class Topology {
+    Grid,       // Square-ish grid, spacingM apart
+    Line,       // Chain, spacingM apart
+    Random      // Uniform in a square of side spacingM * sqrt(nodeCount)
+};
+
+struct SimConfig {
+    int nodeCount = 100;
+    Topology topology = Topology::Grid;
+    double spacingM = 3000.0;
+    ChannelConfig channel;
+    uint64_t seed = 1;
+    uint32_t durationS = 300;
+    uint32_t tickUs = 5000;             // Protocol loop() period
+    double messageIntervalS = 60.0;     // Mean per-node message interval, 0 = none
+    double directShare = 0.0;           // Share of messages sent as DMs to a random known contact
+    size_t directLength = 0;            // DM text padded to this many characters, 0 = id only
+    double repeaterShare = 0.0;         // Share of nodes that forward routed frames, evenly spread
+    bool sendAdverts = true;            // Scheduled adverts, the first within a minute of start
+    bool listenBeforeTalk = true;       // CAD + backoff before each transmit
+    bool adaptiveDataRate = true;       // Faster SF for DMs to close neighbours
+    bool signedAdverts = false;         // Ed25519 identities; adverts signed and batch-verified
+};
+
+struct SimReport {
+    int nodes = 0;
+    uint32_t durationS = 0;
+    double avgNeighbours = 0.0;
+    uint64_t messagesSent = 0;
+    uint64_t sendFailures = 0;
+    uint64_t neighbourReceptions = 0;   // Unique (message, receiver) pairs within one hop
+    uint64_t neighbourExpected = 0;     // Sum of sender neighbour counts
+    uint64_t networkReceptions = 0;     // Unique (message, receiver) pairs anywhere
+    uint64_t directSent = 0;
+    uint64_t directDelivered = 0;       // DMs received by their recipient
+    uint64_t directRouted = 0;          // DMs sent along a learned route
+    uint64_t advertsSent = 0;           // Scheduled and requested
+    uint64_t advertsSuppressed = 0;     // Scheduled adverts our own traffic stood in for
+    uint64_t contactsLearned = 0;
+    int repeaters = 0;
+    uint64_t forwarded = 0;             // Rebroadcasts by repeaters
+    uint64_t routeDuplicates = 0;       // Routed frames dropped as already seen
+    uint64_t forwardsCancelled = 0;     // Rebroadcasts suppressed by copies heard
+    uint64_t forwardDrops = 0;
+    uint64_t lbtScans = 0;              // Channel activity detections
+    uint64_t lbtDefers = 0;             // Scans that found the channel busy
+    uint64_t lbtDeferMs = 0;
+    uint64_t lbtForced = 0;             // Sent busy at the max-defer bound
+    uint64_t adrSwitches = 0;           // Rate switches sent ahead of faster DMs
+    uint64_t adrFastFrames = 0;         // Frames sent faster than the profile SF
+    uint64_t adrWindows = 0;            // Rate switches followed by their recipient
+    uint64_t dutyCycleDrops = 0;        // Frames over the duty cycle budget
+    uint64_t advertsSigned = 0;         // Signed adverts that verified
+    uint64_t advertSigFailures = 0;
+    uint64_t verifyBatches = 0;         // Batch checks of several adverts
+    uint32_t latencyP50Ms = 0;
+    uint32_t latencyP99Ms = 0;
+    uint32_t latencyMaxMs = 0;
+    double channelUtilisation = 0.0;    // Summed airtime / duration (can exceed 1 in sparse meshes)
+    ChannelStats channel;
+    double wallMs = 0.0;
+
+    double neighbourDeliveryRatio() const {
+        return neighbourExpected ? (double)neighbourReceptions / neighbourExpected : 0.0;
+    }
+    double networkReach() const {
+        return (messagesSent && nodes > 1) ? (double)networkReceptions / (messagesSent * (nodes - 1)) : 0.0;
+    }
+    double directDeliveryRatio() const {
+        return directSent ? (double)directDelivered / directSent : 0.0;
+    }
+};
+
+/**
+ * MeshSimulator - Runs many MeshCoreProtocol nodes on one SimChannel.
+ *
+ * Each node is an unmodified MeshCoreProtocol with a SimRadio backend. The
+ * simulator owns the virtual clock: every tick it advances the channel,
+ * fires scheduled application traffic and calls loop() on every node, so a
+ * given SimConfig (including seed) always produces the same report.
+ */
+class MeshSimulator {
+public:
+    explicit MeshSimulator(const SimConfig& config);
+    ~MeshSimulator();
+
+    /**
+     * Queue application traffic (in addition to the generated workload).
+     */
+    void scheduleChannelMessage(uint64_t atUs, int nodeId);
+    void scheduleAdvert(uint64_t atUs, int nodeId);
+
+    /**
+     * Run to config.durationS and return the results.
+     */
+    SimReport run();
+
+    SimChannel& getChannel() { return _channel; }
+    MeshCoreProtocol& getNode(int nodeId) { return *_nodes[nodeId].protocol; }
+    int getNodeCount() const { return (int)_nodes.size(); }
+
+private:
+    struct Node {
+        std::unique_ptr<MeshCoreProtocol> protocol;
+        SimRadio* radio;
+    };
+
+    enum class ActionType : uint8_t { ChannelMessage, DirectMessage, Advert };
+    struct Action {
+        ActionType type;
+        int nodeId;
+    };
+
+    struct SentMessage {
+        int sender;
+        int recipient;                  // -1 for channel messages
+        uint64_t sentAtUs;
+    };
+
+    void placeNodes();
+    void generateWorkload();
+    void runAction(const Action& action);
+    void sendDirectMessage(int nodeId);
+    void onMessage(int receiver, const Message& msg);
+
+    SimConfig _config;
+    Rng _rng;
+    Rng _directRng;                     // Recipient picks; keeps _rng's sequence unchanged
+    SimChannel _channel;
+    diag::ProtocolCounters _counters;   // Shared by all nodes
+    std::vector<Node> _nodes;
+    std::unordered_map<uint32_t, int> _nodeByKeyHash;
+    std::multimap<std::pair<uint64_t, uint64_t>, Action> _actions;
+    uint64_t _actionSeq = 0;
+
+    std::vector<SentMessage> _sent;
+    std::unordered_set<uint64_t> _receptions;     // (messageId << 32) | receiver
+    std::vector<uint32_t> _latenciesUs;
+    SimReport _report;
+};
+
+} // namespace meshola::sim
@@ -0,0 +1,55 @@
+#include "ReplayRadio.h"
+
+#include <cstring>
+
+namespace meshola::sim {
+
+void ReplayRadio::load(const uint8_t* data, size_t len, float rssi, float snr) {
+    _length = len < sizeof(_frame) ? len : sizeof(_frame);
+    memcpy(_frame, data, _length);
+    _rssi = rssi;
+    _snr = snr;
+    _irq |= RadioIrqRxDone;
+}
+
+bool ReplayRadio::begin(const RadioConfig& config) {
+    _config = config;
+    _irq = RadioIrqNone;
+    _length = 0;
+    return true;
+}
+
+void ReplayRadio::end() {
+    _irq = RadioIrqNone;
+}
+
+bool ReplayRadio::applyConfig(const RadioConfig& config) {
+    _config = config;
+    return true;
+}
+
+bool ReplayRadio::startTransmit(const uint8_t*, size_t) {
+    _transmitCount++;
+    _irq |= RadioIrqTxDone;
+    return true;
+}
+
+bool ReplayRadio::startChannelScan() {
+    // Replayed captures never contend for the channel
+    _irq |= RadioIrqCadDone;
+    return true;
+}
+
+bool ReplayRadio::readData(uint8_t* dest, size_t len) {
+    if (!dest || _length == 0) {
+        return false;
+    }
+    memcpy(dest, _frame, len < _length ? len : _length);
+    return true;
+}
+
+uint32_t ReplayRadio::getTimeOnAirUs(size_t len) {
+    return loraTimeOnAirUs(_config, len);
+}
+
+} // namespace meshola::sim
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "protocol/IRadio.h"
+
+#include <cstdint>
+
+namespace meshola::sim {
+
+/**
+ * ReplayRadio - IRadio backend that hands pre-recorded frames to a protocol.
+ *
+ * load() stages one frame and raises RadioIrqRxDone; the next protocol
+ * loop() reads it exactly as it would read the SX1262 FIFO. Transmissions
+ * are counted and dropped, and complete at once (RadioIrqTxDone).
+ */
+class ReplayRadio : public IRadio {
+public:
+    /**
+     * Stage a frame for the next loop(). Replaces any unread frame.
+     */
+    void load(const uint8_t* data, size_t len, float rssi, float snr);
+
+    uint32_t getTransmitCount() const { return _transmitCount; }
+
+    bool begin(const RadioConfig& config) override;
+    void end() override;
+    bool applyConfig(const RadioConfig& config) override;
+    bool startReceive() override { return true; }
+    bool startReceiveDutyCycle(uint32_t, uint32_t) override { return true; }
+    void standby() override {}
+    bool startTransmit(const uint8_t* data, size_t len) override;
+    bool startChannelScan() override;
+    uint32_t pollIrq() override { return _irq; }
+    void clearIrq(uint32_t flags) override { _irq &= ~flags; }
+    size_t getPacketLength() override { return _length; }
+    bool readData(uint8_t* dest, size_t len) override;
+    float getRssi() override { return _rssi; }
+    float getSnr() override { return _snr; }
+    uint32_t getTimeOnAirUs(size_t len) override;
+    bool isExclusive() const override { return true; }
+
+private:
+    RadioConfig _config{};
+    uint8_t _frame[MAX_RADIO_PACKET_LEN];
+    size_t _length = 0;
+    float _rssi = 0.0f;
+    float _snr = 0.0f;
+    uint32_t _irq = RadioIrqNone;
+    uint32_t _transmitCount = 0;
+};
+
+} // namespace meshola::sim
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+namespace meshola::sim {
+
+/**
+ * SplitMix64: small, fast and identical on every platform, so a seed
+ * reproduces the same run bit-for-bit (std:: distributions are not portable).
+ */
+class Rng {
+public:
+    explicit Rng(uint64_t seed = 1) : _state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (_state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * Uniform in [0, 1).
+     */
+    double uniform() { return (double)(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    /**
+     * Uniform integer in [0, bound).
+     */
+    uint32_t below(uint32_t bound) { return bound ? (uint32_t)(next() % bound) : 0; }
+
+    bool chance(double p) { return p > 0.0 && uniform() < p; }
+
+    /**
+     * Exponentially distributed value with the given mean.
+     */
+    double exponential(double mean) { return -mean * std::log(1.0 - uniform()); }
+
+private:
+    uint64_t _state;
+};
+
+} // namespace meshola::sim
@@ -0,0 +1,187 @@
+#include "SimChannel.h"
+#include "SimRadio.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace meshola::sim {
+
+/**
+ * Minimum demodulation SNR per spreading factor (SX126x datasheet).
+ */
+static float snrLimitDb(int spreadingFactor) {
+    static const float limits[] = { -2.5f, -5.0f, -7.5f, -10.0f, -12.5f, -15.0f, -17.5f, -20.0f };
+    int index = std::clamp(spreadingFactor, 5, 12) - 5;
+    return limits[index];
+}
+
+SimChannel::SimChannel(const ChannelConfig& config, uint64_t seed)
+    : _config(config)
+    , _rng(seed)
+{
+    _noiseFloorDbm = (float)(-174.0 + 10.0 * std::log10(config.radio.bandwidth * 1000.0) + config.noiseFigureDb);
+    _snrFloorDb = snrLimitDb(config.radio.spreadingFactor);
+}
+
+int SimChannel::addNode(SimRadio* radio, double x, double y) {
+    _nodes.push_back(Node{ .radio = radio, .x = x, .y = y });
+    _receivers.emplace_back();
+    return (int)_nodes.size() - 1;
+}
+
+float SimChannel::linkRssi(int a, int b) const {
+    double dx = _nodes[a].x - _nodes[b].x;
+    double dy = _nodes[a].y - _nodes[b].y;
+    double distance = std::max(1.0, std::sqrt(dx * dx + dy * dy));
+    double pathLoss = _config.referenceLossDb + 10.0 * _config.pathLossExponent * std::log10(distance);
+    return (float)(_config.radio.txPower - pathLoss);
+}
+
+float SimChannel::linkSnr(int a, int b) const {
+    return linkRssi(a, b) - _noiseFloorDbm;
+}
+
+bool SimChannel::inRange(int a, int b) const {
+    return a != b && linkSnr(a, b) >= _snrFloorDb;
+}
+
+int SimChannel::neighbourCount(int nodeId) const {
+    int count = 0;
+    for (int i = 0; i < (int)_nodes.size(); i++) {
+        if (inRange(nodeId, i)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool SimChannel::channelActive(int nodeId, uint64_t sinceUs) const {
+    for (const auto& signal : _receivers[nodeId].onAir) {
+        if (signal.endUs > sinceUs) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t SimChannel::transmit(int nodeId, const uint8_t* data, size_t len, uint64_t nowUs) {
+    Node& node = _nodes[nodeId];
+    const RadioConfig& radio = node.radio->getConfig();
+    uint32_t airtimeUs = loraTimeOnAirUs(radio, len);
+
+    Frame frame;
+    frame.sender = nodeId;
+    frame.spreadingFactor = radio.spreadingFactor;
+    frame.startUs = std::max(nowUs, node.txQueuedUntilUs);
+    frame.endUs = frame.startUs + airtimeUs;
+    frame.data.assign(data, data + len);
+    node.txQueuedUntilUs = frame.endUs;
+
+    uint32_t frameId = _nextFrameId++;
+    _events.emplace(std::make_pair(frame.startUs, _eventSeq++), Event{ EventType::TxStart, frameId });
+    _events.emplace(std::make_pair(frame.endUs, _eventSeq++), Event{ EventType::TxEnd, frameId });
+    _frames.emplace(frameId, std::move(frame));
+
+    _stats.framesSent++;
+    _stats.airtimeUs += airtimeUs;
+    return airtimeUs;
+}
+
+void SimChannel::advanceTo(uint64_t nowUs) {
+    while (!_events.empty() && _events.begin()->first.first <= nowUs) {
+        Event event = _events.begin()->second;
+        _events.erase(_events.begin());
+        if (event.type == EventType::TxStart) {
+            onTxStart(event.frameId);
+        } else {
+            onTxEnd(event.frameId);
+        }
+    }
+}
+
+uint64_t SimChannel::nextEventUs() const {
+    return _events.empty() ? std::numeric_limits<uint64_t>::max() : _events.begin()->first.first;
+}
+
+void SimChannel::onTxStart(uint32_t frameId) {
+    const Frame& frame = _frames.at(frameId);
+    Node& sender = _nodes[frame.sender];
+    sender.txActiveUntilUs = frame.endUs;
+
+    // Half duplex: whatever the sender was receiving is lost
+    Receiver& own = _receivers[frame.sender];
+    if (own.locked) {
+        own.locked = false;
+        _stats.halfDuplexDrops++;
+    }
+
+    for (int r = 0; r < (int)_nodes.size(); r++) {
+        if (!inRange(frame.sender, r)) {
+            continue;
+        }
+        Receiver& rx = _receivers[r];
+        float rssi = linkRssi(frame.sender, r);
+
+        // Forget energy that has already left the air
+        rx.onAir.erase(std::remove_if(rx.onAir.begin(), rx.onAir.end(),
+                                      [&](const Signal& s) { return s.endUs <= frame.startUs; }),
+                       rx.onAir.end());
+
+        bool canReceive = _nodes[r].txActiveUntilUs <= frame.startUs && _nodes[r].radio->isListening();
+        bool canDemodulate = _nodes[r].radio->getConfig().spreadingFactor == frame.spreadingFactor &&
+                             linkSnr(frame.sender, r) >= snrLimitDb(frame.spreadingFactor);
+        if (!canReceive) {
+            _stats.halfDuplexDrops++;
+        } else if (!canDemodulate) {
+            // Energy on the channel only; a locked frame still suffers below
+            _stats.rateMismatches++;
+            if (rx.locked && rx.lockedRssi < rssi + _config.captureThresholdDb) {
+                rx.lockedCorrupt = true;
+            }
+        } else if (rx.locked) {
+            // Receiver stays locked on the earlier frame; the new one is lost
+            // and destroys the earlier one unless it is clearly weaker
+            if (rx.lockedRssi < rssi + _config.captureThresholdDb) {
+                rx.lockedCorrupt = true;
+            }
+            _stats.collisions++;
+        } else {
+            float strongest = -std::numeric_limits<float>::infinity();
+            for (const auto& signal : rx.onAir) {
+                strongest = std::max(strongest, signal.rssi);
+            }
+            rx.locked = true;
+            rx.lockedFrame = frameId;
+            rx.lockedRssi = rssi;
+            rx.lockedCorrupt = strongest > rssi - _config.captureThresholdDb;
+        }
+        rx.onAir.push_back(Signal{ .frameId = frameId, .endUs = frame.endUs, .rssi = rssi });
+    }
+}
+
+void SimChannel::onTxEnd(uint32_t frameId) {
+    auto it = _frames.find(frameId);
+    const Frame& frame = it->second;
+
+    for (int r = 0; r < (int)_nodes.size(); r++) {
+        Receiver& rx = _receivers[r];
+        if (!rx.locked || rx.lockedFrame != frameId) {
+            continue;
+        }
+        rx.locked = false;
+        SimRadio* radio = _nodes[r].radio;
+        if (rx.lockedCorrupt) {
+            _stats.collisions++;
+            radio->deliverCrcError();
+        } else if (_rng.chance(_config.lossProbability)) {
+            _stats.randomLoss++;
+        } else {
+            _stats.delivered++;
+            radio->deliver(frame.data.data(), frame.data.size(), rx.lockedRssi, linkSnr(frame.sender, r));
+        }
+    }
+    _frames.erase(it);
+}
+
+} // namespace meshola::sim
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "Rng.h"
+#include "protocol/IRadio.h"
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace meshola::sim {
+
+class SimRadio;
+
+/**
+ * Propagation and interference model.
+ */
+struct ChannelConfig {
+    RadioConfig radio;                  // Shared modem settings (SF/BW/CR/power)
+    double pathLossExponent = 3.0;      // Log-distance model
+    double referenceLossDb = 31.7;      // Path loss at 1 m (~915 MHz)
+    double noiseFigureDb = 6.0;
+    double captureThresholdDb = 6.0;    // Stronger frame survives a collision by this margin
+    double lossProbability = 0.0;       // Extra random frame loss (fading, interference)
+};
+
+struct ChannelStats {
+    uint64_t framesSent = 0;
+    uint64_t airtimeUs = 0;
+    uint64_t delivered = 0;             // Frames handed to a receiver intact
+    uint64_t collisions = 0;            // Receptions destroyed by overlap
+    uint64_t randomLoss = 0;            // Receptions dropped by lossProbability
+    uint64_t halfDuplexDrops = 0;       // Receiver was transmitting or not in RX
+    uint64_t rateMismatches = 0;        // Receiver on another SF, or link below the frame's SF floor
+};
+
+/**
+ * SimChannel - Shared virtual LoRa channel.
+ *
+ * Nodes sit at fixed positions; link RSSI follows a log-distance path loss
+ * model and a link exists when the SNR clears the demodulation floor for the
+ * configured SF. Frames occupy the channel for their real time on air at
+ * the sender's current settings, and are only demodulated by receivers
+ * tuned to the same SF whose link clears that SF's floor; to everyone else
+ * in range they are just interference.
+ *
+ * Receivers lock onto the first frame they hear. An overlapping frame
+ * destroys it unless the locked frame is captureThresholdDb stronger; a frame
+ * that starts while stronger energy is still on air is received corrupted.
+ * Transmitting nodes cannot receive, and a node's transmissions are
+ * serialised as on a real half-duplex radio.
+ *
+ * Everything is driven by advanceTo(); the channel never reads a clock, and
+ * events at the same instant are processed in insertion order.
+ */
+class SimChannel {
+public:
+    SimChannel(const ChannelConfig& config, uint64_t seed);
+
+    /**
+     * Add a node at (x, y) metres. Returns its id.
+     */
+    int addNode(SimRadio* radio, double x, double y);
+
+    int getNodeCount() const { return (int)_nodes.size(); }
+
+    /**
+     * Queue a frame from nodeId. Starts at nowUs, or when the node's previous
+     * frame has finished. Returns the time on air.
+     */
+    uint32_t transmit(int nodeId, const uint8_t* data, size_t len, uint64_t nowUs);
+
+    /**
+     * Process all channel events up to and including nowUs.
+     */
+    void advanceTo(uint64_t nowUs);
+
+    /**
+     * Time of the next pending event, or UINT64_MAX if idle.
+     */
+    uint64_t nextEventUs() const;
+
+    /**
+     * True if a frame from a can be demodulated by b (ignoring interference).
+     */
+    bool inRange(int a, int b) const;
+
+    /**
+     * Static link RSSI/SNR between two nodes.
+     */
+    float linkRssi(int a, int b) const;
+    float linkSnr(int a, int b) const;
+
+    /**
+     * Number of nodes within range of nodeId.
+     */
+    int neighbourCount(int nodeId) const;
+
+    /**
+     * True if a frame audible at nodeId was on air at any time since sinceUs
+     * (channel activity detection).
+     */
+    bool channelActive(int nodeId, uint64_t sinceUs) const;
+
+    const ChannelConfig& getConfig() const { return _config; }
+    const ChannelStats& getStats() const { return _stats; }
+
+private:
+    struct Node {
+        SimRadio* radio;
+        double x;
+        double y;
+        uint64_t txQueuedUntilUs = 0;   // End of the last queued frame
+        uint64_t txActiveUntilUs = 0;   // End of the frame currently on air
+    };
+
+    struct Frame {
+        int sender;
+        uint8_t spreadingFactor;
+        uint64_t startUs;
+        uint64_t endUs;
+        std::vector<uint8_t> data;
+    };
+
+    // Per-receiver reception state
+    struct Signal {
+        uint32_t frameId;
+        uint64_t endUs;
+        float rssi;
+    };
+    struct Receiver {
+        std::vector<Signal> onAir;      // Everything currently audible
+        bool locked = false;
+        uint32_t lockedFrame = 0;
+        float lockedRssi = 0.0f;
+        bool lockedCorrupt = false;
+    };
+
+    enum class EventType : uint8_t { TxStart, TxEnd };
+    struct Event {
+        EventType type;
+        uint32_t frameId;
+    };
+
+    void onTxStart(uint32_t frameId);
+    void onTxEnd(uint32_t frameId);
+
+    ChannelConfig _config;
+    Rng _rng;
+    ChannelStats _stats;
+    float _noiseFloorDbm;
+    float _snrFloorDb;
+    std::vector<Node> _nodes;
+    std::vector<Receiver> _receivers;
+    std::map<uint32_t, Frame> _frames;  // In flight
+    uint32_t _nextFrameId = 1;
+    // (time, sequence) keeps same-instant events in insertion order
+    std::multimap<std::pair<uint64_t, uint64_t>, Event> _events;
+    uint64_t _eventSeq = 0;
+};
+
+} // namespace meshola::sim
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "protocol/IRadio.h"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace meshola::sim {
+
+class SimChannel;
+
+/**
+ * SimRadio - IRadio backend attached to a SimChannel.
+ *
+ * startTransmit() hands the frame to the channel, which keeps it on air for
+ * its time on air; RadioIrqTxDone is raised once virtual time has passed its
+ * end. startChannelScan() listens for CAD_SYMBOLS symbols and reports any
+ * audible frame on air during that window. Received frames are queued and reported through RadioIrqRxDone like
+ * the hardware FIFO.
+ */
+class SimRadio : public IRadio {
+public:
+    explicit SimRadio(SimChannel& channel);
+
+    void attach(int nodeId) { _nodeId = nodeId; }
+    int getNodeId() const { return _nodeId; }
+
+    bool begin(const RadioConfig& config) override;
+    void end() override;
+    bool applyConfig(const RadioConfig& config) override;
+    bool startReceive() override;
+    bool startReceiveDutyCycle(uint32_t rxPeriodUs, uint32_t sleepPeriodUs) override;
+    void standby() override;
+    bool startTransmit(const uint8_t* data, size_t len) override;
+    bool startChannelScan() override;
+    uint32_t pollIrq() override;
+    void clearIrq(uint32_t flags) override;
+    size_t getPacketLength() override;
+    bool readData(uint8_t* dest, size_t len) override;
+    float getRssi() override;
+    float getSnr() override;
+    uint32_t getTimeOnAirUs(size_t len) override;
+    bool isExclusive() const override { return true; }
+
+    /**
+     * Called by SimChannel.
+     */
+    bool isListening() const { return _listening; }
+    const RadioConfig& getConfig() const { return _config; }
+    void deliver(const uint8_t* data, size_t len, float rssi, float snr);
+    void deliverCrcError();
+
+private:
+    struct RxFrame {
+        std::vector<uint8_t> data;
+        float rssi;
+        float snr;
+    };
+
+    SimChannel& _channel;
+    RadioConfig _config{};
+    int _nodeId = -1;
+    bool _active = false;
+    bool _listening = false;
+    uint32_t _irq = RadioIrqNone;
+    uint64_t _txDoneUs = 0;             // End of the frame on air, 0 = none
+    uint64_t _cadStartUs = 0;
+    uint64_t _cadDoneUs = 0;            // End of the channel scan, 0 = none
+    std::deque<RxFrame> _rxQueue;
+    float _lastRssi = 0.0f;
+    float _lastSnr = 0.0f;
+
+    static constexpr size_t RX_QUEUE_DEPTH = 4;
+    static constexpr uint32_t CAD_SYMBOLS = 2;  // SX126x default cadSymbolNum
+};
+
+} // namespace meshola::sim
@@ -0,0 +1,16 @@
+#include "VirtualClock.h"
+#include "util/Clock.h"
+
+namespace meshola::sim {
+
+uint64_t VirtualClock::_nowUs = 0;
+
+void VirtualClock::install() {
+    clock::setSource(&VirtualClock::nowUs);
+}
+
+void VirtualClock::uninstall() {
+    clock::setSource(nullptr);
+}
+
+} // namespace meshola::sim
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+namespace meshola::sim {
+
+/**
+ * Simulated time. install() routes meshola::clock through it, so protocol
+ * and service code see virtual time that only moves when the simulator
+ * advances it.
+ */
+class VirtualClock {
+public:
+    static void install();
+    static void uninstall();
+
+    static uint64_t nowUs() { return _nowUs; }
+    static void setUs(uint64_t us) { _nowUs = us; }
+    static void advanceUs(uint64_t us) { _nowUs += us; }
+
+private:
+    static uint64_t _nowUs;
+};
+
+} // namespace meshola::sim
@@ -0,0 +1,172 @@
+/**
+ * meshola_codec_bench - Compression ratio and speed of the chat text codec.
+ *
+ * Each line of the corpus (default: sim/corpus/chat.txt) is one message.
+ * Reports the overall and per-message compression ratio, how many messages
+ * grow, and encode/decode cost per message in nanoseconds and, on x86, TSC
+ * cycles.
+ *
+ *   meshola_codec_bench [CORPUS] [--iterations N] [--json]
+ */
+
+#include "protocol/TextCodec.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MESHOLA_BENCH_TSC 1
+#else
+#define MESHOLA_BENCH_TSC 0
+#endif
+
+using namespace meshola;
+
+namespace {
+
+constexpr size_t MAX_TEXT = 256;
+
+struct Cost {
+    double ns = 0.0;
+    double cycles = 0.0;
+};
+
+uint64_t cycleCount() {
+#if MESHOLA_BENCH_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Average cost of fn() per message over all messages and iterations.
+ */
+template <typename Fn>
+Cost measure(size_t messages, uint32_t iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t startCycles = cycleCount();
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (size_t m = 0; m < messages; m++) {
+            fn(m);
+        }
+    }
+    uint64_t cycles = cycleCount() - startCycles;
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    double runs = (double)messages * iterations;
+    return Cost{ns / runs, cycles / runs};
+}
+
+} // namespace
+
+static void printUsage(const char* argv0) {
+    fprintf(stderr,
+        "Usage: %s [CORPUS] [options]\n"
+        "  --iterations N     Passes over the corpus for timing (default 2000)\n"
+        "  --json             Print the report as JSON\n",
+        argv0);
+}
+
+int main(int argc, char** argv) {
+    const char* corpusPath = MESHOLA_DEFAULT_CORPUS;
+    uint32_t iterations = 2000;
+    bool json = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--iterations") == 0 && i + 1 < argc) {
+            iterations = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(arg, "--json") == 0) {
+            json = true;
+        } else if (arg[0] != '-') {
+            corpusPath = arg;
+        } else {
+            printUsage(argv[0]);
+            return strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0 ? 0 : 2;
+        }
+    }
+    if (iterations == 0) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    FILE* file = fopen(corpusPath, "r");
+    if (!file) {
+        fprintf(stderr, "Cannot open corpus: %s\n", corpusPath);
+        return 1;
+    }
+    std::vector<std::string> lines;
+    char buffer[1024];
+    while (fgets(buffer, sizeof(buffer), file)) {
+        size_t len = strcspn(buffer, "\r\n");
+        if (len > 0 && len < MAX_TEXT) {
+            lines.emplace_back(buffer, len);
+        }
+    }
+    fclose(file);
+    if (lines.empty()) {
+        fprintf(stderr, "Corpus is empty: %s\n", corpusPath);
+        return 1;
+    }
+
+    // Correctness and ratio
+    std::vector<std::vector<uint8_t>> encoded(lines.size());
+    size_t rawBytes = 0;
+    size_t encodedBytes = 0;
+    size_t grown = 0;
+    size_t mismatches = 0;
+    double ratioSum = 0.0;
+    for (size_t m = 0; m < lines.size(); m++) {
+        uint8_t out[MAX_TEXT * 2];
+        size_t len = compressText(lines[m].data(), lines[m].size(), out, sizeof(out));
+        encoded[m].assign(out, out + len);
+        char decoded[MAX_TEXT];
+        size_t decodedLen = decompressText(out, len, decoded, sizeof(decoded));
+        if (len == 0 || decodedLen != lines[m].size() || memcmp(decoded, lines[m].data(), decodedLen) != 0) {
+            mismatches++;
+        }
+        // What goes on air: the codec is skipped when it does not help
+        size_t sent = std::min(len, lines[m].size());
+        rawBytes += lines[m].size();
+        encodedBytes += sent;
+        grown += len > lines[m].size() ? 1 : 0;
+        ratioSum += (double)sent / lines[m].size();
+    }
+
+    // Speed
+    uint8_t scratch[MAX_TEXT * 2];
+    char text[MAX_TEXT];
+    volatile size_t sink = 0;
+    Cost encode = measure(lines.size(), iterations, [&](size_t m) {
+        sink = sink + compressText(lines[m].data(), lines[m].size(), scratch, sizeof(scratch));
+    });
+    Cost decode = measure(lines.size(), iterations, [&](size_t m) {
+        sink = sink + decompressText(encoded[m].data(), encoded[m].size(), text, sizeof(text));
+    });
+
+    double ratio = (double)encodedBytes / rawBytes;
+    double meanRatio = ratioSum / lines.size();
+    if (json) {
+        printf("{\"messages\":%zu,\"raw_bytes\":%zu,\"encoded_bytes\":%zu,\"ratio\":%.3f,\"mean_ratio\":%.3f,"
+               "\"grown\":%zu,\"mismatches\":%zu,\"encode_ns\":%.1f,\"decode_ns\":%.1f,"
+               "\"encode_cycles\":%.0f,\"decode_cycles\":%.0f}\n",
+               lines.size(), rawBytes, encodedBytes, ratio, meanRatio, grown, mismatches,
+               encode.ns, decode.ns, encode.cycles, decode.cycles);
+    } else {
+        printf("corpus=%s messages=%zu\n", corpusPath, lines.size());
+        printf("bytes: raw=%zu encoded=%zu ratio=%.3f mean_ratio=%.3f grown=%zu mismatches=%zu\n",
+               rawBytes, encodedBytes, ratio, meanRatio, grown, mismatches);
+        printf("encode: %.1fns", encode.ns);
+        if (MESHOLA_BENCH_TSC) printf(" %.0f cycles", encode.cycles);
+        printf("/msg\ndecode: %.1fns", decode.ns);
+        if (MESHOLA_BENCH_TSC) printf(" %.0f cycles", decode.cycles);
+        printf("/msg\n");
+    }
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,317 @@
+/**
+ * meshola_crypto_bench - Reference vectors and cost of the crypto layer.
+ *
+ * Checks the primitives against published test vectors (FIPS 180-2 SHA,
+ * RFC 4231 HMAC, SP 800-38A AES-CTR, RFC 7748 X25519, RFC 8032 Ed25519),
+ * then times key generation, signing, single and batch verification, key
+ * exchange and the per-peer cache, in microseconds and, on x86, TSC cycles.
+ * Host figures use the portable code paths; the ESP32 runs SHA and AES on
+ * its accelerators.
+ *
+ *   meshola_crypto_bench [--iterations N] [--json]
+ *
+ * Exits non-zero if any vector fails.
+ */
+
+#include "crypto/Aes.h"
+#include "crypto/Ed25519.h"
+#include "crypto/PeerCrypto.h"
+#include "crypto/Sha2.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MESHOLA_BENCH_TSC 1
+#else
+#define MESHOLA_BENCH_TSC 0
+#endif
+
+using namespace meshola::crypto;
+
+namespace {
+
+constexpr size_t PAYLOAD_LEN = 160;         // A long chat message
+constexpr uint32_t SYMMETRIC_FACTOR = 100;  // Cheap operations run this many times more
+
+struct Cost {
+    double us = 0.0;
+    double cycles = 0.0;
+};
+
+uint64_t cycleCount() {
+#if MESHOLA_BENCH_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Average cost of one fn() call over iterations, divided by perCall items.
+ */
+template <typename Fn>
+Cost measure(uint32_t iterations, size_t perCall, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t startCycles = cycleCount();
+    for (uint32_t i = 0; i < iterations; i++) {
+        fn(i);
+    }
+    uint64_t cycles = cycleCount() - startCycles;
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    double runs = (double)iterations * perCall;
+    return Cost{us / runs, cycles / runs};
+}
+
+std::vector<uint8_t> fromHex(const char* hex) {
+    std::vector<uint8_t> out;
+    for (size_t i = 0; hex[i] && hex[i + 1]; i += 2) {
+        char byte[3] = { hex[i], hex[i + 1], 0 };
+        out.push_back((uint8_t)strtoul(byte, nullptr, 16));
+    }
+    return out;
+}
+
+int failures = 0;
+
+void check(const char* name, const uint8_t* actual, const char* expectedHex) {
+    std::vector<uint8_t> expected = fromHex(expectedHex);
+    if (memcmp(actual, expected.data(), expected.size()) != 0) {
+        fprintf(stderr, "FAIL %s\n", name);
+        failures++;
+    }
+}
+
+void checkTrue(const char* name, bool ok) {
+    if (!ok) {
+        fprintf(stderr, "FAIL %s\n", name);
+        failures++;
+    }
+}
+
+struct Rfc8032Case {
+    const char* seed;
+    const char* message;
+    const char* publicKey;
+    const char* signature;
+};
+
+const Rfc8032Case RFC8032_CASES[] = {
+    {   // Test 1
+        "9d61b19deffd5a60ba844af492ec2cc44449c5697b326919703bac031cae7f60",
+        "",
+        "d75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a",
+        "e5564300c360ac729086e2cc806e828a84877f1eb8e5d974d873e06522490155"
+        "5fb8821590a33bacc61e39701cf9b46bd25bf5f0595bbe24655141438e7a100b"
+    },
+    {   // Test 2
+        "4ccd089b28ff96da9db6c346ec114e0f5b8a319f35aba624da8cf6ed4fb8a6fb",
+        "72",
+        "3d4017c3e843895a92b70aa74d1b7ebc9c982ccf2ec4968cc0cd55f12af4660c",
+        "92a009a9f0d4cab8720e820b5f642540a2b27b5416503f8fb3762223ebdb69da"
+        "085ac1e43e15996e458f3613d0f11d8c387b2eaeb4302aeeb00d291612bb0c00"
+    },
+};
+
+void checkVectors() {
+    uint8_t digest[SHA512_LEN];
+    sha256("abc", 3, digest);
+    check("sha256", digest, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    sha512("abc", 3, digest);
+    check("sha512", digest,
+          "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+          "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f");
+    const char* hmacData = "what do ya want for nothing?";
+    hmacSha256(reinterpret_cast<const uint8_t*>("Jefe"), 4, hmacData, strlen(hmacData), digest);
+    check("hmac-sha256", digest, "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+
+    std::vector<uint8_t> key = fromHex("2b7e151628aed2a6abf7158809cf4f3c");
+    std::vector<uint8_t> iv = fromHex("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+    std::vector<uint8_t> block = fromHex(
+        "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+        "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710");
+    aes128Ctr(key.data(), iv.data(), block.data(), block.size());
+    check("aes128-ctr", block.data(),
+          "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+          "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee");
+
+    uint8_t shared[X25519_LEN];
+    std::vector<uint8_t> scalar = fromHex("a546e36bf0527c9d3b16154b82465edd62144c0ac1fc5a18506a2244ba449ac4");
+    std::vector<uint8_t> u = fromHex("e6db6867583030db3594c1a424b15f7c726624ec26b3353b10a903a6d0ab1c4c");
+    x25519(shared, scalar.data(), u.data());
+    check("x25519", shared, "c3da55379de9c6908e94ea4df28d084f32eccf03491c71f754b4075577a28552");
+
+    for (const Rfc8032Case& c : RFC8032_CASES) {
+        std::vector<uint8_t> seed = fromHex(c.seed);
+        std::vector<uint8_t> message = fromHex(c.message);
+        uint8_t publicKey[ED25519_PUBLIC_KEY_LEN];
+        uint8_t signature[ED25519_SIGNATURE_LEN];
+        ed25519PublicKey(seed.data(), publicKey);
+        check("ed25519 public key", publicKey, c.publicKey);
+        ed25519Sign(seed.data(), publicKey, message.data(), message.size(), signature);
+        check("ed25519 sign", signature, c.signature);
+        checkTrue("ed25519 verify", ed25519Verify(publicKey, message.data(), message.size(), signature));
+        signature[0] ^= 1;
+        checkTrue("ed25519 reject", !ed25519Verify(publicKey, message.data(), message.size(), signature));
+    }
+}
+
+} // namespace
+
+static void printUsage(const char* argv0) {
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --iterations N     Public-key operations to time (default 200)\n"
+        "  --json             Print the report as JSON\n",
+        argv0);
+}
+
+int main(int argc, char** argv) {
+    uint32_t iterations = 200;
+    bool json = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "--iterations") == 0 && i + 1 < argc) {
+            iterations = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(arg, "--json") == 0) {
+            json = true;
+        } else {
+            printUsage(argv[0]);
+            return strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0 ? 0 : 2;
+        }
+    }
+    if (iterations == 0) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    checkVectors();
+
+    // Identities and signed messages for the timings
+    constexpr size_t KEYS = ED25519_MAX_BATCH;
+    uint8_t seeds[KEYS][ED25519_SEED_LEN];
+    uint8_t publicKeys[KEYS][ED25519_PUBLIC_KEY_LEN];
+    uint8_t messages[KEYS][PAYLOAD_LEN];
+    uint8_t signatures[KEYS][ED25519_SIGNATURE_LEN];
+    Ed25519Item items[KEYS];
+    for (size_t k = 0; k < KEYS; k++) {
+        for (size_t b = 0; b < ED25519_SEED_LEN; b++) {
+            seeds[k][b] = (uint8_t)(k * 31 + b * 7 + 1);
+        }
+        for (size_t b = 0; b < PAYLOAD_LEN; b++) {
+            messages[k][b] = (uint8_t)(k + b);
+        }
+        ed25519PublicKey(seeds[k], publicKeys[k]);
+        ed25519Sign(seeds[k], publicKeys[k], messages[k], PAYLOAD_LEN, signatures[k]);
+        items[k] = Ed25519Item{ publicKeys[k], messages[k], PAYLOAD_LEN, signatures[k] };
+    }
+    checkTrue("ed25519 batch", ed25519VerifyBatch(items, KEYS));
+
+    // Both ends of a peer pair derive the same keys; a tampered frame fails
+    PeerKeyCache alice;
+    PeerKeyCache bob;
+    alice.setIdentity(seeds[0]);
+    bob.setIdentity(seeds[1]);
+    const PeerKeys* aliceKeys = alice.lookup(publicKeys[1]);
+    const PeerKeys* bobKeys = bob.lookup(publicKeys[0]);
+    checkTrue("peer keys", aliceKeys && bobKeys && memcmp(aliceKeys, bobKeys, sizeof(PeerKeys)) == 0);
+    uint8_t nonce[PEER_NONCE_LEN] = { 1, 2, 3, 4, 0, 0, 0, 1 };
+    uint8_t payload[PAYLOAD_LEN];
+    uint8_t tag[PEER_TAG_LEN];
+    memcpy(payload, messages[0], PAYLOAD_LEN);
+    if (aliceKeys && bobKeys) {
+        seal(*aliceKeys, nonce, payload, PAYLOAD_LEN, tag);
+        payload[5] ^= 1;
+        checkTrue("peer open rejects", !open(*bobKeys, nonce, payload, PAYLOAD_LEN, tag));
+        payload[5] ^= 1;
+        checkTrue("peer open", open(*bobKeys, nonce, payload, PAYLOAD_LEN, tag) &&
+                               memcmp(payload, messages[0], PAYLOAD_LEN) == 0);
+    }
+
+    // Speed
+    volatile uint32_t sink = 0;
+    uint8_t scratchKey[ED25519_PUBLIC_KEY_LEN];
+    uint8_t scratchSig[ED25519_SIGNATURE_LEN];
+    uint8_t shared[X25519_LEN];
+    Cost keygen = measure(iterations, 1, [&](uint32_t i) {
+        ed25519PublicKey(seeds[i % KEYS], scratchKey);
+        sink = sink + scratchKey[0];
+    });
+    Cost sign = measure(iterations, 1, [&](uint32_t i) {
+        size_t k = i % KEYS;
+        ed25519Sign(seeds[k], publicKeys[k], messages[k], PAYLOAD_LEN, scratchSig);
+        sink = sink + scratchSig[0];
+    });
+    Cost verify = measure(iterations, 1, [&](uint32_t i) {
+        size_t k = i % KEYS;
+        sink = sink + ed25519Verify(publicKeys[k], messages[k], PAYLOAD_LEN, signatures[k]);
+    });
+    uint32_t batches = (iterations + KEYS - 1) / KEYS;
+    Cost batch = measure(batches, KEYS, [&](uint32_t) {
+        sink = sink + ed25519VerifyBatch(items, KEYS);
+    });
+    Cost exchange = measure(iterations, 1, [&](uint32_t i) {
+        sink = sink + ed25519KeyExchange(seeds[i % KEYS], publicKeys[(i + 1) % KEYS], shared);
+    });
+
+    // Cache: a working set that fits, then symmetric cost per message
+    PeerKeyCache cache;
+    cache.setIdentity(seeds[0]);
+    for (size_t k = 1; k < KEYS; k++) {
+        cache.lookup(publicKeys[k]);
+    }
+    uint32_t symmetricIterations = iterations * SYMMETRIC_FACTOR;
+    Cost cached = measure(symmetricIterations, 1, [&](uint32_t i) {
+        sink = sink + (cache.lookup(publicKeys[1 + i % (KEYS - 1)]) != nullptr);
+    });
+    const PeerKeys& keys = *cache.lookup(publicKeys[1]);
+    Cost sealCost = measure(symmetricIterations, 1, [&](uint32_t i) {
+        nonce[7] = (uint8_t)i;
+        seal(keys, nonce, payload, PAYLOAD_LEN, tag);
+        sink = sink + tag[0];
+    });
+    uint8_t received[PAYLOAD_LEN];
+    Cost openCost = measure(symmetricIterations, 1, [&](uint32_t) {
+        // open() decrypts in place; each pass gets the sealed frame
+        memcpy(received, payload, PAYLOAD_LEN);
+        sink = sink + open(keys, nonce, received, PAYLOAD_LEN, tag);
+    });
+
+    struct Row {
+        const char* name;
+        Cost cost;
+    };
+    const Row rows[] = {
+        { "keygen", keygen },
+        { "sign", sign },
+        { "verify", verify },
+        { "verify_batch", batch },
+        { "key_exchange", exchange },
+        { "cached_lookup", cached },
+        { "seal", sealCost },
+        { "open", openCost },
+    };
+    if (json) {
+        printf("{\"vector_failures\":%d,\"payload_bytes\":%zu,\"batch\":%zu", failures, PAYLOAD_LEN, KEYS);
+        for (const Row& row : rows) {
+            printf(",\"%s_us\":%.2f,\"%s_cycles\":%.0f", row.name, row.cost.us, row.name, row.cost.cycles);
+        }
+        printf(",\"cache_hits\":%lu,\"cache_misses\":%lu}\n",
+               (unsigned long)cache.hits(), (unsigned long)cache.misses());
+    } else {
+        printf("vectors: %s\n", failures == 0 ? "ok" : "FAILED");
+        printf("payload=%zuB batch=%zu (verify_batch is per signature)\n", PAYLOAD_LEN, KEYS);
+        for (const Row& row : rows) {
+            printf("%-14s %9.2fus", row.name, row.cost.us);
+            if (MESHOLA_BENCH_TSC) printf(" %10.0f cycles", row.cost.cycles);
+            printf("\n");
+        }
+        printf("cache: hits=%lu misses=%lu\n", (unsigned long)cache.hits(), (unsigned long)cache.misses());
+    }
+    return failures == 0 ? 0 : 1;
+}
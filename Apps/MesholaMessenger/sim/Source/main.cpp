@@ -0,0 +1,278 @@
+/**
+ * meshola_sim - Deterministic multi-node mesh simulator.
+ *
+ * Runs N MeshCoreProtocol instances on a virtual LoRa channel and prints
+ * throughput, latency and airtime figures. Same arguments, same output.
+ *
+ *   meshola_sim --nodes 200 --topology grid --spacing 3000 --sf 11 --bw 250 \
+ *               --duration 300 --interval 60 --loss 0.02 --seed 1 [--json]
+ *
+ * --repeaters and --dm exercise flood routing: the share of nodes that
+ * forward, and the share of messages sent as DMs (which use learned routes).
+ * --dm-length pads DMs to a realistic size, where adaptive data rate pays.
+ * --duty-cycle applies a regulatory transmit limit to every node.
+ * --signed-adverts gives nodes Ed25519 identities that sign their adverts.
+ *
+ * --capture writes the frames one node receives in the device capture
+ * format, for meshola_replay.
+ */
+
+#include "MeshSimulator.h"
+
+#include "diag/Capture.h"
+
+#include <Tactility/Log.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace meshola;
+using namespace meshola::sim;
+
+static void printUsage(const char* argv0) {
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --nodes N          Number of nodes (default 100)\n"
+        "  --topology T       grid | line | random (default grid)\n"
+        "  --spacing M        Node spacing in metres (default 3000)\n"
+        "  --sf N             Spreading factor 7-12 (default 11)\n"
+        "  --bw KHZ           Bandwidth in kHz (default 250)\n"
+        "  --cr N             Coding rate 5-8 (default 5)\n"
+        "  --power DBM        TX power (default 22)\n"
+        "  --preamble N       Preamble length in symbols (default 12)\n"
+        "  --duty-cycle N     Transmit limit in permille per hour, 0 = none (default 0)\n"
+        "  --ple X            Path loss exponent (default 3.0)\n"
+        "  --loss P           Extra random frame loss 0-1 (default 0)\n"
+        "  --duration S       Simulated seconds (default 300)\n"
+        "  --interval S       Mean per-node message interval, 0 = none (default 60)\n"
+        "  --dm P             Share of messages sent as DMs 0-1 (default 0)\n"
+        "  --dm-length N      Pad DM text to N characters (default: id only)\n"
+        "  --repeaters P      Share of nodes that forward 0-1 (default 0)\n"
+        "  --no-adverts       Turn off scheduled adverts\n"
+        "  --no-lbt           Transmit without listen-before-talk\n"
+        "  --no-adr           Send every DM at the profile SF\n"
+        "  --signed-adverts   Sign adverts and batch-verify them on receipt\n"
+        "  --tick MS          Protocol loop period (default 5)\n"
+        "  --seed N           Random seed (default 1)\n"
+        "  --capture FILE     Record the frames received by one node\n"
+        "  --capture-node N   Node to record with --capture (default 0)\n"
+        "  --json             Print the report as JSON\n"
+        "  -v                 Verbose protocol logging (repeat for more)\n",
+        argv0);
+}
+
+static bool parseTopology(const char* value, Topology& out) {
+    if (strcmp(value, "grid") == 0) { out = Topology::Grid; return true; }
+    if (strcmp(value, "line") == 0) { out = Topology::Line; return true; }
+    if (strcmp(value, "random") == 0) { out = Topology::Random; return true; }
+    return false;
+}
+
+static const char* topologyName(Topology topology) {
+    switch (topology) {
+        case Topology::Grid: return "grid";
+        case Topology::Line: return "line";
+        case Topology::Random: return "random";
+    }
+    return "?";
+}
+
+static void printText(const SimConfig& config, const SimReport& r) {
+    printf("nodes=%d topology=%s spacing=%.0fm sf=%u bw=%.1fkHz cr=4/%u seed=%llu\n",
+           r.nodes, topologyName(config.topology), config.spacingM,
+           config.channel.radio.spreadingFactor, config.channel.radio.bandwidth,
+           config.channel.radio.codingRate, (unsigned long long)config.seed);
+    printf("simulated=%us wall=%.0fms speedup=%.0fx avg_neighbours=%.1f\n",
+           r.durationS, r.wallMs, r.wallMs > 0 ? r.durationS * 1000.0 / r.wallMs : 0.0, r.avgNeighbours);
+    printf("messages: sent=%llu failed=%llu one_hop_delivery=%.1f%% network_reach=%.1f%%\n",
+           (unsigned long long)r.messagesSent, (unsigned long long)r.sendFailures,
+           r.neighbourDeliveryRatio() * 100.0, r.networkReach() * 100.0);
+    printf("latency: p50=%ums p99=%ums max=%ums\n", r.latencyP50Ms, r.latencyP99Ms, r.latencyMaxMs);
+    printf("dm: sent=%llu delivered=%.1f%% routed=%llu\n",
+           (unsigned long long)r.directSent, r.directDeliveryRatio() * 100.0,
+           (unsigned long long)r.directRouted);
+    printf("routing: repeaters=%d forwarded=%llu duplicates=%llu cancelled=%llu queue_drops=%llu\n",
+           r.repeaters, (unsigned long long)r.forwarded, (unsigned long long)r.routeDuplicates,
+           (unsigned long long)r.forwardsCancelled, (unsigned long long)r.forwardDrops);
+    printf("lbt: scans=%llu defers=%llu wait=%.1fs forced=%llu\n",
+           (unsigned long long)r.lbtScans, (unsigned long long)r.lbtDefers, r.lbtDeferMs / 1e3,
+           (unsigned long long)r.lbtForced);
+    printf("adr: switches=%llu fast_frames=%llu windows=%llu rate_mismatches=%llu\n",
+           (unsigned long long)r.adrSwitches, (unsigned long long)r.adrFastFrames,
+           (unsigned long long)r.adrWindows, (unsigned long long)r.channel.rateMismatches);
+    printf("duty_cycle: limit=%u permille drops=%llu\n",
+           config.channel.radio.dutyCyclePermille, (unsigned long long)r.dutyCycleDrops);
+    printf("adverts: sent=%llu suppressed=%llu contacts_learned=%llu signed=%llu bad_signatures=%llu "
+           "verify_batches=%llu\n",
+           (unsigned long long)r.advertsSent, (unsigned long long)r.advertsSuppressed,
+           (unsigned long long)r.contactsLearned,
+           (unsigned long long)r.advertsSigned, (unsigned long long)r.advertSigFailures,
+           (unsigned long long)r.verifyBatches);
+    printf("channel: frames=%llu airtime=%.1fs utilisation=%.1f%% delivered=%llu collisions=%llu "
+           "random_loss=%llu half_duplex=%llu\n",
+           (unsigned long long)r.channel.framesSent, r.channel.airtimeUs / 1e6, r.channelUtilisation * 100.0,
+           (unsigned long long)r.channel.delivered, (unsigned long long)r.channel.collisions,
+           (unsigned long long)r.channel.randomLoss, (unsigned long long)r.channel.halfDuplexDrops);
+}
+
+static void printJson(const SimConfig& config, const SimReport& r) {
+    printf("{\"nodes\":%d,\"topology\":\"%s\",\"spacing_m\":%.0f,\"sf\":%u,\"bw_khz\":%.1f,\"cr\":%u,"
+           "\"seed\":%llu,\"duration_s\":%u,\"wall_ms\":%.1f,\"avg_neighbours\":%.2f,"
+           "\"messages_sent\":%llu,\"send_failures\":%llu,\"one_hop_delivery\":%.4f,\"network_reach\":%.4f,"
+           "\"latency_p50_ms\":%u,\"latency_p99_ms\":%u,\"latency_max_ms\":%u,"
+           "\"dm_sent\":%llu,\"dm_delivery\":%.4f,\"dm_routed\":%llu,"
+           "\"repeaters\":%d,\"forwarded\":%llu,\"route_duplicates\":%llu,\"forwards_cancelled\":%llu,"
+           "\"forward_drops\":%llu,"
+           "\"lbt_scans\":%llu,\"lbt_defers\":%llu,\"lbt_wait_ms\":%llu,\"lbt_forced\":%llu,"
+           "\"adr_switches\":%llu,\"adr_fast_frames\":%llu,\"adr_windows\":%llu,\"rate_mismatches\":%llu,"
+           "\"duty_cycle_permille\":%u,\"duty_cycle_drops\":%llu,"
+           "\"adverts_sent\":%llu,\"adverts_suppressed\":%llu,\"contacts_learned\":%llu,"
+           "\"adverts_signed\":%llu,\"advert_sig_failures\":%llu,\"verify_batches\":%llu,"
+           "\"frames\":%llu,\"airtime_ms\":%llu,\"utilisation\":%.4f,\"delivered\":%llu,"
+           "\"collisions\":%llu,\"random_loss\":%llu,\"half_duplex\":%llu}\n",
+           r.nodes, topologyName(config.topology), config.spacingM, config.channel.radio.spreadingFactor,
+           config.channel.radio.bandwidth, config.channel.radio.codingRate,
+           (unsigned long long)config.seed, r.durationS, r.wallMs, r.avgNeighbours,
+           (unsigned long long)r.messagesSent, (unsigned long long)r.sendFailures,
+           r.neighbourDeliveryRatio(), r.networkReach(),
+           r.latencyP50Ms, r.latencyP99Ms, r.latencyMaxMs,
+           (unsigned long long)r.directSent, r.directDeliveryRatio(), (unsigned long long)r.directRouted,
+           r.repeaters, (unsigned long long)r.forwarded, (unsigned long long)r.routeDuplicates,
+           (unsigned long long)r.forwardsCancelled, (unsigned long long)r.forwardDrops,
+           (unsigned long long)r.lbtScans, (unsigned long long)r.lbtDefers,
+           (unsigned long long)r.lbtDeferMs, (unsigned long long)r.lbtForced,
+           (unsigned long long)r.adrSwitches, (unsigned long long)r.adrFastFrames,
+           (unsigned long long)r.adrWindows, (unsigned long long)r.channel.rateMismatches,
+           config.channel.radio.dutyCyclePermille, (unsigned long long)r.dutyCycleDrops,
+           (unsigned long long)r.advertsSent, (unsigned long long)r.advertsSuppressed,
+           (unsigned long long)r.contactsLearned,
+           (unsigned long long)r.advertsSigned, (unsigned long long)r.advertSigFailures,
+           (unsigned long long)r.verifyBatches,
+           (unsigned long long)r.channel.framesSent, (unsigned long long)(r.channel.airtimeUs / 1000),
+           r.channelUtilisation, (unsigned long long)r.channel.delivered,
+           (unsigned long long)r.channel.collisions, (unsigned long long)r.channel.randomLoss,
+           (unsigned long long)r.channel.halfDuplexDrops);
+}
+
+int main(int argc, char** argv) {
+    SimConfig config;
+    config.channel.radio = RadioConfig{
+        .frequency = 906.875f,
+        .bandwidth = 250.0f,
+        .spreadingFactor = 11,
+        .codingRate = 5,
+        .txPower = 22,
+        .preambleLength = LORA_DEFAULT_PREAMBLE_LEN,
+        .dutyCyclePermille = 0
+    };
+    bool json = false;
+    const char* capturePath = nullptr;
+    int captureNode = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        auto takeValue = [&]() -> const char* {
+            if (!value) {
+                fprintf(stderr, "Missing value for %s\n", arg);
+                exit(2);
+            }
+            i++;
+            return value;
+        };
+
+        if (strcmp(arg, "--nodes") == 0) {
+            config.nodeCount = atoi(takeValue());
+        } else if (strcmp(arg, "--topology") == 0) {
+            if (!parseTopology(takeValue(), config.topology)) {
+                fprintf(stderr, "Unknown topology: %s\n", value);
+                return 2;
+            }
+        } else if (strcmp(arg, "--spacing") == 0) {
+            config.spacingM = atof(takeValue());
+        } else if (strcmp(arg, "--sf") == 0) {
+            config.channel.radio.spreadingFactor = (uint8_t)atoi(takeValue());
+        } else if (strcmp(arg, "--bw") == 0) {
+            config.channel.radio.bandwidth = (float)atof(takeValue());
+        } else if (strcmp(arg, "--cr") == 0) {
+            config.channel.radio.codingRate = (uint8_t)atoi(takeValue());
+        } else if (strcmp(arg, "--power") == 0) {
+            config.channel.radio.txPower = (int8_t)atoi(takeValue());
+        } else if (strcmp(arg, "--preamble") == 0) {
+            config.channel.radio.preambleLength = (uint16_t)atoi(takeValue());
+        } else if (strcmp(arg, "--duty-cycle") == 0) {
+            config.channel.radio.dutyCyclePermille = (uint16_t)atoi(takeValue());
+        } else if (strcmp(arg, "--ple") == 0) {
+            config.channel.pathLossExponent = atof(takeValue());
+        } else if (strcmp(arg, "--loss") == 0) {
+            config.channel.lossProbability = atof(takeValue());
+        } else if (strcmp(arg, "--duration") == 0) {
+            config.durationS = (uint32_t)atoi(takeValue());
+        } else if (strcmp(arg, "--interval") == 0) {
+            config.messageIntervalS = atof(takeValue());
+        } else if (strcmp(arg, "--dm") == 0) {
+            config.directShare = atof(takeValue());
+        } else if (strcmp(arg, "--dm-length") == 0) {
+            config.directLength = (size_t)atoi(takeValue());
+        } else if (strcmp(arg, "--repeaters") == 0) {
+            config.repeaterShare = atof(takeValue());
+        } else if (strcmp(arg, "--no-adverts") == 0) {
+            config.sendAdverts = false;
+        } else if (strcmp(arg, "--no-lbt") == 0) {
+            config.listenBeforeTalk = false;
+        } else if (strcmp(arg, "--no-adr") == 0) {
+            config.adaptiveDataRate = false;
+        } else if (strcmp(arg, "--signed-adverts") == 0) {
+            config.signedAdverts = true;
+        } else if (strcmp(arg, "--tick") == 0) {
+            config.tickUs = (uint32_t)(atof(takeValue()) * 1000.0);
+        } else if (strcmp(arg, "--seed") == 0) {
+            config.seed = strtoull(takeValue(), nullptr, 10);
+        } else if (strcmp(arg, "--capture") == 0) {
+            capturePath = takeValue();
+        } else if (strcmp(arg, "--capture-node") == 0) {
+            captureNode = atoi(takeValue());
+        } else if (strcmp(arg, "--json") == 0) {
+            json = true;
+        } else if (strcmp(arg, "-v") == 0) {
+            sim::logLevel++;
+        } else {
+            printUsage(argv[0]);
+            return strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0 ? 0 : 2;
+        }
+    }
+
+    if (config.nodeCount < 1 || config.tickUs == 0 ||
+        config.channel.radio.spreadingFactor < 7 || config.channel.radio.spreadingFactor > 12 ||
+        config.channel.radio.dutyCyclePermille > DUTY_CYCLE_PERMILLE_MAX ||
+        captureNode < 0 || captureNode >= config.nodeCount ||
+        config.directShare < 0.0 || config.directShare > 1.0 ||
+        config.repeaterShare < 0.0 || config.repeaterShare > 1.0) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    MeshSimulator simulator(config);
+    diag::PacketCapture capture;
+    if (capturePath) {
+        if (!capture.open(capturePath, config.channel.radio)) {
+            fprintf(stderr, "Cannot write capture: %s\n", capturePath);
+            return 1;
+        }
+        simulator.getNode(captureNode).setCapture(&capture);
+    }
+    SimReport report = simulator.run();
+    if (capturePath) {
+        simulator.getNode(captureNode).setCapture(nullptr);
+        capture.close();
+        fprintf(stderr, "capture: %u frames from node %d -> %s\n",
+                capture.getRecordCount(), captureNode, capturePath);
+    }
+    if (json) {
+        printJson(config, report);
+    } else {
+        printText(config, report);
+    }
+    return 0;
+}
@@ -0,0 +1,246 @@
+/**
+ * meshola_replay - Feed a recorded RX capture through the protocol stack.
+ *
+ * Frames from a capture file (diag/Capture.h, written on the device or by
+ * meshola_sim --capture) are handed to MeshCoreProtocol through ReplayRadio
+ * back-to-back, with contact updates going through the service's
+ * EventCoalescer and, optionally, messages through MessageStore. Reports
+ * parse results and per-frame processing time.
+ *
+ *   meshola_replay capture.mcap [--repeat N] [--store DIR] [--json] [-v]
+ */
+
+#include "ReplayRadio.h"
+
+#include "diag/Capture.h"
+#include "diag/Metrics.h"
+#include "protocol/MeshCoreProtocol.h"
+#include "service/EventCoalescer.h"
+#include "storage/MessageStore.h"
+#include "util/Clock.h"
+
+#include <Tactility/Log.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace meshola;
+using namespace meshola::sim;
+
+namespace {
+
+struct Frame {
+    diag::CaptureRecordHeader header;
+    uint8_t data[255];
+};
+
+struct ReplayReport {
+    uint32_t framesInFile = 0;
+    uint64_t framesReplayed = 0;
+    uint64_t adverts = 0;
+    uint64_t messages = 0;
+    uint64_t parseFailures = 0;
+    uint64_t readErrors = 0;
+    uint64_t contactEvents = 0;
+    uint64_t contactBatches = 0;
+    uint64_t stored = 0;
+    uint64_t storeFailures = 0;
+    size_t contacts = 0;
+    double wallMs = 0.0;
+    diag::LatencyHistogram::Snapshot frameUs = {};
+    diag::LatencyHistogram::Snapshot storeUs = {};
+
+    double framesPerSecond() const { return wallMs > 0 ? framesReplayed * 1000.0 / wallMs : 0.0; }
+};
+
+/**
+ * Histogram percentiles are bucket upper bounds; never report more than the max.
+ */
+uint32_t percentile(const diag::LatencyHistogram::Snapshot& snapshot, uint32_t p) {
+    uint32_t bound = snapshot.percentileUs(p);
+    return bound < snapshot.maxUs ? bound : snapshot.maxUs;
+}
+
+} // namespace
+
+static void printUsage(const char* argv0) {
+    fprintf(stderr,
+        "Usage: %s CAPTURE [options]\n"
+        "  --repeat N         Replay the capture N times (default 1)\n"
+        "  --store DIR        Also append received messages to a MessageStore under DIR\n"
+        "  --json             Print the report as JSON\n"
+        "  -v                 Verbose protocol logging (repeat for more)\n",
+        argv0);
+}
+
+static void printText(const char* path, const diag::CaptureFileHeader& h, const ReplayReport& r) {
+    printf("capture=%s frames=%u freq=%.3fMHz sf=%u bw=%.1fkHz cr=4/%u\n",
+           path, r.framesInFile, h.frequencyKhz / 1000.0, h.spreadingFactor,
+           h.bandwidthHz / 1000.0, h.codingRate);
+    printf("replayed=%llu wall=%.1fms rate=%.0f frames/s\n",
+           (unsigned long long)r.framesReplayed, r.wallMs, r.framesPerSecond());
+    printf("parsed: adverts=%llu messages=%llu parse_failures=%llu read_errors=%llu contacts=%zu\n",
+           (unsigned long long)r.adverts, (unsigned long long)r.messages,
+           (unsigned long long)r.parseFailures, (unsigned long long)r.readErrors, r.contacts);
+    printf("coalescer: contact_events=%llu batches=%llu\n",
+           (unsigned long long)r.contactEvents, (unsigned long long)r.contactBatches);
+    printf("frame: p50=%uus p99=%uus max=%uus\n",
+           percentile(r.frameUs, 50), percentile(r.frameUs, 99), r.frameUs.maxUs);
+    if (r.storeUs.count > 0 || r.storeFailures > 0) {
+        printf("store: appended=%llu failed=%llu p50=%uus p99=%uus max=%uus\n",
+               (unsigned long long)r.stored, (unsigned long long)r.storeFailures,
+               percentile(r.storeUs, 50), percentile(r.storeUs, 99), r.storeUs.maxUs);
+    }
+}
+
+static void printJson(const diag::CaptureFileHeader& h, const ReplayReport& r) {
+    printf("{\"frames_in_file\":%u,\"freq_khz\":%u,\"sf\":%u,\"bw_khz\":%.1f,\"cr\":%u,"
+           "\"replayed\":%llu,\"wall_ms\":%.1f,\"frames_per_s\":%.1f,"
+           "\"adverts\":%llu,\"messages\":%llu,\"parse_failures\":%llu,\"read_errors\":%llu,"
+           "\"contacts\":%zu,\"contact_events\":%llu,\"contact_batches\":%llu,"
+           "\"frame_p50_us\":%u,\"frame_p99_us\":%u,\"frame_max_us\":%u,"
+           "\"stored\":%llu,\"store_failures\":%llu,\"store_p50_us\":%u,\"store_p99_us\":%u,\"store_max_us\":%u}\n",
+           r.framesInFile, h.frequencyKhz, h.spreadingFactor, h.bandwidthHz / 1000.0, h.codingRate,
+           (unsigned long long)r.framesReplayed, r.wallMs, r.framesPerSecond(),
+           (unsigned long long)r.adverts, (unsigned long long)r.messages,
+           (unsigned long long)r.parseFailures, (unsigned long long)r.readErrors,
+           r.contacts, (unsigned long long)r.contactEvents, (unsigned long long)r.contactBatches,
+           percentile(r.frameUs, 50), percentile(r.frameUs, 99), r.frameUs.maxUs,
+           (unsigned long long)r.stored, (unsigned long long)r.storeFailures,
+           percentile(r.storeUs, 50), percentile(r.storeUs, 99), r.storeUs.maxUs);
+}
+
+int main(int argc, char** argv) {
+    const char* capturePath = nullptr;
+    const char* storeDir = nullptr;
+    uint32_t repeat = 1;
+    bool json = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        auto takeValue = [&]() -> const char* {
+            if (!value) {
+                fprintf(stderr, "Missing value for %s\n", arg);
+                exit(2);
+            }
+            i++;
+            return value;
+        };
+
+        if (strcmp(arg, "--repeat") == 0) {
+            repeat = (uint32_t)atoi(takeValue());
+        } else if (strcmp(arg, "--store") == 0) {
+            storeDir = takeValue();
+        } else if (strcmp(arg, "--json") == 0) {
+            json = true;
+        } else if (strcmp(arg, "-v") == 0) {
+            sim::logLevel++;
+        } else if (arg[0] != '-' && !capturePath) {
+            capturePath = arg;
+        } else {
+            printUsage(argv[0]);
+            return strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0 ? 0 : 2;
+        }
+    }
+
+    if (!capturePath || repeat == 0) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    // Load the whole capture up front so file I/O stays out of the timings
+    diag::CaptureReader reader;
+    if (!reader.open(capturePath)) {
+        fprintf(stderr, "Not a capture file: %s\n", capturePath);
+        return 1;
+    }
+    std::vector<Frame> frames;
+    Frame frame;
+    while (reader.next(frame.header, frame.data)) {
+        frames.push_back(frame);
+    }
+
+    ReplayReport report;
+    report.framesInFile = (uint32_t)frames.size();
+
+    auto radio = std::make_unique<ReplayRadio>();
+    ReplayRadio* replayRadio = radio.get();
+    MeshCoreProtocol protocol(std::move(radio));
+    diag::ProtocolCounters counters;
+    protocol.setCounters(&counters);
+
+    uint8_t publicKey[PUBLIC_KEY_SIZE];
+    memset(publicKey, 0xA5, sizeof(publicKey));
+    protocol.setNodeName("replay");
+    protocol.setLocalIdentity(publicKey, "replay");
+
+    // Mirror the service: contacts are coalesced, messages go to storage
+    service::EventCoalescer coalescer(0);
+    std::unique_ptr<MessageStore> store;
+    if (storeDir) {
+        store = std::make_unique<MessageStore>(storeDir);
+        store->setActiveProfile("replay");
+    }
+    diag::LatencyHistogram frameUs;
+    diag::LatencyHistogram storeUs;
+
+    protocol.setContactCallback([&](const Contact& contact, bool isNew) {
+        coalescer.addContact(contact, isNew);
+        report.contactEvents++;
+    });
+    protocol.setMessageCallback([&](const Message& msg) {
+        if (!store) {
+            return;
+        }
+        uint64_t start = clock::micros();
+        if (store->appendMessage(msg)) {
+            report.stored++;
+        } else {
+            report.storeFailures++;
+        }
+        storeUs.record((uint32_t)(clock::micros() - start));
+    });
+
+    if (!protocol.init(reader.getRadioConfig()) || !protocol.start()) {
+        fprintf(stderr, "Protocol failed to start\n");
+        return 1;
+    }
+
+    service::ContactBatchEvent batch;
+    auto wallStart = std::chrono::steady_clock::now();
+    for (uint32_t pass = 0; pass < repeat; pass++) {
+        for (const Frame& f : frames) {
+            uint64_t start = clock::micros();
+            replayRadio->load(f.data, f.header.length, f.header.rssiX4 / 4.0f, f.header.snrX4 / 4.0f);
+            protocol.loop();
+            if (coalescer.takeContacts(batch)) {
+                report.contactBatches++;
+            }
+            frameUs.record((uint32_t)(clock::micros() - start));
+            report.framesReplayed++;
+        }
+    }
+    report.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+
+    protocol.stop();
+
+    report.adverts = counters.rxAdverts.get();
+    report.messages = counters.rxMessages.get();
+    report.parseFailures = counters.rxParseFailures.get();
+    report.readErrors = counters.rxReadErrors.get();
+    report.contacts = protocol.getContactCount();
+    report.frameUs = frameUs.snapshot();
+    report.storeUs = storeUs.snapshot();
+
+    if (json) {
+        printJson(reader.getHeader(), report);
+    } else {
+        printText(capturePath, reader.getHeader(), report);
+    }
+    return 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+/**
+ * Host stand-in for Tactility's logger so protocol sources build unmodified.
+ * Errors and warnings go to stderr; info/debug only when verbose logging is on.
+ */
+
+#include <cstdio>
+
+namespace meshola::sim {
+inline int logLevel = 0;    // 0 = errors, 1 = +warnings, 2 = +info, 3 = +debug
+}
+
+#define TT_SIM_LOG(level, letter, tag, format, ...) \
+    do { \
+        if (::meshola::sim::logLevel >= (level)) { \
+            fprintf(stderr, letter " [%s] " format "\n", tag, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define TT_LOG_E(tag, format, ...) TT_SIM_LOG(0, "E", tag, format, ##__VA_ARGS__)
+#define TT_LOG_W(tag, format, ...) TT_SIM_LOG(1, "W", tag, format, ##__VA_ARGS__)
+#define TT_LOG_I(tag, format, ...) TT_SIM_LOG(2, "I", tag, format, ##__VA_ARGS__)
+#define TT_LOG_D(tag, format, ...) TT_SIM_LOG(3, "D", tag, format, ##__VA_ARGS__)
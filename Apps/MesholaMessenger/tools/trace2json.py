@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""
+Convert a Meshola pipeline trace dump (diag/Trace.h) to Chrome trace JSON.
+
+Usage:
+    trace2json.py meshola_trace.bin [-o trace.json]
+
+Open the result in chrome://tracing or https://ui.perfetto.dev. Each stage
+gets its own track; the flow id (one per received/transmitted frame) is
+attached to every event so a single packet can be followed from IRQ to UI.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+HEADER = struct.Struct("<4sHHII")
+RECORD = struct.Struct("<QIBBH")
+MAGIC = b"MTRC"
+VERSION = 1
+
+# Keep in sync with TraceStage in diag/Trace.h
+STAGES = [
+    "mesh_loop",
+    "irq",
+    "read_data",
+    "parse_advert",
+    "parse_packet",
+    "append_message",
+    "publish",
+    "ui",
+    "transmit",
+    "verify_adverts",
+]
+
+PHASES = {0: "B", 1: "E", 2: "i"}
+
+
+def read_trace(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < HEADER.size:
+        raise ValueError("file too short")
+    magic, version, record_size, count, dropped = HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise ValueError("bad magic %r" % magic)
+    if version != VERSION or record_size != RECORD.size:
+        raise ValueError("unsupported trace version %d / record size %d" % (version, record_size))
+
+    records = []
+    offset = HEADER.size
+    for _ in range(count):
+        if offset + RECORD.size > len(data):
+            break
+        records.append(RECORD.unpack_from(data, offset))
+        offset += RECORD.size
+    return records, dropped
+
+
+def to_chrome(records):
+    events = []
+    for tid, name in enumerate(STAGES):
+        events.append({"ph": "M", "name": "thread_name", "pid": 1, "tid": tid, "args": {"name": name}})
+
+    base = records[0][0] if records else 0
+    for timestamp, flow, stage, phase, arg in records:
+        name = STAGES[stage] if stage < len(STAGES) else "stage_%d" % stage
+        event = {
+            "name": name,
+            "ph": PHASES.get(phase, "i"),
+            "ts": timestamp - base,
+            "pid": 1,
+            "tid": stage,
+            "args": {"flow": flow, "arg": arg},
+        }
+        if event["ph"] == "i":
+            event["s"] = "t"
+        events.append(event)
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("input", help="trace dump written by MesholaMsgService::dumpTrace()")
+    parser.add_argument("-o", "--output", help="output JSON file (default: stdout)")
+    args = parser.parse_args()
+
+    try:
+        records, dropped = read_trace(args.input)
+    except (OSError, ValueError) as e:
+        print("trace2json: %s" % e, file=sys.stderr)
+        return 1
+
+    if dropped:
+        print("trace2json: %d older records were overwritten" % dropped, file=sys.stderr)
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    json.dump(to_chrome(records), out)
+    if args.output:
+        out.close()
+        print("trace2json: wrote %d events to %s" % (len(records), args.output), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())